@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "atomic_file.hpp"
+#include "text.hpp"
+#ifdef _WIN32
+#  include <process.h>
+#else
+#  include <unistd.h>
+#endif
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <system_error>
+
+namespace gputester {
+
+// A clash needs another writer with the same pid and random suffix, a few retries are plenty.
+static constexpr const int kMaxCreateAttempts{ 8 };
+
+[[nodiscard]] static inline std::filesystem::path makeTemporaryPath(const std::filesystem::path& path, std::mt19937_64& random) {
+#ifdef _WIN32
+    const auto pid = static_cast<unsigned long long>(::_getpid());
+#else
+    const auto pid = static_cast<unsigned long long>(::getpid());
+#endif
+    char suffix[48]{};
+    std::snprintf(suffix, sizeof(suffix), ".%llu.%016llx.tmp", pid, static_cast<unsigned long long>(random()));
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += suffix;
+    return temporaryPath;
+}
+
+bool writeFileAtomically(const std::filesystem::path& path, const std::string_view content) {
+    std::mt19937_64 random{ (static_cast<std::uint64_t>(std::random_device{}()) << 32)
+                            ^ static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count()) };
+    std::filesystem::path temporaryPath{};
+    FILE* file{ nullptr };
+    for (int attempt = 0; !file && attempt != kMaxCreateAttempts; ++attempt) {
+        temporaryPath = makeTemporaryPath(path, random);
+        // "x" fails if the file exists instead of truncating somebody else's.
+#ifdef _WIN32
+        file = _wfopen(temporaryPath.c_str(), L"wbx");
+#else
+        file = std::fopen(temporaryPath.c_str(), "wbx");
+#endif
+        if (!file && errno != EEXIST) {
+            break;
+        }
+    }
+    if (!file) {
+        std::wcerr << L"Failed to create \"" << temporaryPath.wstring() << L"\"." << std::endl;
+        return false;
+    }
+    std::error_code error{};
+    const bool written = std::fwrite(content.data(), 1, content.size(), file) == content.size();
+    const bool closed = std::fclose(file) == 0;
+    if (!written || !closed) {
+        std::wcerr << L"Failed to write \"" << temporaryPath.wstring() << L"\"." << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error) {
+        std::wcerr << L"Failed to replace \"" << path.wstring() << L"\": " << utf8ToWide(error.message()) << std::endl;
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
+
+} // namespace gputester
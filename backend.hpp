@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "model.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace gputester {
+
+// A set of probe nodes, one bit per probe_node_t.
+using probe_node_mask_t = std::uint32_t;
+
+[[nodiscard]] constexpr probe_node_mask_t probeNodeBit(const probe_node_t node) {
+    return probe_node_mask_t{ 1 } << static_cast<std::uint32_t>(node);
+}
+
+static constexpr const probe_node_mask_t kAllProbeNodes{ (probe_node_mask_t{ 1 } << kProbeNodeCount) - 1 };
+// The probes of a single output, each of them needs the output list.
+static constexpr const probe_node_mask_t kOutputProbeNodes{ probeNodeBit(probe_node_t::ModeInfo) | probeNodeBit(probe_node_t::ColorInfo)
+                                                           | probeNodeBit(probe_node_t::PathInfo) | probeNodeBit(probe_node_t::Dpi) };
+
+// A platform backend answers the individual probes, the caller decides which
+// of them to run and in what order. Every probe returns false if the information
+// is not available, the backend reports the reason itself.
+// Once enumerateAdapters() returned, the probes of different adapters may run concurrently,
+// and so may the probes of different outputs once their adapter's enumerateOutputs() returned.
+// A probe abandoned at its deadline (see ProbeOptions::timeout) keeps running on a helper thread
+// while the others go on, but enumerateAdapters() is not called again before it returned.
+class Backend : public std::enable_shared_from_this<Backend> {
+public:
+    Backend() = default;
+    virtual ~Backend() = default;
+    Backend(const Backend&) = delete;
+    Backend& operator=(const Backend&) = delete;
+
+    [[nodiscard]] virtual std::wstring_view name() const = 0;
+
+    [[nodiscard]] virtual bool getVariableRefreshRateSupport(bool& supportedOut) = 0;
+    // Must be called before any other probe, it (re)builds the backend's native handle table.
+    [[nodiscard]] virtual bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) = 0;
+    [[nodiscard]] virtual bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) = 0;
+    [[nodiscard]] virtual bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) = 0;
+    [[nodiscard]] virtual bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) = 0;
+    [[nodiscard]] virtual bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) = 0;
+    [[nodiscard]] virtual bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) = 0;
+    [[nodiscard]] virtual bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) = 0;
+
+    // Cheap fingerprints of the OS state a probe reads besides its descriptor. ProbeGraph keeps the last
+    // answer as long as the descriptor and the key stay the same. Returning false means the state can't be
+    // told apart without running the probe itself, which then runs every time.
+    [[nodiscard]] virtual bool getDriverInfoKey(const AdapterDesc& /*adapter*/, std::uint64_t& /*keyOut*/) {
+        return false;
+    }
+    // "node" is one of ModeInfo, ColorInfo, PathInfo and Dpi. Only valid after the adapter's enumerateOutputs().
+    [[nodiscard]] virtual bool getOutputProbeKey(const probe_node_t /*node*/, const OutputDesc& /*output*/, std::uint64_t& /*keyOut*/) {
+        return false;
+    }
+
+    // Bookkeeping of the probe engine: calls which missed their deadline and haven't returned yet.
+    [[nodiscard]] std::size_t abandonedProbeCount() const {
+        return m_abandonedProbes.load(std::memory_order_acquire);
+    }
+    void probeAbandoned() {
+        m_abandonedProbes.fetch_add(1, std::memory_order_relaxed);
+    }
+    void abandonedProbeReturned() {
+        m_abandonedProbes.fetch_sub(1, std::memory_order_release);
+    }
+
+private:
+    std::atomic<std::size_t> m_abandonedProbes{ 0 };
+};
+using backend_ptr_t = std::shared_ptr<Backend>;
+
+// Returns the backend for the current platform, or nullptr if there is none.
+[[nodiscard]] backend_ptr_t createNativeBackend();
+#ifdef _WIN32
+[[nodiscard]] backend_ptr_t createDxgiBackend();
+#endif
+#ifdef __linux__
+// "root" is where sysfs is mounted, point it to a copied tree to run against a fixture.
+[[nodiscard]] backend_ptr_t createSysfsBackend(std::string root = "/sys");
+#endif
+// Serves a fixed adapter list, for embedding applications which already know the
+// topology and for running the probe engine on machines without a GPU.
+[[nodiscard]] backend_ptr_t createFixtureBackend(std::vector<AdapterInfo> adapters, const bool variableRefreshRateSupported = false);
+
+} // namespace gputester
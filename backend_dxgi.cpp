@@ -0,0 +1,381 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Most code is based on https://github.com/LizardByte/Sunshine/blob/master/tools/dxgi.cpp */
+
+#include "backend.hpp"
+#include "dxgi_support.hpp"
+#include "win32.hpp"
+#include "registry.hpp"
+#include <wrl/client.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::WRL;
+using namespace m4x1m1l14n;
+
+namespace gputester {
+
+static constexpr const float kDefaultRefreshRate{ 60.f };
+static constexpr const DXGI_FORMAT kDefaultPixelFormat{ DXGI_FORMAT_R8G8B8A8_UNORM };
+
+static_assert(static_cast<std::uint32_t>(DXGI_MODE_ROTATION_ROTATE270) == static_cast<std::uint32_t>(rotation_t::Rotate270));
+static_assert(static_cast<std::uint32_t>(DXGI_COLOR_SPACE_YCBCR_STUDIO_G24_TOPLEFT_P2020) == static_cast<std::uint32_t>(color_space_t::YCBCR_STUDIO_G24_TOPLEFT_P2020));
+static_assert(DXGI_ADAPTER_FLAG_SOFTWARE == kAdapterFlagSoftware);
+static_assert(USER_DEFAULT_SCREEN_DPI == kDefaultScreenDpi);
+
+// Used when the display path doesn't report a valid refresh rate.
+[[nodiscard]] static inline bool getFallbackRefreshRate(const std::wstring& targetDeviceName, float& rateOut) {
+    if (targetDeviceName.empty()) { // The following solutions need the device name to be correct.
+        return false;
+    }
+    if (USER32_API(EnumDisplaySettingsW)) {
+        DEVMODEW devMode{};
+        if (USER32_API(EnumDisplaySettingsW)(targetDeviceName.c_str(), ENUM_CURRENT_SETTINGS, &devMode)) {
+            const auto& refreshRate = devMode.dmDisplayFrequency;
+            if (refreshRate > 1) { // 0,1 means hardware default.
+                rateOut = static_cast<float>(refreshRate);
+                return true;
+            }
+        } else {
+            std::wcerr << L"\"EnumDisplaySettingsW\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+    if (GDI32_API(CreateDCW) && GDI32_API(DeleteDC) && GDI32_API(GetDeviceCaps)) {
+        const HDC hdc = GDI32_API(CreateDCW)(targetDeviceName.c_str(), targetDeviceName.c_str(), nullptr, nullptr);
+        if (hdc) {
+            const auto refreshRate = GDI32_API(GetDeviceCaps)(hdc, VREFRESH);
+            if (!GDI32_API(DeleteDC(hdc))) {
+                std::wcerr << L"\"DeleteDC\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            }
+            if (refreshRate > 1) { // 0,1 means hardware default.
+                rateOut = static_cast<float>(refreshRate);
+                return true;
+            }
+        } else {
+            std::wcerr << L"\"CreateDCW\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+    return false;
+}
+
+[[nodiscard]] static inline bool getDpi(const HMONITOR monitor, std::uint32_t& dpiOut) {
+    assert(monitor);
+    if (!monitor) {
+        dpiOut = USER_DEFAULT_SCREEN_DPI;
+        return false;
+    }
+    if (SHCORE_API(GetDpiForMonitor)) {
+        std::uint32_t dpiX{ 0 };
+        std::uint32_t dpiY{ 0 };
+        const HRESULT hr = SHCORE_API(GetDpiForMonitor)(monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY);
+        if (SUCCEEDED(hr)) {
+            dpiOut = dpiX;
+            return true;
+        } else {
+            std::wcerr << L"\"GetDpiForMonitor\" failed: " << getComErrorMessage(hr) << std::endl;
+        }
+    }
+    dpiOut = USER_DEFAULT_SCREEN_DPI;
+    return false;
+}
+
+class DxgiBackend final : public Backend {
+public:
+    explicit DxgiBackend(ComPtr<IDXGIFactory1> factory, DxgiSeams seams) : m_factory(std::move(factory)), m_support(std::move(seams)) {}
+    ~DxgiBackend() override = default;
+
+    [[nodiscard]] std::wstring_view name() const override {
+        return L"dxgi";
+    }
+
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override {
+        supportedOut = false;
+        ComPtr<IDXGIFactory5> factory5;
+        HRESULT hr = m_factory->QueryInterface(IID_PPV_ARGS(factory5.GetAddressOf()));
+        if (FAILED(hr)) {
+            return false;
+        }
+        BOOL allowTearing{ FALSE };
+        hr = factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing));
+        supportedOut = SUCCEEDED(hr) && allowTearing;
+        return true;
+    }
+
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override {
+        adaptersOut.clear();
+        m_adapters.clear();
+        m_outputs.clear();
+        m_support.invalidate();
+        // The adapter list of a factory is a snapshot, only a new factory sees the adapters which came or went since.
+        if (!m_factory->IsCurrent()) {
+            ComPtr<IDXGIFactory1> factory;
+            const HRESULT hr = DXGI_API(CreateDXGIFactory1)(IID_PPV_ARGS(factory.GetAddressOf()));
+            if (SUCCEEDED(hr)) {
+                m_factory = std::move(factory);
+            } else {
+                std::wcerr << L"\"CreateDXGIFactory1\" failed: " << getComErrorMessage(hr) << std::endl;
+            }
+        }
+        ComPtr<IDXGIAdapter1> adapter;
+        for (std::uint32_t adapterIndex = 0; m_factory->EnumAdapters1(adapterIndex, adapter.ReleaseAndGetAddressOf()) != DXGI_ERROR_NOT_FOUND; ++adapterIndex) {
+            m_adapters.push_back(adapter);
+            DXGI_ADAPTER_DESC1 adapterDesc1{};
+            HRESULT hr = adapter->GetDesc1(&adapterDesc1);
+            if (FAILED(hr)) {
+                std::wcerr << L"\"IDXGIAdapter1::GetDesc1\" failed: " << getComErrorMessage(hr) << std::endl;
+                continue;
+            }
+            AdapterDesc desc{};
+            desc.index = adapterIndex;
+            desc.description = adapterDesc1.Description;
+            desc.vendorId = adapterDesc1.VendorId;
+            desc.deviceId = adapterDesc1.DeviceId;
+            desc.subSysId = adapterDesc1.SubSysId;
+            desc.revision = adapterDesc1.Revision;
+            desc.dedicatedVideoMemory = adapterDesc1.DedicatedVideoMemory;
+            desc.dedicatedSystemMemory = adapterDesc1.DedicatedSystemMemory;
+            desc.sharedSystemMemory = adapterDesc1.SharedSystemMemory;
+            desc.luid = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(adapterDesc1.AdapterLuid.HighPart)) << 32) | adapterDesc1.AdapterLuid.LowPart;
+            desc.flags = adapterDesc1.Flags;
+            {
+                ComPtr<IDXGIAdapter3> adapter3;
+                hr = adapter->QueryInterface(IID_PPV_ARGS(adapter3.GetAddressOf()));
+                if (SUCCEEDED(hr)) {
+                    // Simple heuristic but without profiling it's hard to do better.
+                    DXGI_QUERY_VIDEO_MEMORY_INFO nonLocalVideoMemoryInfo{};
+                    hr = adapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL, &nonLocalVideoMemoryInfo);
+                    if (SUCCEEDED(hr)) {
+                        desc.integrated = nonLocalVideoMemoryInfo.Budget == 0;
+                    }
+                }
+            }
+            adaptersOut.push_back(std::move(desc));
+        }
+        m_outputs.resize(m_adapters.size());
+        return true;
+    }
+
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override {
+        return m_support.getDriverInfo(adapter, infoOut);
+    }
+
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override {
+        outputsOut.clear();
+        if (adapter.index >= m_adapters.size() || !m_adapters[adapter.index]) {
+            return false;
+        }
+        auto& outputs = m_outputs[adapter.index];
+        outputs.clear();
+        ComPtr<IDXGIOutput> output;
+        for (std::uint32_t outputIndex = 0; m_adapters[adapter.index]->EnumOutputs(outputIndex, output.ReleaseAndGetAddressOf()) != DXGI_ERROR_NOT_FOUND; ++outputIndex) {
+            DXGI_OUTPUT_DESC outputDesc{};
+            const HRESULT hr = output->GetDesc(&outputDesc);
+            if (FAILED(hr)) {
+                std::wcerr << L"\"IDXGIOutput::GetDesc\" failed: " << getComErrorMessage(hr) << std::endl;
+                outputs.push_back({ output, nullptr });
+                continue;
+            }
+            outputs.push_back({ output, outputDesc.Monitor });
+            OutputDesc desc{};
+            desc.adapterIndex = adapter.index;
+            desc.index = outputIndex;
+            desc.deviceName = outputDesc.DeviceName;
+            desc.left = outputDesc.DesktopCoordinates.left;
+            desc.top = outputDesc.DesktopCoordinates.top;
+            desc.right = outputDesc.DesktopCoordinates.right;
+            desc.bottom = outputDesc.DesktopCoordinates.bottom;
+            desc.attachedToDesktop = outputDesc.AttachedToDesktop;
+            desc.rotation = static_cast<rotation_t>(outputDesc.Rotation);
+            outputsOut.push_back(std::move(desc));
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override {
+        const OutputEntry* entry = findOutput(output);
+        if (!entry) {
+            return false;
+        }
+        ComPtr<IDXGIOutput1> output1;
+        HRESULT hr = entry->output->QueryInterface(IID_PPV_ARGS(output1.GetAddressOf()));
+        if (FAILED(hr)) {
+            return false;
+        }
+        std::uint32_t modeCount{ 0 };
+        hr = output1->GetDisplayModeList1(kDefaultPixelFormat, 0, &modeCount, nullptr);
+        if (FAILED(hr) || modeCount <= 0) {
+            return false;
+        }
+        const auto modeList = std::make_unique<DXGI_MODE_DESC1[]>(modeCount);
+        hr = output1->GetDisplayModeList1(kDefaultPixelFormat, 0, &modeCount, modeList.get());
+        if (FAILED(hr)) {
+            return false;
+        }
+        float maxRefreshRate{ kDefaultRefreshRate };
+        for (std::size_t modeIndex = 0; modeIndex != static_cast<std::size_t>(modeCount); ++modeIndex) {
+            const DXGI_MODE_DESC1& mode = modeList[modeIndex];
+            const auto refreshRate = static_cast<float>(mode.RefreshRate.Numerator) / static_cast<float>(mode.RefreshRate.Denominator);
+            maxRefreshRate = std::max(maxRefreshRate, refreshRate);
+        }
+        infoOut.maxRefreshRate = maxRefreshRate;
+        return true;
+    }
+
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override {
+        const OutputEntry* entry = findOutput(output);
+        if (!entry) {
+            return false;
+        }
+        ComPtr<IDXGIOutput6> output6;
+        HRESULT hr = entry->output->QueryInterface(IID_PPV_ARGS(output6.GetAddressOf()));
+        if (FAILED(hr)) {
+            return false;
+        }
+        DXGI_OUTPUT_DESC1 outputDesc1{};
+        hr = output6->GetDesc1(&outputDesc1);
+        if (FAILED(hr)) {
+            return false;
+        }
+        infoOut.bitsPerColor = outputDesc1.BitsPerColor;
+        infoOut.colorSpace = static_cast<color_space_t>(outputDesc1.ColorSpace);
+        std::copy_n(outputDesc1.RedPrimary, 2, infoOut.redPrimary);
+        std::copy_n(outputDesc1.GreenPrimary, 2, infoOut.greenPrimary);
+        std::copy_n(outputDesc1.BluePrimary, 2, infoOut.bluePrimary);
+        std::copy_n(outputDesc1.WhitePoint, 2, infoOut.whitePoint);
+        infoOut.minLuminance = outputDesc1.MinLuminance;
+        infoOut.maxLuminance = outputDesc1.MaxLuminance;
+        infoOut.maxFullFrameLuminance = outputDesc1.MaxFullFrameLuminance;
+        return true;
+    }
+
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override {
+        if (!m_support.getPathInfo(output, infoOut)) {
+            return false;
+        }
+        if (!infoOut.currentRefreshRate) {
+            float refreshRate{ kDefaultRefreshRate };
+            if (getFallbackRefreshRate(output.deviceName, refreshRate)) {
+                infoOut.currentRefreshRate = refreshRate;
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override {
+        const OutputEntry* entry = findOutput(output);
+        if (!entry || !entry->monitor) {
+            return false;
+        }
+        return gputester::getDpi(entry->monitor, dpiOut);
+    }
+
+    // The user mode driver version is one cheap call, the driver info itself needs SetupAPI and the registry.
+    [[nodiscard]] bool getDriverInfoKey(const AdapterDesc& adapter, std::uint64_t& keyOut) override {
+        if (adapter.index >= m_adapters.size() || !m_adapters[adapter.index]) {
+            return false;
+        }
+        LARGE_INTEGER umdVersion{};
+        if (FAILED(m_adapters[adapter.index]->CheckInterfaceSupport(__uuidof(IDXGIDevice), &umdVersion))) {
+            return false;
+        }
+        keyOut = static_cast<std::uint64_t>(umdVersion.QuadPart);
+        return true;
+    }
+
+    // Only the mode list has a key, see DxgiSupport::getModeInfoKey(). Color, path and DPI follow user settings
+    // which can't be observed without asking for them, they are cheap to ask for anyway.
+    [[nodiscard]] bool getOutputProbeKey(const probe_node_t node, const OutputDesc& output, std::uint64_t& keyOut) override {
+        if (node != probe_node_t::ModeInfo) {
+            return false;
+        }
+        return m_support.getModeInfoKey(output, keyOut);
+    }
+
+private:
+    struct OutputEntry final {
+        ComPtr<IDXGIOutput> output{};
+        HMONITOR monitor{ nullptr };
+    };
+
+    [[nodiscard]] const OutputEntry* findOutput(const OutputDesc& output) const {
+        if (output.adapterIndex >= m_outputs.size()) {
+            return nullptr;
+        }
+        const auto& outputs = m_outputs[output.adapterIndex];
+        if (output.index >= outputs.size() || !outputs[output.index].output) {
+            return nullptr;
+        }
+        return &outputs[output.index];
+    }
+
+    ComPtr<IDXGIFactory1> m_factory{};
+    std::vector<ComPtr<IDXGIAdapter1>> m_adapters{};
+    std::vector<std::vector<OutputEntry>> m_outputs{};
+    DxgiSupport m_support;
+};
+
+DxgiSeams createWin32DxgiSeams() {
+    DxgiSeams seams{};
+    seams.displayConfig = createWin32DisplayConfigProvider();
+    seams.setupApi = createWin32SetupApiProvider();
+    try {
+        seams.system = Registry::LocalMachine->Open(L"SYSTEM");
+    } catch (const std::exception& ex) {
+        std::wcerr << L"Failed to access the registry: " << ex.what() << std::endl;
+    }
+    return seams;
+}
+
+backend_ptr_t createDxgiBackend() {
+    return createDxgiBackend(createWin32DxgiSeams());
+}
+
+backend_ptr_t createDxgiBackend(DxgiSeams seams) {
+    if (!USER32_AVAILABLE) {
+        std::wcerr << L"We need an available \"user32.dll\" to be able to use this tool." << std::endl;
+        return nullptr;
+    }
+    if (!DXGI_AVAILABLE) {
+        std::wcerr << L"We need an available \"dxgi.dll\" to be able to use this tool." << std::endl;
+        return nullptr;
+    }
+    if (!DXGI_API(CreateDXGIFactory1)) {
+        std::wcerr << L"The critical function \"CreateDXGIFactory1\" is not available for some unknown reason, aborted." << std::endl;
+        return nullptr;
+    }
+    ComPtr<IDXGIFactory1> factory;
+    const HRESULT hr = DXGI_API(CreateDXGIFactory1)(IID_PPV_ARGS(factory.GetAddressOf()));
+    if (FAILED(hr)) {
+        std::wcerr << L"\"CreateDXGIFactory1\" failed: " << getComErrorMessage(hr) << std::endl;
+        return nullptr;
+    }
+    return std::make_shared<DxgiBackend>(std::move(factory), std::move(seams));
+}
+
+} // namespace gputester
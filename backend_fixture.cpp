@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "backend.hpp"
+#include <utility>
+
+namespace gputester {
+
+class FixtureBackend final : public Backend {
+public:
+    explicit FixtureBackend(std::vector<AdapterInfo> adapters, const bool variableRefreshRateSupported)
+        : m_adapters(std::move(adapters)), m_variableRefreshRateSupported(variableRefreshRateSupported) {
+        for (std::size_t adapterIndex = 0; adapterIndex != m_adapters.size(); ++adapterIndex) {
+            AdapterInfo& adapter = m_adapters[adapterIndex];
+            adapter.desc.index = static_cast<std::uint32_t>(adapterIndex);
+            for (std::size_t outputIndex = 0; outputIndex != adapter.outputs.size(); ++outputIndex) {
+                OutputDesc& output = adapter.outputs[outputIndex].desc;
+                output.adapterIndex = adapter.desc.index;
+                output.index = static_cast<std::uint32_t>(outputIndex);
+            }
+        }
+    }
+
+    ~FixtureBackend() override = default;
+
+    [[nodiscard]] std::wstring_view name() const override {
+        return L"fixture";
+    }
+
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override {
+        supportedOut = m_variableRefreshRateSupported;
+        return true;
+    }
+
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override {
+        adaptersOut.clear();
+        adaptersOut.reserve(m_adapters.size());
+        for (auto&& adapter : std::as_const(m_adapters)) {
+            adaptersOut.push_back(adapter.desc);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override {
+        const AdapterInfo* info = findAdapter(adapter);
+        if (!info || !info->driver) {
+            return false;
+        }
+        infoOut = info->driver.value();
+        return true;
+    }
+
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override {
+        outputsOut.clear();
+        const AdapterInfo* info = findAdapter(adapter);
+        if (!info) {
+            return false;
+        }
+        outputsOut.reserve(info->outputs.size());
+        for (auto&& output : std::as_const(info->outputs)) {
+            outputsOut.push_back(output.desc);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override {
+        const DisplayInfo* display = findDisplay(output);
+        if (!display || !display->mode) {
+            return false;
+        }
+        infoOut = display->mode.value();
+        return true;
+    }
+
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override {
+        const DisplayInfo* display = findDisplay(output);
+        if (!display || !display->color) {
+            return false;
+        }
+        infoOut = display->color.value();
+        return true;
+    }
+
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override {
+        const DisplayInfo* display = findDisplay(output);
+        if (!display || !display->path) {
+            return false;
+        }
+        infoOut = display->path.value();
+        return true;
+    }
+
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override {
+        const DisplayInfo* display = findDisplay(output);
+        if (!display || !display->dpi) {
+            return false;
+        }
+        dpiOut = display->dpi.value();
+        return true;
+    }
+
+    // The served data never changes, the descriptors alone identify every answer.
+    [[nodiscard]] bool getDriverInfoKey(const AdapterDesc& adapter, std::uint64_t& keyOut) override {
+        keyOut = 0;
+        return findAdapter(adapter) != nullptr;
+    }
+
+    [[nodiscard]] bool getOutputProbeKey(const probe_node_t /*node*/, const OutputDesc& output, std::uint64_t& keyOut) override {
+        keyOut = 0;
+        return findDisplay(output) != nullptr;
+    }
+
+private:
+    [[nodiscard]] const AdapterInfo* findAdapter(const AdapterDesc& adapter) const {
+        if (adapter.index >= m_adapters.size()) {
+            return nullptr;
+        }
+        return &m_adapters[adapter.index];
+    }
+
+    [[nodiscard]] const DisplayInfo* findDisplay(const OutputDesc& output) const {
+        if (output.adapterIndex >= m_adapters.size()) {
+            return nullptr;
+        }
+        const auto& outputs = m_adapters[output.adapterIndex].outputs;
+        if (output.index >= outputs.size()) {
+            return nullptr;
+        }
+        return &outputs[output.index].display;
+    }
+
+    std::vector<AdapterInfo> m_adapters{};
+    bool m_variableRefreshRateSupported{ false };
+};
+
+backend_ptr_t createFixtureBackend(std::vector<AdapterInfo> adapters, const bool variableRefreshRateSupported) {
+    return std::make_shared<FixtureBackend>(std::move(adapters), variableRefreshRateSupported);
+}
+
+} // namespace gputester
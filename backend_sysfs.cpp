@@ -0,0 +1,540 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "backend.hpp"
+#include "edid.hpp"
+#include "text.hpp"
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace gputester {
+
+static constexpr const std::uint64_t kPciClassDisplay{ 0x03 }; // PCI_BASE_CLASS_DISPLAY
+static constexpr const std::uint64_t kResourceFlagMemory{ 0x00000200 }; // IORESOURCE_MEM
+static constexpr const std::uint64_t kResourceFlagPrefetch{ 0x00002000 }; // IORESOURCE_PREFETCH
+static constexpr const std::size_t kAttributeBufferSize{ 256 };
+static constexpr const std::size_t kResourceBufferSize{ 4096 };
+static constexpr const std::size_t kEdidBufferSize{ 32768 }; // Enough for the base block plus 255 extensions.
+static constexpr const float kCentimetersPerInch{ 2.54f };
+
+struct scoped_fd_t final {
+    scoped_fd_t() = default;
+    explicit scoped_fd_t(const int fd) : m_fd(fd) {}
+    ~scoped_fd_t() {
+        reset();
+    }
+    scoped_fd_t(const scoped_fd_t&) = delete;
+    scoped_fd_t& operator=(const scoped_fd_t&) = delete;
+    scoped_fd_t(scoped_fd_t&& other) noexcept : m_fd(std::exchange(other.m_fd, -1)) {}
+    scoped_fd_t& operator=(scoped_fd_t&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_fd = std::exchange(other.m_fd, -1);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] inline int get() const {
+        return m_fd;
+    }
+
+    [[nodiscard]] inline explicit operator bool() const {
+        return m_fd >= 0;
+    }
+
+    inline void reset() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+private:
+    int m_fd{ -1 };
+};
+
+[[nodiscard]] static inline scoped_fd_t openDirectoryAt(const int dirFd, const char* name) {
+    return scoped_fd_t{ ::openat(dirFd, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC) };
+}
+
+// sysfs attributes are generated on open, a single pread() from offset 0 returns the whole value.
+[[nodiscard]] static inline ssize_t readFileAt(const int dirFd, const char* name, char* buffer, const std::size_t size) {
+    const scoped_fd_t fd{ ::openat(dirFd, name, O_RDONLY | O_CLOEXEC) };
+    if (!fd) {
+        return -1;
+    }
+    ssize_t result{ -1 };
+    do {
+        result = ::pread(fd.get(), buffer, size, 0);
+    } while (result < 0 && errno == EINTR);
+    return result;
+}
+
+[[nodiscard]] static inline bool readTextAt(const int dirFd, const char* name, std::string& textOut) {
+    char buffer[kAttributeBufferSize];
+    const ssize_t size = readFileAt(dirFd, name, buffer, sizeof(buffer));
+    if (size < 0) {
+        return false;
+    }
+    std::string_view text{ buffer, static_cast<std::size_t>(size) };
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ' || text.back() == '\0')) {
+        text.remove_suffix(1);
+    }
+    textOut = text;
+    return true;
+}
+
+[[nodiscard]] static inline bool parseHex(std::string_view text, std::uint64_t& valueOut) {
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        text.remove_prefix(2);
+    }
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), valueOut, 16);
+    return ec == std::errc{} && ptr != text.data();
+}
+
+[[nodiscard]] static inline bool readHexAt(const int dirFd, const char* name, std::uint64_t& valueOut) {
+    std::string text{};
+    return readTextAt(dirFd, name, text) && parseHex(text, valueOut);
+}
+
+[[nodiscard]] static inline bool readLinkNameAt(const int dirFd, const char* name, std::string& nameOut) {
+    char buffer[PATH_MAX];
+    const ssize_t size = ::readlinkat(dirFd, name, buffer, sizeof(buffer));
+    if (size <= 0) {
+        return false;
+    }
+    const std::string_view target{ buffer, static_cast<std::size_t>(size) };
+    const std::size_t slash = target.rfind('/');
+    nameOut = (slash == std::string_view::npos) ? target : target.substr(slash + 1);
+    return !nameOut.empty();
+}
+
+// The entries are sorted, so the enumeration order doesn't depend on the file system.
+[[nodiscard]] static inline bool listDirectory(const int dirFd, std::vector<std::string>& namesOut) {
+    namesOut.clear();
+    // fdopendir() takes ownership of the descriptor, give it a copy.
+    const int fd = ::openat(dirFd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    DIR* dir = ::fdopendir(fd);
+    if (!dir) {
+        ::close(fd);
+        return false;
+    }
+    while (const dirent* entry = ::readdir(dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        namesOut.emplace_back(entry->d_name);
+    }
+    ::closedir(dir);
+    std::sort(namesOut.begin(), namesOut.end());
+    return true;
+}
+
+// "DDDD:BB:dd.f" -> domain << 16 | bus << 8 | device << 3 | function, which is unique per machine like a LUID.
+[[nodiscard]] static inline bool parsePciAddress(const std::string_view address, std::uint64_t& addressOut) {
+    unsigned int domain{ 0 };
+    unsigned int bus{ 0 };
+    unsigned int device{ 0 };
+    unsigned int function{ 0 };
+    const std::string text{ address };
+    if (std::sscanf(text.c_str(), "%x:%x:%x.%x", &domain, &bus, &device, &function) != 4) {
+        return false;
+    }
+    addressOut = (static_cast<std::uint64_t>(domain) << 16) | (bus << 8) | (device << 3) | function;
+    return true;
+}
+
+// Each line of the "resource" attribute is "start end flags", the first six lines are the BARs.
+[[nodiscard]] static inline std::uint64_t getLargestPrefetchableBarSize(const int deviceFd) {
+    char buffer[kResourceBufferSize];
+    const ssize_t size = readFileAt(deviceFd, "resource", buffer, sizeof(buffer));
+    if (size <= 0) {
+        return 0;
+    }
+    std::uint64_t largest{ 0 };
+    std::string_view text{ buffer, static_cast<std::size_t>(size) };
+    for (int bar = 0; bar != 6 && !text.empty(); ++bar) {
+        const std::size_t lineEnd = text.find('\n');
+        const std::string_view line = text.substr(0, lineEnd);
+        text = (lineEnd == std::string_view::npos) ? std::string_view{} : text.substr(lineEnd + 1);
+        std::uint64_t values[3]{};
+        std::string_view rest = line;
+        bool valid{ true };
+        for (auto&& value : values) {
+            const std::size_t space = rest.find(' ');
+            if (!parseHex(rest.substr(0, space), value)) {
+                valid = false;
+                break;
+            }
+            rest = (space == std::string_view::npos) ? std::string_view{} : rest.substr(space + 1);
+        }
+        const auto [start, end, flags] = values;
+        if (!valid || start == 0 || end <= start) {
+            continue;
+        }
+        if ((flags & kResourceFlagMemory) && (flags & kResourceFlagPrefetch)) {
+            largest = std::max(largest, end - start + 1);
+        }
+    }
+    return largest;
+}
+
+// FNV-1a, to notice a different display behind the same connector.
+[[nodiscard]] static inline std::uint64_t hashBytes(const std::uint8_t* data, const std::size_t size) {
+    std::uint64_t hash{ 14695981039346656037ull };
+    for (std::size_t index = 0; index != size; ++index) {
+        hash = (hash ^ data[index]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+class SysfsBackend final : public Backend {
+public:
+    explicit SysfsBackend(std::string root) : m_root(std::move(root)) {}
+    ~SysfsBackend() override = default;
+
+    [[nodiscard]] std::wstring_view name() const override {
+        return L"sysfs";
+    }
+
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override {
+        // Only exposed as a DRM connector property, not through sysfs.
+        supportedOut = false;
+        return false;
+    }
+
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override {
+        adaptersOut.clear();
+        m_devices.clear();
+        m_rootFd = scoped_fd_t{ ::open(m_root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC) };
+        if (!m_rootFd) {
+            std::wcerr << L"Failed to open the sysfs root \"" << utf8ToWide(m_root) << L"\": " << utf8ToWide(std::strerror(errno)) << std::endl;
+            return false;
+        }
+        const scoped_fd_t devicesFd = openDirectoryAt(m_rootFd.get(), "bus/pci/devices");
+        std::vector<std::string> addresses{};
+        if (!devicesFd || !listDirectory(devicesFd.get(), addresses)) {
+            std::wcerr << L"Failed to list the PCI devices: " << utf8ToWide(std::strerror(errno)) << std::endl;
+            return false;
+        }
+        for (auto&& address : std::as_const(addresses)) {
+            scoped_fd_t deviceFd = openDirectoryAt(devicesFd.get(), address.c_str());
+            if (!deviceFd) {
+                continue;
+            }
+            std::uint64_t pciClass{ 0 };
+            if (!readHexAt(deviceFd.get(), "class", pciClass) || (pciClass >> 16) != kPciClassDisplay) {
+                continue;
+            }
+            std::uint64_t vendorId{ 0 };
+            std::uint64_t deviceId{ 0 };
+            std::uint64_t subsystemVendorId{ 0 };
+            std::uint64_t subsystemDeviceId{ 0 };
+            std::uint64_t revision{ 0 };
+            std::ignore = readHexAt(deviceFd.get(), "vendor", vendorId);
+            std::ignore = readHexAt(deviceFd.get(), "device", deviceId);
+            std::ignore = readHexAt(deviceFd.get(), "subsystem_vendor", subsystemVendorId);
+            std::ignore = readHexAt(deviceFd.get(), "subsystem_device", subsystemDeviceId);
+            std::ignore = readHexAt(deviceFd.get(), "revision", revision);
+            PciDevice device{};
+            device.address = address;
+            std::ignore = readLinkNameAt(deviceFd.get(), "driver", device.driver);
+            AdapterDesc desc{};
+            desc.index = static_cast<std::uint32_t>(m_devices.size());
+            desc.vendorId = static_cast<std::uint32_t>(vendorId);
+            desc.deviceId = static_cast<std::uint32_t>(deviceId);
+            // Same layout as DXGI_ADAPTER_DESC1::SubSysId.
+            desc.subSysId = static_cast<std::uint32_t>((subsystemDeviceId << 16) | subsystemVendorId);
+            desc.revision = static_cast<std::uint32_t>(revision);
+            std::string label{};
+            if (readTextAt(deviceFd.get(), "label", label) && !label.empty()) {
+                desc.description = utf8ToWide(label);
+            } else {
+                desc.description = std::wstring{ vendorToString(vendorIdToVendor(vendorId)) } + L" PCI device " + utf8ToWide(address);
+            }
+            // amdgpu reports the real VRAM size, for the others the prefetchable BAR is the VRAM aperture.
+            std::uint64_t videoMemory{ 0 };
+            std::string vramTotal{};
+            if (readTextAt(deviceFd.get(), "mem_info_vram_total", vramTotal)) {
+                std::from_chars(vramTotal.data(), vramTotal.data() + vramTotal.size(), videoMemory);
+            }
+            if (videoMemory == 0) {
+                videoMemory = getLargestPrefetchableBarSize(deviceFd.get());
+            }
+            desc.dedicatedVideoMemory = videoMemory;
+            // Nothing in sysfs tells an integrated GPU apart reliably, the bus number doesn't, so "integrated" stays unknown.
+            std::uint64_t pciAddress{ 0 };
+            if (parsePciAddress(address, pciAddress)) {
+                desc.luid = pciAddress;
+            }
+            device.fd = std::move(deviceFd);
+            m_devices.push_back(std::move(device));
+            adaptersOut.push_back(std::move(desc));
+        }
+        m_outputs.clear();
+        m_outputs.resize(m_devices.size());
+        indexConnectors();
+        return true;
+    }
+
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override {
+        const PciDevice* device = findDevice(adapter);
+        if (!device || device->driver.empty()) {
+            return false;
+        }
+        infoOut = {};
+        infoOut.provider = utf8ToWide(device->driver);
+        // Out-of-tree modules carry their own version, in-tree drivers are versioned with the kernel.
+        std::string version{};
+        const std::string versionPath = "module/" + device->driver + "/version";
+        if (!readTextAt(m_rootFd.get(), versionPath.c_str(), version) || version.empty()) {
+            utsname name{};
+            if (::uname(&name) != 0) {
+                return false;
+            }
+            version = name.release;
+        }
+        infoOut.version = utf8ToWide(version);
+        return true;
+    }
+
+    // Only the connected connectors are reported, like IDXGIAdapter::EnumOutputs() does.
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override {
+        outputsOut.clear();
+        const PciDevice* device = findDevice(adapter);
+        if (!device || !m_drmFd) {
+            return false;
+        }
+        auto& outputs = m_outputs[adapter.index];
+        outputs.clear();
+        std::vector<std::uint8_t> edid(kEdidBufferSize);
+        for (auto&& connector : std::as_const(device->connectors)) {
+            const scoped_fd_t connectorFd = openDirectoryAt(m_drmFd.get(), connector.c_str());
+            if (!connectorFd) {
+                continue;
+            }
+            std::string status{};
+            if (!readTextAt(connectorFd.get(), "status", status) || status != "connected") {
+                continue;
+            }
+            std::string enabled{};
+            std::ignore = readTextAt(connectorFd.get(), "enabled", enabled);
+            // The first entry of "modes" is the preferred (and usually current) mode, e.g. "2560x1440".
+            std::uint32_t width{ 0 };
+            std::uint32_t height{ 0 };
+            std::string modes{};
+            if (readTextAt(connectorFd.get(), "modes", modes)) {
+                std::ignore = std::sscanf(modes.c_str(), "%ux%u", &width, &height);
+            }
+            OutputEntry entry{};
+            const ssize_t edidSize = readFileAt(connectorFd.get(), "edid", reinterpret_cast<char*>(edid.data()), edid.size());
+            if (edidSize > 0) {
+                entry.edidHash = hashBytes(edid.data(), static_cast<std::size_t>(edidSize));
+                EdidInfo edidInfo{};
+                if (parseEdid(edid.data(), static_cast<std::size_t>(edidSize), edidInfo)) {
+                    if (width == 0 || height == 0) {
+                        width = edidInfo.preferredWidth;
+                        height = edidInfo.preferredHeight;
+                    }
+                    entry.edid = std::move(edidInfo);
+                }
+            }
+            entry.width = width;
+            OutputDesc desc{};
+            desc.adapterIndex = adapter.index;
+            desc.index = static_cast<std::uint32_t>(outputs.size());
+            desc.deviceName = utf8ToWide(connector);
+            desc.right = static_cast<std::int32_t>(width);
+            desc.bottom = static_cast<std::int32_t>(height);
+            desc.attachedToDesktop = enabled == "enabled";
+            outputs.push_back(std::move(entry));
+            outputsOut.push_back(std::move(desc));
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override {
+        const EdidInfo* edid = findEdid(output);
+        if (!edid || edid->maxRefreshRate <= 0.f) {
+            return false;
+        }
+        infoOut.maxRefreshRate = edid->maxRefreshRate;
+        return true;
+    }
+
+    // The EDID describes what the display is capable of, the current color space is not exposed through sysfs.
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override {
+        const EdidInfo* edid = findEdid(output);
+        if (!edid) {
+            return false;
+        }
+        infoOut = {};
+        infoOut.bitsPerColor = edid->bitsPerColor;
+        infoOut.colorSpace = color_space_t::RGB_FULL_G22_NONE_P709;
+        std::copy_n(edid->redPrimary, 2, infoOut.redPrimary);
+        std::copy_n(edid->greenPrimary, 2, infoOut.greenPrimary);
+        std::copy_n(edid->bluePrimary, 2, infoOut.bluePrimary);
+        std::copy_n(edid->whitePoint, 2, infoOut.whitePoint);
+        infoOut.minLuminance = edid->minLuminance.value_or(0.f);
+        infoOut.maxLuminance = edid->maxLuminance.value_or(0.f);
+        infoOut.maxFullFrameLuminance = edid->maxFullFrameLuminance.value_or(0.f);
+        return true;
+    }
+
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override {
+        const EdidInfo* edid = findEdid(output);
+        if (!edid || edid->monitorName.empty()) {
+            return false;
+        }
+        infoOut = {};
+        infoOut.friendlyName = edid->monitorName;
+        return true;
+    }
+
+    // There is no desktop scale factor in sysfs, this is the physical DPI calculated from the EDID screen size.
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override {
+        const OutputEntry* entry = findOutput(output);
+        if (!entry || !entry->edid || entry->edid->widthInCentimeters == 0 || entry->width == 0) {
+            return false;
+        }
+        const float widthInInches = static_cast<float>(entry->edid->widthInCentimeters) / kCentimetersPerInch;
+        dpiOut = static_cast<std::uint32_t>(std::lround(static_cast<float>(entry->width) / widthInInches));
+        return true;
+    }
+
+    // Everything but the driver comes from the EDID read by enumerateOutputs(), so it is the key of all output probes.
+    [[nodiscard]] bool getOutputProbeKey(const probe_node_t node, const OutputDesc& output, std::uint64_t& keyOut) override {
+        const OutputEntry* entry = findOutput(output);
+        if (!entry) {
+            return false;
+        }
+        keyOut = entry->edidHash;
+        if (node == probe_node_t::Dpi) {
+            keyOut ^= static_cast<std::uint64_t>(entry->width) * 1099511628211ull;
+        }
+        return true;
+    }
+
+private:
+    struct PciDevice final {
+        std::string address{};
+        std::string driver{};
+        scoped_fd_t fd{};
+        std::vector<std::string> connectors{}; // "card0-DP-1", ...
+    };
+
+    struct OutputEntry final {
+        std::optional<EdidInfo> edid{};
+        std::uint64_t edidHash{ 0 };
+        std::uint32_t width{ 0 };
+    };
+
+    // Links the DRM cards to their parent PCI devices and collects the connectors of each card.
+    void indexConnectors() {
+        m_drmFd = openDirectoryAt(m_rootFd.get(), "class/drm");
+        std::vector<std::string> names{};
+        if (!m_drmFd || !listDirectory(m_drmFd.get(), names)) {
+            return;
+        }
+        std::vector<std::pair<std::string, std::size_t>> cards{};
+        for (auto&& name : std::as_const(names)) {
+            if (name.rfind("card", 0) != 0 || name.find('-') != std::string::npos) {
+                continue;
+            }
+            std::string address{};
+            if (!readLinkNameAt(m_drmFd.get(), (name + "/device").c_str(), address)) {
+                continue;
+            }
+            const auto it = std::find_if(m_devices.cbegin(), m_devices.cend(), [&address](const PciDevice& device) {
+                return device.address == address;
+            });
+            if (it != m_devices.cend()) {
+                cards.emplace_back(name + '-', static_cast<std::size_t>(std::distance(m_devices.cbegin(), it)));
+            }
+        }
+        for (auto&& name : std::as_const(names)) {
+            for (auto&& [prefix, deviceIndex] : std::as_const(cards)) {
+                if (name.rfind(prefix, 0) == 0) {
+                    m_devices[deviceIndex].connectors.push_back(name);
+                    break;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] const OutputEntry* findOutput(const OutputDesc& output) const {
+        if (output.adapterIndex >= m_outputs.size()) {
+            return nullptr;
+        }
+        const auto& outputs = m_outputs[output.adapterIndex];
+        if (output.index >= outputs.size()) {
+            return nullptr;
+        }
+        return &outputs[output.index];
+    }
+
+    [[nodiscard]] const EdidInfo* findEdid(const OutputDesc& output) const {
+        const OutputEntry* entry = findOutput(output);
+        if (!entry || !entry->edid) {
+            return nullptr;
+        }
+        return &entry->edid.value();
+    }
+
+    [[nodiscard]] const PciDevice* findDevice(const AdapterDesc& adapter) const {
+        if (adapter.index >= m_devices.size()) {
+            return nullptr;
+        }
+        return &m_devices[adapter.index];
+    }
+
+    std::string m_root{};
+    scoped_fd_t m_rootFd{};
+    scoped_fd_t m_drmFd{};
+    std::vector<PciDevice> m_devices{};
+    std::vector<std::vector<OutputEntry>> m_outputs{};
+};
+
+backend_ptr_t createSysfsBackend(std::string root) {
+    return std::make_shared<SysfsBackend>(std::move(root));
+}
+
+} // namespace gputester
@@ -0,0 +1,1261 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "backend_trace.hpp"
+#include "mapped_file.hpp"
+#include "registry_memory.hpp"
+#include "text.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace m4x1m1l14n;
+
+namespace gputester {
+
+// Adapter and output indexes share one lookup key with the call, see traceKey().
+static constexpr const std::uint64_t kMaxTraceIndex{ 0xFFFFFF };
+
+class TraceWriter final {
+public:
+    explicit TraceWriter(std::string& buffer) : m_buffer(buffer) {}
+
+    void byte(const std::uint8_t value) {
+        m_buffer.push_back(static_cast<char>(value));
+    }
+
+    void varint(std::uint64_t value) {
+        while (value >= 0x80) {
+            byte(static_cast<std::uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        byte(static_cast<std::uint8_t>(value));
+    }
+
+    void signedVarint(const std::int64_t value) {
+        varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+    }
+
+    void real(const float value) {
+        const auto bits = std::bit_cast<std::uint32_t>(value);
+        for (int shift = 0; shift != 32; shift += 8) {
+            byte(static_cast<std::uint8_t>(bits >> shift));
+        }
+    }
+
+    void string(const std::wstring_view value) {
+        m_utf8.clear();
+        appendUtf8(m_utf8, value);
+        varint(m_utf8.size());
+        m_buffer.append(m_utf8);
+    }
+
+private:
+    std::string& m_buffer;
+    std::string m_utf8{};
+};
+
+// Bounds checked, reading past the end or an oversized value marks the reader as failed and
+// yields zeros from then on.
+class TraceReader final {
+public:
+    TraceReader(const std::uint8_t* data, const std::size_t size) : m_data(data), m_size(size) {}
+
+    [[nodiscard]] bool failed() const {
+        return m_failed;
+    }
+    [[nodiscard]] bool atEnd() const {
+        return m_offset == m_size;
+    }
+    [[nodiscard]] std::size_t offset() const {
+        return m_offset;
+    }
+
+    [[nodiscard]] std::uint8_t byte() {
+        if (m_failed || m_offset == m_size) {
+            m_failed = true;
+            return 0;
+        }
+        return m_data[m_offset++];
+    }
+
+    [[nodiscard]] std::uint64_t varint() {
+        std::uint64_t value{ 0 };
+        for (int shift = 0; shift < 64; shift += 7) {
+            const std::uint8_t part = byte();
+            value |= std::uint64_t{ part & 0x7Fu } << shift;
+            if ((part & 0x80) == 0) {
+                return value;
+            }
+        }
+        m_failed = true;
+        return 0;
+    }
+
+    [[nodiscard]] std::uint32_t varint32() {
+        const std::uint64_t value = varint();
+        if (value > UINT32_MAX) {
+            m_failed = true;
+            return 0;
+        }
+        return static_cast<std::uint32_t>(value);
+    }
+
+    [[nodiscard]] std::int32_t signedVarint32() {
+        const std::uint64_t value = varint();
+        const auto decoded = static_cast<std::int64_t>((value >> 1) ^ (~(value & 1) + 1));
+        if (decoded < INT32_MIN || decoded > INT32_MAX) {
+            m_failed = true;
+            return 0;
+        }
+        return static_cast<std::int32_t>(decoded);
+    }
+
+    [[nodiscard]] float real() {
+        std::uint32_t bits{ 0 };
+        for (int shift = 0; shift != 32; shift += 8) {
+            bits |= std::uint32_t{ byte() } << shift;
+        }
+        return std::bit_cast<float>(bits);
+    }
+
+    [[nodiscard]] std::wstring string() {
+        const std::uint64_t size = varint();
+        if (m_failed || size > m_size - m_offset) {
+            m_failed = true;
+            return {};
+        }
+        const std::string_view utf8{ reinterpret_cast<const char*>(m_data + m_offset), static_cast<std::size_t>(size) };
+        m_offset += static_cast<std::size_t>(size);
+        return utf8ToWide(utf8);
+    }
+
+private:
+    const std::uint8_t* m_data{ nullptr };
+    std::size_t m_size{ 0 };
+    std::size_t m_offset{ 0 };
+    bool m_failed{ false };
+};
+
+// The answers, one pair of write and read per type.
+
+static inline void writeAnswer(TraceWriter& writer, const bool value) {
+    writer.byte(value ? 1 : 0);
+}
+static inline void readAnswer(TraceReader& reader, bool& valueOut) {
+    valueOut = reader.byte() != 0;
+}
+
+static inline void writeAnswer(TraceWriter& writer, const std::uint32_t value) {
+    writer.varint(value);
+}
+static inline void readAnswer(TraceReader& reader, std::uint32_t& valueOut) {
+    valueOut = reader.varint32();
+}
+
+static inline void writeAnswer(TraceWriter& writer, const std::uint64_t value) {
+    writer.varint(value);
+}
+static inline void readAnswer(TraceReader& reader, std::uint64_t& valueOut) {
+    valueOut = reader.varint();
+}
+
+static inline void writeAnswer(TraceWriter& writer, const AdapterDesc& adapter) {
+    writer.varint(adapter.index);
+    writer.string(adapter.description);
+    writer.varint(adapter.vendorId);
+    writer.varint(adapter.deviceId);
+    writer.varint(adapter.subSysId);
+    writer.varint(adapter.revision);
+    writer.varint(adapter.dedicatedVideoMemory);
+    writer.varint(adapter.dedicatedSystemMemory);
+    writer.varint(adapter.sharedSystemMemory);
+    writer.varint(adapter.luid);
+    writer.varint(adapter.flags);
+    writer.byte(adapter.integrated ? (adapter.integrated.value() ? 2 : 1) : 0);
+}
+static inline void readAnswer(TraceReader& reader, AdapterDesc& adapterOut) {
+    adapterOut.index = reader.varint32();
+    adapterOut.description = reader.string();
+    adapterOut.vendorId = reader.varint32();
+    adapterOut.deviceId = reader.varint32();
+    adapterOut.subSysId = reader.varint32();
+    adapterOut.revision = reader.varint32();
+    adapterOut.dedicatedVideoMemory = reader.varint();
+    adapterOut.dedicatedSystemMemory = reader.varint();
+    adapterOut.sharedSystemMemory = reader.varint();
+    adapterOut.luid = reader.varint();
+    adapterOut.flags = reader.varint32();
+    const std::uint8_t integrated = reader.byte();
+    adapterOut.integrated = integrated ? std::optional<bool>{ integrated == 2 } : std::nullopt;
+}
+
+static inline void writeAnswer(TraceWriter& writer, const DriverInfo& info) {
+    writer.string(info.provider);
+    writer.string(info.version);
+    writer.string(info.date);
+}
+static inline void readAnswer(TraceReader& reader, DriverInfo& infoOut) {
+    infoOut.provider = reader.string();
+    infoOut.version = reader.string();
+    infoOut.date = reader.string();
+}
+
+static inline void writeAnswer(TraceWriter& writer, const OutputDesc& output) {
+    writer.varint(output.adapterIndex);
+    writer.varint(output.index);
+    writer.string(output.deviceName);
+    writer.signedVarint(output.left);
+    writer.signedVarint(output.top);
+    writer.signedVarint(output.right);
+    writer.signedVarint(output.bottom);
+    writer.byte(output.attachedToDesktop ? 1 : 0);
+    writer.varint(static_cast<std::uint32_t>(output.rotation));
+}
+static inline void readAnswer(TraceReader& reader, OutputDesc& outputOut) {
+    outputOut.adapterIndex = reader.varint32();
+    outputOut.index = reader.varint32();
+    outputOut.deviceName = reader.string();
+    outputOut.left = reader.signedVarint32();
+    outputOut.top = reader.signedVarint32();
+    outputOut.right = reader.signedVarint32();
+    outputOut.bottom = reader.signedVarint32();
+    outputOut.attachedToDesktop = reader.byte() != 0;
+    outputOut.rotation = static_cast<rotation_t>(reader.varint32());
+}
+
+template <typename T>
+static inline void writeAnswer(TraceWriter& writer, const std::vector<T>& values) {
+    writer.varint(values.size());
+    for (auto&& value : values) {
+        writeAnswer(writer, value);
+    }
+}
+template <typename T>
+static inline void readAnswer(TraceReader& reader, std::vector<T>& valuesOut) {
+    const std::uint64_t count = reader.varint();
+    valuesOut.clear();
+    // Every element takes at least a byte, a corrupted count can't make this allocate much.
+    for (std::uint64_t index = 0; index != count && !reader.failed(); ++index) {
+        readAnswer(reader, valuesOut.emplace_back());
+    }
+}
+
+static inline void writeAnswer(TraceWriter& writer, const ModeInfo& info) {
+    writer.real(info.maxRefreshRate);
+}
+static inline void readAnswer(TraceReader& reader, ModeInfo& infoOut) {
+    infoOut.maxRefreshRate = reader.real();
+}
+
+static inline void writeAnswer(TraceWriter& writer, const ColorInfo& info) {
+    writer.varint(info.bitsPerColor);
+    writer.varint(static_cast<std::uint32_t>(info.colorSpace));
+    for (const float* point : { info.redPrimary, info.greenPrimary, info.bluePrimary, info.whitePoint }) {
+        writer.real(point[0]);
+        writer.real(point[1]);
+    }
+    writer.real(info.minLuminance);
+    writer.real(info.maxLuminance);
+    writer.real(info.maxFullFrameLuminance);
+}
+static inline void readAnswer(TraceReader& reader, ColorInfo& infoOut) {
+    infoOut.bitsPerColor = reader.varint32();
+    infoOut.colorSpace = static_cast<color_space_t>(reader.varint32());
+    for (float* point : { infoOut.redPrimary, infoOut.greenPrimary, infoOut.bluePrimary, infoOut.whitePoint }) {
+        point[0] = reader.real();
+        point[1] = reader.real();
+    }
+    infoOut.minLuminance = reader.real();
+    infoOut.maxLuminance = reader.real();
+    infoOut.maxFullFrameLuminance = reader.real();
+}
+
+static constexpr const std::uint8_t kPathSdrWhiteLevel{ 1u << 0 };
+static constexpr const std::uint8_t kPathCurrentRefreshRate{ 1u << 1 };
+static constexpr const std::uint8_t kPathFriendlyName{ 1u << 2 };
+
+static inline void writeAnswer(TraceWriter& writer, const PathInfo& info) {
+    writer.byte((info.sdrWhiteLevel ? kPathSdrWhiteLevel : 0) | (info.currentRefreshRate ? kPathCurrentRefreshRate : 0)
+                | (info.friendlyName ? kPathFriendlyName : 0));
+    if (info.sdrWhiteLevel) {
+        writer.real(info.sdrWhiteLevel.value());
+    }
+    if (info.currentRefreshRate) {
+        writer.real(info.currentRefreshRate.value());
+    }
+    if (info.friendlyName) {
+        writer.string(info.friendlyName.value());
+    }
+}
+static inline void readAnswer(TraceReader& reader, PathInfo& infoOut) {
+    const std::uint8_t presence = reader.byte();
+    infoOut = {};
+    if (presence & kPathSdrWhiteLevel) {
+        infoOut.sdrWhiteLevel = reader.real();
+    }
+    if (presence & kPathCurrentRefreshRate) {
+        infoOut.currentRefreshRate = reader.real();
+    }
+    if (presence & kPathFriendlyName) {
+        infoOut.friendlyName = reader.string();
+    }
+}
+
+static inline void writeAnswer(TraceWriter& writer, const std::wstring& value) {
+    writer.string(value);
+}
+static inline void readAnswer(TraceReader& reader, std::wstring& valueOut) {
+    valueOut = reader.string();
+}
+
+static inline void writeAnswer(TraceWriter& writer, const std::vector<std::uint8_t>& bytes) {
+    writer.varint(bytes.size());
+    for (const std::uint8_t value : bytes) {
+        writer.byte(value);
+    }
+}
+static inline void readAnswer(TraceReader& reader, std::vector<std::uint8_t>& bytesOut) {
+    const std::uint64_t count = reader.varint();
+    bytesOut.clear();
+    for (std::uint64_t index = 0; index != count && !reader.failed(); ++index) {
+        bytesOut.push_back(reader.byte());
+    }
+}
+
+static inline void writeAnswer(TraceWriter& writer, const DisplayConfigTargetName& name) {
+    writer.string(name.friendlyName);
+    writer.string(name.monitorDevicePath);
+}
+static inline void readAnswer(TraceReader& reader, DisplayConfigTargetName& nameOut) {
+    nameOut.friendlyName = reader.string();
+    nameOut.monitorDevicePath = reader.string();
+}
+
+static inline void writeAnswer(TraceWriter& writer, const DisplayConfigPath& path) {
+    writer.varint(path.sourceAdapterLuid);
+    writer.varint(path.sourceId);
+    writer.varint(path.targetAdapterLuid);
+    writer.varint(path.targetId);
+    writer.varint(path.refreshRateNumerator);
+    writer.varint(path.refreshRateDenominator);
+}
+static inline void readAnswer(TraceReader& reader, DisplayConfigPath& pathOut) {
+    pathOut.sourceAdapterLuid = reader.varint();
+    pathOut.sourceId = reader.varint32();
+    pathOut.targetAdapterLuid = reader.varint();
+    pathOut.targetId = reader.varint32();
+    pathOut.refreshRateNumerator = reader.varint32();
+    pathOut.refreshRateDenominator = reader.varint32();
+}
+
+// The arguments of the DisplayConfig calls about one path.
+static inline void writePathIdentity(TraceWriter& writer, const DisplayConfigPath& path) {
+    writer.varint(path.sourceAdapterLuid);
+    writer.varint(path.sourceId);
+    writer.varint(path.targetAdapterLuid);
+    writer.varint(path.targetId);
+}
+
+// Reads past an answer of the given call, to validate it and find the next record.
+static inline void skipAnswer(TraceReader& reader, const trace_call_t call) {
+    const auto skip = [&reader]<typename T>(T value) {
+        readAnswer(reader, value);
+    };
+    switch (call) {
+        case trace_call_t::VariableRefreshRateSupport:
+            return skip(bool{});
+        case trace_call_t::EnumerateAdapters:
+            return skip(std::vector<AdapterDesc>{});
+        case trace_call_t::DriverInfo:
+            return skip(DriverInfo{});
+        case trace_call_t::EnumerateOutputs:
+            return skip(std::vector<OutputDesc>{});
+        case trace_call_t::ModeInfo:
+            return skip(ModeInfo{});
+        case trace_call_t::ColorInfo:
+            return skip(ColorInfo{});
+        case trace_call_t::PathInfo:
+            return skip(PathInfo{});
+        case trace_call_t::Dpi:
+            return skip(std::uint32_t{});
+        case trace_call_t::DriverInfoKey:
+        case trace_call_t::OutputProbeKey:
+        case trace_call_t::RegistryQword:
+            return skip(std::uint64_t{});
+        case trace_call_t::DisplayConfigPaths:
+            return skip(std::vector<DisplayConfigPath>{});
+        case trace_call_t::DisplayConfigSourceName:
+        case trace_call_t::SetupApiProperty:
+        case trace_call_t::RegistryString:
+            return skip(std::wstring{});
+        case trace_call_t::DisplayConfigTargetName:
+            return skip(DisplayConfigTargetName{});
+        case trace_call_t::DisplayConfigSdrWhiteLevel:
+        case trace_call_t::RegistryDword:
+            return skip(std::uint32_t{});
+        case trace_call_t::SetupApiOpen:
+        case trace_call_t::SetupApiDevice:
+        case trace_call_t::RegistryKey:
+        case trace_call_t::RegistryValue:
+            return; // Whether it succeeded is the answer.
+        case trace_call_t::RegistryBinary:
+            return skip(std::vector<std::uint8_t>{});
+        case trace_call_t::RegistrySubKeys:
+            return skip(std::vector<std::wstring>{});
+    }
+}
+
+[[nodiscard]] static inline std::uint64_t traceKey(const trace_call_t call, const probe_node_t node, const std::uint64_t adapterIndex, const std::uint64_t outputIndex) {
+    return std::uint64_t{ static_cast<std::uint8_t>(call) } | (std::uint64_t{ static_cast<std::uint8_t>(node) } << 8) | (adapterIndex << 16) | (outputIndex << 40);
+}
+
+void TraceRecorder::append(const std::string_view record) {
+    const std::scoped_lock lock{ m_mutex };
+    m_records += record;
+}
+
+void TraceRecorder::appendTo(std::string& bufferOut) const {
+    const std::scoped_lock lock{ m_mutex };
+    bufferOut += m_records;
+}
+
+RecordingBackend::RecordingBackend(backend_ptr_t backend, trace_recorder_ptr_t recorder)
+    : m_backend(std::move(backend)), m_recorder(recorder ? std::move(recorder) : std::make_shared<TraceRecorder>()) {
+    TraceWriter writer{ m_header };
+    for (int shift = 0; shift != 32; shift += 8) {
+        writer.byte(static_cast<std::uint8_t>(kBackendTraceMagic >> shift));
+    }
+    writer.byte(static_cast<std::uint8_t>(kBackendTraceVersion));
+    writer.byte(static_cast<std::uint8_t>(kBackendTraceVersion >> 8));
+    writer.string(m_backend->name());
+}
+
+RecordingBackend::~RecordingBackend() = default;
+
+void RecordingBackend::saveTrace(std::string& bufferOut) const {
+    bufferOut = m_header;
+    m_recorder->appendTo(bufferOut);
+}
+
+template <typename T, typename Call>
+bool RecordingBackend::record(const trace_call_t call, const probe_node_t node, const std::uint32_t adapterIndex, const std::uint32_t outputIndex,
+                              const T& answer, Call&& function) {
+    const auto begin = std::chrono::steady_clock::now();
+    const bool succeeded = function();
+    const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin);
+    // Encoded outside of the lock, concurrent probes only meet for the append.
+    std::string entry{};
+    TraceWriter writer{ entry };
+    writer.byte(static_cast<std::uint8_t>(call));
+    // Only the output keys need the node, for every other call it is AdapterDesc.
+    if (call == trace_call_t::OutputProbeKey) {
+        writer.byte(static_cast<std::uint8_t>(node));
+    }
+    writer.varint(adapterIndex);
+    writer.varint(outputIndex);
+    writer.byte(succeeded ? 1 : 0);
+    writer.varint(static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0)));
+    if (succeeded) {
+        writeAnswer(writer, answer);
+    }
+    m_recorder->append(entry);
+    return succeeded;
+}
+
+std::wstring_view RecordingBackend::name() const {
+    return m_backend->name();
+}
+
+bool RecordingBackend::getVariableRefreshRateSupport(bool& supportedOut) {
+    return record(trace_call_t::VariableRefreshRateSupport, probe_node_t::AdapterDesc, 0, 0, supportedOut, [this, &supportedOut]() {
+        return m_backend->getVariableRefreshRateSupport(supportedOut);
+    });
+}
+
+bool RecordingBackend::enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) {
+    return record(trace_call_t::EnumerateAdapters, probe_node_t::AdapterDesc, 0, 0, adaptersOut, [this, &adaptersOut]() {
+        return m_backend->enumerateAdapters(adaptersOut);
+    });
+}
+
+bool RecordingBackend::getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) {
+    return record(trace_call_t::DriverInfo, probe_node_t::AdapterDesc, adapter.index, 0, infoOut, [this, &adapter, &infoOut]() {
+        return m_backend->getDriverInfo(adapter, infoOut);
+    });
+}
+
+bool RecordingBackend::enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) {
+    return record(trace_call_t::EnumerateOutputs, probe_node_t::AdapterDesc, adapter.index, 0, outputsOut, [this, &adapter, &outputsOut]() {
+        return m_backend->enumerateOutputs(adapter, outputsOut);
+    });
+}
+
+bool RecordingBackend::getModeInfo(const OutputDesc& output, ModeInfo& infoOut) {
+    return record(trace_call_t::ModeInfo, probe_node_t::AdapterDesc, output.adapterIndex, output.index, infoOut, [this, &output, &infoOut]() {
+        return m_backend->getModeInfo(output, infoOut);
+    });
+}
+
+bool RecordingBackend::getColorInfo(const OutputDesc& output, ColorInfo& infoOut) {
+    return record(trace_call_t::ColorInfo, probe_node_t::AdapterDesc, output.adapterIndex, output.index, infoOut, [this, &output, &infoOut]() {
+        return m_backend->getColorInfo(output, infoOut);
+    });
+}
+
+bool RecordingBackend::getPathInfo(const OutputDesc& output, PathInfo& infoOut) {
+    return record(trace_call_t::PathInfo, probe_node_t::AdapterDesc, output.adapterIndex, output.index, infoOut, [this, &output, &infoOut]() {
+        return m_backend->getPathInfo(output, infoOut);
+    });
+}
+
+bool RecordingBackend::getDpi(const OutputDesc& output, std::uint32_t& dpiOut) {
+    return record(trace_call_t::Dpi, probe_node_t::AdapterDesc, output.adapterIndex, output.index, dpiOut, [this, &output, &dpiOut]() {
+        return m_backend->getDpi(output, dpiOut);
+    });
+}
+
+bool RecordingBackend::getDriverInfoKey(const AdapterDesc& adapter, std::uint64_t& keyOut) {
+    return record(trace_call_t::DriverInfoKey, probe_node_t::AdapterDesc, adapter.index, 0, keyOut, [this, &adapter, &keyOut]() {
+        return m_backend->getDriverInfoKey(adapter, keyOut);
+    });
+}
+
+bool RecordingBackend::getOutputProbeKey(const probe_node_t node, const OutputDesc& output, std::uint64_t& keyOut) {
+    return record(trace_call_t::OutputProbeKey, node, output.adapterIndex, output.index, keyOut, [this, node, &output, &keyOut]() {
+        return m_backend->getOutputProbeKey(node, output, keyOut);
+    });
+}
+
+// One seam call: the call and its arguments, which is also what a replay finds the answers of the
+// call by, then whether it succeeded and the answer.
+class SeamCall final {
+public:
+    explicit SeamCall(const trace_call_t call) {
+        m_writer.byte(static_cast<std::uint8_t>(call));
+    }
+    SeamCall(const SeamCall&) = delete;
+    SeamCall& operator=(const SeamCall&) = delete;
+
+    [[nodiscard]] TraceWriter& arguments() {
+        return m_writer;
+    }
+    [[nodiscard]] const std::string& key() const {
+        return m_record;
+    }
+
+    void record(TraceRecorder& recorder, const bool succeeded) {
+        m_writer.byte(succeeded ? 1 : 0);
+        recorder.append(m_record);
+    }
+
+    template <typename T>
+    void record(TraceRecorder& recorder, const bool succeeded, const T& answer) {
+        m_writer.byte(succeeded ? 1 : 0);
+        if (succeeded) {
+            writeAnswer(m_writer, answer);
+        }
+        recorder.append(m_record);
+    }
+
+private:
+    std::string m_record{};
+    TraceWriter m_writer{ m_record };
+};
+
+class RecordingDisplayConfigProvider final : public DisplayConfigProvider {
+public:
+    RecordingDisplayConfigProvider(display_config_provider_ptr_t provider, trace_recorder_ptr_t recorder)
+        : m_provider(std::move(provider)), m_recorder(std::move(recorder)) {}
+    ~RecordingDisplayConfigProvider() override = default;
+
+    [[nodiscard]] bool queryActivePaths(std::vector<DisplayConfigPath>& pathsOut) override {
+        SeamCall call{ trace_call_t::DisplayConfigPaths };
+        const bool succeeded = m_provider->queryActivePaths(pathsOut);
+        call.record(*m_recorder, succeeded, pathsOut);
+        return succeeded;
+    }
+
+    [[nodiscard]] bool getSourceName(const DisplayConfigPath& path, std::wstring& nameOut) override {
+        return record(trace_call_t::DisplayConfigSourceName, path, nameOut, [this, &path, &nameOut]() {
+            return m_provider->getSourceName(path, nameOut);
+        });
+    }
+
+    [[nodiscard]] bool getTargetName(const DisplayConfigPath& path, DisplayConfigTargetName& nameOut) override {
+        return record(trace_call_t::DisplayConfigTargetName, path, nameOut, [this, &path, &nameOut]() {
+            return m_provider->getTargetName(path, nameOut);
+        });
+    }
+
+    [[nodiscard]] bool getSdrWhiteLevel(const DisplayConfigPath& path, std::uint32_t& levelOut) override {
+        return record(trace_call_t::DisplayConfigSdrWhiteLevel, path, levelOut, [this, &path, &levelOut]() {
+            return m_provider->getSdrWhiteLevel(path, levelOut);
+        });
+    }
+
+private:
+    template <typename T, typename Call>
+    [[nodiscard]] bool record(const trace_call_t kind, const DisplayConfigPath& path, const T& answer, Call&& function) {
+        SeamCall call{ kind };
+        writePathIdentity(call.arguments(), path);
+        const bool succeeded = function();
+        call.record(*m_recorder, succeeded, answer);
+        return succeeded;
+    }
+
+    display_config_provider_ptr_t m_provider{};
+    trace_recorder_ptr_t m_recorder{};
+};
+
+class RecordingSetupApiProvider final : public SetupApiProvider {
+public:
+    RecordingSetupApiProvider(setupapi_provider_ptr_t provider, trace_recorder_ptr_t recorder)
+        : m_provider(std::move(provider)), m_recorder(std::move(recorder)) {}
+    ~RecordingSetupApiProvider() override = default;
+
+    [[nodiscard]] bool open() override {
+        SeamCall call{ trace_call_t::SetupApiOpen };
+        const bool succeeded = m_provider->open();
+        call.record(*m_recorder, succeeded);
+        return succeeded;
+    }
+
+    void close() override {
+        m_provider->close();
+    }
+
+    [[nodiscard]] bool hasDevice(const std::uint32_t index) override {
+        SeamCall call{ trace_call_t::SetupApiDevice };
+        call.arguments().varint(index);
+        const bool succeeded = m_provider->hasDevice(index);
+        call.record(*m_recorder, succeeded);
+        return succeeded;
+    }
+
+    [[nodiscard]] bool getProperty(const std::uint32_t index, const device_property_t property, std::wstring& valueOut) override {
+        SeamCall call{ trace_call_t::SetupApiProperty };
+        call.arguments().varint(index);
+        call.arguments().byte(static_cast<std::uint8_t>(property));
+        const bool succeeded = m_provider->getProperty(index, property, valueOut);
+        call.record(*m_recorder, succeeded, valueOut);
+        return succeeded;
+    }
+
+private:
+    setupapi_provider_ptr_t m_provider{};
+    trace_recorder_ptr_t m_recorder{};
+};
+
+// Knows its path below the key recordDxgiSeams() was given, the records are about those paths.
+class RecordingRegistryKey final : public Registry::RegistryKey {
+public:
+    RecordingRegistryKey(Registry::RegistryKey_ptr key, std::wstring path, trace_recorder_ptr_t recorder)
+        : m_key(std::move(key)), m_path(std::move(path)), m_recorder(std::move(recorder)) {}
+    ~RecordingRegistryKey() override = default;
+
+    Registry::RegistryKey_ptr Open(const std::wstring& path, Registry::DesiredAccess access = Registry::DesiredAccess::Read) override {
+        const std::wstring subKeyPath = join(path);
+        Registry::RegistryKey_ptr subKey{};
+        try {
+            subKey = m_key->Open(path, access);
+        } catch (const std::exception&) {
+            recordKey(subKeyPath, false);
+            throw;
+        }
+        recordKey(subKeyPath, subKey != nullptr);
+        if (!subKey) {
+            return nullptr;
+        }
+        return std::make_shared<RecordingRegistryKey>(std::move(subKey), subKeyPath, m_recorder);
+    }
+
+    bool HasKey(const std::wstring& path) override {
+        const bool found = m_key->HasKey(path);
+        recordKey(join(path), found);
+        return found;
+    }
+
+    bool HasValue(const std::wstring& name) override {
+        const bool found = m_key->HasValue(name);
+        SeamCall call{ trace_call_t::RegistryValue };
+        call.arguments().string(m_path);
+        call.arguments().string(name);
+        call.record(*m_recorder, found);
+        return found;
+    }
+
+    bool GetBoolean(const std::wstring& name) override {
+        const bool value = m_key->GetBoolean(name);
+        recordValue(trace_call_t::RegistryDword, name, std::optional<std::uint32_t>{ value ? 1 : 0 });
+        return value;
+    }
+
+    long GetInt32(const std::wstring& name) override {
+        const long value = m_key->GetInt32(name);
+        recordValue(trace_call_t::RegistryDword, name, std::optional<std::uint32_t>{ static_cast<std::uint32_t>(value) });
+        return value;
+    }
+
+    long long GetInt64(const std::wstring& name) override {
+        const long long value = m_key->GetInt64(name);
+        recordValue(trace_call_t::RegistryQword, name, std::optional<std::uint64_t>{ static_cast<std::uint64_t>(value) });
+        return value;
+    }
+
+    std::wstring GetString(const std::wstring& name) override {
+        std::wstring value = m_key->GetString(name);
+        recordValue(trace_call_t::RegistryString, name, std::optional<std::wstring>{ value });
+        return value;
+    }
+
+    std::optional<std::wstring> TryGetString(const std::wstring& name) override {
+        std::optional<std::wstring> value = m_key->TryGetString(name);
+        recordValue(trace_call_t::RegistryString, name, value);
+        return value;
+    }
+
+    std::optional<std::uint32_t> TryGetDWORD(const std::wstring& name) override {
+        const std::optional<std::uint32_t> value = m_key->TryGetDWORD(name);
+        recordValue(trace_call_t::RegistryDword, name, value);
+        return value;
+    }
+
+    std::optional<std::vector<std::uint8_t>> TryGetBinary(const std::wstring& name) override {
+        std::optional<std::vector<std::uint8_t>> value = m_key->TryGetBinary(name);
+        recordValue(trace_call_t::RegistryBinary, name, value);
+        return value;
+    }
+
+    std::vector<std::optional<std::wstring>> GetValues(const std::vector<std::wstring>& names) override {
+        std::vector<std::optional<std::wstring>> values = m_key->GetValues(names);
+        for (std::size_t index = 0; index != names.size() && index != values.size(); ++index) {
+            recordValue(trace_call_t::RegistryString, names[index], values[index]);
+        }
+        return values;
+    }
+
+    // Only the subkeys the callback has seen are recorded.
+    void EnumerateSubKeys(const std::function<bool(const std::wstring&)>& callback) override {
+        std::vector<std::wstring> names{};
+        try {
+            m_key->EnumerateSubKeys([&names, &callback](const std::wstring& name) {
+                names.push_back(name);
+                return callback(name);
+            });
+        } catch (const std::exception&) {
+            recordSubKeys(names);
+            throw;
+        }
+        recordSubKeys(names);
+    }
+
+private:
+    [[nodiscard]] std::wstring join(const std::wstring& path) const {
+        return m_path.empty() ? path : m_path + L'\\' + path;
+    }
+
+    void recordKey(const std::wstring& path, const bool found) {
+        SeamCall call{ trace_call_t::RegistryKey };
+        call.arguments().string(path);
+        call.record(*m_recorder, found);
+    }
+
+    void recordSubKeys(const std::vector<std::wstring>& names) {
+        SeamCall call{ trace_call_t::RegistrySubKeys };
+        call.arguments().string(m_path);
+        call.record(*m_recorder, true, names);
+    }
+
+    template <typename T>
+    void recordValue(const trace_call_t kind, const std::wstring& name, const std::optional<T>& value) {
+        SeamCall call{ kind };
+        call.arguments().string(m_path);
+        call.arguments().string(name);
+        if (value) {
+            call.record(*m_recorder, true, value.value());
+        } else {
+            call.record(*m_recorder, false);
+        }
+    }
+
+    Registry::RegistryKey_ptr m_key{};
+    std::wstring m_path{};
+    trace_recorder_ptr_t m_recorder{};
+};
+
+DxgiSeams recordDxgiSeams(DxgiSeams seams, trace_recorder_ptr_t recorder) {
+    DxgiSeams recorded{};
+    if (seams.displayConfig) {
+        recorded.displayConfig = std::make_shared<RecordingDisplayConfigProvider>(std::move(seams.displayConfig), recorder);
+    }
+    if (seams.setupApi) {
+        recorded.setupApi = std::make_shared<RecordingSetupApiProvider>(std::move(seams.setupApi), recorder);
+    }
+    if (seams.system) {
+        recorded.system = std::make_shared<RecordingRegistryKey>(std::move(seams.system), std::wstring{}, recorder);
+    }
+    return recorded;
+}
+
+struct TraceAnswer final {
+    std::size_t offset{ 0 }; // Of the encoded answer.
+    std::chrono::nanoseconds latency{ 0 };
+    bool succeeded{ false };
+};
+
+// Of one call, in the recorded order.
+struct TraceAnswers final {
+    std::vector<TraceAnswer> answers{};
+    std::size_t next{ 0 };
+};
+
+// The last answer is repeated once they are used up.
+[[nodiscard]] static inline TraceAnswer nextAnswer(TraceAnswers& answers) {
+    const TraceAnswer answer = answers.answers[answers.next];
+    answers.next = std::min(answers.next + 1, answers.answers.size() - 1);
+    return answer;
+}
+
+// The DisplayConfig and SetupAPI answers of a trace, found by the call and its arguments.
+class SeamAnswers final {
+public:
+    explicit SeamAnswers(const std::string& trace) : m_trace(trace) {}
+
+    // While the trace is opened, before any replay.
+    void add(std::string key, const TraceAnswer& answer) {
+        m_answers[std::move(key)].answers.push_back(answer);
+    }
+
+    [[nodiscard]] bool replay(const SeamCall& call) {
+        TraceAnswer answer{};
+        return find(call, answer) && answer.succeeded;
+    }
+
+    template <typename T>
+    [[nodiscard]] bool replay(const SeamCall& call, T& answerOut) {
+        TraceAnswer answer{};
+        if (!find(call, answer) || !answer.succeeded) {
+            return false;
+        }
+        // Validated by ReplayBackend::open() already.
+        TraceReader reader{ reinterpret_cast<const std::uint8_t*>(m_trace.data()) + answer.offset, m_trace.size() - answer.offset };
+        readAnswer(reader, answerOut);
+        return true;
+    }
+
+private:
+    [[nodiscard]] bool find(const SeamCall& call, TraceAnswer& answerOut) {
+        const std::scoped_lock lock{ m_mutex };
+        const auto it = m_answers.find(call.key());
+        if (it == m_answers.end()) {
+            return false;
+        }
+        answerOut = nextAnswer(it->second);
+        return true;
+    }
+
+    const std::string& m_trace;
+    std::mutex m_mutex{};
+    std::unordered_map<std::string, TraceAnswers> m_answers{};
+};
+using seam_answers_ptr_t = std::shared_ptr<SeamAnswers>;
+
+class ReplayDisplayConfigProvider final : public DisplayConfigProvider {
+public:
+    explicit ReplayDisplayConfigProvider(seam_answers_ptr_t answers) : m_answers(std::move(answers)) {}
+    ~ReplayDisplayConfigProvider() override = default;
+
+    [[nodiscard]] bool queryActivePaths(std::vector<DisplayConfigPath>& pathsOut) override {
+        const SeamCall call{ trace_call_t::DisplayConfigPaths };
+        return m_answers->replay(call, pathsOut);
+    }
+
+    [[nodiscard]] bool getSourceName(const DisplayConfigPath& path, std::wstring& nameOut) override {
+        return replay(trace_call_t::DisplayConfigSourceName, path, nameOut);
+    }
+
+    [[nodiscard]] bool getTargetName(const DisplayConfigPath& path, DisplayConfigTargetName& nameOut) override {
+        return replay(trace_call_t::DisplayConfigTargetName, path, nameOut);
+    }
+
+    [[nodiscard]] bool getSdrWhiteLevel(const DisplayConfigPath& path, std::uint32_t& levelOut) override {
+        return replay(trace_call_t::DisplayConfigSdrWhiteLevel, path, levelOut);
+    }
+
+private:
+    template <typename T>
+    [[nodiscard]] bool replay(const trace_call_t kind, const DisplayConfigPath& path, T& answerOut) {
+        SeamCall call{ kind };
+        writePathIdentity(call.arguments(), path);
+        return m_answers->replay(call, answerOut);
+    }
+
+    seam_answers_ptr_t m_answers{};
+};
+
+class ReplaySetupApiProvider final : public SetupApiProvider {
+public:
+    explicit ReplaySetupApiProvider(seam_answers_ptr_t answers) : m_answers(std::move(answers)) {}
+    ~ReplaySetupApiProvider() override = default;
+
+    [[nodiscard]] bool open() override {
+        const SeamCall call{ trace_call_t::SetupApiOpen };
+        return m_answers->replay(call);
+    }
+
+    void close() override {}
+
+    [[nodiscard]] bool hasDevice(const std::uint32_t index) override {
+        SeamCall call{ trace_call_t::SetupApiDevice };
+        call.arguments().varint(index);
+        return m_answers->replay(call);
+    }
+
+    [[nodiscard]] bool getProperty(const std::uint32_t index, const device_property_t property, std::wstring& valueOut) override {
+        SeamCall call{ trace_call_t::SetupApiProperty };
+        call.arguments().varint(index);
+        call.arguments().byte(static_cast<std::uint8_t>(property));
+        return m_answers->replay(call, valueOut);
+    }
+
+private:
+    seam_answers_ptr_t m_answers{};
+};
+
+class ReplayBackend final : public Backend {
+public:
+    ReplayBackend(std::string trace, const bool replayLatency) : m_trace(std::move(trace)), m_replayLatency(replayLatency) {}
+    ~ReplayBackend() override = default;
+
+    // Validates the whole trace and indexes its records.
+    [[nodiscard]] bool open() {
+        TraceReader reader{ data(), m_trace.size() };
+        std::uint32_t magic{ 0 };
+        for (int shift = 0; shift != 32; shift += 8) {
+            magic |= std::uint32_t{ reader.byte() } << shift;
+        }
+        std::uint16_t version = reader.byte();
+        version |= static_cast<std::uint16_t>(reader.byte() << 8);
+        if (reader.failed() || magic != kBackendTraceMagic || version == 0 || version > kBackendTraceVersion) {
+            std::wcerr << L"Not a backend trace of version " << kBackendTraceVersion << L" or older." << std::endl;
+            return false;
+        }
+        m_name = reader.string();
+        while (!reader.atEnd() && !reader.failed()) {
+            const std::size_t recordOffset = reader.offset();
+            const auto call = static_cast<trace_call_t>(reader.byte());
+            if (call > trace_call_t::RegistrySubKeys || (call > trace_call_t::OutputProbeKey && version == 1)) {
+                break;
+            }
+            if (call > trace_call_t::OutputProbeKey) {
+                if (!openSeamCall(reader, call, recordOffset)) {
+                    break;
+                }
+                continue;
+            }
+            const auto node = (call == trace_call_t::OutputProbeKey) ? static_cast<probe_node_t>(reader.byte()) : probe_node_t::AdapterDesc;
+            const std::uint64_t adapterIndex = reader.varint();
+            const std::uint64_t outputIndex = reader.varint();
+            TraceAnswer answer{};
+            answer.succeeded = reader.byte() != 0;
+            answer.latency = std::chrono::nanoseconds{ static_cast<std::int64_t>(std::min<std::uint64_t>(reader.varint(), INT64_MAX)) };
+            answer.offset = reader.offset();
+            if (answer.succeeded) {
+                skipAnswer(reader, call);
+            }
+            if (reader.failed() || adapterIndex > kMaxTraceIndex || outputIndex > kMaxTraceIndex || static_cast<std::size_t>(node) >= kProbeNodeCount) {
+                break;
+            }
+            m_answers[traceKey(call, node, adapterIndex, outputIndex)].answers.push_back(answer);
+        }
+        if (reader.failed() || !reader.atEnd()) {
+            std::wcerr << L"The backend trace is corrupted at offset " << reader.offset() << L'.' << std::endl;
+            return false;
+        }
+        if (m_seams) {
+            DxgiSeams seams{};
+            seams.displayConfig = std::make_shared<ReplayDisplayConfigProvider>(m_seams);
+            seams.setupApi = std::make_shared<ReplaySetupApiProvider>(m_seams);
+            seams.system = m_system;
+            m_support = std::make_unique<DxgiSupport>(std::move(seams));
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::wstring_view name() const override {
+        return m_name;
+    }
+
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override {
+        return replay(trace_call_t::VariableRefreshRateSupport, probe_node_t::AdapterDesc, 0, 0, supportedOut);
+    }
+
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override {
+        if (m_support) {
+            m_support->invalidate();
+        }
+        return replay(trace_call_t::EnumerateAdapters, probe_node_t::AdapterDesc, 0, 0, adaptersOut);
+    }
+
+    // With the seams recorded, the recorded answer only sets how long this takes.
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override {
+        if (!m_support) {
+            return replay(trace_call_t::DriverInfo, probe_node_t::AdapterDesc, adapter.index, 0, infoOut);
+        }
+        DriverInfo recorded{};
+        std::ignore = replay(trace_call_t::DriverInfo, probe_node_t::AdapterDesc, adapter.index, 0, recorded);
+        return m_support->getDriverInfo(adapter, infoOut);
+    }
+
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override {
+        return replay(trace_call_t::EnumerateOutputs, probe_node_t::AdapterDesc, adapter.index, 0, outputsOut);
+    }
+
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override {
+        return replay(trace_call_t::ModeInfo, probe_node_t::AdapterDesc, output.adapterIndex, output.index, infoOut);
+    }
+
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override {
+        return replay(trace_call_t::ColorInfo, probe_node_t::AdapterDesc, output.adapterIndex, output.index, infoOut);
+    }
+
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override {
+        if (!m_support) {
+            return replay(trace_call_t::PathInfo, probe_node_t::AdapterDesc, output.adapterIndex, output.index, infoOut);
+        }
+        PathInfo recorded{};
+        const bool recordedSucceeded = replay(trace_call_t::PathInfo, probe_node_t::AdapterDesc, output.adapterIndex, output.index, recorded);
+        if (!m_support->getPathInfo(output, infoOut)) {
+            return false;
+        }
+        // The backend asks GDI for a refresh rate the path lacks, GDI is no seam.
+        if (!infoOut.currentRefreshRate && recordedSucceeded) {
+            infoOut.currentRefreshRate = recorded.currentRefreshRate;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override {
+        return replay(trace_call_t::Dpi, probe_node_t::AdapterDesc, output.adapterIndex, output.index, dpiOut);
+    }
+
+    [[nodiscard]] bool getDriverInfoKey(const AdapterDesc& adapter, std::uint64_t& keyOut) override {
+        return replay(trace_call_t::DriverInfoKey, probe_node_t::AdapterDesc, adapter.index, 0, keyOut);
+    }
+
+    [[nodiscard]] bool getOutputProbeKey(const probe_node_t node, const OutputDesc& output, std::uint64_t& keyOut) override {
+        if (!m_support || node != probe_node_t::ModeInfo) {
+            return replay(trace_call_t::OutputProbeKey, node, output.adapterIndex, output.index, keyOut);
+        }
+        std::uint64_t recorded{ 0 };
+        std::ignore = replay(trace_call_t::OutputProbeKey, node, output.adapterIndex, output.index, recorded);
+        return m_support->getModeInfoKey(output, keyOut);
+    }
+
+private:
+    [[nodiscard]] const std::uint8_t* data() const {
+        return reinterpret_cast<const std::uint8_t*>(m_trace.data());
+    }
+
+    // Indexes a DisplayConfig or SetupAPI call, or loads a registry answer into the memory registry.
+    [[nodiscard]] bool openSeamCall(TraceReader& reader, const trace_call_t call, const std::size_t recordOffset) {
+        if (!m_seams) {
+            m_seams = std::make_shared<SeamAnswers>(m_trace);
+            m_system = createMemoryRegistry();
+        }
+        std::wstring path{};
+        std::wstring name{};
+        switch (call) {
+            case trace_call_t::DisplayConfigSourceName:
+            case trace_call_t::DisplayConfigTargetName:
+            case trace_call_t::DisplayConfigSdrWhiteLevel:
+                for (int field = 0; field != 4; ++field) {
+                    std::ignore = reader.varint();
+                }
+                break;
+            case trace_call_t::SetupApiDevice:
+                std::ignore = reader.varint32();
+                break;
+            case trace_call_t::SetupApiProperty:
+                std::ignore = reader.varint32();
+                std::ignore = reader.byte();
+                break;
+            case trace_call_t::RegistryKey:
+            case trace_call_t::RegistrySubKeys:
+                path = reader.string();
+                break;
+            case trace_call_t::RegistryValue:
+            case trace_call_t::RegistryString:
+            case trace_call_t::RegistryDword:
+            case trace_call_t::RegistryQword:
+            case trace_call_t::RegistryBinary:
+                path = reader.string();
+                name = reader.string();
+                break;
+            default:
+                break;
+        }
+        const std::size_t argumentsEnd = reader.offset();
+        TraceAnswer answer{};
+        answer.succeeded = reader.byte() != 0;
+        answer.offset = reader.offset();
+        if (answer.succeeded) {
+            skipAnswer(reader, call);
+        }
+        if (reader.failed()) {
+            return false;
+        }
+        if (call < trace_call_t::RegistryKey) {
+            m_seams->add(m_trace.substr(recordOffset, argumentsEnd - recordOffset), answer);
+            return true;
+        }
+        // Keys and values which weren't there aren't in the memory registry either.
+        if (!answer.succeeded) {
+            return true;
+        }
+        TraceReader answerReader{ data() + answer.offset, m_trace.size() - answer.offset };
+        try {
+            loadRegistryAnswer(call, path, name, answerReader);
+        } catch (const std::exception& ex) {
+            std::wcerr << L"Failed to load a registry answer of the backend trace: " << ex.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void loadRegistryAnswer(const trace_call_t call, const std::wstring& path, const std::wstring& name, TraceReader& reader) {
+        const Registry::RegistryKey_ptr key = path.empty() ? m_system : m_system->Create(path);
+        switch (call) {
+            case trace_call_t::RegistryValue:
+                // Only known to exist, a read of it may have been recorded as well.
+                if (!key->HasValue(name)) {
+                    key->SetString(name, {});
+                }
+                return;
+            case trace_call_t::RegistryString:
+                return key->SetString(name, reader.string());
+            case trace_call_t::RegistryDword:
+                return key->SetInt32(name, static_cast<long>(reader.varint32()));
+            case trace_call_t::RegistryQword:
+                return key->SetInt64(name, static_cast<long long>(reader.varint()));
+            case trace_call_t::RegistryBinary: {
+                std::vector<std::uint8_t> bytes{};
+                readAnswer(reader, bytes);
+                return key->SetBinary(name, bytes);
+            }
+            case trace_call_t::RegistrySubKeys: {
+                std::vector<std::wstring> names{};
+                readAnswer(reader, names);
+                for (auto&& subKey : names) {
+                    std::ignore = key->Create(subKey);
+                }
+                return;
+            }
+            default:
+                return; // RegistryKey, the key is there now.
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]] bool replay(const trace_call_t call, const probe_node_t node, const std::uint64_t adapterIndex, const std::uint64_t outputIndex, T& answerOut) {
+        TraceAnswer answer{};
+        {
+            const std::scoped_lock lock{ m_mutex };
+            const auto it = m_answers.find(traceKey(call, node, adapterIndex, outputIndex));
+            if (it == m_answers.end()) {
+                return false;
+            }
+            answer = nextAnswer(it->second);
+        }
+        if (m_replayLatency) {
+            std::this_thread::sleep_for(answer.latency);
+        }
+        if (!answer.succeeded) {
+            return false;
+        }
+        // Validated by open() already.
+        TraceReader reader{ data() + answer.offset, m_trace.size() - answer.offset };
+        readAnswer(reader, answerOut);
+        return true;
+    }
+
+    std::string m_trace{};
+    bool m_replayLatency{ false };
+    std::wstring m_name{};
+    std::mutex m_mutex{};
+    std::unordered_map<std::uint64_t, TraceAnswers> m_answers{};
+    seam_answers_ptr_t m_seams{};
+    Registry::RegistryKey_ptr m_system{};
+    std::unique_ptr<DxgiSupport> m_support{};
+};
+
+backend_ptr_t createReplayBackend(std::string trace, const bool replayLatency) {
+    auto backend = std::make_shared<ReplayBackend>(std::move(trace), replayLatency);
+    if (!backend->open()) {
+        return nullptr;
+    }
+    return backend;
+}
+
+bool saveBackendTrace(const std::filesystem::path& path, const std::string_view trace) {
+#ifdef _WIN32
+    FILE* file = _wfopen(path.c_str(), L"wb");
+#else
+    FILE* file = std::fopen(path.c_str(), "wb");
+#endif
+    if (!file) {
+        std::wcerr << L"Failed to create \"" << path.wstring() << L"\"." << std::endl;
+        return false;
+    }
+    const bool written = std::fwrite(trace.data(), 1, trace.size(), file) == trace.size();
+    const bool closed = std::fclose(file) == 0;
+    if (!written || !closed) {
+        std::wcerr << L"Failed to write \"" << path.wstring() << L"\"." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool loadBackendTrace(const std::filesystem::path& path, std::string& traceOut) {
+    MappedFile file{};
+    if (!file.open(path)) {
+        return false;
+    }
+    traceOut.assign(reinterpret_cast<const char*>(file.data()), file.size());
+    return true;
+}
+
+} // namespace gputester
@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include "dxgi_support.hpp"
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace gputester {
+
+// Record and replay of backend answers. Every call into the wrapped backend (and so every OS call
+// behind it: DXGI, the registry, SetupAPI, DisplayConfig or sysfs) is recorded together with its
+// answer and latency, and a replay backend serves the answers back on any platform. Capture a
+// machine once with "gputester --record=<trace>" and probe it anywhere with "--replay=<trace>".
+//
+// The DXGI backend's seams can be recorded as well (see recordDxgiSeams()). A replay then answers
+// the driver info, the display paths and the mode list keys by running DxgiSupport, the DXGI
+// backend's own code, over the recorded DisplayConfig, SetupAPI and registry answers instead of
+// serving what the backend returned.
+//
+// Trace layout, version 2: the header is the magic "GPBT" and the version as little-endian u32
+// and u16, followed by the backend name as a string. Then one record per call, in the order the
+// calls returned. A backend call is recorded as
+//
+//   u8 call (trace_call_t), u8 probe_node_t (OutputProbeKey only), varint adapter index,
+//   varint output index, u8 succeeded, varint latency in nanoseconds, the answer if it succeeded
+//
+// and a seam call as
+//
+//   u8 call (trace_call_t), the arguments, u8 succeeded, the answer if it succeeded
+//
+// A display path is identified by its source adapter LUID and id and its target adapter LUID and
+// id, registry keys by their path below HKEY_LOCAL_MACHINE\SYSTEM. Integers are LEB128 varints
+// (zigzag for signed ones), floats are little-endian IEEE 754, strings are a varint byte count and
+// UTF-8 and binary values a varint byte count and the bytes. Version 1 is version 2 without seam
+// calls, it is still read.
+static constexpr const std::uint32_t kBackendTraceMagic{ 0x54425047 }; // "GPBT"
+static constexpr const std::uint16_t kBackendTraceVersion{ 2 };
+
+enum class trace_call_t : std::uint8_t {
+    VariableRefreshRateSupport,
+    EnumerateAdapters,
+    DriverInfo,
+    EnumerateOutputs,
+    ModeInfo,
+    ColorInfo,
+    PathInfo,
+    Dpi,
+    DriverInfoKey,
+    OutputProbeKey,
+    // DisplayConfigProvider
+    DisplayConfigPaths,
+    DisplayConfigSourceName,
+    DisplayConfigTargetName,
+    DisplayConfigSdrWhiteLevel,
+    // SetupApiProvider
+    SetupApiOpen,
+    SetupApiDevice,
+    SetupApiProperty,
+    // RegistryKey, "succeeded" tells whether the key or value exists.
+    RegistryKey,
+    RegistryValue,
+    RegistryString,
+    RegistryDword,
+    RegistryQword,
+    RegistryBinary,
+    RegistrySubKeys
+};
+
+// The records of one trace, shared by a recording backend and the seams recorded along with it.
+class TraceRecorder final {
+public:
+    void append(const std::string_view record);
+    void appendTo(std::string& bufferOut) const;
+
+private:
+    mutable std::mutex m_mutex{};
+    std::string m_records{};
+};
+using trace_recorder_ptr_t = std::shared_ptr<TraceRecorder>;
+
+// Forwards every call to "backend" and records it, the probe engine can't tell the difference.
+class RecordingBackend final : public Backend {
+public:
+    // A recorder of its own if "recorder" is null.
+    explicit RecordingBackend(backend_ptr_t backend, trace_recorder_ptr_t recorder = {});
+    ~RecordingBackend() override;
+
+    // Every call which returned so far.
+    void saveTrace(std::string& bufferOut) const;
+
+    [[nodiscard]] std::wstring_view name() const override;
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override;
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override;
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override;
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override;
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override;
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override;
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override;
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override;
+    [[nodiscard]] bool getDriverInfoKey(const AdapterDesc& adapter, std::uint64_t& keyOut) override;
+    [[nodiscard]] bool getOutputProbeKey(const probe_node_t node, const OutputDesc& output, std::uint64_t& keyOut) override;
+
+private:
+    template <typename T, typename Call>
+    [[nodiscard]] bool record(const trace_call_t call, const probe_node_t node, const std::uint32_t adapterIndex, const std::uint32_t outputIndex,
+                              const T& answer, Call&& function);
+
+    backend_ptr_t m_backend{};
+    trace_recorder_ptr_t m_recorder{};
+    std::string m_header{};
+};
+
+// Wraps the seams so every call through them is recorded to "recorder" too. Hand the result to
+// createDxgiBackend() and the same recorder to the RecordingBackend around it. The registry key is
+// read only, and a read which throws is not recorded.
+[[nodiscard]] DxgiSeams recordDxgiSeams(DxgiSeams seams, trace_recorder_ptr_t recorder);
+
+// Serves the answers of a trace. A call is matched by its kind and the adapter and output index it
+// is about; calls recorded several times (e.g. by --watch) are answered in the recorded order, and
+// the last answer is repeated once they are used up. A call the trace has no record of fails.
+// With "replayLatency" every answer takes as long as it took on the recorded machine.
+// If the trace has seam calls, DisplayConfig and SetupAPI calls are matched by their arguments the
+// same way, and the registry answers are loaded into a memory registry (see createMemoryRegistry()).
+// Returns nullptr if "trace" is not a valid trace, the reason is reported.
+[[nodiscard]] backend_ptr_t createReplayBackend(std::string trace, const bool replayLatency = false);
+
+[[nodiscard]] bool saveBackendTrace(const std::filesystem::path& path, const std::string_view trace);
+[[nodiscard]] bool loadBackendTrace(const std::filesystem::path& path, std::string& traceOut);
+
+} // namespace gputester
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+// A minimal timing harness, so the benchmarks don't need any third-party library.
+namespace gputester::bench {
+
+static constexpr const std::chrono::nanoseconds kMinSampleTime{ std::chrono::milliseconds(100) };
+static constexpr const int kSampleCount{ 5 };
+
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#ifdef _MSC_VER
+    const volatile void* sink = &value;
+    static_cast<void>(sink);
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+struct Result final {
+    std::string name{};
+    double nanosecondsPerIteration{ 0.0 };
+    std::size_t iterations{ 0 };
+};
+
+// Runs "function" in batches until a batch takes at least kMinSampleTime, then reports
+// the median time per iteration of kSampleCount such batches.
+template <typename Function>
+inline Result run(const std::string& name, Function&& function) {
+    using clock_t = std::chrono::steady_clock;
+    const auto timeBatch = [&function](const std::size_t iterations) -> std::chrono::nanoseconds {
+        const auto begin = clock_t::now();
+        for (std::size_t index = 0; index != iterations; ++index) {
+            function();
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - begin);
+    };
+    std::size_t iterations{ 1 };
+    for (auto elapsed = timeBatch(iterations); elapsed < kMinSampleTime; elapsed = timeBatch(iterations)) {
+        const auto ratio = elapsed.count() > 0 ? static_cast<double>(kMinSampleTime.count()) / static_cast<double>(elapsed.count()) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<std::size_t>(static_cast<double>(iterations) * std::min(ratio * 1.2, 10.0)));
+    }
+    std::vector<double> samples{};
+    for (int sample = 0; sample != kSampleCount; ++sample) {
+        samples.push_back(static_cast<double>(timeBatch(iterations).count()) / static_cast<double>(iterations));
+    }
+    std::sort(samples.begin(), samples.end());
+    Result result{ name, samples[samples.size() / 2], iterations };
+    std::printf("%-56s %14.1f ns/op %12zu iterations\n", result.name.c_str(), result.nanosecondsPerIteration, result.iterations);
+    std::fflush(stdout);
+    return result;
+}
+
+} // namespace gputester::bench
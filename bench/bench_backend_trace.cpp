@@ -0,0 +1,224 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "backend_trace.hpp"
+#include "binary_report.hpp"
+#include "dxgi_support.hpp"
+#include "probe_graph.hpp"
+#include "registry_memory.hpp"
+#include "report.hpp"
+#include "thread_pool.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace gputester;
+
+// The DXGI backend with the DXGI calls themselves answered by a fixture, so everything it asks the
+// seams runs the real code.
+class SeamBackend final : public Backend {
+public:
+    SeamBackend(backend_ptr_t fixture, DxgiSeams seams) : m_fixture(std::move(fixture)), m_support(std::move(seams)) {}
+    ~SeamBackend() override = default;
+
+    [[nodiscard]] std::wstring_view name() const override {
+        return L"dxgi";
+    }
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override {
+        return m_fixture->getVariableRefreshRateSupport(supportedOut);
+    }
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override {
+        m_support.invalidate();
+        return m_fixture->enumerateAdapters(adaptersOut);
+    }
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override {
+        return m_support.getDriverInfo(adapter, infoOut);
+    }
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override {
+        return m_fixture->enumerateOutputs(adapter, outputsOut);
+    }
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override {
+        return m_fixture->getModeInfo(output, infoOut);
+    }
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override {
+        return m_fixture->getColorInfo(output, infoOut);
+    }
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override {
+        return m_support.getPathInfo(output, infoOut);
+    }
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override {
+        return m_fixture->getDpi(output, dpiOut);
+    }
+    [[nodiscard]] bool getOutputProbeKey(const probe_node_t node, const OutputDesc& output, std::uint64_t& keyOut) override {
+        return node == probe_node_t::ModeInfo && m_support.getModeInfoKey(output, keyOut);
+    }
+
+private:
+    backend_ptr_t m_fixture{};
+    DxgiSupport m_support;
+};
+
+static constexpr const wchar_t kAmdDriverKey[]{ L"{4d36e968-e325-11ce-bfc1-08002be10318}\\0000" };
+
+// An AMD and an NVIDIA adapter, and monitors of which every other one has an EDID in the registry.
+[[nodiscard]] static inline DxgiSeams makeSeams(const std::vector<AdapterInfo>& adapters) {
+    DxgiSeams seams{};
+    seams.setupApi = std::make_shared<FakeSetupApiProvider>(std::vector<FakeSetupApiProvider::Device>{
+        { L"AMD Radeon RX 7900 XTX", kAmdDriverKey, L"Advanced Micro Devices, Inc.", L"31.0.24002.92", L"2024-3-1" },
+        { L"NVIDIA GeForce RTX 4090", L"{4d36e968-e325-11ce-bfc1-08002be10318}\\0001", L"NVIDIA", L"32.0.15.5585", L"2024-6-2" } });
+    seams.system = createMemoryRegistry();
+    const auto amdKey = seams.system->Create(std::wstring{ L"CurrentControlSet\\Control\\Class\\" } + kAmdDriverKey);
+    amdKey->SetString(L"RadeonSoftwareEdition", L"Adrenalin");
+    amdKey->SetString(L"RadeonSoftwareVersion", L"24.3.1");
+    std::vector<FakeDisplayConfigProvider::Display> displays{};
+    for (auto&& adapter : adapters) {
+        for (auto&& output : adapter.outputs) {
+            const std::wstring instance = L"5&2f7ce4f&0&UID" + std::to_wstring(displays.size());
+            FakeDisplayConfigProvider::Display display{};
+            display.gdiDeviceName = output.desc.deviceName;
+            display.friendlyName = L"DELL U2723QE";
+            display.monitorDevicePath = L"\\\\?\\DISPLAY#DEL4109#" + instance + L"#{e6f07b5f-ee97-4a90-b076-33f57bf4eaa7}";
+            if (displays.size() % 2 == 0) {
+                std::vector<std::uint8_t> edid(256, 0);
+                edid[1] = static_cast<std::uint8_t>(displays.size());
+                seams.system->Create(L"CurrentControlSet\\Enum\\DISPLAY\\DEL4109\\" + instance + L"\\Device Parameters")->SetBinary(L"EDID", edid);
+            }
+            displays.push_back(std::move(display));
+        }
+    }
+    seams.displayConfig = std::make_shared<FakeDisplayConfigProvider>(std::move(displays));
+    return seams;
+}
+
+[[nodiscard]] static inline std::string encode(const GpuReport& report) {
+    std::string buffer{};
+    encodeBinaryReport(report, buffer);
+    return buffer;
+}
+
+int main() {
+    ThreadPool pool{};
+    ProbeOptions options{};
+    options.pool = &pool;
+    for (const std::size_t adapterCount : { 1, 4, 16 }) {
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        const backend_ptr_t fixture = createFixtureBackend(bench::makeReport(adapterCount, 2).adapters);
+        // What recording adds to a probe, measured on a backend which answers instantly.
+        bench::run("backend_trace/probe/direct/" + label, [&fixture, &options]() {
+            GpuReport report{};
+            std::ignore = probe(*fixture, report, options);
+            bench::doNotOptimize(report);
+        });
+        bench::run("backend_trace/probe/recording/" + label, [&fixture, &options]() {
+            const auto recorder = std::make_shared<RecordingBackend>(fixture);
+            GpuReport report{};
+            std::ignore = probe(*recorder, report, options);
+            bench::doNotOptimize(report);
+        });
+        // A captured machine whose driver calls block as long as real ones.
+        const auto recorder = std::make_shared<RecordingBackend>(std::make_shared<bench::BlockingBackend>(fixture));
+        GpuReport report{};
+        if (!probe(*recorder, report, options)) {
+            return 1;
+        }
+        std::string trace{};
+        recorder->saveTrace(trace);
+        std::printf("%-56s %14zu bytes\n", ("backend_trace/size/" + label).c_str(), trace.size());
+        bench::run("backend_trace/open/" + label, [&trace]() {
+            const backend_ptr_t replay = createReplayBackend(trace);
+            bench::doNotOptimize(replay);
+        });
+        for (const bool replayLatency : { false, true }) {
+            const backend_ptr_t replay = createReplayBackend(trace, replayLatency);
+            if (!replay) {
+                return 1;
+            }
+            bench::run(std::string{ replayLatency ? "backend_trace/replay/recorded_latency/" : "backend_trace/replay/instant/" } + label, [&replay, &options]() {
+                GpuReport report{};
+                std::ignore = probe(*replay, report, options);
+                bench::doNotOptimize(report);
+            });
+        }
+        // With the seams recorded the replay runs the DXGI backend's own code, it has to arrive at the same report.
+        std::vector<AdapterInfo> adapters = bench::makeReport(adapterCount, 2).adapters;
+        adapters.front().desc.description = L"AMD Radeon RX 7900 XTX";
+        const backend_ptr_t seamFixture = createFixtureBackend(adapters);
+        const auto traceRecorder = std::make_shared<TraceRecorder>();
+        const auto seamRecorder = std::make_shared<RecordingBackend>(std::make_shared<SeamBackend>(seamFixture, recordDxgiSeams(makeSeams(adapters), traceRecorder)), traceRecorder);
+        ProbeGraph recordedGraph{ seamRecorder };
+        GpuReport recordedReport{};
+        if (!recordedGraph.update(recordedReport, options) || !recordedReport.adapters.front().driver
+            || recordedReport.adapters.front().driver->version != L"Adrenalin 24.3.1") {
+            return 1;
+        }
+        std::string seamTrace{};
+        seamRecorder->saveTrace(seamTrace);
+        std::printf("%-56s %14zu bytes\n", ("backend_trace/size/seams/" + label).c_str(), seamTrace.size());
+        const backend_ptr_t seamReplay = createReplayBackend(seamTrace);
+        if (!seamReplay) {
+            return 1;
+        }
+        ProbeGraph replayedGraph{ seamReplay };
+        GpuReport replayedReport{};
+        if (!replayedGraph.update(replayedReport, options) || encode(replayedReport) != encode(recordedReport)) {
+            std::printf("The seam replay of %s differs from the recorded report.\n", label.c_str());
+            return 1;
+        }
+        // The mode list keys come from the EDID or the device path, both read through the seams.
+        const auto reference = std::make_shared<SeamBackend>(seamFixture, makeSeams(adapters));
+        std::vector<AdapterDesc> referenceAdapters{};
+        std::vector<AdapterDesc> replayedAdapters{};
+        if (!reference->enumerateAdapters(referenceAdapters) || !seamReplay->enumerateAdapters(replayedAdapters)) {
+            return 1;
+        }
+        for (auto&& adapter : referenceAdapters) {
+            std::vector<OutputDesc> outputs{};
+            std::vector<OutputDesc> replayedOutputs{};
+            if (!reference->enumerateOutputs(adapter, outputs) || !seamReplay->enumerateOutputs(adapter, replayedOutputs)) {
+                return 1;
+            }
+            for (auto&& output : outputs) {
+                std::uint64_t referenceKey{ 0 };
+                std::uint64_t replayedKey{ 0 };
+                if (!reference->getOutputProbeKey(probe_node_t::ModeInfo, output, referenceKey)
+                    || !seamReplay->getOutputProbeKey(probe_node_t::ModeInfo, output, replayedKey) || referenceKey != replayedKey) {
+                    std::printf("The replayed mode list key of %ls differs.\n", output.deviceName.c_str());
+                    return 1;
+                }
+            }
+        }
+        bench::run("backend_trace/replay/seams/" + label, [&seamReplay, &options]() {
+            GpuReport report{};
+            std::ignore = probe(*seamReplay, report, options);
+            bench::doNotOptimize(report);
+        });
+    }
+    return 0;
+}
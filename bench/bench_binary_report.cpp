@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "report_fixture.hpp"
+#include "binary_report.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace gputester;
+
+static constexpr const std::size_t kDefaultReportCount{ 1000000 };
+static constexpr const std::size_t kAccessPatternSize{ 1 << 20 };
+
+// xorshift64, a fixed seed keeps the access pattern the same between runs.
+[[nodiscard]] static inline std::uint64_t nextRandom(std::uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Usage: bench_binary_report [report count]
+int main(int argc, char** argv) {
+    const std::size_t reportCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultReportCount;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "gputester_bench_reports.bin";
+    {
+        // Vary the shape a little, so the reports aren't all the same size.
+        std::vector<GpuReport> shapes{};
+        for (std::size_t adapterCount = 1; adapterCount <= 2; ++adapterCount) {
+            for (std::size_t outputCount = 1; outputCount <= 3; ++outputCount) {
+                shapes.push_back(bench::makeReport(adapterCount, outputCount));
+            }
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        BinaryArchiveWriter writer{};
+        if (!writer.open(path)) {
+            return 1;
+        }
+        for (std::size_t index = 0; index != reportCount; ++index) {
+            GpuReport& report = shapes[index % shapes.size()];
+            report.adapters.front().desc.luid = index;
+            if (!writer.append(report)) {
+                return 1;
+            }
+        }
+        if (!writer.finish()) {
+            return 1;
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        std::printf("binary_report/write_archive/%zu reports: %.1f ms, %.1f MiB\n", reportCount, elapsed, static_cast<double>(std::filesystem::file_size(path)) / 1048576.0);
+    }
+    BinaryArchive archive{};
+    if (!archive.open(path) || archive.size() != reportCount) {
+        return 1;
+    }
+    std::vector<std::uint64_t> pattern(kAccessPatternSize);
+    std::uint64_t state{ 0x9E3779B97F4A7C15ull };
+    for (auto&& index : pattern) {
+        index = nextRandom(state) % reportCount;
+    }
+    std::size_t cursor{ 0 };
+    const std::string label = std::to_string(reportCount) + "reports";
+    bench::run("binary_report/random_adapter_field/" + label, [&]() {
+        const auto report = archive.report(pattern[cursor++ & (kAccessPatternSize - 1)]);
+        bench::doNotOptimize(report->adapter(0).luid());
+    });
+    bench::run("binary_report/random_output_field/" + label, [&]() {
+        const auto report = archive.report(pattern[cursor++ & (kAccessPatternSize - 1)]);
+        const BinaryAdapterView adapter = report->adapter(report->adapterCount() - 1);
+        bench::doNotOptimize(adapter.output(adapter.outputCount() - 1).currentRefreshRate());
+    });
+    bench::run("binary_report/random_string_field/" + label, [&]() {
+        const auto report = archive.report(pattern[cursor++ & (kAccessPatternSize - 1)]);
+        bench::doNotOptimize(report->adapter(0).output(0).friendlyName());
+    });
+    bench::run("binary_report/random_full_decode/" + label, [&]() {
+        const auto report = archive.report(pattern[cursor++ & (kAccessPatternSize - 1)]);
+        GpuReport decoded{};
+        report->decode(decoded);
+        bench::doNotOptimize(decoded);
+    });
+    std::filesystem::remove(path);
+    return 0;
+}
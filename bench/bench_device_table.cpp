@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "device_table.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <tuple>
+#include <utility>
+
+using namespace gputester;
+
+// Besides the real adapters, the display class usually also lists things like the
+// "Microsoft Basic Display Adapter" and remote display drivers.
+static constexpr const std::size_t kExtraDeviceCount{ 2 };
+// Each SetupAPI call goes through cfgmgr32 and usually the registry, a microsecond is optimistic.
+static constexpr const std::chrono::nanoseconds kCallLatency{ std::chrono::microseconds(1) };
+
+[[nodiscard]] static inline std::vector<FakeSetupApiProvider::Device> makeDevices(const std::size_t adapterCount) {
+    std::vector<FakeSetupApiProvider::Device> devices{};
+    for (std::size_t index = 0; index != adapterCount + kExtraDeviceCount; ++index) {
+        FakeSetupApiProvider::Device device{};
+        device.driverDesc = L"NVIDIA GeForce RTX 4090 #" + std::to_wstring(index + 1);
+        device.driver = L"{4d36e968-e325-11ce-bfc1-08002be10318}\\" + std::to_wstring(10000 + index).substr(1);
+        device.driverProvider = L"NVIDIA";
+        device.driverVersion = L"32.0.15.6094";
+        device.driverDate = L"2024-8-14";
+        devices.push_back(std::move(device));
+    }
+    return devices;
+}
+
+// What every adapter used to do: open the device list, walk it until the description
+// contains the adapter name, then read the remaining properties of that device.
+static inline void probeLegacy(SetupApiProvider& provider, const std::vector<std::wstring>& adapterNames) {
+    for (auto&& adapterName : std::as_const(adapterNames)) {
+        if (!provider.open()) {
+            continue;
+        }
+        std::wstring value{};
+        for (std::uint32_t index = 0; provider.hasDevice(index); ++index) {
+            if (!provider.getProperty(index, device_property_t::DriverDesc, value) || value.find(adapterName) == std::wstring::npos) {
+                continue;
+            }
+            std::ignore = provider.getProperty(index, device_property_t::Driver, value);
+            std::ignore = provider.getProperty(index, device_property_t::DriverProvider, value);
+            std::ignore = provider.getProperty(index, device_property_t::DriverVersion, value);
+            std::ignore = provider.getProperty(index, device_property_t::DriverDate, value);
+            bench::doNotOptimize(value);
+            break;
+        }
+        provider.close();
+    }
+}
+
+static inline void probeTable(SetupApiProvider& provider, const std::vector<std::wstring>& adapterNames) {
+    DeviceTable table{};
+    if (!table.build(provider)) {
+        return;
+    }
+    for (auto&& adapterName : std::as_const(adapterNames)) {
+        const std::optional<DeviceTableRow> row = table.find(adapterName);
+        bench::doNotOptimize(row);
+    }
+}
+
+// The row find() has to pick for exact, case and whitespace different and substring descriptions,
+// identified by the driver key. The first of two identical devices wins, and a device which
+// lacks a driver property is never returned.
+[[nodiscard]] static inline bool verify() {
+    const auto makeDevice = [](const wchar_t* driverDesc, const wchar_t* driver, const wchar_t* driverVersion) {
+        FakeSetupApiProvider::Device device{};
+        device.driverDesc = driverDesc;
+        device.driver = driver;
+        device.driverProvider = L"Vendor";
+        device.driverVersion = driverVersion;
+        device.driverDate = L"2024-8-14";
+        return device;
+    };
+    FakeSetupApiProvider provider{ {
+        makeDevice(L"Microsoft Basic Display Adapter", L"0000", L"10.0.22621.1"),
+        makeDevice(L"NVIDIA GeForce RTX 4090", L"0001", L"32.0.15.6094"),
+        makeDevice(L"NVIDIA GeForce RTX 4090 Laptop GPU", L"0002", L"32.0.15.6094"),
+        makeDevice(L"AMD Radeon RX 7900 XTX", L"0003", L""),
+        makeDevice(L"Intel(R) UHD Graphics 770", L"0004", L"31.0.101.5186"),
+        makeDevice(L"NVIDIA GeForce RTX 4090", L"0005", L"32.0.15.6094"),
+    } };
+    DeviceTable table{};
+    if (!table.build(provider)) {
+        std::fprintf(stderr, "Building the device table failed.\n");
+        return false;
+    }
+    static constexpr const std::pair<const wchar_t*, const wchar_t*> kCases[]{
+        { L"NVIDIA GeForce RTX 4090", L"0001" },
+        { L"nvidia geforce rtx 4090", L"0001" },
+        { L"  NVIDIA\tGeForce  RTX 4090 ", L"0001" },
+        { L"NVIDIA GeForce RTX 4090 Laptop GPU", L"0002" },
+        { L"NVIDIA GEFORCE RTX 4090 LAPTOP GPU", L"0002" },
+        { L"UHD Graphics", L"0004" },
+        { L"uhd graphics 770", L"0004" },
+        { L"Basic Display", L"0000" },
+        { L"AMD Radeon RX 7900 XTX", nullptr },
+        { L"Matrox G200", nullptr },
+        { L"", nullptr },
+    };
+    for (auto&& [description, driver] : kCases) {
+        const std::optional<DeviceTableRow> row = table.find(description);
+        const bool same = driver ? (row && row->driver == driver) : !row;
+        if (!same) {
+            std::fprintf(stderr, "The device table found %ls for \"%ls\", expected %ls.\n", row ? std::wstring(row->driver).c_str() : L"nothing",
+                         description, driver ? driver : L"nothing");
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    if (!verify()) {
+        return 1;
+    }
+    for (const std::size_t adapterCount : { 1, 4, 16, 64 }) {
+        const std::vector<FakeSetupApiProvider::Device> devices = makeDevices(adapterCount);
+        std::vector<std::wstring> adapterNames{};
+        for (std::size_t index = 0; index != adapterCount; ++index) {
+            adapterNames.push_back(devices[index].driverDesc);
+        }
+        FakeSetupApiProvider provider{ devices, kCallLatency };
+        const std::string label = std::to_string(adapterCount) + "adapters";
+
+        provider.resetCallCount();
+        probeLegacy(provider, adapterNames);
+        const std::size_t legacyCalls = provider.callCount();
+        provider.resetCallCount();
+        probeTable(provider, adapterNames);
+        const std::size_t tableCalls = provider.callCount();
+        std::printf("device_table/api_calls/%-32s %14zu legacy %12zu table\n", label.c_str(), legacyCalls, tableCalls);
+
+        bench::run("device_table/legacy_per_adapter/" + label, [&provider, &adapterNames]() {
+            probeLegacy(provider, adapterNames);
+        });
+        bench::run("device_table/single_pass_table/" + label, [&provider, &adapterNames]() {
+            probeTable(provider, adapterNames);
+        });
+    }
+    return 0;
+}
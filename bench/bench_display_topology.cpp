@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "display_config.hpp"
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace gputester;
+
+[[nodiscard]] static inline std::vector<FakeDisplayConfigProvider::Display> makeDisplays(const std::size_t count) {
+    std::vector<FakeDisplayConfigProvider::Display> displays{};
+    for (std::size_t index = 0; index != count; ++index) {
+        FakeDisplayConfigProvider::Display display{};
+        display.gdiDeviceName = L"\\\\.\\DISPLAY" + std::to_wstring(index + 1);
+        display.friendlyName = L"Monitor " + std::to_wstring(index + 1);
+        display.refreshRateNumerator = 144000;
+        display.refreshRateDenominator = 1000;
+        displays.push_back(std::move(display));
+    }
+    return displays;
+}
+
+// What every output used to do: query all active paths, resolve the source name of each
+// of them to find its own, then ask for the white level and the friendly name. Nothing if
+// no active path belongs to the output.
+[[nodiscard]] static inline std::optional<DisplayTopologyEntry> findLegacy(DisplayConfigProvider& provider, const std::wstring& outputName) {
+    std::vector<DisplayConfigPath> paths{};
+    if (!provider.queryActivePaths(paths)) {
+        return std::nullopt;
+    }
+    std::wstring sourceName{};
+    std::erase_if(paths, [&](const DisplayConfigPath& path) -> bool {
+        return !provider.getSourceName(path, sourceName) || sourceName != outputName;
+    });
+    if (paths.empty()) {
+        return std::nullopt;
+    }
+    DisplayTopologyEntry entry{};
+    for (auto&& path : std::as_const(paths)) {
+        std::uint32_t level{ 0 };
+        if (provider.getSdrWhiteLevel(path, level)) {
+            entry.sdrWhiteLevel = static_cast<float>(level) / 1000.f * 80.f;
+            break;
+        }
+    }
+    for (auto&& path : std::as_const(paths)) {
+        if (path.refreshRateNumerator > 0 && path.refreshRateDenominator > 0) {
+            entry.refreshRate = static_cast<float>(path.refreshRateNumerator) / static_cast<float>(path.refreshRateDenominator);
+            break;
+        }
+    }
+    for (auto&& path : std::as_const(paths)) {
+        DisplayConfigTargetName targetName{};
+        if (provider.getTargetName(path, targetName)) {
+            entry.friendlyName = std::move(targetName.friendlyName);
+            break;
+        }
+    }
+    return entry;
+}
+
+static inline void probeLegacy(DisplayConfigProvider& provider, const std::vector<std::wstring>& outputNames) {
+    for (auto&& outputName : std::as_const(outputNames)) {
+        const std::optional<DisplayTopologyEntry> entry = findLegacy(provider, outputName);
+        bench::doNotOptimize(entry);
+    }
+}
+
+static inline void probeTopology(DisplayConfigProvider& provider, const std::vector<std::wstring>& outputNames) {
+    DisplayTopology topology{};
+    if (!topology.build(provider)) {
+        return;
+    }
+    for (auto&& outputName : std::as_const(outputNames)) {
+        const DisplayTopologyEntry* entry = topology.find(outputName);
+        bench::doNotOptimize(entry);
+    }
+}
+
+// Cloned outputs, a path without a refresh rate, distinct white levels and names, and an output
+// which isn't active at all: the topology has to answer exactly like the per output queries.
+[[nodiscard]] static inline bool verify() {
+    std::vector<FakeDisplayConfigProvider::Display> displays = makeDisplays(4);
+    displays[0].sdrWhiteLevel = 2500;
+    displays[1].refreshRateNumerator = 0;
+    displays[1].refreshRateDenominator = 0;
+    FakeDisplayConfigProvider::Display clone = displays[1];
+    clone.friendlyName = L"Cloned monitor";
+    clone.sdrWhiteLevel = 3000;
+    clone.refreshRateNumerator = 59940;
+    clone.refreshRateDenominator = 1000;
+    displays.push_back(std::move(clone));
+    displays[2].friendlyName.clear();
+    std::vector<std::wstring> outputNames{};
+    for (auto&& display : std::as_const(displays)) {
+        outputNames.push_back(display.gdiDeviceName);
+    }
+    outputNames.push_back(L"\\\\.\\DISPLAY99");
+    FakeDisplayConfigProvider provider{ std::move(displays) };
+    DisplayTopology topology{};
+    if (!topology.build(provider)) {
+        std::fprintf(stderr, "Building the display topology failed.\n");
+        return false;
+    }
+    for (auto&& outputName : std::as_const(outputNames)) {
+        const std::optional<DisplayTopologyEntry> expected = findLegacy(provider, outputName);
+        const DisplayTopologyEntry* actual = topology.find(outputName);
+        const bool same = (expected.has_value() == (actual != nullptr))
+                          && (!actual
+                              || (expected->sdrWhiteLevel == actual->sdrWhiteLevel && expected->refreshRate == actual->refreshRate
+                                  && expected->friendlyName == actual->friendlyName));
+        if (!same) {
+            std::fprintf(stderr, "The display topology disagrees with the per output queries for \"%ls\".\n", outputName.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    if (!verify()) {
+        return 1;
+    }
+    for (const std::size_t outputCount : { 1, 16, 64 }) {
+        const std::vector<FakeDisplayConfigProvider::Display> displays = makeDisplays(outputCount);
+        std::vector<std::wstring> outputNames{};
+        for (auto&& display : std::as_const(displays)) {
+            outputNames.push_back(display.gdiDeviceName);
+        }
+        FakeDisplayConfigProvider provider{ displays };
+        const std::string label = std::to_string(outputCount) + "outputs";
+
+        provider.resetCallCount();
+        probeLegacy(provider, outputNames);
+        const std::size_t legacyCalls = provider.callCount();
+        provider.resetCallCount();
+        probeTopology(provider, outputNames);
+        const std::size_t topologyCalls = provider.callCount();
+        std::printf("display_config/api_calls/%-30s %14zu legacy %12zu topology\n", label.c_str(), legacyCalls, topologyCalls);
+
+        bench::run("display_config/legacy_per_output/" + label, [&provider, &outputNames]() {
+            probeLegacy(provider, outputNames);
+        });
+        bench::run("display_config/topology_index/" + label, [&provider, &outputNames]() {
+            probeTopology(provider, outputNames);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "text.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace gputester;
+
+static constexpr const std::u16string_view kValueName{ u"RadeonSoftwareVersion" };
+static constexpr const std::u16string_view kLongName{ u"{4d36e968-e325-11ce-bfc1-08002be10318}\\0000\\UMD\\DXVA\\Properties" };
+
+[[nodiscard]] static inline const char* levelName(const simd_level_t level) {
+    switch (level) {
+        case simd_level_t::Scalar:
+            return "scalar";
+        case simd_level_t::SSE2:
+            return "sse2";
+        case simd_level_t::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+template <typename String>
+[[nodiscard]] static inline String toUpper(const String& str) {
+    String result{ str };
+    for (auto&& ch : result) {
+        ch = foldCase(ch);
+    }
+    return result;
+}
+
+[[nodiscard]] static inline std::vector<std::uint8_t> toUtf16Bytes(const std::u16string_view str) {
+    std::vector<std::uint8_t> result{};
+    for (const char16_t ch : str) {
+        result.push_back(static_cast<std::uint8_t>(ch & 0xFF));
+        result.push_back(static_cast<std::uint8_t>(ch >> 8));
+    }
+    return result;
+}
+
+// The display class of a machine with a few adapters, which DeviceTable::find() falls back to searching.
+[[nodiscard]] static inline std::vector<std::wstring> makeDescriptions() {
+    std::vector<std::wstring> descriptions{ L"Microsoft Basic Display Adapter", L"Microsoft Remote Display Adapter" };
+    for (int index = 1; index <= 6; ++index) {
+        descriptions.push_back(L"NVIDIA GeForce RTX 4090 #" + std::to_wstring(index));
+    }
+    descriptions.push_back(L"Intel(R) UHD Graphics 770");
+    descriptions.push_back(L"AMD Radeon RX 7900 XTX");
+    return descriptions;
+}
+
+// Every level has to agree with the plain per character definition, including the characters
+// around the folded ranges and the ones the vector code compares as negative numbers.
+[[nodiscard]] static inline bool verify() {
+    static constexpr const char16_t kAlphabet[]{ u'a', u'A', u'z', u'Z', u'`', u'{', u'@', u'[', 0xDF, 0xE0, 0xC0, 0xF7, 0xD7, 0xFE, 0xDE, 0xFF, 0x178, 0x100, 0x8061, 0xFFFF };
+    std::mt19937 random{ 42 };
+    std::uniform_int_distribution<std::size_t> pick{ 0, std::size(kAlphabet) - 1 };
+    std::uniform_int_distribution<std::size_t> length{ 0, 40 };
+    const simd_level_t supported = supportedSimdLevel();
+    for (int round = 0; round != 20000; ++round) {
+        std::u16string lhs{};
+        for (std::size_t index = length(random); index != 0; --index) {
+            lhs.push_back(kAlphabet[pick(random)]);
+        }
+        std::u16string rhs{ lhs };
+        if (!rhs.empty() && round % 2 == 0) {
+            rhs[pick(random) % rhs.size()] = kAlphabet[pick(random)];
+        }
+        bool expected = lhs.size() == rhs.size();
+        for (std::size_t index = 0; expected && index != lhs.size(); ++index) {
+            expected = foldCase(lhs[index]) == foldCase(rhs[index]);
+        }
+        std::vector<std::uint8_t> latin1{};
+        bool isLatin1{ true };
+        for (const char16_t ch : lhs) {
+            isLatin1 = isLatin1 && ch <= 0xFF;
+            latin1.push_back(static_cast<std::uint8_t>(ch));
+        }
+        const std::wstring haystack(lhs.begin(), lhs.end());
+        const std::wstring needle(rhs.begin() + static_cast<std::ptrdiff_t>(rhs.size() / 2), rhs.end());
+        std::size_t expectedPosition = std::wstring::npos;
+        for (std::size_t index = 0; expectedPosition == std::wstring::npos && index + needle.size() <= haystack.size(); ++index) {
+            if (toUpper(haystack.substr(index, needle.size())) == toUpper(needle)) {
+                expectedPosition = index;
+            }
+        }
+        for (auto level = simd_level_t::Scalar; level <= supported; level = static_cast<simd_level_t>(static_cast<int>(level) + 1)) {
+            setSimdLevel(level);
+            const std::vector<std::uint8_t> utf16 = toUtf16Bytes(lhs);
+            if (equalsIgnoringCase(lhs, rhs) != expected || equalsIgnoringCase(std::wstring(lhs.begin(), lhs.end()), std::wstring(rhs.begin(), rhs.end())) != expected
+                || equalsIgnoringCaseUtf16(utf16, rhs) != expected || (isLatin1 && equalsIgnoringCaseLatin1(latin1, rhs) != expected)
+                || findIgnoringCase(haystack, needle) != expectedPosition) {
+                std::fprintf(stderr, "The %s compare disagrees with foldCase() in round %d.\n", levelName(level), round);
+                return false;
+            }
+        }
+    }
+    setSimdLevel(supported);
+    return true;
+}
+
+int main() {
+    if (!verify()) {
+        return 1;
+    }
+    const std::u16string upperValueName = toUpper(std::u16string(kValueName));
+    const std::u16string upperLongName = toUpper(std::u16string(kLongName));
+    const std::vector<std::uint8_t> latin1ValueName(kValueName.begin(), kValueName.end());
+    const std::vector<std::uint8_t> utf16LongName = toUtf16Bytes(kLongName);
+    const std::vector<std::wstring> descriptions = makeDescriptions();
+    const std::wstring adapterName{ L"AMD Radeon RX 7900 XTX" };
+    bench::run("fold_case/find/std_wstring_find", [&descriptions, &adapterName]() {
+        for (auto&& description : descriptions) {
+            const std::size_t position = description.find(adapterName);
+            bench::doNotOptimize(position);
+        }
+    });
+    const simd_level_t supported = supportedSimdLevel();
+    for (auto level = simd_level_t::Scalar; level <= supported; level = static_cast<simd_level_t>(static_cast<int>(level) + 1)) {
+        setSimdLevel(level);
+        const std::string suffix = levelName(level);
+        bench::run("fold_case/equals/value_name/" + suffix, [&upperValueName]() {
+            const bool equal = equalsIgnoringCase(kValueName, upperValueName);
+            bench::doNotOptimize(equal);
+        });
+        bench::run("fold_case/equals/long_name/" + suffix, [&upperLongName]() {
+            const bool equal = equalsIgnoringCase(kLongName, upperLongName);
+            bench::doNotOptimize(equal);
+        });
+        bench::run("fold_case/equals/hive_latin1/" + suffix, [&latin1ValueName, &upperValueName]() {
+            const bool equal = equalsIgnoringCaseLatin1(latin1ValueName, upperValueName);
+            bench::doNotOptimize(equal);
+        });
+        bench::run("fold_case/equals/hive_utf16/" + suffix, [&utf16LongName, &upperLongName]() {
+            const bool equal = equalsIgnoringCaseUtf16(utf16LongName, upperLongName);
+            bench::doNotOptimize(equal);
+        });
+        bench::run("fold_case/find/" + suffix, [&descriptions, &adapterName]() {
+            for (auto&& description : descriptions) {
+                const std::size_t position = findIgnoringCase(description, adapterName);
+                bench::doNotOptimize(position);
+            }
+        });
+    }
+    setSimdLevel(supported);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "gputester.h"
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <iostream>
+#include <tuple>
+
+// Where CMake put the command line tool, see CMakeLists.txt.
+#ifndef GPUTESTER_EXECUTABLE
+#  error "GPUTESTER_EXECUTABLE must be defined."
+#endif
+
+extern char** environ;
+
+// What an agent without the library does on every poll: run the tool and wait for its JSON.
+[[nodiscard]] static inline bool runExecutable() {
+    posix_spawn_file_actions_t actions{};
+    ::posix_spawn_file_actions_init(&actions);
+    ::posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    char executable[]{ GPUTESTER_EXECUTABLE };
+    char format[]{ "--format=json" };
+    char noCache[]{ "--no-cache" };
+    char* arguments[]{ executable, format, noCache, nullptr };
+    pid_t pid{ 0 };
+    const int result = ::posix_spawn(&pid, executable, &actions, nullptr, arguments, environ);
+    ::posix_spawn_file_actions_destroy(&actions);
+    if (result != 0) {
+        return false;
+    }
+    int status{ 0 };
+    return (::waitpid(pid, &status, 0) == pid) && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+[[nodiscard]] static inline bool probeJson(gputester_context* context) {
+    gputester_report* report{ nullptr };
+    if (gputester_probe(context, &report) != GPUTESTER_OK) {
+        return false;
+    }
+    const uint8_t* data{ nullptr };
+    size_t size{ 0 };
+    const bool succeeded = gputester_report_get_buffer(report, GPUTESTER_FORMAT_JSON, &data, &size) == GPUTESTER_OK;
+    gputester::bench::doNotOptimize(data);
+    gputester_report_free(report);
+    return succeeded;
+}
+
+int main() {
+    if (!runExecutable()) {
+        std::wcerr << L"Failed to run the command line tool." << std::endl;
+        return 1;
+    }
+    gputester::bench::run("library/spawn_executable", []() {
+        std::ignore = runExecutable();
+    });
+    gputester::bench::run("library/cold_context", []() {
+        gputester_context* context{ nullptr };
+        if (gputester_context_create(nullptr, &context) == GPUTESTER_OK) {
+            std::ignore = probeJson(context);
+            gputester_context_destroy(context);
+        }
+    });
+    gputester_context* context{ nullptr };
+    if ((gputester_context_create(nullptr, &context) != GPUTESTER_OK) || !probeJson(context)) {
+        std::wcerr << L"Failed to probe through libgputester." << std::endl;
+        return 1;
+    }
+    gputester::bench::run("library/warm_context", [context]() {
+        std::ignore = probeJson(context);
+    });
+    gputester_context_destroy(context);
+    return 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "backend.hpp"
+#include "report.hpp"
+#include "thread_pool.hpp"
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+using namespace gputester;
+
+int main() {
+    ThreadPool pool{};
+    std::printf("parallel_probe: %zu pool threads, %u hardware threads\n", pool.threadCount(), std::thread::hardware_concurrency());
+    for (const std::size_t adapterCount : { 1, 2, 4, 8, 16, 32 }) {
+        bench::BlockingBackend backend{ createFixtureBackend(bench::makeReport(adapterCount, 2).adapters) };
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        bench::run("parallel_probe/sequential/" + label, [&backend]() {
+            GpuReport report{};
+            std::ignore = probe(backend, report);
+            bench::doNotOptimize(report);
+        });
+        bench::run("parallel_probe/thread_pool/" + label, [&backend, &pool]() {
+            ProbeOptions options{};
+            options.pool = &pool;
+            GpuReport report{};
+            std::ignore = probe(backend, report, options);
+            bench::doNotOptimize(report);
+        });
+    }
+    return 0;
+}
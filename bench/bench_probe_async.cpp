@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "probe_async.hpp"
+#include "report.hpp"
+#include "task.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <cstdio>
+#include <latch>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace gputester;
+
+// What an agent hosting other collectors does: awaits the report and moves on.
+static DetachedTask collect(const backend_ptr_t backend, const ProbeOptions options, std::atomic<std::size_t>& adapterCount, std::latch& done) {
+    const std::optional<GpuReport> report = co_await probeAsync(backend, options);
+    if (report) {
+        adapterCount += report->adapters.size();
+    }
+    done.count_down();
+}
+
+int main() {
+    ThreadPool pool{};
+    ThreadPool largePool{ 16 };
+    const backend_ptr_t backend = std::make_shared<bench::BlockingBackend>(createFixtureBackend(bench::makeReport(4, 2).adapters));
+    {
+        ProbeOptions options{};
+        options.pool = &pool;
+        bench::run("probe_async/single/sync", [&backend, &options]() {
+            GpuReport report{};
+            std::ignore = probe(*backend, report, options);
+            bench::doNotOptimize(report);
+        });
+        bench::run("probe_async/single/async", [&backend, &options]() {
+            const std::optional<GpuReport> report = syncWait(probeAsync(backend, options));
+            bench::doNotOptimize(report);
+        });
+    }
+    // Many collectors probing at once: a thread each, or tasks sharing the pool.
+    for (const std::size_t probeCount : { 16, 64 }) {
+        const std::string label = std::to_string(probeCount) + "probes";
+        bench::run("probe_async/concurrent/thread_per_probe/" + label, [&backend, probeCount]() {
+            std::vector<std::thread> threads{};
+            threads.reserve(probeCount);
+            for (std::size_t index = 0; index != probeCount; ++index) {
+                threads.emplace_back([&backend]() {
+                    GpuReport report{};
+                    std::ignore = probe(*backend, report);
+                    bench::doNotOptimize(report);
+                });
+            }
+            for (auto&& thread : threads) {
+                thread.join();
+            }
+        });
+        // The blocking calls run on the helper threads while their probes are suspended, so the pool
+        // only runs the short stretches in between and its size hardly matters.
+        for (ThreadPool* const taskPool : { &pool, &largePool }) {
+            bench::run("probe_async/concurrent/tasks_on_" + std::to_string(taskPool->threadCount()) + "_threads/" + label, [&backend, taskPool, probeCount]() {
+                ProbeOptions options{};
+                options.pool = taskPool;
+                std::atomic<std::size_t> adapterCount{ 0 };
+                std::latch done{ static_cast<std::ptrdiff_t>(probeCount) };
+                for (std::size_t index = 0; index != probeCount; ++index) {
+                    collect(backend, options, adapterCount, done);
+                }
+                done.wait();
+                bench::doNotOptimize(adapterCount);
+            });
+        }
+    }
+    return 0;
+}
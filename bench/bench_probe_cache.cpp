@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "probe_cache.hpp"
+#include "probe_graph.hpp"
+#include "thread_pool.hpp"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <tuple>
+
+using namespace gputester;
+
+// What one run of the CLI does, minus the formatting: load the cache, probe, save the cache.
+static inline void startup(const backend_ptr_t& backend, const std::filesystem::path& cachePath, const ProbeOptions& options) {
+    ProbeGraph graph{ backend };
+    std::ignore = loadProbeCache(cachePath, graph);
+    GpuReport report{};
+    std::ignore = graph.update(report, options);
+    std::ignore = saveProbeCache(cachePath, graph);
+    bench::doNotOptimize(report);
+}
+
+int main() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gputester_bench_probe_cache";
+    const std::filesystem::path cachePath = directory / "probe-cache.bin";
+    ThreadPool pool{};
+    ProbeOptions options{};
+    options.pool = &pool;
+    for (const std::size_t adapterCount : { 1, 4, 16 }) {
+        const backend_ptr_t backend = std::make_shared<bench::BlockingBackend>(createFixtureBackend(bench::makeReport(adapterCount, 2).adapters));
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        bench::run("probe_cache/cold/" + label, [&backend, &cachePath, &options]() {
+            std::error_code error{};
+            std::filesystem::remove(cachePath, error);
+            startup(backend, cachePath, options);
+        });
+        startup(backend, cachePath, options);
+        bench::run("probe_cache/warm/" + label, [&backend, &cachePath, &options]() {
+            startup(backend, cachePath, options);
+        });
+    }
+    std::error_code error{};
+    std::filesystem::remove_all(directory, error);
+    return 0;
+}
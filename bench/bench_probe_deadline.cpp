@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "stalling_backend.hpp"
+#include "report.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+using namespace gputester;
+
+static constexpr const std::chrono::milliseconds kStall{ 2000 };
+static constexpr const std::chrono::milliseconds kTimeout{ 50 };
+
+int main() {
+    ThreadPool pool{};
+    // What the deadline costs when nothing hangs: every probe hops to a helper thread.
+    for (const std::size_t adapterCount : { 1, 4, 16 }) {
+        const backend_ptr_t backend = std::make_shared<bench::BlockingBackend>(createFixtureBackend(bench::makeReport(adapterCount, 2).adapters));
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        for (const bool deadline : { false, true }) {
+            ProbeOptions options{};
+            options.pool = &pool;
+            options.timeout = deadline ? std::chrono::nanoseconds{ kTimeout } : std::chrono::nanoseconds{ 0 };
+            bench::run(std::string{ deadline ? "probe_deadline/timeout/" : "probe_deadline/no_timeout/" } + label, [&backend, &options]() {
+                GpuReport report{};
+                std::ignore = probe(*backend, report, options);
+                bench::doNotOptimize(report);
+            });
+        }
+    }
+    // One adapter's driver query hangs: the report must come back after about one timeout, not the stall.
+    // An abandoned call blocks the next enumeration, so this is timed once instead of in batches.
+    const auto backend = std::make_shared<bench::StallingBackend>(createFixtureBackend(bench::makeReport(16, 2).adapters));
+    backend->stall(probe_node_t::DriverInfo, kStall, 3);
+    ProbeOptions options{};
+    options.pool = &pool;
+    options.timeout = kTimeout;
+    GpuReport report{};
+    const auto begin = std::chrono::steady_clock::now();
+    const bool succeeded = probe(*backend, report, options);
+    const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+    std::printf("%-56s %14.1f ms (stall %lld ms, timeout %lld ms)\n", "probe_deadline/stalled_driver/16adapters", elapsed,
+                static_cast<long long>(kStall.count()), static_cast<long long>(kTimeout.count()));
+    backend->release();
+    if (!succeeded || (report.adapters.size() != 16)) {
+        std::fprintf(stderr, "The stalled probe failed the whole report.\n");
+        return 1;
+    }
+    for (auto&& adapterInfo : std::as_const(report.adapters)) {
+        const probe_status_t status = adapterInfo.probes[static_cast<std::size_t>(probe_node_t::DriverInfo)].status;
+        const bool stalled = adapterInfo.desc.index == 3;
+        if ((status == probe_status_t::TimedOut) != stalled || (adapterInfo.driver.has_value() == stalled)) {
+            std::fprintf(stderr, "Adapter #%u has the wrong driver status.\n", adapterInfo.desc.index);
+            return 1;
+        }
+    }
+    while (backend->abandonedProbeCount() != 0) {
+        std::this_thread::yield();
+    }
+    return 0;
+}
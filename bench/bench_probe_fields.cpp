@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "query.hpp"
+#include "report.hpp"
+#include "thread_pool.hpp"
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace gputester;
+
+// What a scheduler polling driver versions asks for, next to the full report.
+static constexpr const std::string_view kFieldSets[][3]{
+    { "", "", "" }, // The empty query selects the whole report.
+    { "adapters[*].vendorId", "adapters[*].deviceId", "adapters[*].driver.version" },
+    { "adapters[*].outputs[*].deviceName", "adapters[*].outputs[*].attachedToDesktop", "adapters[*].outputs[*].currentRefreshRate" },
+};
+static constexpr const std::string_view kFieldSetNames[]{ "all", "driver_versions", "refresh_rates" };
+
+int main() {
+    ThreadPool pool{};
+    for (const std::size_t adapterCount : { 1, 4, 16 }) {
+        bench::BlockingBackend backend{ createFixtureBackend(bench::makeReport(adapterCount, 2).adapters) };
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        for (std::size_t set = 0; set != std::size(kFieldSets); ++set) {
+            ProbeOptions options{};
+            options.pool = &pool;
+            options.nodes = 0;
+            std::vector<QuerySegment> segments{};
+            for (const std::string_view field : kFieldSets[set]) {
+                std::ignore = parseQuery(field, segments);
+                options.nodes |= getQueryProbeNodes(segments);
+            }
+            bench::run("probe_fields/" + std::string{ kFieldSetNames[set] } + '/' + label, [&backend, &options]() {
+                GpuReport report{};
+                std::ignore = probe(backend, report, options);
+                bench::doNotOptimize(report);
+            });
+        }
+    }
+    return 0;
+}
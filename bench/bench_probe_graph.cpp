@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "probe_graph.hpp"
+#include "report.hpp"
+#include "thread_pool.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <tuple>
+
+using namespace gputester;
+
+int main() {
+    ThreadPool pool{};
+    ProbeOptions options{};
+    options.pool = &pool;
+    for (const std::size_t adapterCount : { 1, 2, 4, 8, 16, 32 }) {
+        const auto backend = std::make_shared<bench::BlockingBackend>(createFixtureBackend(bench::makeReport(adapterCount, 2).adapters));
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        bench::run("probe_graph/full_probe/" + label, [&backend, &options]() {
+            GpuReport report{};
+            std::ignore = probe(*backend, report, options);
+            bench::doNotOptimize(report);
+        });
+        ProbeGraph graph{ backend };
+        GpuReport report{};
+        std::ignore = graph.update(report, options);
+        bench::run("probe_graph/unchanged/" + label, [&graph, &options]() {
+            GpuReport report{};
+            std::ignore = graph.update(report, options);
+            bench::doNotOptimize(report);
+        });
+        bench::run("probe_graph/path_changed/" + label, [&backend, &graph, &options]() {
+            backend->changePathState();
+            GpuReport report{};
+            std::ignore = graph.update(report, options);
+            bench::doNotOptimize(report);
+        });
+        const ProbeGraphStatistics& statistics = graph.statistics();
+        std::printf("probe_graph/path_changed/%s: %zu path probes evaluated, %zu mode probes reused\n", label.c_str(),
+                    statistics.evaluated[static_cast<std::size_t>(probe_node_t::PathInfo)],
+                    statistics.reused[static_cast<std::size_t>(probe_node_t::ModeInfo)]);
+    }
+    return 0;
+}
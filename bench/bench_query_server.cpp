@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "report_fixture.hpp"
+#include "format.hpp"
+#include "query.hpp"
+#include "query_server.hpp"
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+using namespace gputester;
+
+static constexpr const std::string_view kQuery{ "adapters[*].driver.version" };
+
+[[nodiscard]] static inline int connectTo(const std::filesystem::path& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    const std::string path = socketPath.string();
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends "queryCount" queries in one write and reads until every answer line is in.
+static inline void roundTrip(const int fd, const std::string& queries, const std::size_t queryCount, std::string& answers) {
+    std::ignore = ::send(fd, queries.data(), queries.size(), MSG_NOSIGNAL);
+    answers.clear();
+    std::size_t lines{ 0 };
+    char buffer[65536]{};
+    while (lines != queryCount) {
+        const ssize_t size = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (size <= 0) {
+            return;
+        }
+        answers.append(buffer, static_cast<std::size_t>(size));
+        lines += static_cast<std::size_t>(std::count(buffer, buffer + size, '\n'));
+    }
+}
+
+int main() {
+    const std::filesystem::path socketPath = std::filesystem::temp_directory_path() / "gputester_bench_query.sock";
+    for (const std::size_t adapterCount : { 1, 4, 16 }) {
+        const GpuReport report = bench::makeReport(adapterCount, 2);
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        std::string json{};
+        formatJson(report, json);
+        std::vector<QuerySegment> segments{};
+        std::string result{};
+        bench::run("query/evaluate/" + label, [&json, &segments, &result]() {
+            result.clear();
+            std::ignore = parseQuery(kQuery, segments);
+            std::ignore = evaluateQuery(json, segments, result);
+            bench::doNotOptimize(result);
+        });
+        QueryServer server{};
+        server.setReport(report);
+        if (!server.start(socketPath)) {
+            return 1;
+        }
+        const int fd = connectTo(socketPath);
+        if (fd < 0) {
+            std::wcerr << L"Failed to connect to the query server." << std::endl;
+            return 1;
+        }
+        std::string answers{};
+        for (const std::size_t batchSize : { 1, 64 }) {
+            std::string queries{};
+            for (std::size_t index = 0; index != batchSize; ++index) {
+                queries.append(kQuery);
+                queries.push_back('\n');
+            }
+            bench::run("query/round_trip/" + label + "/batch" + std::to_string(batchSize), [fd, &queries, batchSize, &answers]() {
+                roundTrip(fd, queries, batchSize, answers);
+                bench::doNotOptimize(answers);
+            });
+        }
+        ::close(fd);
+        server.stop();
+    }
+    return 0;
+}
@@ -0,0 +1,247 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "hive_builder.hpp"
+#include "device_table.hpp"
+#include "driver_info.hpp"
+#include "registry_hive.hpp"
+#include "registry_memory.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <utility>
+
+using namespace gputester;
+
+static constexpr const std::wstring_view kDisplayClassGuid{ L"{4d36e968-e325-11ce-bfc1-08002be10318}" };
+static constexpr const std::wstring_view kAmdAdapterName{ L"AMD Radeon RX 7900 XTX" };
+
+// A SYSTEM hive shaped like a real one where it matters: the display class next to "classCount" other
+// device classes with a few driver instances each. The first of the display adapters is made by AMD.
+[[nodiscard]] static inline bench::HiveKeyFixture makeSystemHive(const std::size_t adapterCount, const std::size_t classCount) {
+    bench::HiveKeyFixture displayClass{ std::wstring(kDisplayClassGuid) };
+    displayClass.addSubKey(L"Properties");
+    for (std::size_t index = 0; index != adapterCount; ++index) {
+        bench::HiveKeyFixture& device = displayClass.addSubKey(std::to_wstring(10000 + index).substr(1));
+        if (index == 0) {
+            device.addString(L"DriverDesc", kAmdAdapterName);
+            device.addString(L"ProviderName", L"Advanced Micro Devices, Inc.");
+            device.addString(L"DriverVersion", L"31.0.24033.1003");
+            device.addString(L"DriverDate", L"8-14-2024");
+            device.addString(L"RadeonSoftwareEdition", L"Adrenalin");
+            device.addString(L"RadeonSoftwareVersion", L"24.8.1");
+        } else {
+            device.addString(L"DriverDesc", L"NVIDIA GeForce RTX 4090 #" + std::to_wstring(index));
+            device.addString(L"ProviderName", L"NVIDIA");
+            device.addString(L"DriverVersion", L"32.0.15.6094");
+            device.addString(L"DriverDate", L"8-14-2024");
+        }
+        device.addDword(L"FeatureScore", 0xF8);
+    }
+    bench::HiveKeyFixture classKey{ L"Class" };
+    classKey.subKeys.push_back(std::move(displayClass));
+    for (std::size_t index = 0; index != classCount; ++index) {
+        wchar_t guid[39]{};
+        std::swprintf(guid, std::size(guid), L"{%08zx-e325-11ce-bfc1-08002be10318}", 0x4d36e000 + index * 0x10 + 1);
+        bench::HiveKeyFixture& deviceClass = classKey.addSubKey(guid);
+        deviceClass.addString(L"Class", L"Device class " + std::to_wstring(index));
+        for (std::size_t instance = 0; instance != 4; ++instance) {
+            deviceClass.addSubKey(std::to_wstring(10000 + instance).substr(1)).addString(L"DriverDesc", L"Device " + std::to_wstring(instance));
+        }
+    }
+    bench::HiveKeyFixture control{ L"Control" };
+    control.subKeys.push_back(std::move(classKey));
+    bench::HiveKeyFixture controlSet{ L"ControlSet001" };
+    controlSet.subKeys.push_back(std::move(control));
+    bench::HiveKeyFixture root{ L"ROOT" };
+    root.subKeys.push_back(std::move(controlSet));
+    root.addSubKey(L"Select").addDword(L"Current", 1);
+    return root;
+}
+
+// The same content in a memory registry, the way a cache in front of the registry would hold it.
+// Only has the value types makeSystemHive() uses.
+static inline void fillMemoryRegistry(const bench::HiveKeyFixture& fixture, m4x1m1l14n::Registry::RegistryKey& key) {
+    for (auto&& value : std::as_const(fixture.values)) {
+        if (value.type == 1) { // REG_SZ
+            std::wstring string{};
+            for (std::size_t offset = 0; offset + 3 < value.data.size(); offset += 2) {
+                string.push_back(static_cast<wchar_t>(static_cast<std::uint8_t>(value.data[offset]) | (static_cast<std::uint8_t>(value.data[offset + 1]) << 8)));
+            }
+            key.SetString(value.name, string);
+        } else if (value.type == 4) { // REG_DWORD
+            std::uint32_t number{ 0 };
+            for (std::size_t index = 0; index != 4; ++index) {
+                number |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(value.data[index])) << (index * 8);
+            }
+            key.SetUInt32(value.name, number);
+        }
+    }
+    for (auto&& subKey : std::as_const(fixture.subKeys)) {
+        fillMemoryRegistry(subKey, *key.Create(subKey.name));
+    }
+}
+
+// There is no "CurrentControlSet" link in memory, the control set is copied under that name too.
+[[nodiscard]] static inline m4x1m1l14n::Registry::RegistryKey_ptr createMemorySystem(const bench::HiveKeyFixture& root) {
+    const m4x1m1l14n::Registry::RegistryKey_ptr system = createMemoryRegistry();
+    fillMemoryRegistry(root, *system);
+    for (auto&& subKey : std::as_const(root.subKeys)) {
+        if (subKey.name == L"ControlSet001") {
+            fillMemoryRegistry(subKey, *system->Create(L"CurrentControlSet"));
+        }
+    }
+    return system;
+}
+
+[[nodiscard]] static inline bool readDriverInfo(const m4x1m1l14n::Registry::RegistryKey_ptr& system, const std::wstring& adapterName, DriverInfo& infoOut) {
+    const setupapi_provider_ptr_t provider = createRegistrySetupApiProvider(system);
+    DeviceTable table{};
+    if (!table.build(*provider)) {
+        return false;
+    }
+    return getDriverInfo(table, adapterName, system, infoOut);
+}
+
+// What bulk processing does for every collected hive.
+[[nodiscard]] static inline bool readDriverInfo(const std::filesystem::path& path, const std::wstring& adapterName, DriverInfo& infoOut) {
+    const m4x1m1l14n::Registry::RegistryKey_ptr system = openRegistryHive(path);
+    return system && readDriverInfo(system, adapterName, infoOut);
+}
+
+// Lists the display drivers of real hives, e.g. ones collected from crash reports.
+[[nodiscard]] static inline int runOnHives(const int count, char** paths) {
+    for (int index = 0; index != count; ++index) {
+        const m4x1m1l14n::Registry::RegistryKey_ptr system = openRegistryHive(paths[index]);
+        const setupapi_provider_ptr_t provider = createRegistrySetupApiProvider(system);
+        DeviceTable table{};
+        if (!provider || !table.build(*provider)) {
+            return 1;
+        }
+        for (std::uint32_t device = 0; provider->hasDevice(device); ++device) {
+            std::wstring description{};
+            DriverInfo info{};
+            if (provider->getProperty(device, device_property_t::DriverDesc, description) && getDriverInfo(table, description, system, info)) {
+                std::wcout << paths[index] << L": " << description << L", " << info.provider << L' ' << info.version << L' ' << info.date << std::endl;
+            }
+        }
+    }
+    bench::run("registry_hive/driver_info/custom", [count, paths]() {
+        for (int index = 0; index != count; ++index) {
+            DriverInfo info{};
+            std::ignore = readDriverInfo(paths[index], std::wstring(kAmdAdapterName), info);
+            bench::doNotOptimize(info);
+        }
+    });
+    return 0;
+}
+
+// Usage: bench_registry_hive [SYSTEM hive...], without an argument it runs against generated hives.
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        return runOnHives(argc - 1, argv + 1);
+    }
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "gputester_bench_SYSTEM";
+    const std::filesystem::path indexPath = std::filesystem::temp_directory_path() / "gputester_bench_SYSTEM.index";
+    for (const auto& [adapterCount, classCount] : { std::pair<std::size_t, std::size_t>{ 1, 96 }, { 4, 96 }, { 16, 1024 }, { 16, 4096 } }) {
+        const std::string label = std::to_string(adapterCount) + "adapters_" + std::to_string(classCount) + "classes";
+        const bench::HiveKeyFixture fixture = makeSystemHive(adapterCount, classCount);
+        {
+            const std::string hive = bench::buildHive(fixture);
+            std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+            file.write(hive.data(), static_cast<std::streamsize>(hive.size()));
+            std::printf("%-56s %14zu bytes\n", ("registry_hive/size/" + label).c_str(), hive.size());
+        }
+        DriverInfo info{};
+        if (!readDriverInfo(path, std::wstring(kAmdAdapterName), info) || info.version != L"Adrenalin 24.8.1" || info.date != L"2024-8-14") {
+            std::wcerr << L"The AMD driver version wasn't read from the hive." << std::endl;
+            return 1;
+        }
+        std::filesystem::remove(indexPath);
+        const m4x1m1l14n::Registry::RegistryKey_ptr system = openRegistryHive(path);
+        const m4x1m1l14n::Registry::RegistryKey_ptr indexedSystem = openRegistryHive(path, indexPath);
+        std::printf("%-56s %14ju bytes\n", ("registry_hive/index_size/" + label).c_str(), static_cast<std::uintmax_t>(std::filesystem::file_size(indexPath)));
+        const std::wstring driverKeyPath = L"CurrentControlSet\\Control\\Class\\" + std::wstring(kDisplayClassGuid) + L"\\0000";
+        bench::run("registry_hive/open_hive/" + label, [&path]() {
+            const m4x1m1l14n::Registry::RegistryKey_ptr root = openRegistryHive(path);
+            bench::doNotOptimize(root);
+        });
+        if (indexedSystem->Open(driverKeyPath)->GetString(L"RadeonSoftwareVersion") != L"24.8.1") {
+            std::wcerr << L"The indexed lookup didn't find the AMD driver key." << std::endl;
+            return 1;
+        }
+        bench::run("registry_hive/open_hive_indexed/build/" + label, [&path]() {
+            const m4x1m1l14n::Registry::RegistryKey_ptr root = openRegistryHive(path, {});
+            bench::doNotOptimize(root);
+        });
+        bench::run("registry_hive/open_hive_indexed/load/" + label, [&path, &indexPath]() {
+            const m4x1m1l14n::Registry::RegistryKey_ptr root = openRegistryHive(path, indexPath);
+            bench::doNotOptimize(root);
+        });
+        // The linear walk scans the lf/lh list of every path component for a matching hint, the index hashes the
+        // whole path once and then only checks the parent links of the candidate.
+        bench::run("registry_hive/open_driver_key/linear/" + label, [&system, &driverKeyPath]() {
+            const m4x1m1l14n::Registry::RegistryKey_ptr key = system->Open(driverKeyPath);
+            bench::doNotOptimize(key);
+        });
+        bench::run("registry_hive/open_driver_key/indexed/" + label, [&indexedSystem, &driverKeyPath]() {
+            const m4x1m1l14n::Registry::RegistryKey_ptr key = indexedSystem->Open(driverKeyPath);
+            bench::doNotOptimize(key);
+        });
+        bench::run("registry_hive/driver_info/" + label, [&path]() {
+            DriverInfo result{};
+            std::ignore = readDriverInfo(path, std::wstring(kAmdAdapterName), result);
+            bench::doNotOptimize(result);
+        });
+        const m4x1m1l14n::Registry::RegistryKey_ptr memorySystem = createMemorySystem(fixture);
+        DriverInfo memoryInfo{};
+        if (!readDriverInfo(memorySystem, std::wstring(kAmdAdapterName), memoryInfo) || memoryInfo.version != info.version || memoryInfo.date != info.date) {
+            std::wcerr << L"The memory registry doesn't match the hive." << std::endl;
+            return 1;
+        }
+        bench::run("registry_memory/fill/" + label, [&fixture]() {
+            const m4x1m1l14n::Registry::RegistryKey_ptr root = createMemorySystem(fixture);
+            bench::doNotOptimize(root);
+        });
+        bench::run("registry_memory/open_driver_key/" + label, [&memorySystem, &driverKeyPath]() {
+            const m4x1m1l14n::Registry::RegistryKey_ptr key = memorySystem->Open(driverKeyPath);
+            bench::doNotOptimize(key);
+        });
+        bench::run("registry_memory/driver_info/" + label, [&memorySystem]() {
+            DriverInfo result{};
+            std::ignore = readDriverInfo(memorySystem, std::wstring(kAmdAdapterName), result);
+            bench::doNotOptimize(result);
+        });
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(indexPath);
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "blocking_backend.hpp"
+#include "report_fixture.hpp"
+#include "binary_report.hpp"
+#include "report.hpp"
+#include "shared_snapshot.hpp"
+#include "thread_pool.hpp"
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+
+using namespace gputester;
+
+static constexpr const std::string_view kBenchSnapshotName{ "gputester-bench-snapshot" };
+
+int main() {
+    for (const std::size_t adapterCount : { 1, 4, 16 }) {
+        const GpuReport report = bench::makeReport(adapterCount, 2);
+        std::string snapshot{};
+        encodeBinaryReport(report, snapshot);
+        SharedSnapshotPublisher publisher{};
+        SharedSnapshotReader reader{};
+        if (!publisher.open(kBenchSnapshotName) || !publisher.publish(snapshot) || !reader.open(kBenchSnapshotName)) {
+            std::wcerr << L"Failed to set up the shared snapshot." << std::endl;
+            return 1;
+        }
+        const std::string label = std::to_string(adapterCount) + "adapters";
+        std::string buffer{};
+        bench::run("shared_snapshot/read/" + label, [&reader, &buffer]() {
+            std::ignore = reader.read(buffer);
+            bench::doNotOptimize(buffer);
+        });
+        bench::run("shared_snapshot/read_decode/" + label, [&reader, &buffer]() {
+            std::ignore = reader.read(buffer);
+            GpuReport decoded{};
+            BinaryReportView::open(reinterpret_cast<const std::uint8_t*>(buffer.data()), buffer.size())->decode(decoded);
+            bench::doNotOptimize(decoded);
+        });
+        // A publisher rewriting the snapshot all the time is the worst case for the readers' retries.
+        std::atomic_bool stop{ false };
+        std::thread writer{ [&publisher, &snapshot, &stop]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::ignore = publisher.publish(snapshot);
+                std::this_thread::yield();
+            }
+        } };
+        bench::run("shared_snapshot/read_contended/" + label, [&reader, &buffer]() {
+            std::ignore = reader.read(buffer);
+            bench::doNotOptimize(buffer);
+        });
+        stop.store(true, std::memory_order_relaxed);
+        writer.join();
+        // What the reader saves: probing the same machine, even in parallel.
+        ThreadPool pool{};
+        ProbeOptions options{};
+        options.pool = &pool;
+        bench::BlockingBackend backend{ createFixtureBackend(report.adapters) };
+        bench::run("shared_snapshot/probe/" + label, [&backend, &options]() {
+            GpuReport probed{};
+            std::ignore = probe(backend, probed, options);
+            bench::doNotOptimize(probed);
+        });
+    }
+    return 0;
+}
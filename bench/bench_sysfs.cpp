@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "sysfs_fixture.hpp"
+#include "backend.hpp"
+#include <filesystem>
+#include <tuple>
+#include <utility>
+
+using namespace gputester;
+
+// Enumerates everything the sysfs backend knows about, the same sequence the CLI runs.
+static inline void probeAll(Backend& backend) {
+    std::vector<AdapterDesc> adapters{};
+    std::ignore = backend.enumerateAdapters(adapters);
+    for (auto&& adapter : std::as_const(adapters)) {
+        DriverInfo driverInfo{};
+        std::ignore = backend.getDriverInfo(adapter, driverInfo);
+        std::vector<OutputDesc> outputs{};
+        std::ignore = backend.enumerateOutputs(adapter, outputs);
+        for (auto&& output : std::as_const(outputs)) {
+            ModeInfo modeInfo{};
+            ColorInfo colorInfo{};
+            PathInfo pathInfo{};
+            std::uint32_t dpi{ 0 };
+            std::ignore = backend.getModeInfo(output, modeInfo);
+            std::ignore = backend.getColorInfo(output, colorInfo);
+            std::ignore = backend.getPathInfo(output, pathInfo);
+            std::ignore = backend.getDpi(output, dpi);
+            bench::doNotOptimize(dpi);
+        }
+    }
+    bench::doNotOptimize(adapters);
+}
+
+static inline void runBenchmarks(const std::string& label, const std::string& root) {
+    const backend_ptr_t backend = createSysfsBackend(root);
+    bench::run("sysfs/enumerate_adapters/" + label, [&backend]() {
+        std::vector<AdapterDesc> adapters{};
+        std::ignore = backend->enumerateAdapters(adapters);
+        bench::doNotOptimize(adapters);
+    });
+    bench::run("sysfs/probe_all/" + label, [&backend]() {
+        probeAll(*backend);
+    });
+}
+
+// Usage: bench_sysfs [sysfs root], without an argument it runs against generated fixture trees.
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        runBenchmarks("custom", argv[1]);
+        return 0;
+    }
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gputester_bench_sysfs";
+    for (const std::size_t gpuCount : { 1, 4, 16, 32 }) {
+        bench::SysfsFixtureOptions options{};
+        options.gpuCount = gpuCount;
+        const std::filesystem::path root = bench::createSysfsFixture(directory, options);
+        runBenchmarks(std::to_string(gpuCount) + "gpu", root.string());
+    }
+    std::filesystem::remove_all(directory);
+    return 0;
+}
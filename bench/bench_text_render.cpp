@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "bench.hpp"
+#include "report_fixture.hpp"
+#include "format.hpp"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+
+using namespace gputester;
+
+#ifdef _WIN32
+static constexpr const char kNullDevice[]{ "NUL" };
+#else
+static constexpr const char kNullDevice[]{ "/dev/null" };
+#endif
+
+// The renderer before the UTF-8 buffer: a std::wostream and a flush after every line.
+static inline void formatTextLegacy(const GpuReport& report, std::wostream& stream, const bool colored) {
+    const auto color = [colored](const std::wstring_view value) -> std::wstring_view {
+        return colored ? value : std::wstring_view{};
+    };
+    for (auto&& adapterInfo : std::as_const(report.adapters)) {
+        const AdapterDesc& adapter = adapterInfo.desc;
+        stream << color(kColorBlue) << L"##############################" << color(kColorDefault) << std::endl;
+        stream << color(kColorGreen) << L"GPU #" << adapter.index + 1 << L':' << color(kColorDefault) << std::endl;
+        stream << L"Device name: " << adapter.description << std::endl;
+        stream << L"Vendor ID: 0x" << std::hex << adapter.vendorId << std::dec;
+        {
+            const vendor_t vendor = vendorIdToVendor(adapter.vendorId);
+            if (vendor != vendor_t::Unknown) {
+                stream << L" (" << vendorToString(vendor) << L')';
+            }
+            stream << std::endl;
+        }
+        stream << L"Device ID: 0x" << std::hex << adapter.deviceId << std::dec << std::endl;
+        stream << L"Dedicated video memory: " << adapter.dedicatedVideoMemory / 1048576 << L" MiB" << std::endl;
+        stream << L"Dedicated system memory: " << adapter.dedicatedSystemMemory / 1048576 << L" MiB" << std::endl;
+        stream << L"Shared system memory: " << adapter.sharedSystemMemory / 1048576 << L" MiB" << std::endl;
+        stream << L"Variable refresh rate supported: " << (report.variableRefreshRateSupported ? L"Yes" : L"No") << std::endl;
+        stream << L"Software simulation (rendered by CPU): " << ((adapter.flags & kAdapterFlagSoftware) ? L"Yes" : L"No") << std::endl;
+        if (adapter.integrated) {
+            stream << L"Integrated device: " << (adapter.integrated.value() ? L"Yes" : L"No") << std::endl;
+        }
+        if (adapterInfo.driver) {
+            const DriverInfo& driverInfo = adapterInfo.driver.value();
+            stream << L"Driver: " << driverInfo.version;
+            if (!driverInfo.date.empty()) {
+                stream << L" (" << driverInfo.date << L')';
+            }
+            stream << std::endl;
+        }
+        for (auto&& outputInfo : std::as_const(adapterInfo.outputs)) {
+            const OutputDesc& output = outputInfo.desc;
+            const DisplayInfo& display = outputInfo.display;
+            const auto width = std::abs(output.right - output.left);
+            const auto height = std::abs(output.bottom - output.top);
+            stream << color(kColorRed) << L"-------------------------------" << color(kColorDefault) << std::endl;
+            stream << color(kColorYellow) << L"Output #" << output.index + 1 << L':' << color(kColorDefault) << std::endl;
+            stream << L"Device name: " << output.deviceName << std::endl;
+            stream << L"Desktop geometry: x: " << output.left << L", y: " << output.top << L", width: " << width << L", height: " << height << std::endl;
+            stream << L"Attached to desktop: " << (output.attachedToDesktop ? L"Yes" : L"No") << std::endl;
+            stream << L"Rotation: " << rotationToString(output.rotation) << L" degree" << std::endl;
+            if (display.mode) {
+                stream << L"Maximum refresh rate: " << display.mode->maxRefreshRate << L" Hz" << std::endl;
+            }
+            if (display.color) {
+                const ColorInfo& colorInfo = display.color.value();
+                stream << L"Bits per color: " << colorInfo.bitsPerColor << std::endl;
+                stream << L"Color space: " << colorSpaceToString(colorInfo.colorSpace) << std::endl;
+                stream << L"Red primary: " << colorInfo.redPrimary[0] << L", " << colorInfo.redPrimary[1] << std::endl;
+                stream << L"Green primary: " << colorInfo.greenPrimary[0] << L", " << colorInfo.greenPrimary[1] << std::endl;
+                stream << L"Blue primary: " << colorInfo.bluePrimary[0] << L", " << colorInfo.bluePrimary[1] << std::endl;
+                stream << L"White point: " << colorInfo.whitePoint[0] << L", " << colorInfo.whitePoint[1] << std::endl;
+                stream << L"Minimum luminance: " << colorInfo.minLuminance << L" nit" << std::endl;
+                stream << L"Maximum luminance: " << colorInfo.maxLuminance << L" nit" << std::endl;
+                stream << L"Maximum average full frame luminance: " << colorInfo.maxFullFrameLuminance << L" nit" << std::endl;
+            }
+            if (display.path) {
+                const PathInfo& pathInfo = display.path.value();
+                if (pathInfo.sdrWhiteLevel) {
+                    stream << L"SDR white level: " << pathInfo.sdrWhiteLevel.value() << L" nit" << std::endl;
+                }
+                if (pathInfo.currentRefreshRate) {
+                    stream << L"Current refresh rate: " << pathInfo.currentRefreshRate.value() << L" Hz" << std::endl;
+                }
+                if (pathInfo.friendlyName) {
+                    stream << L"Display name: " << pathInfo.friendlyName.value() << std::endl;
+                }
+            }
+            if (display.dpi) {
+                const std::uint32_t dpi = display.dpi.value();
+                const auto scale = std::uint32_t(std::round(static_cast<float>(dpi) / static_cast<float>(kDefaultScreenDpi) * 100.f));
+                stream << L"Dots-per-inch: " << dpi << L" (" << scale << L"%)" << std::endl;
+            }
+        }
+    }
+    stream << color(kColorBlue) << L"##############################" << color(kColorDefault) << std::endl;
+}
+
+int main() {
+    std::wofstream legacyStream{ kNullDevice };
+    std::FILE* nullFile = std::fopen(kNullDevice, "wb");
+    if (!legacyStream || !nullFile) {
+        std::fprintf(stderr, "Failed to open %s.\n", kNullDevice);
+        return 1;
+    }
+    std::string buffer{};
+    for (const auto& [adapterCount, outputsPerAdapter] : { std::pair<std::size_t, std::size_t>{ 1, 1 }, { 4, 4 }, { 16, 4 } }) {
+        const GpuReport report = bench::makeReport(adapterCount, outputsPerAdapter);
+        const std::string label = std::to_string(adapterCount) + "x" + std::to_string(outputsPerAdapter);
+        bench::run("text_render/wostream_endl/" + label, [&report, &legacyStream]() {
+            formatTextLegacy(report, legacyStream, true);
+        });
+        bench::run("text_render/utf8_buffer_single_write/" + label, [&report, &buffer, nullFile]() {
+            buffer.clear();
+            formatText(report, buffer, true);
+            std::fwrite(buffer.data(), 1, buffer.size(), nullFile);
+            std::fflush(nullFile);
+        });
+        bench::run("text_render/utf8_buffer_format_only/" + label, [&report, &buffer]() {
+            buffer.clear();
+            formatText(report, buffer, true);
+            bench::doNotOptimize(buffer);
+        });
+        bench::run("text_render/json_format_only/" + label, [&report, &buffer]() {
+            buffer.clear();
+            formatJson(report, buffer);
+            bench::doNotOptimize(buffer);
+        });
+    }
+    std::fclose(nullFile);
+    return 0;
+}
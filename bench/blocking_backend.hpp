@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace gputester::bench {
+
+// Wraps another backend and sleeps in every probe for about as long as the real calls
+// block: SetupAPI and the registry for the driver, GetDisplayModeList1 or the EDID read
+// for the modes.
+class BlockingBackend final : public Backend {
+public:
+    explicit BlockingBackend(backend_ptr_t backend) : m_backend(std::move(backend)) {}
+    ~BlockingBackend() override = default;
+
+    // Pretends a setting behind the path info changed, e.g. the current refresh rate.
+    void changePathState() {
+        m_pathGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::wstring_view name() const override {
+        return m_backend->name();
+    }
+
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override {
+        return m_backend->getVariableRefreshRateSupport(supportedOut);
+    }
+
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override {
+        return m_backend->enumerateAdapters(adaptersOut);
+    }
+
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return m_backend->getDriverInfo(adapter, infoOut);
+    }
+
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        return m_backend->enumerateOutputs(adapter, outputsOut);
+    }
+
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+        return m_backend->getModeInfo(output, infoOut);
+    }
+
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        return m_backend->getColorInfo(output, infoOut);
+    }
+
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        return m_backend->getPathInfo(output, infoOut);
+    }
+
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override {
+        return m_backend->getDpi(output, dpiOut);
+    }
+
+    [[nodiscard]] bool getDriverInfoKey(const AdapterDesc& adapter, std::uint64_t& keyOut) override {
+        return m_backend->getDriverInfoKey(adapter, keyOut);
+    }
+
+    [[nodiscard]] bool getOutputProbeKey(const probe_node_t node, const OutputDesc& output, std::uint64_t& keyOut) override {
+        if (!m_backend->getOutputProbeKey(node, output, keyOut)) {
+            return false;
+        }
+        if (node == probe_node_t::PathInfo) {
+            keyOut += m_pathGeneration.load(std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+private:
+    backend_ptr_t m_backend{};
+    std::atomic<std::uint64_t> m_pathGeneration{ 0 };
+};
+
+} // namespace gputester::bench
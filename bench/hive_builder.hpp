@@ -0,0 +1,271 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Writes registry hives in the REGF format, so the offline registry code can run without
+// any Windows machine. The subkey lists are sorted "lh" lists, split under an "ri" index
+// root once they grow past what Windows puts in a single leaf.
+namespace gputester::bench {
+
+struct HiveValueFixture final {
+    std::wstring name{};
+    std::uint32_t type{ 0 };
+    std::string data{};
+};
+
+struct HiveKeyFixture final {
+    std::wstring name{};
+    std::vector<HiveValueFixture> values{};
+    std::vector<HiveKeyFixture> subKeys{};
+
+    // The reference is valid until the next subkey is added to this key.
+    HiveKeyFixture& addSubKey(const std::wstring_view subKeyName) {
+        subKeys.push_back({ std::wstring(subKeyName) });
+        return subKeys.back();
+    }
+
+    void addString(const std::wstring_view valueName, const std::wstring_view value) {
+        std::string data{};
+        for (const wchar_t ch : value) {
+            data.push_back(static_cast<char>(ch & 0xFF));
+            data.push_back(static_cast<char>((ch >> 8) & 0xFF));
+        }
+        data.append(2, '\0');
+        values.push_back({ std::wstring(valueName), 1, std::move(data) }); // REG_SZ
+    }
+
+    void addDword(const std::wstring_view valueName, const std::uint32_t value) {
+        std::string data(4, '\0');
+        for (std::size_t index = 0; index != 4; ++index) {
+            data[index] = static_cast<char>((value >> (index * 8)) & 0xFF);
+        }
+        values.push_back({ std::wstring(valueName), 4, std::move(data) }); // REG_DWORD
+    }
+};
+
+class HiveWriter final {
+public:
+    static constexpr const std::size_t kMaxLeafSize{ 511 };
+
+    [[nodiscard]] std::string write(const HiveKeyFixture& root) {
+        m_bins.assign(32, '\0');
+        const std::uint32_t rootCell = writeKey(root, 0xFFFFFFFF, true);
+        m_bins.resize((m_bins.size() + 4095) / 4096 * 4096, '\0');
+        std::memcpy(m_bins.data(), "hbin", 4);
+        put32(m_bins, 8, static_cast<std::uint32_t>(m_bins.size()));
+        std::string hive(4096, '\0');
+        std::memcpy(hive.data(), "regf", 4);
+        put32(hive, 0x04, 1); // Primary and secondary sequence numbers, equal for a clean hive.
+        put32(hive, 0x08, 1);
+        put32(hive, 0x14, 1); // Version 1.5
+        put32(hive, 0x18, 5);
+        put32(hive, 0x20, 1); // Direct memory load
+        put32(hive, 0x24, rootCell);
+        put32(hive, 0x28, static_cast<std::uint32_t>(m_bins.size()));
+        put32(hive, 0x2C, 1);
+        std::uint32_t checksum{ 0 };
+        for (std::size_t offset = 0; offset != 0x1FC; offset += 4) {
+            checksum ^= get32(hive, offset);
+        }
+        put32(hive, 0x1FC, checksum);
+        return hive + m_bins;
+    }
+
+private:
+    static void put16(std::string& buffer, const std::size_t offset, const std::uint16_t value) {
+        buffer[offset] = static_cast<char>(value & 0xFF);
+        buffer[offset + 1] = static_cast<char>(value >> 8);
+    }
+
+    static void put32(std::string& buffer, const std::size_t offset, const std::uint32_t value) {
+        for (std::size_t index = 0; index != 4; ++index) {
+            buffer[offset + index] = static_cast<char>((value >> (index * 8)) & 0xFF);
+        }
+    }
+
+    [[nodiscard]] static std::uint32_t get32(const std::string& buffer, const std::size_t offset) {
+        std::uint32_t value{ 0 };
+        for (std::size_t index = 0; index != 4; ++index) {
+            value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(buffer[offset + index])) << (index * 8);
+        }
+        return value;
+    }
+
+    // ASCII and Latin-1, enough for the names the fixtures use.
+    [[nodiscard]] static wchar_t upcase(const wchar_t ch) {
+        return ((ch >= L'a' && ch <= L'z') || (ch >= 0xE0 && ch <= 0xFE && ch != 0xF7)) ? static_cast<wchar_t>(ch - 0x20) : ch;
+    }
+
+    [[nodiscard]] static bool compressible(const std::wstring_view name) {
+        return std::all_of(name.begin(), name.end(), [](const wchar_t ch) { return static_cast<std::uint32_t>(ch) <= 0xFF; });
+    }
+
+    [[nodiscard]] static std::string encodeName(const std::wstring_view name) {
+        std::string result{};
+        const bool compressed = compressible(name);
+        for (const wchar_t ch : name) {
+            result.push_back(static_cast<char>(ch & 0xFF));
+            if (!compressed) {
+                result.push_back(static_cast<char>((ch >> 8) & 0xFF));
+            }
+        }
+        return result;
+    }
+
+    // Returns the offset of a zeroed cell with room for "size" bytes, relative to the first bin.
+    [[nodiscard]] std::uint32_t allocate(const std::size_t size) {
+        const auto offset = static_cast<std::uint32_t>(m_bins.size());
+        const std::size_t cellSize = (size + 4 + 7) / 8 * 8;
+        m_bins.append(cellSize, '\0');
+        put32(m_bins, offset, static_cast<std::uint32_t>(-static_cast<std::int32_t>(cellSize)));
+        return offset;
+    }
+
+    [[nodiscard]] std::uint32_t writeData(const std::string_view data) {
+        const std::uint32_t cell = allocate(data.size());
+        std::memcpy(m_bins.data() + cell + 4, data.data(), data.size());
+        return cell;
+    }
+
+    [[nodiscard]] std::uint32_t writeValue(const HiveValueFixture& value) {
+        const std::string name = encodeName(value.name);
+        std::uint32_t dataSize = static_cast<std::uint32_t>(value.data.size());
+        std::uint32_t dataOffset{ 0 };
+        if (dataSize <= 4) {
+            for (std::size_t index = 0; index != value.data.size(); ++index) {
+                dataOffset |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(value.data[index])) << (index * 8);
+            }
+            dataSize |= 0x80000000;
+        } else {
+            dataOffset = writeData(value.data);
+        }
+        const std::uint32_t cell = allocate(0x14 + name.size());
+        const std::size_t base = cell + 4;
+        m_bins[base] = 'v';
+        m_bins[base + 1] = 'k';
+        put16(m_bins, base + 0x02, static_cast<std::uint16_t>(name.size()));
+        put32(m_bins, base + 0x04, dataSize);
+        put32(m_bins, base + 0x08, dataOffset);
+        put32(m_bins, base + 0x0C, value.type);
+        put16(m_bins, base + 0x10, compressible(value.name) ? 0x0001 : 0x0000);
+        std::memcpy(m_bins.data() + base + 0x14, name.data(), name.size());
+        return cell;
+    }
+
+    [[nodiscard]] std::uint32_t writeLeaf(const std::vector<std::pair<std::uint32_t, std::uint32_t>>& entries) {
+        const std::uint32_t cell = allocate(4 + entries.size() * 8);
+        const std::size_t base = cell + 4;
+        m_bins[base] = 'l';
+        m_bins[base + 1] = 'h';
+        put16(m_bins, base + 0x02, static_cast<std::uint16_t>(entries.size()));
+        for (std::size_t index = 0; index != entries.size(); ++index) {
+            put32(m_bins, base + 4 + index * 8, entries[index].first);
+            put32(m_bins, base + 8 + index * 8, entries[index].second);
+        }
+        return cell;
+    }
+
+    [[nodiscard]] std::uint32_t writeKey(const HiveKeyFixture& key, const std::uint32_t parent, const bool root) {
+        const std::string name = encodeName(key.name);
+        const std::uint32_t cell = allocate(0x4C + name.size());
+        std::vector<std::uint32_t> values{};
+        for (auto&& value : key.values) {
+            values.push_back(writeValue(value));
+        }
+        std::uint32_t valueList{ 0xFFFFFFFF };
+        if (!values.empty()) {
+            valueList = allocate(values.size() * 4);
+            for (std::size_t index = 0; index != values.size(); ++index) {
+                put32(m_bins, valueList + 4 + index * 4, values[index]);
+            }
+        }
+        // Windows keeps subkey lists sorted by the upper cased name.
+        std::vector<const HiveKeyFixture*> subKeys{};
+        for (auto&& subKey : key.subKeys) {
+            subKeys.push_back(&subKey);
+        }
+        std::sort(subKeys.begin(), subKeys.end(), [](const HiveKeyFixture* lhs, const HiveKeyFixture* rhs) {
+            return std::lexicographical_compare(lhs->name.begin(), lhs->name.end(), rhs->name.begin(), rhs->name.end(),
+                [](const wchar_t left, const wchar_t right) { return upcase(left) < upcase(right); });
+        });
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> entries{};
+        for (const HiveKeyFixture* subKey : subKeys) {
+            std::uint32_t hash{ 0 };
+            for (const wchar_t ch : subKey->name) {
+                hash = hash * 37 + static_cast<std::uint32_t>(upcase(ch));
+            }
+            entries.emplace_back(writeKey(*subKey, cell, false), hash);
+        }
+        std::uint32_t subKeyList{ 0xFFFFFFFF };
+        if (entries.size() > kMaxLeafSize) {
+            std::vector<std::uint32_t> leaves{};
+            for (std::size_t begin = 0; begin < entries.size(); begin += kMaxLeafSize) {
+                const std::size_t end = std::min(entries.size(), begin + kMaxLeafSize);
+                leaves.push_back(writeLeaf({ entries.begin() + static_cast<std::ptrdiff_t>(begin), entries.begin() + static_cast<std::ptrdiff_t>(end) }));
+            }
+            subKeyList = allocate(4 + leaves.size() * 4);
+            m_bins[subKeyList + 4] = 'r';
+            m_bins[subKeyList + 5] = 'i';
+            put16(m_bins, subKeyList + 6, static_cast<std::uint16_t>(leaves.size()));
+            for (std::size_t index = 0; index != leaves.size(); ++index) {
+                put32(m_bins, subKeyList + 8 + index * 4, leaves[index]);
+            }
+        } else if (!entries.empty()) {
+            subKeyList = writeLeaf(entries);
+        }
+        const std::size_t base = cell + 4;
+        m_bins[base] = 'n';
+        m_bins[base + 1] = 'k';
+        put16(m_bins, base + 0x02, static_cast<std::uint16_t>((root ? 0x0004 : 0x0000) | (compressible(key.name) ? 0x0020 : 0x0000)));
+        put32(m_bins, base + 0x10, parent);
+        put32(m_bins, base + 0x14, static_cast<std::uint32_t>(entries.size()));
+        put32(m_bins, base + 0x1C, subKeyList);
+        put32(m_bins, base + 0x20, 0xFFFFFFFF);
+        put32(m_bins, base + 0x24, static_cast<std::uint32_t>(values.size()));
+        put32(m_bins, base + 0x28, valueList);
+        put32(m_bins, base + 0x2C, 0xFFFFFFFF);
+        put32(m_bins, base + 0x30, 0xFFFFFFFF);
+        put16(m_bins, base + 0x48, static_cast<std::uint16_t>(name.size()));
+        std::memcpy(m_bins.data() + base + 0x4C, name.data(), name.size());
+        return cell;
+    }
+
+    std::string m_bins{};
+};
+
+[[nodiscard]] inline std::string buildHive(const HiveKeyFixture& root) {
+    return HiveWriter{}.write(root);
+}
+
+} // namespace gputester::bench
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "model.hpp"
+#include <string>
+#include <utility>
+
+namespace gputester::bench {
+
+// A fully populated report, as a high end machine with HDR monitors would produce.
+[[nodiscard]] inline GpuReport makeReport(const std::size_t adapterCount, const std::size_t outputsPerAdapter) {
+    GpuReport report{};
+    report.backend = L"fixture";
+    for (std::size_t adapterIndex = 0; adapterIndex != adapterCount; ++adapterIndex) {
+        AdapterInfo adapter{};
+        adapter.desc.index = static_cast<std::uint32_t>(adapterIndex);
+        adapter.desc.description = L"NVIDIA GeForce RTX 4090";
+        adapter.desc.vendorId = 0x10DE;
+        adapter.desc.deviceId = 0x2684;
+        adapter.desc.dedicatedVideoMemory = 24ull << 30;
+        adapter.desc.sharedSystemMemory = 16ull << 30;
+        adapter.desc.integrated = false;
+        adapter.driver = DriverInfo{ L"NVIDIA", L"560.94", L"2024-8-14" };
+        for (std::size_t outputIndex = 0; outputIndex != outputsPerAdapter; ++outputIndex) {
+            OutputInfo output{};
+            output.desc.adapterIndex = adapter.desc.index;
+            output.desc.index = static_cast<std::uint32_t>(outputIndex);
+            output.desc.deviceName = L"\\\\.\\DISPLAY" + std::to_wstring(adapterIndex * outputsPerAdapter + outputIndex + 1);
+            output.desc.left = static_cast<std::int32_t>(outputIndex * 3840);
+            output.desc.right = output.desc.left + 3840;
+            output.desc.bottom = 2160;
+            output.desc.attachedToDesktop = true;
+            output.desc.rotation = rotation_t::Identity;
+            output.display.mode = ModeInfo{ 240.f };
+            ColorInfo color{};
+            color.bitsPerColor = 10;
+            color.colorSpace = color_space_t::RGB_FULL_G2084_NONE_P2020;
+            color.redPrimary[0] = 0.6796875f;
+            color.redPrimary[1] = 0.3193359375f;
+            color.greenPrimary[0] = 0.2324218f;
+            color.greenPrimary[1] = 0.7109375f;
+            color.bluePrimary[0] = 0.1396484f;
+            color.bluePrimary[1] = 0.0498046f;
+            color.whitePoint[0] = 0.3134765f;
+            color.whitePoint[1] = 0.3291015f;
+            color.minLuminance = 0.0001f;
+            color.maxLuminance = 1015.f;
+            color.maxFullFrameLuminance = 264.f;
+            output.display.color = color;
+            output.display.path = PathInfo{ 240.f, 239.997f, L"Odyssey OLED G8" };
+            output.display.dpi = 144;
+            adapter.outputs.push_back(std::move(output));
+        }
+        report.adapters.push_back(std::move(adapter));
+    }
+    return report;
+}
+
+} // namespace gputester::bench
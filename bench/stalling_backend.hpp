@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gputester::bench {
+
+// Wraps another backend and makes chosen probes hang like a wedged driver would: the call
+// blocks until its stall is over or release() is called, whichever comes first.
+class StallingBackend final : public Backend {
+public:
+    explicit StallingBackend(backend_ptr_t backend) : m_backend(std::move(backend)) {}
+    ~StallingBackend() override = default;
+
+    // Every later "node" probe blocks for "duration", only those of adapter "adapterIndex" if given.
+    void stall(const probe_node_t node, const std::chrono::nanoseconds duration, const std::optional<std::uint32_t> adapterIndex = std::nullopt) {
+        const std::scoped_lock lock{ m_mutex };
+        m_stalls[static_cast<std::size_t>(node)] = Stall{ duration, adapterIndex };
+    }
+
+    // Lets every blocked call return now and removes all stalls.
+    void release() {
+        {
+            const std::scoped_lock lock{ m_mutex };
+            m_stalls = {};
+            ++m_generation;
+        }
+        m_condition.notify_all();
+    }
+
+    [[nodiscard]] std::wstring_view name() const override {
+        return m_backend->name();
+    }
+
+    [[nodiscard]] bool getVariableRefreshRateSupport(bool& supportedOut) override {
+        return m_backend->getVariableRefreshRateSupport(supportedOut);
+    }
+
+    [[nodiscard]] bool enumerateAdapters(std::vector<AdapterDesc>& adaptersOut) override {
+        wait(probe_node_t::AdapterDesc, std::nullopt);
+        return m_backend->enumerateAdapters(adaptersOut);
+    }
+
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) override {
+        wait(probe_node_t::DriverInfo, adapter.index);
+        return m_backend->getDriverInfo(adapter, infoOut);
+    }
+
+    [[nodiscard]] bool enumerateOutputs(const AdapterDesc& adapter, std::vector<OutputDesc>& outputsOut) override {
+        wait(probe_node_t::OutputList, adapter.index);
+        return m_backend->enumerateOutputs(adapter, outputsOut);
+    }
+
+    [[nodiscard]] bool getModeInfo(const OutputDesc& output, ModeInfo& infoOut) override {
+        wait(probe_node_t::ModeInfo, output.adapterIndex);
+        return m_backend->getModeInfo(output, infoOut);
+    }
+
+    [[nodiscard]] bool getColorInfo(const OutputDesc& output, ColorInfo& infoOut) override {
+        wait(probe_node_t::ColorInfo, output.adapterIndex);
+        return m_backend->getColorInfo(output, infoOut);
+    }
+
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut) override {
+        wait(probe_node_t::PathInfo, output.adapterIndex);
+        return m_backend->getPathInfo(output, infoOut);
+    }
+
+    [[nodiscard]] bool getDpi(const OutputDesc& output, std::uint32_t& dpiOut) override {
+        wait(probe_node_t::Dpi, output.adapterIndex);
+        return m_backend->getDpi(output, dpiOut);
+    }
+
+private:
+    struct Stall final {
+        std::chrono::nanoseconds duration{ 0 };
+        std::optional<std::uint32_t> adapterIndex{};
+    };
+
+    void wait(const probe_node_t node, const std::optional<std::uint32_t> adapterIndex) {
+        std::unique_lock lock{ m_mutex };
+        const Stall stall = m_stalls[static_cast<std::size_t>(node)];
+        if ((stall.duration.count() <= 0) || (stall.adapterIndex && (stall.adapterIndex != adapterIndex))) {
+            return;
+        }
+        const std::uint64_t generation = m_generation;
+        std::ignore = m_condition.wait_for(lock, stall.duration, [this, generation]() {
+            return m_generation != generation;
+        });
+    }
+
+    backend_ptr_t m_backend{};
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    std::array<Stall, kProbeNodeCount> m_stalls{};
+    std::uint64_t m_generation{ 0 };
+};
+
+} // namespace gputester::bench
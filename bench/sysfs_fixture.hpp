@@ -0,0 +1,164 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+// Generates a synthetic sysfs tree with the layout the sysfs backend reads, so the
+// benchmarks can run on machines without any GPU.
+namespace gputester::bench {
+
+struct SysfsFixtureOptions final {
+    std::size_t gpuCount{ 1 };
+    std::size_t connectorsPerGpu{ 4 };
+    std::size_t connectedPerGpu{ 2 };
+    std::size_t otherDeviceCount{ 64 }; // Non-display PCI devices the enumeration has to skip.
+};
+
+[[nodiscard]] inline std::array<std::uint8_t, 128> makeEdid(const std::string_view name, const std::uint32_t width, const std::uint32_t height, const std::uint32_t refreshRate) {
+    std::array<std::uint8_t, 128> edid{ 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+    edid[8] = 0x1C; // "GPT"
+    edid[9] = 0xF4;
+    edid[10] = 0x34;
+    edid[11] = 0x12;
+    edid[18] = 1;
+    edid[19] = 4;
+    edid[20] = 0xA5; // Digital, 8 bits per color, DisplayPort.
+    edid[21] = 60; // cm
+    edid[22] = 34;
+    edid[23] = 0x78;
+    edid[24] = 0x3A;
+    constexpr const std::uint8_t kChromaticity[]{ 0xEE, 0x91, 0xA3, 0x54, 0x4C, 0x99, 0x26, 0x0F, 0x50, 0x54 }; // sRGB
+    std::copy(std::begin(kChromaticity), std::end(kChromaticity), edid.begin() + 25);
+    for (std::size_t offset = 38; offset != 54; ++offset) {
+        edid[offset] = 0x01;
+    }
+    const std::uint32_t horizontalBlanking{ 160 };
+    const std::uint32_t verticalBlanking{ 40 };
+    const std::uint32_t pixelClock = (width + horizontalBlanking) * (height + verticalBlanking) * refreshRate / 10000;
+    std::uint8_t* timing = edid.data() + 54;
+    timing[0] = pixelClock & 0xFF;
+    timing[1] = (pixelClock >> 8) & 0xFF;
+    timing[2] = width & 0xFF;
+    timing[3] = horizontalBlanking & 0xFF;
+    timing[4] = ((width >> 8) << 4) | (horizontalBlanking >> 8);
+    timing[5] = height & 0xFF;
+    timing[6] = verticalBlanking & 0xFF;
+    timing[7] = ((height >> 8) << 4) | (verticalBlanking >> 8);
+    std::uint8_t* descriptor = edid.data() + 72;
+    descriptor[3] = 0xFC;
+    std::size_t index = 5;
+    for (; index != 18 && index - 5 < name.size(); ++index) {
+        descriptor[index] = static_cast<std::uint8_t>(name[index - 5]);
+    }
+    if (index != 18) {
+        descriptor[index++] = 0x0A;
+    }
+    for (; index != 18; ++index) {
+        descriptor[index] = 0x20;
+    }
+    edid[90 + 3] = 0x10; // Dummy descriptors.
+    edid[108 + 3] = 0x10;
+    std::uint8_t sum{ 0 };
+    for (std::size_t offset = 0; offset != 127; ++offset) {
+        sum += edid[offset];
+    }
+    edid[127] = static_cast<std::uint8_t>(0x100 - sum);
+    return edid;
+}
+
+inline void writeFile(const std::filesystem::path& path, const std::string_view content) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+// Returns the path to pass to createSysfsBackend().
+inline std::filesystem::path createSysfsFixture(const std::filesystem::path& directory, const SysfsFixtureOptions& options) {
+    namespace fs = std::filesystem;
+    const fs::path root = directory / "sys";
+    fs::remove_all(root);
+    const fs::path pciRoot = root / "devices" / "pci0000:00";
+    const fs::path busDevices = root / "bus" / "pci" / "devices";
+    const fs::path drm = root / "class" / "drm";
+    fs::create_directories(busDevices);
+    fs::create_directories(drm);
+    fs::create_directories(root / "bus" / "pci" / "drivers" / "fixturegpu");
+    fs::create_directories(root / "module" / "fixturegpu");
+    writeFile(root / "module" / "fixturegpu" / "version", "1.2.3\n");
+    char buffer[64];
+    const auto addDevice = [&](const std::size_t bus, const bool display) -> fs::path {
+        std::snprintf(buffer, sizeof(buffer), "0000:%02zx:%02zx.0", bus / 32, bus % 32);
+        const std::string address{ buffer };
+        const fs::path device = pciRoot / address;
+        fs::create_directories(device);
+        writeFile(device / "class", display ? "0x030000\n" : "0x020000\n");
+        writeFile(device / "vendor", "0x10de\n");
+        writeFile(device / "device", "0x2684\n");
+        writeFile(device / "subsystem_vendor", "0x1043\n");
+        writeFile(device / "subsystem_device", "0x88e2\n");
+        writeFile(device / "revision", "0xa1\n");
+        writeFile(device / "resource",
+                  "0x00000000f0000000 0x00000000f0ffffff 0x0000000000040200\n"
+                  "0x0000006000000000 0x00000067ffffffff 0x000000000014220c\n");
+        fs::create_directory_symlink("../../../devices/pci0000:00/" + address, busDevices / address);
+        if (display) {
+            fs::create_directory_symlink("../../../bus/pci/drivers/fixturegpu", device / "driver");
+        }
+        return device;
+    };
+    std::size_t bus{ 1 };
+    for (std::size_t other = 0; other != options.otherDeviceCount; ++other) {
+        addDevice(bus++, false);
+    }
+    for (std::size_t gpu = 0; gpu != options.gpuCount; ++gpu) {
+        const fs::path device = addDevice(bus++, true);
+        const std::string card = "card" + std::to_string(gpu);
+        fs::create_directories(drm / card);
+        fs::create_directory_symlink(device, drm / card / "device");
+        for (std::size_t connector = 0; connector != options.connectorsPerGpu; ++connector) {
+            const fs::path path = drm / (card + "-DP-" + std::to_string(connector + 1));
+            fs::create_directories(path);
+            const bool connected = connector < options.connectedPerGpu;
+            writeFile(path / "status", connected ? "connected\n" : "disconnected\n");
+            writeFile(path / "enabled", connected ? "enabled\n" : "disabled\n");
+            writeFile(path / "modes", connected ? "2560x1440\n1920x1080\n1280x720\n" : "");
+            if (connected) {
+                const auto edid = makeEdid("FIXTURE " + std::to_string(connector + 1), 2560, 1440, 144);
+                writeFile(path / "edid", std::string_view{ reinterpret_cast<const char*>(edid.data()), edid.size() });
+            } else {
+                writeFile(path / "edid", {});
+            }
+        }
+    }
+    return root;
+}
+
+} // namespace gputester::bench
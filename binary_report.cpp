@@ -0,0 +1,404 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "binary_report.hpp"
+#include "text.hpp"
+#include <iostream>
+#include <utility>
+
+namespace gputester {
+
+static constexpr const std::size_t kArchiveBufferSize{ 1 << 20 };
+
+[[nodiscard]] static inline std::size_t alignTo8(const std::size_t value) {
+    return (value + 7) & ~std::size_t{ 7 };
+}
+
+// Strings go to the end of the buffer, the tables before them are patched in place by
+// offset, which stays valid when the buffer grows.
+class BinaryReportEncoder final {
+public:
+    BinaryReportEncoder(std::string& buffer, const std::size_t reportBegin, const std::size_t poolBegin)
+        : m_buffer(buffer), m_reportBegin(reportBegin), m_poolBegin(poolBegin) {}
+
+    template <typename T>
+    void store(const std::size_t offset, const T value) {
+        storeLittleEndian(reinterpret_cast<std::uint8_t*>(m_buffer.data()) + m_reportBegin + offset, value);
+    }
+
+    void storeString(const std::size_t offset, const std::wstring_view str) {
+        const std::size_t begin = m_buffer.size();
+        appendUtf8(m_buffer, str);
+        store(offset, static_cast<std::uint32_t>(begin - m_poolBegin));
+        store(offset + 4, static_cast<std::uint32_t>(m_buffer.size() - begin));
+    }
+
+private:
+    std::string& m_buffer;
+    std::size_t m_reportBegin{ 0 };
+    std::size_t m_poolBegin{ 0 };
+};
+
+void encodeBinaryReport(const GpuReport& report, std::string& bufferOut) {
+    std::size_t outputCount{ 0 };
+    for (auto&& adapterInfo : std::as_const(report.adapters)) {
+        outputCount += adapterInfo.outputs.size();
+    }
+    const std::size_t reportBegin = bufferOut.size();
+    const std::size_t adapterTableOffset = kBinaryReportHeaderSize;
+    const std::size_t outputTableOffset = adapterTableOffset + report.adapters.size() * kBinaryAdapterRecordSize;
+    const std::size_t stringPoolOffset = outputTableOffset + outputCount * kBinaryOutputRecordSize;
+    bufferOut.resize(reportBegin + stringPoolOffset, '\0');
+    BinaryReportEncoder encoder{ bufferOut, reportBegin, reportBegin + stringPoolOffset };
+
+    encoder.store(0, kBinaryReportMagic);
+    encoder.store(4, kBinaryReportVersion);
+    encoder.store(6, static_cast<std::uint16_t>(kBinaryReportHeaderSize));
+    encoder.store(12, report.variableRefreshRateSupported ? BinaryReportView::kVariableRefreshRate : 0u);
+    encoder.store(16, static_cast<std::uint32_t>(report.adapters.size()));
+    encoder.store(20, static_cast<std::uint32_t>(adapterTableOffset));
+    encoder.store(24, static_cast<std::uint32_t>(outputCount));
+    encoder.store(28, static_cast<std::uint32_t>(outputTableOffset));
+    encoder.store(32, static_cast<std::uint32_t>(stringPoolOffset));
+    encoder.storeString(40, report.backend);
+
+    std::size_t outputIndex{ 0 };
+    for (std::size_t adapterIndex = 0; adapterIndex != report.adapters.size(); ++adapterIndex) {
+        const AdapterInfo& adapterInfo = report.adapters[adapterIndex];
+        const AdapterDesc& adapter = adapterInfo.desc;
+        const std::size_t record = adapterTableOffset + adapterIndex * kBinaryAdapterRecordSize;
+        std::uint32_t presence{ 0 };
+        if (adapter.integrated) {
+            presence |= BinaryAdapterView::kIntegratedKnown;
+            if (adapter.integrated.value()) {
+                presence |= BinaryAdapterView::kIntegrated;
+            }
+        }
+        if (adapterInfo.driver) {
+            presence |= BinaryAdapterView::kDriver;
+        }
+        encoder.store(record + 0, adapter.dedicatedVideoMemory);
+        encoder.store(record + 8, adapter.dedicatedSystemMemory);
+        encoder.store(record + 16, adapter.sharedSystemMemory);
+        encoder.store(record + 24, adapter.luid);
+        encoder.store(record + 32, adapter.index);
+        encoder.store(record + 36, adapter.vendorId);
+        encoder.store(record + 40, adapter.deviceId);
+        encoder.store(record + 44, adapter.subSysId);
+        encoder.store(record + 48, adapter.revision);
+        encoder.store(record + 52, adapter.flags);
+        encoder.store(record + 56, presence);
+        encoder.store(record + 60, static_cast<std::uint32_t>(outputIndex));
+        encoder.store(record + 64, static_cast<std::uint32_t>(adapterInfo.outputs.size()));
+        encoder.storeString(record + 72, adapter.description);
+        if (adapterInfo.driver) {
+            encoder.storeString(record + 80, adapterInfo.driver->provider);
+            encoder.storeString(record + 88, adapterInfo.driver->version);
+            encoder.storeString(record + 96, adapterInfo.driver->date);
+        }
+        for (auto&& outputInfo : std::as_const(adapterInfo.outputs)) {
+            const OutputDesc& output = outputInfo.desc;
+            const DisplayInfo& display = outputInfo.display;
+            const std::size_t outputRecord = outputTableOffset + outputIndex * kBinaryOutputRecordSize;
+            ++outputIndex;
+            std::uint32_t outputPresence{ 0 };
+            if (output.attachedToDesktop) {
+                outputPresence |= BinaryOutputView::kAttached;
+            }
+            encoder.store(outputRecord + 0, output.adapterIndex);
+            encoder.store(outputRecord + 4, output.index);
+            encoder.store(outputRecord + 8, output.left);
+            encoder.store(outputRecord + 12, output.top);
+            encoder.store(outputRecord + 16, output.right);
+            encoder.store(outputRecord + 20, output.bottom);
+            encoder.store(outputRecord + 24, static_cast<std::uint32_t>(output.rotation));
+            if (display.mode) {
+                outputPresence |= BinaryOutputView::kMode;
+                encoder.store(outputRecord + 32, display.mode->maxRefreshRate);
+            }
+            if (display.color) {
+                const ColorInfo& colorInfo = display.color.value();
+                outputPresence |= BinaryOutputView::kColor;
+                encoder.store(outputRecord + 36, colorInfo.bitsPerColor);
+                encoder.store(outputRecord + 40, static_cast<std::uint32_t>(colorInfo.colorSpace));
+                const float* points[]{ colorInfo.redPrimary, colorInfo.greenPrimary, colorInfo.bluePrimary, colorInfo.whitePoint };
+                for (std::size_t point = 0; point != std::size(points); ++point) {
+                    encoder.store(outputRecord + 44 + point * 8, points[point][0]);
+                    encoder.store(outputRecord + 48 + point * 8, points[point][1]);
+                }
+                encoder.store(outputRecord + 76, colorInfo.minLuminance);
+                encoder.store(outputRecord + 80, colorInfo.maxLuminance);
+                encoder.store(outputRecord + 84, colorInfo.maxFullFrameLuminance);
+            }
+            if (display.path) {
+                const PathInfo& pathInfo = display.path.value();
+                outputPresence |= BinaryOutputView::kPath;
+                if (pathInfo.sdrWhiteLevel) {
+                    outputPresence |= BinaryOutputView::kSdrWhiteLevel;
+                    encoder.store(outputRecord + 88, pathInfo.sdrWhiteLevel.value());
+                }
+                if (pathInfo.currentRefreshRate) {
+                    outputPresence |= BinaryOutputView::kCurrentRefreshRate;
+                    encoder.store(outputRecord + 92, pathInfo.currentRefreshRate.value());
+                }
+                if (pathInfo.friendlyName) {
+                    outputPresence |= BinaryOutputView::kFriendlyName;
+                    encoder.storeString(outputRecord + 112, pathInfo.friendlyName.value());
+                }
+            }
+            if (display.dpi) {
+                outputPresence |= BinaryOutputView::kDpi;
+                encoder.store(outputRecord + 96, display.dpi.value());
+            }
+            encoder.store(outputRecord + 28, outputPresence);
+            encoder.storeString(outputRecord + 104, output.deviceName);
+        }
+    }
+    encoder.store(36, static_cast<std::uint32_t>(bufferOut.size() - reportBegin - stringPoolOffset));
+    bufferOut.resize(reportBegin + alignTo8(bufferOut.size() - reportBegin), '\0');
+    encoder.store(8, static_cast<std::uint32_t>(bufferOut.size() - reportBegin));
+}
+
+std::optional<BinaryReportView> BinaryReportView::open(const std::uint8_t* data, const std::size_t size) {
+    if (!data || size < kBinaryReportHeaderSize) {
+        return std::nullopt;
+    }
+    if (loadLittleEndian<std::uint32_t>(data) != kBinaryReportMagic || loadLittleEndian<std::uint16_t>(data + 4) != kBinaryReportVersion) {
+        return std::nullopt;
+    }
+    const auto headerSize = loadLittleEndian<std::uint16_t>(data + 6);
+    const auto totalSize = loadLittleEndian<std::uint32_t>(data + 8);
+    const auto adapterCount = loadLittleEndian<std::uint32_t>(data + 16);
+    const auto adapterTableOffset = loadLittleEndian<std::uint32_t>(data + 20);
+    const auto outputCount = loadLittleEndian<std::uint32_t>(data + 24);
+    const auto outputTableOffset = loadLittleEndian<std::uint32_t>(data + 28);
+    const auto stringPoolOffset = loadLittleEndian<std::uint32_t>(data + 32);
+    const auto stringPoolSize = loadLittleEndian<std::uint32_t>(data + 36);
+    // 64 bit math, so none of the checks can overflow.
+    const auto fits = [totalSize](const std::uint64_t offset, const std::uint64_t length) -> bool {
+        return offset + length <= totalSize;
+    };
+    if (headerSize < kBinaryReportHeaderSize || totalSize > size
+        || !fits(adapterTableOffset, std::uint64_t{ adapterCount } * kBinaryAdapterRecordSize)
+        || !fits(outputTableOffset, std::uint64_t{ outputCount } * kBinaryOutputRecordSize)
+        || !fits(stringPoolOffset, stringPoolSize)
+        || (adapterTableOffset % 8) != 0 || (outputTableOffset % 8) != 0) {
+        return std::nullopt;
+    }
+    BinaryReportView view{};
+    view.m_data = data;
+    view.m_adapterTable = data + adapterTableOffset;
+    view.m_outputTable = data + outputTableOffset;
+    view.m_pool = { data + stringPoolOffset, stringPoolSize };
+    return view;
+}
+
+void BinaryReportView::decode(GpuReport& reportOut) const {
+    reportOut = {};
+    reportOut.backend = utf8ToWide(backend());
+    reportOut.variableRefreshRateSupported = variableRefreshRateSupported();
+    reportOut.adapters.reserve(adapterCount());
+    for (std::uint32_t adapterIndex = 0; adapterIndex != adapterCount(); ++adapterIndex) {
+        const BinaryAdapterView adapterView = adapter(adapterIndex);
+        AdapterInfo adapterInfo{};
+        AdapterDesc& desc = adapterInfo.desc;
+        desc.index = adapterView.index();
+        desc.description = utf8ToWide(adapterView.description());
+        desc.vendorId = adapterView.vendorId();
+        desc.deviceId = adapterView.deviceId();
+        desc.subSysId = adapterView.subSysId();
+        desc.revision = adapterView.revision();
+        desc.dedicatedVideoMemory = adapterView.dedicatedVideoMemory();
+        desc.dedicatedSystemMemory = adapterView.dedicatedSystemMemory();
+        desc.sharedSystemMemory = adapterView.sharedSystemMemory();
+        desc.luid = adapterView.luid();
+        desc.flags = adapterView.flags();
+        desc.integrated = adapterView.integrated();
+        if (adapterView.hasDriver()) {
+            adapterInfo.driver = DriverInfo{ utf8ToWide(adapterView.driverProvider()), utf8ToWide(adapterView.driverVersion()), utf8ToWide(adapterView.driverDate()) };
+        }
+        adapterInfo.outputs.reserve(adapterView.outputCount());
+        for (std::uint32_t outputIndex = 0; outputIndex != adapterView.outputCount(); ++outputIndex) {
+            const BinaryOutputView outputView = adapterView.output(outputIndex);
+            OutputInfo outputInfo{};
+            OutputDesc& output = outputInfo.desc;
+            DisplayInfo& display = outputInfo.display;
+            output.adapterIndex = outputView.adapterIndex();
+            output.index = outputView.index();
+            output.deviceName = utf8ToWide(outputView.deviceName());
+            output.left = outputView.left();
+            output.top = outputView.top();
+            output.right = outputView.right();
+            output.bottom = outputView.bottom();
+            output.attachedToDesktop = outputView.attachedToDesktop();
+            output.rotation = outputView.rotation();
+            if (const auto maxRefreshRate = outputView.maxRefreshRate()) {
+                display.mode = ModeInfo{ maxRefreshRate.value() };
+            }
+            if (outputView.hasColor()) {
+                ColorInfo colorInfo{};
+                colorInfo.bitsPerColor = outputView.bitsPerColor();
+                colorInfo.colorSpace = outputView.colorSpace();
+                float* points[]{ colorInfo.redPrimary, colorInfo.greenPrimary, colorInfo.bluePrimary, colorInfo.whitePoint };
+                for (std::uint32_t point = 0; point != std::size(points); ++point) {
+                    points[point][0] = outputView.chromaticity(point, 0);
+                    points[point][1] = outputView.chromaticity(point, 1);
+                }
+                colorInfo.minLuminance = outputView.minLuminance();
+                colorInfo.maxLuminance = outputView.maxLuminance();
+                colorInfo.maxFullFrameLuminance = outputView.maxFullFrameLuminance();
+                display.color = colorInfo;
+            }
+            if (outputView.hasPath()) {
+                PathInfo pathInfo{};
+                pathInfo.sdrWhiteLevel = outputView.sdrWhiteLevel();
+                pathInfo.currentRefreshRate = outputView.currentRefreshRate();
+                if (const auto friendlyName = outputView.friendlyName()) {
+                    pathInfo.friendlyName = utf8ToWide(friendlyName.value());
+                }
+                display.path = std::move(pathInfo);
+            }
+            display.dpi = outputView.dpi();
+            adapterInfo.outputs.push_back(std::move(outputInfo));
+        }
+        reportOut.adapters.push_back(std::move(adapterInfo));
+    }
+}
+
+BinaryArchiveWriter::~BinaryArchiveWriter() {
+    if (m_file) {
+        std::fclose(m_file);
+    }
+}
+
+bool BinaryArchiveWriter::write(const void* data, const std::size_t size) {
+    if (std::fwrite(data, 1, size, m_file) != size) {
+        std::wcerr << L"Failed to write the report archive." << std::endl;
+        return false;
+    }
+    m_position += size;
+    return true;
+}
+
+bool BinaryArchiveWriter::open(const std::filesystem::path& path) {
+    if (m_file) {
+        std::fclose(m_file);
+    }
+    m_position = 0;
+    m_offsets.clear();
+#ifdef _WIN32
+    m_file = _wfopen(path.c_str(), L"wb");
+#else
+    m_file = std::fopen(path.c_str(), "wb");
+#endif
+    if (!m_file) {
+        std::wcerr << L"Failed to create \"" << path.wstring() << L"\"." << std::endl;
+        return false;
+    }
+    std::setvbuf(m_file, nullptr, _IOFBF, kArchiveBufferSize);
+    // A placeholder, finish() writes the real header once the index offset is known.
+    const std::uint8_t header[kBinaryArchiveHeaderSize]{};
+    return write(header, sizeof(header));
+}
+
+bool BinaryArchiveWriter::append(const GpuReport& report) {
+    if (!m_file) {
+        return false;
+    }
+    m_buffer.clear();
+    encodeBinaryReport(report, m_buffer);
+    m_offsets.push_back(m_position);
+    return write(m_buffer.data(), m_buffer.size());
+}
+
+bool BinaryArchiveWriter::finish() {
+    if (!m_file) {
+        return false;
+    }
+    const std::uint64_t indexOffset = m_position;
+    std::uint8_t entry[8]{};
+    for (const std::uint64_t offset : std::as_const(m_offsets)) {
+        storeLittleEndian(entry, offset);
+        if (!write(entry, sizeof(entry))) {
+            return false;
+        }
+    }
+    std::uint8_t header[kBinaryArchiveHeaderSize]{};
+    storeLittleEndian(header + 0, kBinaryArchiveMagic);
+    storeLittleEndian(header + 4, kBinaryReportVersion);
+    storeLittleEndian(header + 6, static_cast<std::uint16_t>(kBinaryArchiveHeaderSize));
+    storeLittleEndian(header + 8, static_cast<std::uint64_t>(m_offsets.size()));
+    storeLittleEndian(header + 16, indexOffset);
+    const bool result = std::fseek(m_file, 0, SEEK_SET) == 0 && std::fwrite(header, 1, sizeof(header), m_file) == sizeof(header);
+    const bool closed = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    if (!result || !closed) {
+        std::wcerr << L"Failed to finish the report archive." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BinaryArchive::open(const std::filesystem::path& path) {
+    m_reportCount = 0;
+    m_index = nullptr;
+    if (!m_file.open(path)) {
+        return false;
+    }
+    const std::uint8_t* data = m_file.data();
+    const std::size_t size = m_file.size();
+    if (size < kBinaryArchiveHeaderSize || loadLittleEndian<std::uint32_t>(data) != kBinaryArchiveMagic
+        || loadLittleEndian<std::uint16_t>(data + 4) != kBinaryReportVersion) {
+        std::wcerr << L"\"" << path.wstring() << L"\" is not a report archive." << std::endl;
+        m_file.close();
+        return false;
+    }
+    const auto reportCount = loadLittleEndian<std::uint64_t>(data + 8);
+    const auto indexOffset = loadLittleEndian<std::uint64_t>(data + 16);
+    if (indexOffset > size || reportCount > (size - indexOffset) / 8) {
+        std::wcerr << L"The index of \"" << path.wstring() << L"\" is truncated." << std::endl;
+        m_file.close();
+        return false;
+    }
+    m_reportCount = reportCount;
+    m_index = data + indexOffset;
+    return true;
+}
+
+std::uint64_t BinaryArchive::size() const {
+    return m_reportCount;
+}
+
+std::optional<BinaryReportView> BinaryArchive::report(const std::uint64_t index) const {
+    if (index >= m_reportCount) {
+        return std::nullopt;
+    }
+    const auto offset = loadLittleEndian<std::uint64_t>(m_index + index * 8);
+    if (offset >= m_file.size()) {
+        return std::nullopt;
+    }
+    return BinaryReportView::open(m_file.data() + offset, m_file.size() - offset);
+}
+
+} // namespace gputester
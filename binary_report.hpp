@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "mapped_file.hpp"
+#include "model.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A fixed layout binary encoding of GpuReport which is read in place, e.g. straight from
+// a memory mapped archive, without any parsing. Version 1 layout, every integer is
+// little-endian and every record starts on an 8 byte boundary:
+//
+//   header          kBinaryReportHeaderSize bytes
+//   adapter table   adapterCount * kBinaryAdapterRecordSize bytes
+//   output table    outputCount * kBinaryOutputRecordSize bytes, grouped by adapter
+//   string pool     UTF-8 without terminators, referenced by (offset, size) pairs
+//
+// The field offsets of each record are the ones used by the views below.
+namespace gputester {
+
+static constexpr const std::uint32_t kBinaryReportMagic{ 0x52555047 }; // "GPUR"
+static constexpr const std::uint32_t kBinaryArchiveMagic{ 0x41525047 }; // "GPRA"
+static constexpr const std::uint16_t kBinaryReportVersion{ 1 };
+static constexpr const std::uint32_t kBinaryReportHeaderSize{ 48 };
+static constexpr const std::uint32_t kBinaryAdapterRecordSize{ 104 };
+static constexpr const std::uint32_t kBinaryOutputRecordSize{ 120 };
+static constexpr const std::uint32_t kBinaryArchiveHeaderSize{ 32 };
+
+template <typename T>
+[[nodiscard]] inline T loadLittleEndian(const std::uint8_t* data) {
+    T value{};
+    std::memcpy(&value, data, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+        auto bytes = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(value);
+        std::reverse(bytes.begin(), bytes.end());
+        value = std::bit_cast<T>(bytes);
+    }
+    return value;
+}
+
+template <typename T>
+inline void storeLittleEndian(std::uint8_t* data, const T value) {
+    T stored = value;
+    if constexpr (std::endian::native == std::endian::big) {
+        auto bytes = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(value);
+        std::reverse(bytes.begin(), bytes.end());
+        stored = std::bit_cast<T>(bytes);
+    }
+    std::memcpy(data, &stored, sizeof(T));
+}
+
+// The bytes of one string of the pool, the view is valid as long as the report memory is.
+struct BinaryStringPool final {
+    const std::uint8_t* data{ nullptr };
+    std::uint32_t size{ 0 };
+
+    [[nodiscard]] std::string_view get(const std::uint8_t* reference) const {
+        const auto offset = loadLittleEndian<std::uint32_t>(reference);
+        const auto length = loadLittleEndian<std::uint32_t>(reference + 4);
+        if (offset > size || length > size - offset) { // A corrupted reference reads as an empty string.
+            return {};
+        }
+        return { reinterpret_cast<const char*>(data + offset), length };
+    }
+};
+
+class BinaryOutputView final {
+public:
+    BinaryOutputView(const std::uint8_t* record, const BinaryStringPool pool) : m_record(record), m_pool(pool) {}
+
+    [[nodiscard]] std::uint32_t adapterIndex() const { return load<std::uint32_t>(0); }
+    [[nodiscard]] std::uint32_t index() const { return load<std::uint32_t>(4); }
+    [[nodiscard]] std::int32_t left() const { return load<std::int32_t>(8); }
+    [[nodiscard]] std::int32_t top() const { return load<std::int32_t>(12); }
+    [[nodiscard]] std::int32_t right() const { return load<std::int32_t>(16); }
+    [[nodiscard]] std::int32_t bottom() const { return load<std::int32_t>(20); }
+    [[nodiscard]] rotation_t rotation() const { return static_cast<rotation_t>(load<std::uint32_t>(24)); }
+    [[nodiscard]] bool attachedToDesktop() const { return presence(kAttached); }
+    [[nodiscard]] std::optional<float> maxRefreshRate() const { return presence(kMode) ? std::optional<float>{ load<float>(32) } : std::nullopt; }
+    [[nodiscard]] bool hasColor() const { return presence(kColor); }
+    [[nodiscard]] std::uint32_t bitsPerColor() const { return load<std::uint32_t>(36); }
+    [[nodiscard]] color_space_t colorSpace() const { return static_cast<color_space_t>(load<std::uint32_t>(40)); }
+    // 0: red, 1: green, 2: blue, 3: white point; axis 0: x, 1: y.
+    [[nodiscard]] float chromaticity(const std::uint32_t point, const std::uint32_t axis) const { return load<float>(44 + (point * 2 + axis) * 4); }
+    [[nodiscard]] float minLuminance() const { return load<float>(76); }
+    [[nodiscard]] float maxLuminance() const { return load<float>(80); }
+    [[nodiscard]] float maxFullFrameLuminance() const { return load<float>(84); }
+    [[nodiscard]] bool hasPath() const { return presence(kPath); }
+    [[nodiscard]] std::optional<float> sdrWhiteLevel() const { return presence(kSdrWhiteLevel) ? std::optional<float>{ load<float>(88) } : std::nullopt; }
+    [[nodiscard]] std::optional<float> currentRefreshRate() const { return presence(kCurrentRefreshRate) ? std::optional<float>{ load<float>(92) } : std::nullopt; }
+    [[nodiscard]] std::optional<std::uint32_t> dpi() const { return presence(kDpi) ? std::optional<std::uint32_t>{ load<std::uint32_t>(96) } : std::nullopt; }
+    [[nodiscard]] std::string_view deviceName() const { return m_pool.get(m_record + 104); }
+    [[nodiscard]] std::optional<std::string_view> friendlyName() const { return presence(kFriendlyName) ? std::optional<std::string_view>{ m_pool.get(m_record + 112) } : std::nullopt; }
+
+    static constexpr const std::uint32_t kAttached{ 1u << 0 };
+    static constexpr const std::uint32_t kMode{ 1u << 1 };
+    static constexpr const std::uint32_t kColor{ 1u << 2 };
+    static constexpr const std::uint32_t kPath{ 1u << 3 };
+    static constexpr const std::uint32_t kSdrWhiteLevel{ 1u << 4 };
+    static constexpr const std::uint32_t kCurrentRefreshRate{ 1u << 5 };
+    static constexpr const std::uint32_t kFriendlyName{ 1u << 6 };
+    static constexpr const std::uint32_t kDpi{ 1u << 7 };
+
+private:
+    template <typename T>
+    [[nodiscard]] T load(const std::uint32_t offset) const { return loadLittleEndian<T>(m_record + offset); }
+    [[nodiscard]] bool presence(const std::uint32_t bit) const { return (load<std::uint32_t>(28) & bit) != 0; }
+
+    const std::uint8_t* m_record{ nullptr };
+    BinaryStringPool m_pool{};
+};
+
+class BinaryAdapterView final {
+public:
+    BinaryAdapterView(const std::uint8_t* record, const std::uint8_t* outputTable, const std::uint32_t outputCount, const BinaryStringPool pool)
+        : m_record(record), m_outputTable(outputTable), m_totalOutputCount(outputCount), m_pool(pool) {}
+
+    [[nodiscard]] std::uint64_t dedicatedVideoMemory() const { return load<std::uint64_t>(0); }
+    [[nodiscard]] std::uint64_t dedicatedSystemMemory() const { return load<std::uint64_t>(8); }
+    [[nodiscard]] std::uint64_t sharedSystemMemory() const { return load<std::uint64_t>(16); }
+    [[nodiscard]] std::uint64_t luid() const { return load<std::uint64_t>(24); }
+    [[nodiscard]] std::uint32_t index() const { return load<std::uint32_t>(32); }
+    [[nodiscard]] std::uint32_t vendorId() const { return load<std::uint32_t>(36); }
+    [[nodiscard]] std::uint32_t deviceId() const { return load<std::uint32_t>(40); }
+    [[nodiscard]] std::uint32_t subSysId() const { return load<std::uint32_t>(44); }
+    [[nodiscard]] std::uint32_t revision() const { return load<std::uint32_t>(48); }
+    [[nodiscard]] std::uint32_t flags() const { return load<std::uint32_t>(52); }
+    [[nodiscard]] std::optional<bool> integrated() const {
+        const auto presence = load<std::uint32_t>(56);
+        return (presence & kIntegratedKnown) ? std::optional<bool>{ (presence & kIntegrated) != 0 } : std::nullopt;
+    }
+    [[nodiscard]] bool hasDriver() const { return (load<std::uint32_t>(56) & kDriver) != 0; }
+    [[nodiscard]] std::string_view description() const { return m_pool.get(m_record + 72); }
+    [[nodiscard]] std::string_view driverProvider() const { return m_pool.get(m_record + 80); }
+    [[nodiscard]] std::string_view driverVersion() const { return m_pool.get(m_record + 88); }
+    [[nodiscard]] std::string_view driverDate() const { return m_pool.get(m_record + 96); }
+
+    [[nodiscard]] std::uint32_t outputCount() const {
+        const auto first = load<std::uint32_t>(60);
+        const auto count = load<std::uint32_t>(64);
+        return (first > m_totalOutputCount || count > m_totalOutputCount - first) ? 0 : count;
+    }
+    [[nodiscard]] BinaryOutputView output(const std::uint32_t index) const {
+        assert(index < outputCount());
+        return { m_outputTable + static_cast<std::size_t>(load<std::uint32_t>(60) + index) * kBinaryOutputRecordSize, m_pool };
+    }
+
+    static constexpr const std::uint32_t kIntegratedKnown{ 1u << 0 };
+    static constexpr const std::uint32_t kIntegrated{ 1u << 1 };
+    static constexpr const std::uint32_t kDriver{ 1u << 2 };
+
+private:
+    template <typename T>
+    [[nodiscard]] T load(const std::uint32_t offset) const { return loadLittleEndian<T>(m_record + offset); }
+
+    const std::uint8_t* m_record{ nullptr };
+    const std::uint8_t* m_outputTable{ nullptr };
+    std::uint32_t m_totalOutputCount{ 0 };
+    BinaryStringPool m_pool{};
+};
+
+// One encoded report. open() only checks the header, the table bounds and the version,
+// which is O(1), everything else is read on access.
+class BinaryReportView final {
+public:
+    [[nodiscard]] static std::optional<BinaryReportView> open(const std::uint8_t* data, const std::size_t size);
+
+    [[nodiscard]] std::uint32_t size() const { return loadLittleEndian<std::uint32_t>(m_data + 8); }
+    [[nodiscard]] bool variableRefreshRateSupported() const { return (loadLittleEndian<std::uint32_t>(m_data + 12) & kVariableRefreshRate) != 0; }
+    [[nodiscard]] std::string_view backend() const { return m_pool.get(m_data + 40); }
+    [[nodiscard]] std::uint32_t adapterCount() const { return loadLittleEndian<std::uint32_t>(m_data + 16); }
+    [[nodiscard]] BinaryAdapterView adapter(const std::uint32_t index) const {
+        assert(index < adapterCount());
+        return { m_adapterTable + static_cast<std::size_t>(index) * kBinaryAdapterRecordSize, m_outputTable, outputCount(), m_pool };
+    }
+    [[nodiscard]] std::uint32_t outputCount() const { return loadLittleEndian<std::uint32_t>(m_data + 24); }
+
+    // Copies everything back into the in-memory model, for the formatters.
+    void decode(GpuReport& reportOut) const;
+
+    static constexpr const std::uint32_t kVariableRefreshRate{ 1u << 0 };
+
+private:
+    BinaryReportView() = default;
+
+    const std::uint8_t* m_data{ nullptr };
+    const std::uint8_t* m_adapterTable{ nullptr };
+    const std::uint8_t* m_outputTable{ nullptr };
+    BinaryStringPool m_pool{};
+};
+
+// Appends the encoded report to "bufferOut", which is padded to a multiple of 8 bytes.
+void encodeBinaryReport(const GpuReport& report, std::string& bufferOut);
+
+// An archive is a header, the reports back to back and an index with the offset of
+// every report (u64 each) at the end:
+//   0 u32 magic, 4 u16 version, 6 u16 header size, 8 u64 report count, 16 u64 index offset, 24 u64 reserved
+class BinaryArchiveWriter final {
+public:
+    BinaryArchiveWriter() = default;
+    ~BinaryArchiveWriter();
+    BinaryArchiveWriter(const BinaryArchiveWriter&) = delete;
+    BinaryArchiveWriter& operator=(const BinaryArchiveWriter&) = delete;
+
+    [[nodiscard]] bool open(const std::filesystem::path& path);
+    [[nodiscard]] bool append(const GpuReport& report);
+    // Writes the index and the final header, the archive is unusable without it.
+    [[nodiscard]] bool finish();
+
+private:
+    [[nodiscard]] bool write(const void* data, const std::size_t size);
+
+    std::FILE* m_file{ nullptr };
+    std::uint64_t m_position{ 0 };
+    std::vector<std::uint64_t> m_offsets{};
+    std::string m_buffer{};
+};
+
+class BinaryArchive final {
+public:
+    [[nodiscard]] bool open(const std::filesystem::path& path);
+    [[nodiscard]] std::uint64_t size() const;
+    [[nodiscard]] std::optional<BinaryReportView> report(const std::uint64_t index) const;
+
+private:
+    MappedFile m_file{};
+    std::uint64_t m_reportCount{ 0 };
+    const std::uint8_t* m_index{ nullptr };
+};
+
+} // namespace gputester
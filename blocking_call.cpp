@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "blocking_call.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace gputester {
+
+// Helpers which found nothing to do for this long exit.
+static constexpr const std::chrono::seconds kHelperIdleTime{ 30 };
+
+struct BlockingCall final {
+    std::function<void()> function{};
+    // Waited for by runBlockingCall().
+    std::mutex mutex{};
+    std::condition_variable condition{};
+    bool done{ false };
+    // Or reported by startBlockingCall(), by whichever of the helper and the timer gets there first.
+    std::function<void(bool)> onDone{};
+    std::atomic<bool> reported{ false };
+};
+
+[[nodiscard]] static inline bool claimReport(BlockingCall& call) {
+    return !call.reported.exchange(true, std::memory_order_acq_rel);
+}
+
+class HelperThreads final {
+public:
+    void submit(std::shared_ptr<BlockingCall> call) {
+        const std::scoped_lock lock{ m_mutex };
+        m_queue.push_back(std::move(call));
+        if (m_idle >= m_queue.size()) {
+            m_condition.notify_one();
+            return;
+        }
+        // The helpers are detached: one stuck in a driver can't be joined, not even at exit.
+        std::thread{ [this]() {
+            serve();
+        } }.detach();
+    }
+
+private:
+    void serve() {
+        std::unique_lock lock{ m_mutex };
+        while (true) {
+            ++m_idle;
+            const bool hasWork = m_condition.wait_for(lock, kHelperIdleTime, [this]() {
+                return !m_queue.empty();
+            });
+            --m_idle;
+            if (!hasWork) {
+                return;
+            }
+            std::shared_ptr<BlockingCall> call = std::move(m_queue.front());
+            m_queue.pop_front();
+            lock.unlock();
+            call->function();
+            if (call->onDone) {
+                if (claimReport(*call)) {
+                    call->onDone(true);
+                }
+            } else {
+                {
+                    const std::scoped_lock callLock{ call->mutex };
+                    call->done = true;
+                }
+                call->condition.notify_all();
+            }
+            call.reset(); // Whatever an abandoned call captured goes away here, not under the lock.
+            lock.lock();
+        }
+    }
+
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    std::deque<std::shared_ptr<BlockingCall>> m_queue{};
+    std::size_t m_idle{ 0 };
+};
+
+// Reports the calls of startBlockingCall() which are still running at their deadline. A single thread,
+// started with the first deadline, waits for the earliest one.
+class DeadlineTimer final {
+public:
+    void add(const std::chrono::steady_clock::time_point deadline, std::weak_ptr<BlockingCall> call) {
+        const std::scoped_lock lock{ m_mutex };
+        if (!m_started) {
+            // Detached for the same reason as the helpers: it may be waiting while the process exits.
+            std::thread{ [this]() {
+                serve();
+            } }.detach();
+            m_started = true;
+        }
+        m_deadlines.emplace(deadline, std::move(call));
+        m_condition.notify_one();
+    }
+
+private:
+    void serve() {
+        std::unique_lock lock{ m_mutex };
+        while (true) {
+            if (m_deadlines.empty()) {
+                m_condition.wait(lock);
+                continue;
+            }
+            const auto earliest = m_deadlines.begin();
+            const std::chrono::steady_clock::time_point deadline = earliest->first;
+            if (std::chrono::steady_clock::now() < deadline) {
+                m_condition.wait_until(lock, deadline);
+                continue;
+            }
+            // Calls which returned in time are gone already, they only left their expired entry behind.
+            std::shared_ptr<BlockingCall> call = earliest->second.lock();
+            m_deadlines.erase(earliest);
+            if (!call) {
+                continue;
+            }
+            lock.unlock();
+            if (claimReport(*call)) {
+                call->onDone(false);
+            }
+            call.reset();
+            lock.lock();
+        }
+    }
+
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    std::multimap<std::chrono::steady_clock::time_point, std::weak_ptr<BlockingCall>> m_deadlines{};
+    bool m_started{ false };
+};
+
+// Never destroyed: detached helpers may still use them while the process exits.
+[[nodiscard]] static inline HelperThreads& helperThreads() {
+    static HelperThreads* const helpers = new HelperThreads{};
+    return *helpers;
+}
+
+[[nodiscard]] static inline DeadlineTimer& deadlineTimer() {
+    static DeadlineTimer* const timer = new DeadlineTimer{};
+    return *timer;
+}
+
+bool runBlockingCall(std::function<void()> call, const std::chrono::nanoseconds timeout) {
+    auto blockingCall = std::make_shared<BlockingCall>();
+    blockingCall->function = std::move(call);
+    helperThreads().submit(blockingCall);
+    std::unique_lock lock{ blockingCall->mutex };
+    return blockingCall->condition.wait_for(lock, timeout, [&blockingCall]() {
+        return blockingCall->done;
+    });
+}
+
+void startBlockingCall(std::function<void()> call, const std::chrono::nanoseconds timeout, std::function<void(bool)> done) {
+    auto blockingCall = std::make_shared<BlockingCall>();
+    blockingCall->function = std::move(call);
+    blockingCall->onDone = std::move(done);
+    // The deadline counts from here, queueing for a helper included, like runBlockingCall()'s wait.
+    if (timeout.count() > 0) {
+        deadlineTimer().add(std::chrono::steady_clock::now() + timeout, blockingCall);
+    }
+    helperThreads().submit(std::move(blockingCall));
+}
+
+} // namespace gputester
@@ -0,0 +1,44 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+namespace gputester {
+
+// Runs "call" on a helper thread and waits at most "timeout" for it to return. Returns false if it
+// is still running by then: the caller stops waiting, but nothing can interrupt a thread stuck in a
+// driver, so the call finishes on its helper whenever it returns. It must therefore own (or share)
+// everything it touches. Helper threads are reused, and a new one is only started while every
+// other one is busy or stuck.
+[[nodiscard]] bool runBlockingCall(std::function<void()> call, const std::chrono::nanoseconds timeout);
+
+// The same without a waiting thread: returns right away, and "done" is called exactly once, with true on
+// the helper right after "call" returned, or with false on a timer thread once "timeout" elapsed first.
+// A zero timeout waits as long as the call takes.
+void startBlockingCall(std::function<void()> call, const std::chrono::nanoseconds timeout, std::function<void(bool)> done);
+
+} // namespace gputester
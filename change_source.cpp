@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "change_source.hpp"
+
+namespace gputester {
+
+change_source_ptr_t createNativeChangeSource() {
+#ifdef _WIN32
+    return createRegistryChangeSource();
+#elif defined(__linux__)
+    return createUeventChangeSource();
+#else
+    return nullptr;
+#endif
+}
+
+void ManualChangeSource::notify() {
+    {
+        const std::scoped_lock lock{ m_mutex };
+        ++m_pending;
+    }
+    m_condition.notify_one();
+}
+
+bool ManualChangeSource::wait(const std::chrono::milliseconds timeout) {
+    std::unique_lock lock{ m_mutex };
+    if (!m_condition.wait_for(lock, timeout, [this]() { return m_pending != 0; })) {
+        return false;
+    }
+    // A burst of notifications is one change for the watcher, it re-probes everything anyway.
+    m_pending = 0;
+    return true;
+}
+
+} // namespace gputester
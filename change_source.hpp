@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace gputester {
+
+// Wakes the watch loop when the display configuration may have changed. Sources only give
+// hints, the loop probes again and works out the actual deltas itself, so a spurious wakeup
+// costs one cheap ProbeGraph::update() and nothing else.
+class ChangeSource {
+public:
+    ChangeSource() = default;
+    virtual ~ChangeSource() = default;
+    ChangeSource(const ChangeSource&) = delete;
+    ChangeSource& operator=(const ChangeSource&) = delete;
+
+    // Blocks until a change is signaled or "timeout" elapsed, returns true for a change.
+    [[nodiscard]] virtual bool wait(const std::chrono::milliseconds timeout) = 0;
+};
+using change_source_ptr_t = std::shared_ptr<ChangeSource>;
+
+#ifdef __linux__
+// Kernel uevents of the "drm" and "pci" subsystems (hotplug, connector status, driver binds),
+// read from a NETLINK_KOBJECT_UEVENT socket. Returns nullptr if the socket can't be bound,
+// e.g. in a network namespace without uevents.
+[[nodiscard]] change_source_ptr_t createUeventChangeSource();
+#endif
+#ifdef _WIN32
+// RegistryKey::NotifyAsync() on the display adapter class key (driver installs and updates),
+// the display configuration database (modes, HDR) and the per monitor DPI settings.
+[[nodiscard]] change_source_ptr_t createRegistryChangeSource();
+#endif
+// The native source of the current platform, or nullptr if there is none.
+[[nodiscard]] change_source_ptr_t createNativeChangeSource();
+
+// Signals whatever notify() is called for: a stand-in for tests and benchmarks, and for embedding
+// applications which get their events from elsewhere (their own udev monitor, WM_DISPLAYCHANGE, ...).
+class ManualChangeSource final : public ChangeSource {
+public:
+    ManualChangeSource() = default;
+    ~ManualChangeSource() override = default;
+
+    void notify();
+    [[nodiscard]] bool wait(const std::chrono::milliseconds timeout) override;
+
+private:
+    std::mutex m_mutex{};
+    std::condition_variable m_condition{};
+    std::size_t m_pending{ 0 };
+};
+
+} // namespace gputester
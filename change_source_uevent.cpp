@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "change_source.hpp"
+#include "text.hpp"
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+namespace gputester {
+
+static constexpr const std::uint32_t kKernelUeventGroup{ 1 };
+static constexpr const std::size_t kUeventBufferSize{ 8192 };
+// Connecting a display fires a burst of uevents, they are collected into one change: it is over once
+// no display uevent came for kSettleTime, or after kMaxSettleTime at the latest.
+static constexpr const std::chrono::milliseconds kSettleTime{ 100 };
+static constexpr const std::chrono::milliseconds kMaxSettleTime{ 1000 };
+
+// A kernel uevent is "action@devpath" followed by NUL separated "KEY=value" pairs.
+[[nodiscard]] static inline bool isDisplayUevent(const std::string_view message) {
+    static constexpr const std::string_view kSubsystem{ "SUBSYSTEM=" };
+    std::size_t offset = message.find('\0');
+    while (offset != std::string_view::npos && offset + 1 < message.size()) {
+        const std::size_t begin = offset + 1;
+        offset = message.find('\0', begin);
+        const std::string_view field = message.substr(begin, offset == std::string_view::npos ? std::string_view::npos : offset - begin);
+        if (field.starts_with(kSubsystem)) {
+            const std::string_view subsystem = field.substr(kSubsystem.size());
+            return subsystem == "drm" || subsystem == "pci";
+        }
+    }
+    return false;
+}
+
+class UeventChangeSource final : public ChangeSource {
+public:
+    explicit UeventChangeSource(const int fd) : m_fd(fd) {}
+    ~UeventChangeSource() override {
+        ::close(m_fd);
+    }
+
+    [[nodiscard]] bool wait(const std::chrono::milliseconds timeout) override {
+        // Uevents of other subsystems (USB, input, power supply, ...) are skipped without waking up the caller.
+        const clock_t::time_point deadline = clock_t::now() + timeout;
+        do {
+            if (!poll(deadline)) {
+                return false;
+            }
+        } while (!drain());
+        const clock_t::time_point settleDeadline = clock_t::now() + kMaxSettleTime;
+        clock_t::time_point quietDeadline = clock_t::now() + kSettleTime;
+        while (poll(std::min(quietDeadline, settleDeadline))) {
+            if (drain()) {
+                quietDeadline = clock_t::now() + kSettleTime;
+            }
+        }
+        return true;
+    }
+
+private:
+    using clock_t = std::chrono::steady_clock;
+
+    // Returns false once "deadline" passed without anything to read.
+    [[nodiscard]] bool poll(const clock_t::time_point deadline) const {
+        pollfd descriptor{ m_fd, POLLIN, 0 };
+        int result{ 0 };
+        do {
+            const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock_t::now());
+            if (remaining.count() <= 0) {
+                return false;
+            }
+            result = ::poll(&descriptor, 1, static_cast<int>(remaining.count()));
+        } while (result < 0 && errno == EINTR);
+        return result > 0 && (descriptor.revents & POLLIN);
+    }
+
+    // Reads every queued message, returns true if one of them was about a display device.
+    [[nodiscard]] bool drain() {
+        bool display{ false };
+        while (true) {
+            const ssize_t size = ::recv(m_fd, m_buffer, sizeof(m_buffer), MSG_DONTWAIT);
+            if (size < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // ENOBUFS means uevents were dropped, one of them may have been ours.
+                return display || errno == ENOBUFS;
+            }
+            if (isDisplayUevent(std::string_view{ m_buffer, static_cast<std::size_t>(size) })) {
+                display = true;
+            }
+        }
+    }
+
+    int m_fd{ -1 };
+    char m_buffer[kUeventBufferSize]{};
+};
+
+change_source_ptr_t createUeventChangeSource() {
+    const int fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) {
+        std::wcerr << L"Failed to create the uevent socket: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        return nullptr;
+    }
+    sockaddr_nl address{};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = kKernelUeventGroup;
+    if (::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        std::wcerr << L"Failed to bind the uevent socket: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        ::close(fd);
+        return nullptr;
+    }
+    return std::make_shared<UeventChangeSource>(fd);
+}
+
+} // namespace gputester
@@ -0,0 +1,147 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "change_source.hpp"
+#include "registry.hpp"
+#include "win32.hpp"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gputester {
+
+using namespace m4x1m1l14n;
+
+// Connecting a display rewrites several values in a row, they are collected into one change: it is
+// over once nothing changed for kSettleTime, or after kMaxSettleTime at the latest.
+static constexpr const std::chrono::milliseconds kSettleTime{ 100 };
+static constexpr const std::chrono::milliseconds kMaxSettleTime{ 1000 };
+
+class RegistryChangeSource final : public ChangeSource {
+public:
+    RegistryChangeSource() = default;
+    ~RegistryChangeSource() override {
+        for (auto&& watch : std::as_const(m_watches)) {
+            ::CloseHandle(watch.event);
+        }
+    }
+
+    // Watches "path" and all of its subkeys. A key which doesn't exist on this system is skipped.
+    [[nodiscard]] bool add(const Registry::RegistryKey_ptr& root, const std::wstring& path) {
+        Registry::RegistryKey_ptr key{};
+        try {
+            key = root->Open(path, Registry::DesiredAccess::Notify);
+        } catch (const std::exception&) {
+            return false;
+        }
+        const HANDLE event = ::CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        if (!event) {
+            std::wcerr << L"\"CreateEventW\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            return false;
+        }
+        m_watches.push_back({ std::move(key), event });
+        if (!arm(m_watches.back())) {
+            ::CloseHandle(event);
+            m_watches.pop_back();
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_watches.empty();
+    }
+
+    [[nodiscard]] bool wait(const std::chrono::milliseconds timeout) override {
+        if (!waitOne(timeout)) {
+            return false;
+        }
+        const auto settleDeadline = std::chrono::steady_clock::now() + kMaxSettleTime;
+        while (true) {
+            const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(settleDeadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0 || !waitOne(std::min(remaining, kSettleTime))) {
+                break;
+            }
+            // Re-armed by waitOne(), keep going until the burst is over.
+        }
+        return true;
+    }
+
+private:
+    struct Watch final {
+        Registry::RegistryKey_ptr key{};
+        HANDLE event{ nullptr };
+    };
+
+    // A notification fires once, it has to be requested again after every change.
+    [[nodiscard]] static bool arm(const Watch& watch) {
+        try {
+            watch.key->NotifyAsync(watch.event, true);
+        } catch (const std::exception& ex) {
+            std::wcerr << L"Failed to watch the registry: " << ex.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool waitOne(const std::chrono::milliseconds timeout) {
+        std::vector<HANDLE> events{};
+        events.reserve(m_watches.size());
+        for (auto&& watch : std::as_const(m_watches)) {
+            events.push_back(watch.event);
+        }
+        const DWORD result = ::WaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(), FALSE, static_cast<DWORD>(timeout.count()));
+        if (result >= WAIT_OBJECT_0 + events.size()) {
+            if (result == WAIT_FAILED) {
+                std::wcerr << L"\"WaitForMultipleObjects\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            }
+            return false;
+        }
+        std::ignore = arm(m_watches[result - WAIT_OBJECT_0]);
+        return true;
+    }
+
+    std::vector<Watch> m_watches{};
+};
+
+change_source_ptr_t createRegistryChangeSource() {
+    auto source = std::make_shared<RegistryChangeSource>();
+    // The display adapter device class: driver installs, updates and rollbacks.
+    std::ignore = source->add(Registry::LocalMachine, L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4d36e968-e325-11ce-bfc1-08002be10318}");
+    // The display configuration database: topology, modes, refresh rates and HDR.
+    std::ignore = source->add(Registry::LocalMachine, L"SYSTEM\\CurrentControlSet\\Control\\GraphicsDrivers\\Configuration");
+    // The per monitor scale factors.
+    std::ignore = source->add(Registry::CurrentUser, L"Control Panel\\Desktop\\PerMonitorSettings");
+    if (source->empty()) {
+        std::wcerr << L"None of the display related registry keys can be watched." << std::endl;
+        return nullptr;
+    }
+    return source;
+}
+
+} // namespace gputester
@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "console.hpp"
+#ifdef _WIN32
+#  include "win32.hpp"
+#else
+#  include "text.hpp"
+#  include <unistd.h>
+#  include <cerrno>
+#  include <cstring>
+#endif
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+namespace gputester {
+
+bool isStdoutTerminal() {
+#ifdef _WIN32
+    const HANDLE handle = ::GetStdHandle(STD_OUTPUT_HANDLE);
+    if (!handle || (handle == INVALID_HANDLE_VALUE)) {
+        return false;
+    }
+    DWORD dwMode{ 0 };
+    return ::GetConsoleMode(handle, &dwMode);
+#else
+    return ::isatty(STDOUT_FILENO) == 1;
+#endif
+}
+
+bool writeStdout(const std::string_view data) {
+#ifdef _WIN32
+    const HANDLE handle = ::GetStdHandle(STD_OUTPUT_HANDLE);
+    if (!handle || (handle == INVALID_HANDLE_VALUE)) {
+        return false;
+    }
+    // The console code page is UTF-8 already, so the bytes can go out unchanged.
+    for (std::size_t offset = 0; offset != data.size();) {
+        const auto chunk = static_cast<DWORD>(std::min<std::size_t>(data.size() - offset, UINT32_MAX));
+        DWORD written{ 0 };
+        if (!::WriteFile(handle, data.data() + offset, chunk, &written, nullptr)) {
+            std::wcerr << L"\"WriteFile\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            return false;
+        }
+        offset += written;
+    }
+    return true;
+#else
+    for (std::size_t offset = 0; offset != data.size();) {
+        const ssize_t written = ::write(STDOUT_FILENO, data.data() + offset, data.size() - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::wcerr << L"\"write\" failed: " << utf8ToWide(std::strerror(errno)) << std::endl;
+            return false;
+        }
+        offset += static_cast<std::size_t>(written);
+    }
+    return true;
+#endif
+}
+
+} // namespace gputester
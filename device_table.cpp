@@ -0,0 +1,364 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "device_table.hpp"
+#include "registry.hpp"
+#include "text.hpp"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <tuple>
+#include <utility>
+
+using namespace m4x1m1l14n;
+
+namespace gputester {
+
+// GUID_DEVCLASS_DISPLAY
+static constexpr const std::wstring_view kDisplayClassGuid{ L"{4d36e968-e325-11ce-bfc1-08002be10318}" };
+
+// Lower case ASCII, trimmed, with every whitespace run collapsed to a single space.
+[[nodiscard]] static inline std::wstring normalizeDescription(const std::wstring_view description) {
+    std::wstring result{};
+    result.reserve(description.size());
+    bool pendingSpace{ false };
+    for (const wchar_t ch : description) {
+        if (ch == L' ' || ch == L'\t' || ch == L'\r' || ch == L'\n' || ch == L'\0') {
+            pendingSpace = !result.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            result.push_back(L' ');
+            pendingSpace = false;
+        }
+        result.push_back((ch >= L'A' && ch <= L'Z') ? static_cast<wchar_t>(ch - L'A' + L'a') : ch);
+    }
+    return result;
+}
+
+// FNV-1a over the low two bytes of every character, the same on every platform for BMP text.
+[[nodiscard]] static inline std::uint64_t hashDescription(const std::wstring_view normalized) {
+    std::uint64_t hash{ 14695981039346656037ull };
+    for (const wchar_t ch : normalized) {
+        const auto unit = static_cast<std::uint32_t>(ch);
+        hash = (hash ^ (unit & 0xFF)) * 1099511628211ull;
+        hash = (hash ^ ((unit >> 8) & 0xFF)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+FakeSetupApiProvider::FakeSetupApiProvider(std::vector<Device> devices, const std::chrono::nanoseconds callLatency)
+    : m_devices(std::move(devices)), m_callLatency(callLatency) {}
+
+void FakeSetupApiProvider::onCall() {
+    ++m_callCount;
+    if (m_callLatency.count() <= 0) {
+        return;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + m_callLatency;
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+bool FakeSetupApiProvider::open() {
+    onCall();
+    return true;
+}
+
+void FakeSetupApiProvider::close() {
+    onCall();
+}
+
+bool FakeSetupApiProvider::hasDevice(const std::uint32_t index) {
+    onCall();
+    return index < m_devices.size();
+}
+
+bool FakeSetupApiProvider::getProperty(const std::uint32_t index, const device_property_t property, std::wstring& valueOut) {
+    onCall();
+    if (index >= m_devices.size()) {
+        return false;
+    }
+    const Device& device = m_devices[index];
+    const std::wstring* value{ nullptr };
+    switch (property) {
+        case device_property_t::DriverDesc:
+            value = &device.driverDesc;
+            break;
+        case device_property_t::Driver:
+            value = &device.driver;
+            break;
+        case device_property_t::DriverProvider:
+            value = &device.driverProvider;
+            break;
+        case device_property_t::DriverVersion:
+            value = &device.driverVersion;
+            break;
+        case device_property_t::DriverDate:
+            value = &device.driverDate;
+            break;
+    }
+    if (!value || value->empty()) { // An empty property is treated as a missing one.
+        return false;
+    }
+    valueOut = *value;
+    return true;
+}
+
+std::size_t FakeSetupApiProvider::callCount() const {
+    return m_callCount.load();
+}
+
+void FakeSetupApiProvider::resetCallCount() {
+    m_callCount = 0;
+}
+
+// The class key has the driver date as the INF wrote it, "month-day-year". SetupAPI hands it out as "year-month-day".
+[[nodiscard]] static inline std::optional<std::wstring> convertDriverDate(const std::wstring_view date) {
+    std::uint32_t parts[3]{};
+    std::size_t part{ 0 };
+    bool hasDigits{ false };
+    for (const wchar_t ch : date) {
+        if (ch >= L'0' && ch <= L'9') {
+            if (parts[part] > 9999) {
+                return std::nullopt;
+            }
+            parts[part] = parts[part] * 10 + static_cast<std::uint32_t>(ch - L'0');
+            hasDigits = true;
+        } else if ((ch == L'-' || ch == L'/') && hasDigits && part != 2) {
+            ++part;
+            hasDigits = false;
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (part != 2 || !hasDigits) {
+        return std::nullopt;
+    }
+    return std::to_wstring(parts[2]) + L'-' + std::to_wstring(parts[0]) + L'-' + std::to_wstring(parts[1]);
+}
+
+class RegistrySetupApiProvider final : public SetupApiProvider {
+public:
+    explicit RegistrySetupApiProvider(Registry::RegistryKey_ptr system) : m_system(std::move(system)) {}
+    ~RegistrySetupApiProvider() override = default;
+
+    [[nodiscard]] bool open() override {
+        close();
+        try {
+            const Registry::RegistryKey_ptr classKey = m_system->Open(L"CurrentControlSet\\Control\\Class\\" + std::wstring(kDisplayClassGuid));
+            std::vector<std::wstring> names{};
+            classKey->EnumerateSubKeys([&names](const std::wstring& name) {
+                // Driver instances are numbered "0000", "0001" and so on, next to keys like "Properties".
+                if (name.size() == 4 && std::all_of(name.begin(), name.end(), [](const wchar_t ch) { return ch >= L'0' && ch <= L'9'; })) {
+                    names.push_back(name);
+                }
+                return true;
+            });
+            for (auto&& name : names) {
+                m_devices.push_back({ name, classKey->Open(name) });
+            }
+        } catch (const std::exception& ex) {
+            std::wcerr << L"Failed to read the display device class from the registry: " << ex.what() << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() override {
+        m_devices.clear();
+    }
+
+    [[nodiscard]] bool hasDevice(const std::uint32_t index) override {
+        return index < m_devices.size();
+    }
+
+    [[nodiscard]] bool getProperty(const std::uint32_t index, const device_property_t property, std::wstring& valueOut) override {
+        if (index >= m_devices.size()) {
+            return false;
+        }
+        const Device& device = m_devices[index];
+        const wchar_t* valueName{ nullptr };
+        switch (property) {
+            case device_property_t::DriverDesc:
+                valueName = L"DriverDesc";
+                break;
+            case device_property_t::Driver:
+                valueOut = std::wstring(kDisplayClassGuid) + L'\\' + device.name;
+                return true;
+            case device_property_t::DriverProvider:
+                valueName = L"ProviderName";
+                break;
+            case device_property_t::DriverVersion:
+                valueName = L"DriverVersion";
+                break;
+            case device_property_t::DriverDate:
+                valueName = L"DriverDate";
+                break;
+        }
+        if (!valueName) {
+            return false;
+        }
+        std::wstring value{};
+        try {
+            std::optional<std::wstring> found = device.key->TryGetString(valueName);
+            if (!found) {
+                return false;
+            }
+            value = std::move(found.value());
+        } catch (const std::exception&) {
+            return false;
+        }
+        if (value.empty()) { // An empty property is treated as a missing one.
+            return false;
+        }
+        if (property == device_property_t::DriverDate) {
+            std::optional<std::wstring> date = convertDriverDate(value);
+            if (!date) {
+                return false;
+            }
+            value = std::move(date.value());
+        }
+        valueOut = std::move(value);
+        return true;
+    }
+
+private:
+    struct Device final {
+        std::wstring name{};
+        Registry::RegistryKey_ptr key{};
+    };
+
+    Registry::RegistryKey_ptr m_system{};
+    std::vector<Device> m_devices{};
+};
+
+setupapi_provider_ptr_t createRegistrySetupApiProvider(Registry::RegistryKey_ptr system) {
+    if (!system) {
+        return nullptr;
+    }
+    return std::make_shared<RegistrySetupApiProvider>(std::move(system));
+}
+
+DeviceTable::~DeviceTable() {
+    clear();
+}
+
+bool DeviceTable::build(SetupApiProvider& provider) {
+    clear();
+    if (!provider.open()) {
+        return false;
+    }
+    m_provider = &provider;
+    std::wstring value{};
+    for (std::uint32_t index = 0; provider.hasDevice(index); ++index) {
+        if (!provider.getProperty(index, device_property_t::DriverDesc, value)) {
+            continue;
+        }
+        std::wstring normalized = normalizeDescription(value);
+        m_descriptionIndex.push_back({ hashDescription(normalized), static_cast<std::uint32_t>(m_driverDescs.size()) });
+        m_deviceIndices.push_back(index);
+        m_normalizedDescs.push_back(std::move(normalized));
+        m_driverDescs.push_back(std::move(value));
+        value.clear();
+    }
+    const std::size_t rowCount = m_driverDescs.size();
+    m_drivers.resize(rowCount);
+    m_driverProviders.resize(rowCount);
+    m_driverVersions.resize(rowCount);
+    m_driverDates.resize(rowCount);
+    m_states.resize(rowCount, row_state_t::Unread);
+    // Rows are pushed in order, a stable sort keeps the first device first among equal hashes.
+    std::stable_sort(m_descriptionIndex.begin(), m_descriptionIndex.end(), [](const HashEntry& lhs, const HashEntry& rhs) {
+        return lhs.hash < rhs.hash;
+    });
+    return true;
+}
+
+void DeviceTable::clear() {
+    if (m_provider) {
+        m_provider->close();
+        m_provider = nullptr;
+    }
+    m_descriptionIndex.clear();
+    m_deviceIndices.clear();
+    m_normalizedDescs.clear();
+    m_driverDescs.clear();
+    m_drivers.clear();
+    m_driverProviders.clear();
+    m_driverVersions.clear();
+    m_driverDates.clear();
+    m_states.clear();
+}
+
+bool DeviceTable::readProperties(const std::uint32_t row) {
+    if (m_states[row] == row_state_t::Unread) {
+        const std::uint32_t index = m_deviceIndices[row];
+        // The driver key is optional, only the AMD version needs it.
+        std::ignore = m_provider->getProperty(index, device_property_t::Driver, m_drivers[row]);
+        const bool complete = m_provider->getProperty(index, device_property_t::DriverProvider, m_driverProviders[row])
+                              && m_provider->getProperty(index, device_property_t::DriverVersion, m_driverVersions[row])
+                              && m_provider->getProperty(index, device_property_t::DriverDate, m_driverDates[row]);
+        m_states[row] = complete ? row_state_t::Complete : row_state_t::Incomplete;
+    }
+    return m_states[row] == row_state_t::Complete;
+}
+
+std::optional<DeviceTableRow> DeviceTable::find(const std::wstring_view description) {
+    if (description.empty()) {
+        return std::nullopt;
+    }
+    std::optional<std::uint32_t> row{};
+    const std::wstring normalized = normalizeDescription(description);
+    const std::uint64_t hash = hashDescription(normalized);
+    const auto [first, last] = std::equal_range(m_descriptionIndex.cbegin(), m_descriptionIndex.cend(), HashEntry{ hash, 0 },
+                                                [](const HashEntry& lhs, const HashEntry& rhs) { return lhs.hash < rhs.hash; });
+    for (auto it = first; it != last; ++it) {
+        // The first device wins, like the old linear walk. Comparing the text rules out hash collisions.
+        if (m_normalizedDescs[it->row] == normalized) {
+            row = it->row;
+            break;
+        }
+    }
+    if (!row) {
+        for (std::uint32_t index = 0; index != m_driverDescs.size(); ++index) {
+            if (findIgnoringCase(m_driverDescs[index], description) != std::wstring_view::npos) {
+                row = index;
+                break;
+            }
+        }
+    }
+    if (!row || !readProperties(row.value())) {
+        return std::nullopt;
+    }
+    const std::uint32_t index = row.value();
+    return DeviceTableRow{ m_driverDescs[index], m_drivers[index], m_driverProviders[index], m_driverVersions[index], m_driverDates[index] };
+}
+
+std::size_t DeviceTable::size() const {
+    return m_driverDescs.size();
+}
+
+} // namespace gputester
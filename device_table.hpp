@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace m4x1m1l14n::Registry {
+class RegistryKey;
+}
+
+namespace gputester {
+
+// The DEVPKEY_Device_* properties getDriverInfo() needs.
+enum class device_property_t : std::uint8_t {
+    DriverDesc,
+    Driver, // The driver key name under HKLM\SYSTEM\CurrentControlSet\Control\Class.
+    DriverProvider,
+    DriverVersion,
+    DriverDate // Formatted as "year-month-day".
+};
+
+// The SetupAPI calls getDriverInfo() makes, abstracted so the device table can be built from a fake.
+class SetupApiProvider {
+public:
+    SetupApiProvider() = default;
+    virtual ~SetupApiProvider() = default;
+    SetupApiProvider(const SetupApiProvider&) = delete;
+    SetupApiProvider& operator=(const SetupApiProvider&) = delete;
+
+    // SetupDiGetClassDevsW(GUID_DEVCLASS_DISPLAY, DIGCF_PRESENT), the device list stays valid until close().
+    [[nodiscard]] virtual bool open() = 0;
+    virtual void close() = 0;
+    // SetupDiEnumDeviceInfo
+    [[nodiscard]] virtual bool hasDevice(const std::uint32_t index) = 0;
+    // SetupDiGetDevicePropertyW
+    [[nodiscard]] virtual bool getProperty(const std::uint32_t index, const device_property_t property, std::wstring& valueOut) = 0;
+};
+using setupapi_provider_ptr_t = std::shared_ptr<SetupApiProvider>;
+
+#ifdef _WIN32
+[[nodiscard]] setupapi_provider_ptr_t createWin32SetupApiProvider();
+#endif
+
+// Serves a fixed list of display devices and counts the calls made to it.
+class FakeSetupApiProvider final : public SetupApiProvider {
+public:
+    struct Device final {
+        std::wstring driverDesc{};
+        std::wstring driver{};
+        std::wstring driverProvider{};
+        std::wstring driverVersion{};
+        std::wstring driverDate{};
+    };
+
+    // "callLatency" is spent busy waiting in every call, to model the cost of the real API.
+    explicit FakeSetupApiProvider(std::vector<Device> devices, const std::chrono::nanoseconds callLatency = {});
+    ~FakeSetupApiProvider() override = default;
+
+    [[nodiscard]] bool open() override;
+    void close() override;
+    [[nodiscard]] bool hasDevice(const std::uint32_t index) override;
+    [[nodiscard]] bool getProperty(const std::uint32_t index, const device_property_t property, std::wstring& valueOut) override;
+
+    [[nodiscard]] std::size_t callCount() const;
+    void resetCallCount();
+
+private:
+    void onCall();
+
+    std::vector<Device> m_devices{};
+    std::chrono::nanoseconds m_callLatency{};
+    std::atomic<std::size_t> m_callCount{ 0 };
+};
+
+// Reads the display device class key instead, under "system": HKEY_LOCAL_MACHINE\SYSTEM or an offline
+// copy of it (see openRegistryHive()). Lists every display driver instance the registry knows, present or not.
+[[nodiscard]] setupapi_provider_ptr_t createRegistrySetupApiProvider(std::shared_ptr<m4x1m1l14n::Registry::RegistryKey> system);
+
+struct DeviceTableRow final {
+    std::wstring driverDesc{};
+    std::wstring driver{};
+    std::wstring driverProvider{};
+    std::wstring driverVersion{};
+    std::wstring driverDate{};
+};
+
+// Every present display device, read in a single pass over the SetupAPI device list. Only the
+// descriptions are read up front, the other driver properties of a device are read the first time
+// find() returns it and kept from then on. The columns are kept as separate arrays, and the
+// description lookup is a binary search over (hash, row) pairs sorted by hash.
+class DeviceTable final {
+public:
+    DeviceTable() = default;
+    ~DeviceTable();
+    DeviceTable(const DeviceTable&) = delete;
+    DeviceTable& operator=(const DeviceTable&) = delete;
+
+    // Leaves the provider open for find(), it has to outlive the table or the next clear().
+    [[nodiscard]] bool build(SetupApiProvider& provider);
+    // Closes the provider the table was built from.
+    void clear();
+    // Finds the device whose description matches the adapter description, ignoring case and
+    // redundant whitespace. Falls back to a substring search, which ignores case too, when nothing matches.
+    // Devices lacking the provider, version or date properties are never returned.
+    [[nodiscard]] std::optional<DeviceTableRow> find(const std::wstring_view description);
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    struct HashEntry final {
+        std::uint64_t hash{ 0 };
+        std::uint32_t row{ 0 };
+    };
+
+    enum class row_state_t : std::uint8_t {
+        Unread,
+        Complete,
+        Incomplete
+    };
+
+    [[nodiscard]] bool readProperties(const std::uint32_t row);
+
+    SetupApiProvider* m_provider{ nullptr };
+    std::vector<HashEntry> m_descriptionIndex{}; // Sorted by hash, then by row.
+    std::vector<std::uint32_t> m_deviceIndices{}; // The SetupAPI index of every row.
+    std::vector<std::wstring> m_normalizedDescs{}; // To rule out hash collisions.
+    std::vector<std::wstring> m_driverDescs{};
+    std::vector<std::wstring> m_drivers{};
+    std::vector<std::wstring> m_driverProviders{};
+    std::vector<std::wstring> m_driverVersions{};
+    std::vector<std::wstring> m_driverDates{};
+    std::vector<row_state_t> m_states{};
+};
+
+} // namespace gputester
@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "device_table.hpp"
+#include "win32.hpp"
+#include <algorithm>
+
+namespace gputester {
+
+class Win32SetupApiProvider final : public SetupApiProvider {
+public:
+    Win32SetupApiProvider() = default;
+    ~Win32SetupApiProvider() override {
+        close();
+    }
+
+    [[nodiscard]] bool open() override {
+        close();
+        if (!SETUPAPI_API(SetupDiGetClassDevsW) || !SETUPAPI_API(SetupDiDestroyDeviceInfoList) || !SETUPAPI_API(SetupDiEnumDeviceInfo) || !SETUPAPI_API(SetupDiGetDevicePropertyW)) {
+            return false;
+        }
+        const HDEVINFO hDevInfo = SETUPAPI_API(SetupDiGetClassDevsW)(&GUID_DEVCLASS_DISPLAY, nullptr, nullptr, DIGCF_PRESENT);
+        if (!hDevInfo || hDevInfo == INVALID_HANDLE_VALUE) {
+            std::wcerr << L"\"SetupDiGetClassDevsW\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            return false;
+        }
+        m_devInfo = hDevInfo;
+        return true;
+    }
+
+    void close() override {
+        if (m_devInfo) {
+            SETUPAPI_API(SetupDiDestroyDeviceInfoList)(m_devInfo);
+            m_devInfo = nullptr;
+        }
+        m_deviceIndex.reset();
+    }
+
+    [[nodiscard]] bool hasDevice(const std::uint32_t index) override {
+        return selectDevice(index);
+    }
+
+    [[nodiscard]] bool getProperty(const std::uint32_t index, const device_property_t property, std::wstring& valueOut) override {
+        if (!selectDevice(index)) {
+            return false;
+        }
+        DEVPROPTYPE dataType{ 0 };
+        if (property == device_property_t::DriverDate) {
+            FILETIME fileTime{};
+            if (!SETUPAPI_API(SetupDiGetDevicePropertyW)(m_devInfo, &m_deviceInfoData, &DEVPKEY_Device_DriverDate, &dataType, reinterpret_cast<PBYTE>(&fileTime), sizeof(fileTime), nullptr, 0)) {
+                return false;
+            }
+            SYSTEMTIME systemTime{};
+            FileTimeToSystemTime(&fileTime, &systemTime);
+            valueOut = std::to_wstring(systemTime.wYear) + L'-' + std::to_wstring(systemTime.wMonth) + L'-' + std::to_wstring(systemTime.wDay);
+            return true;
+        }
+        const DEVPROPKEY* key{ nullptr };
+        switch (property) {
+            case device_property_t::DriverDesc:
+                key = &DEVPKEY_Device_DriverDesc;
+                break;
+            case device_property_t::Driver:
+                key = &DEVPKEY_Device_Driver;
+                break;
+            case device_property_t::DriverProvider:
+                key = &DEVPKEY_Device_DriverProvider;
+                break;
+            case device_property_t::DriverVersion:
+                key = &DEVPKEY_Device_DriverVersion;
+                break;
+            default:
+                return false;
+        }
+        // The size is in bytes, the buffer is reused across all properties of all devices.
+        std::fill(m_buffer.begin(), m_buffer.end(), L'\0');
+        if (!SETUPAPI_API(SetupDiGetDevicePropertyW)(m_devInfo, &m_deviceInfoData, key, &dataType, reinterpret_cast<PBYTE>(m_buffer.data()), static_cast<DWORD>(m_buffer.size() * sizeof(wchar_t)), nullptr, 0)) {
+            return false;
+        }
+        valueOut.assign(m_buffer.c_str());
+        return true;
+    }
+
+private:
+    [[nodiscard]] bool selectDevice(const std::uint32_t index) {
+        if (!m_devInfo) {
+            return false;
+        }
+        if (m_deviceIndex == index) {
+            return true;
+        }
+        m_deviceInfoData = {};
+        m_deviceInfoData.cbSize = sizeof(m_deviceInfoData);
+        if (!SETUPAPI_API(SetupDiEnumDeviceInfo)(m_devInfo, index, &m_deviceInfoData)) {
+            m_deviceIndex.reset();
+            return false;
+        }
+        m_deviceIndex = index;
+        return true;
+    }
+
+    HDEVINFO m_devInfo{ nullptr };
+    SP_DEVINFO_DATA m_deviceInfoData{};
+    std::optional<std::uint32_t> m_deviceIndex{};
+    std::wstring m_buffer = std::wstring(512, L'\0');
+};
+
+setupapi_provider_ptr_t createWin32SetupApiProvider() {
+    return std::make_shared<Win32SetupApiProvider>();
+}
+
+} // namespace gputester
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "display_config.hpp"
+#include <utility>
+
+namespace gputester {
+
+FakeDisplayConfigProvider::FakeDisplayConfigProvider(std::vector<Display> displays) : m_displays(std::move(displays)) {}
+
+bool FakeDisplayConfigProvider::queryActivePaths(std::vector<DisplayConfigPath>& pathsOut) {
+    ++m_callCount;
+    pathsOut.clear();
+    pathsOut.reserve(m_displays.size());
+    for (std::size_t index = 0; index != m_displays.size(); ++index) {
+        const Display& display = m_displays[index];
+        DisplayConfigPath path{};
+        path.sourceAdapterLuid = 1;
+        path.sourceId = static_cast<std::uint32_t>(index);
+        path.targetAdapterLuid = 1;
+        path.targetId = static_cast<std::uint32_t>(index);
+        path.refreshRateNumerator = display.refreshRateNumerator;
+        path.refreshRateDenominator = display.refreshRateDenominator;
+        pathsOut.push_back(path);
+    }
+    return true;
+}
+
+bool FakeDisplayConfigProvider::getSourceName(const DisplayConfigPath& path, std::wstring& nameOut) {
+    ++m_callCount;
+    if (path.sourceId >= m_displays.size()) {
+        return false;
+    }
+    nameOut = m_displays[path.sourceId].gdiDeviceName;
+    return true;
+}
+
+bool FakeDisplayConfigProvider::getTargetName(const DisplayConfigPath& path, DisplayConfigTargetName& nameOut) {
+    ++m_callCount;
+    if (path.targetId >= m_displays.size()) {
+        return false;
+    }
+    nameOut.friendlyName = m_displays[path.targetId].friendlyName;
+    nameOut.monitorDevicePath = m_displays[path.targetId].monitorDevicePath;
+    return true;
+}
+
+bool FakeDisplayConfigProvider::getSdrWhiteLevel(const DisplayConfigPath& path, std::uint32_t& levelOut) {
+    ++m_callCount;
+    if (path.targetId >= m_displays.size()) {
+        return false;
+    }
+    levelOut = m_displays[path.targetId].sdrWhiteLevel;
+    return true;
+}
+
+std::size_t FakeDisplayConfigProvider::callCount() const {
+    return m_callCount.load();
+}
+
+void FakeDisplayConfigProvider::resetCallCount() {
+    m_callCount = 0;
+}
+
+bool DisplayTopology::build(DisplayConfigProvider& provider) {
+    m_entries.clear();
+    std::vector<DisplayConfigPath> paths{};
+    if (!provider.queryActivePaths(paths)) {
+        return false;
+    }
+    std::wstring name{};
+    for (auto&& path : std::as_const(paths)) {
+        if (!provider.getSourceName(path, name)) {
+            continue;
+        }
+        // Cloned outputs have several paths, the first one which answers wins, like before.
+        DisplayTopologyEntry& entry = m_entries[name];
+        if (!entry.sdrWhiteLevel) {
+            std::uint32_t level{ 0 };
+            if (provider.getSdrWhiteLevel(path, level)) {
+                entry.sdrWhiteLevel = static_cast<float>(level) / 1000.f * 80.f; // MSDN told me this formula ...
+            }
+        }
+        if (!entry.refreshRate && path.refreshRateNumerator > 0 && path.refreshRateDenominator > 0) {
+            entry.refreshRate = static_cast<float>(path.refreshRateNumerator) / static_cast<float>(path.refreshRateDenominator);
+        }
+        if (!entry.friendlyName || !entry.monitorDevicePath) {
+            DisplayConfigTargetName targetName{};
+            if (provider.getTargetName(path, targetName)) {
+                if (!entry.friendlyName) {
+                    entry.friendlyName = std::move(targetName.friendlyName);
+                }
+                if (!entry.monitorDevicePath && !targetName.monitorDevicePath.empty()) {
+                    entry.monitorDevicePath = std::move(targetName.monitorDevicePath);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void DisplayTopology::clear() {
+    m_entries.clear();
+}
+
+const DisplayTopologyEntry* DisplayTopology::find(const std::wstring& gdiDeviceName) const {
+    const auto it = m_entries.find(gdiDeviceName);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+std::size_t DisplayTopology::size() const {
+    return m_entries.size();
+}
+
+} // namespace gputester
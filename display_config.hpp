@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gputester {
+
+// A platform neutral copy of the DISPLAYCONFIG_PATH_INFO fields we need.
+struct DisplayConfigPath final {
+    std::uint64_t sourceAdapterLuid{ 0 };
+    std::uint32_t sourceId{ 0 };
+    std::uint64_t targetAdapterLuid{ 0 };
+    std::uint32_t targetId{ 0 };
+    std::uint32_t refreshRateNumerator{ 0 };
+    std::uint32_t refreshRateDenominator{ 0 };
+};
+
+// DISPLAYCONFIG_TARGET_DEVICE_NAME
+struct DisplayConfigTargetName final {
+    std::wstring friendlyName{};
+    // The device interface path of the monitor such as
+    // "\\?\DISPLAY#DEL4109#5&2f7ce4f&0&UID4352#{e6f07b5f-ee97-4a90-b076-33f57bf4eaa7}", empty if unknown.
+    std::wstring monitorDevicePath{};
+};
+
+// The QueryDisplayConfig() family, abstracted so the topology index can be built from a fake.
+class DisplayConfigProvider {
+public:
+    DisplayConfigProvider() = default;
+    virtual ~DisplayConfigProvider() = default;
+    DisplayConfigProvider(const DisplayConfigProvider&) = delete;
+    DisplayConfigProvider& operator=(const DisplayConfigProvider&) = delete;
+
+    // QDC_ONLY_ACTIVE_PATHS
+    [[nodiscard]] virtual bool queryActivePaths(std::vector<DisplayConfigPath>& pathsOut) = 0;
+    // DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME, the GDI device name such as "\\.\DISPLAY1".
+    [[nodiscard]] virtual bool getSourceName(const DisplayConfigPath& path, std::wstring& nameOut) = 0;
+    // DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_NAME
+    [[nodiscard]] virtual bool getTargetName(const DisplayConfigPath& path, DisplayConfigTargetName& nameOut) = 0;
+    // DISPLAYCONFIG_DEVICE_INFO_GET_SDR_WHITE_LEVEL, in thousandths of 80 nits.
+    [[nodiscard]] virtual bool getSdrWhiteLevel(const DisplayConfigPath& path, std::uint32_t& levelOut) = 0;
+};
+using display_config_provider_ptr_t = std::shared_ptr<DisplayConfigProvider>;
+
+#ifdef _WIN32
+[[nodiscard]] display_config_provider_ptr_t createWin32DisplayConfigProvider();
+#endif
+
+// Serves one active path per display and counts the calls made to it.
+class FakeDisplayConfigProvider final : public DisplayConfigProvider {
+public:
+    struct Display final {
+        std::wstring gdiDeviceName{};
+        std::wstring friendlyName{};
+        std::wstring monitorDevicePath{};
+        std::uint32_t sdrWhiteLevel{ 1000 };
+        std::uint32_t refreshRateNumerator{ 60 };
+        std::uint32_t refreshRateDenominator{ 1 };
+    };
+
+    explicit FakeDisplayConfigProvider(std::vector<Display> displays);
+    ~FakeDisplayConfigProvider() override = default;
+
+    [[nodiscard]] bool queryActivePaths(std::vector<DisplayConfigPath>& pathsOut) override;
+    [[nodiscard]] bool getSourceName(const DisplayConfigPath& path, std::wstring& nameOut) override;
+    [[nodiscard]] bool getTargetName(const DisplayConfigPath& path, DisplayConfigTargetName& nameOut) override;
+    [[nodiscard]] bool getSdrWhiteLevel(const DisplayConfigPath& path, std::uint32_t& levelOut) override;
+
+    [[nodiscard]] std::size_t callCount() const;
+    void resetCallCount();
+
+private:
+    std::vector<Display> m_displays{};
+    std::atomic<std::size_t> m_callCount{ 0 };
+};
+
+struct DisplayTopologyEntry final {
+    std::optional<float> sdrWhiteLevel{}; // In nits.
+    std::optional<float> refreshRate{};
+    std::optional<std::wstring> friendlyName{};
+    std::optional<std::wstring> monitorDevicePath{};
+};
+
+// One snapshot of the active display paths, indexed by GDI device name. Building it costs
+// O(paths) provider calls, after that every output is a hash lookup instead of a new query.
+class DisplayTopology final {
+public:
+    [[nodiscard]] bool build(DisplayConfigProvider& provider);
+    void clear();
+    [[nodiscard]] const DisplayTopologyEntry* find(const std::wstring& gdiDeviceName) const;
+    [[nodiscard]] std::size_t size() const;
+
+private:
+    std::unordered_map<std::wstring, DisplayTopologyEntry> m_entries{};
+};
+
+} // namespace gputester
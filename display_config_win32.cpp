@@ -0,0 +1,153 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "display_config.hpp"
+#include "win32.hpp"
+#include <utility>
+
+namespace gputester {
+
+using path_info_t = std::vector<DISPLAYCONFIG_PATH_INFO>;
+using mode_info_t = std::vector<DISPLAYCONFIG_MODE_INFO>;
+
+[[nodiscard]] static inline std::uint64_t luidToUInt64(const LUID& luid) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(luid.HighPart)) << 32) | luid.LowPart;
+}
+
+[[nodiscard]] static inline LUID uint64ToLuid(const std::uint64_t value) {
+    LUID luid{};
+    luid.LowPart = static_cast<DWORD>(value & 0xFFFFFFFF);
+    luid.HighPart = static_cast<LONG>(value >> 32);
+    return luid;
+}
+
+class Win32DisplayConfigProvider final : public DisplayConfigProvider {
+public:
+    Win32DisplayConfigProvider() = default;
+    ~Win32DisplayConfigProvider() override = default;
+
+    [[nodiscard]] bool queryActivePaths(std::vector<DisplayConfigPath>& pathsOut) override {
+        pathsOut.clear();
+        if (!USER32_API(GetDisplayConfigBufferSizes) || !USER32_API(QueryDisplayConfig)) {
+            return false;
+        }
+        path_info_t pathInfos{};
+        std::uint32_t pathInfoCount{ 0 };
+        std::uint32_t modeInfoCount{ 0 };
+        LONG result{ ERROR_SUCCESS };
+        do {
+            if (USER32_API(GetDisplayConfigBufferSizes)(QDC_ONLY_ACTIVE_PATHS, &pathInfoCount, &modeInfoCount) == ERROR_SUCCESS) {
+                pathInfos.resize(pathInfoCount);
+                mode_info_t modeInfos(modeInfoCount);
+                result = USER32_API(QueryDisplayConfig)(QDC_ONLY_ACTIVE_PATHS, &pathInfoCount, pathInfos.data(), &modeInfoCount, modeInfos.data(), nullptr);
+            } else {
+                std::wcerr << L"\"GetDisplayConfigBufferSizes\" failed: " << getLastWin32ErrorMessage() << std::endl;
+                return false;
+            }
+        } while (result == ERROR_INSUFFICIENT_BUFFER);
+        if (result != ERROR_SUCCESS) {
+            std::wcerr << L"\"QueryDisplayConfig\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            return false;
+        }
+        pathInfos.resize(pathInfoCount);
+        pathsOut.reserve(pathInfos.size());
+        for (auto&& info : std::as_const(pathInfos)) {
+            DisplayConfigPath path{};
+            path.sourceAdapterLuid = luidToUInt64(info.sourceInfo.adapterId);
+            path.sourceId = info.sourceInfo.id;
+            path.targetAdapterLuid = luidToUInt64(info.targetInfo.adapterId);
+            path.targetId = info.targetInfo.id;
+            path.refreshRateNumerator = info.targetInfo.refreshRate.Numerator;
+            path.refreshRateDenominator = info.targetInfo.refreshRate.Denominator;
+            pathsOut.push_back(path);
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool getSourceName(const DisplayConfigPath& path, std::wstring& nameOut) override {
+        if (!USER32_API(DisplayConfigGetDeviceInfo)) {
+            return false;
+        }
+        DISPLAYCONFIG_SOURCE_DEVICE_NAME deviceName{};
+        deviceName.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+        deviceName.header.size = sizeof(deviceName);
+        deviceName.header.adapterId = uint64ToLuid(path.sourceAdapterLuid);
+        deviceName.header.id = path.sourceId;
+        if (USER32_API(DisplayConfigGetDeviceInfo)(&deviceName.header) != ERROR_SUCCESS) {
+            std::wcerr << L"\"DisplayConfigGetDeviceInfo\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            return false;
+        }
+        nameOut = deviceName.viewGdiDeviceName;
+        return true;
+    }
+
+    [[nodiscard]] bool getTargetName(const DisplayConfigPath& path, DisplayConfigTargetName& nameOut) override {
+        DISPLAYCONFIG_TARGET_DEVICE_NAME deviceName{};
+        if (!getTargetDeviceName(path, deviceName)) {
+            return false;
+        }
+        nameOut.friendlyName = deviceName.monitorFriendlyDeviceName;
+        nameOut.monitorDevicePath = deviceName.monitorDevicePath;
+        return true;
+    }
+
+    [[nodiscard]] bool getSdrWhiteLevel(const DisplayConfigPath& path, std::uint32_t& levelOut) override {
+        if (!USER32_API(DisplayConfigGetDeviceInfo)) {
+            return false;
+        }
+        DISPLAYCONFIG_SDR_WHITE_LEVEL whiteLevel{};
+        whiteLevel.header.size = sizeof(whiteLevel);
+        whiteLevel.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SDR_WHITE_LEVEL;
+        whiteLevel.header.adapterId = uint64ToLuid(path.targetAdapterLuid);
+        whiteLevel.header.id = path.targetId;
+        if (USER32_API(DisplayConfigGetDeviceInfo)(&whiteLevel.header) != ERROR_SUCCESS) {
+            std::wcerr << L"\"DisplayConfigGetDeviceInfo\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            return false;
+        }
+        levelOut = whiteLevel.SDRWhiteLevel;
+        return true;
+    }
+
+private:
+    [[nodiscard]] static bool getTargetDeviceName(const DisplayConfigPath& path, DISPLAYCONFIG_TARGET_DEVICE_NAME& deviceNameOut) {
+        if (!USER32_API(DisplayConfigGetDeviceInfo)) {
+            return false;
+        }
+        deviceNameOut.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_NAME;
+        deviceNameOut.header.size = sizeof(deviceNameOut);
+        deviceNameOut.header.adapterId = uint64ToLuid(path.targetAdapterLuid);
+        deviceNameOut.header.id = path.targetId;
+        if (USER32_API(DisplayConfigGetDeviceInfo)(&deviceNameOut.header) != ERROR_SUCCESS) {
+            std::wcerr << L"\"DisplayConfigGetDeviceInfo\" failed: " << getLastWin32ErrorMessage() << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+display_config_provider_ptr_t createWin32DisplayConfigProvider() {
+    return std::make_shared<Win32DisplayConfigProvider>();
+}
+
+} // namespace gputester
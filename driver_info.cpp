@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "driver_info.hpp"
+#include <cassert>
+#include <exception>
+#include <iostream>
+#include <optional>
+
+using namespace m4x1m1l14n;
+
+namespace gputester {
+
+// Code copied and modified from Unreal Engine 5.4.4:
+// Engine/Source/Runtime/Core/Public/GenericPlatform/GenericPlatformDriver.h
+// Engine/Source/Runtime/Core/Private/Windows/WindowsPlatformMisc.cpp
+bool getDriverInfo(const DeviceTableRow& row, const Registry::RegistryKey_ptr& system, DriverInfo& infoOut) {
+    const std::wstring& registryKeyName = row.driver;
+    const std::wstring& providerName = row.driverProvider;
+    std::wstring driverVersion{ row.driverVersion };
+    const std::wstring& driverDate = row.driverDate;
+    if (providerName.find(L"NVIDIA") != std::wstring::npos) {
+        // Ignore the Windows/DirectX version by taking the last digits of the internal version
+        // and moving the version dot. Coincidentally, that's the user-facing string. For example:
+        // 9.18.13.4788 -> 3.4788 -> 347.88
+        if (driverVersion.size() >= 6) {
+            std::wstring rightPart = driverVersion.substr(driverVersion.size() - 6);
+            for (std::size_t index = rightPart.find(L'.'); index != std::wstring::npos; index = rightPart.find(L'.')) {
+                rightPart.erase(index, 1);
+            }
+            rightPart.insert(3, L".");
+            driverVersion = rightPart;
+        }
+    }
+    if (providerName.find(L"Advanced Micro Devices") != std::wstring::npos) {
+        // Get the AMD specific information directly from the registry.
+        // AMD AGS could be used instead, but retrieving the radeon software version cannot occur after a D3D device
+        // has been created, and this function could be called at any time.
+        if (system && !registryKeyName.empty()) {
+            const std::wstring keyPath = L"CurrentControlSet\\Control\\Class\\" + registryKeyName;
+            try {
+                if (const auto regKey = system->Open(keyPath)) {
+                    // The Radeon Software name wins over the Catalyst version, so only look at the latter when the
+                    // former is incomplete.
+                    const auto radeon = regKey->GetValues({ L"RadeonSoftwareEdition", L"RadeonSoftwareVersion" });
+                    const std::wstring edition = radeon[0].value_or(std::wstring{});
+                    const std::wstring version = radeon[1].value_or(std::wstring{});
+                    if (!edition.empty() && !version.empty()) {
+                        // e.g. "Crimson 15.12" or "Catalyst 14.1".
+                        driverVersion = edition + L' ' + version;
+                    } else if (const auto catalystVersion = regKey->TryGetString(L"Catalyst_Version"); catalystVersion && !catalystVersion->empty()) {
+                        driverVersion = L"Catalyst " + catalystVersion.value();
+                    }
+                } else {
+                    std::wcerr << L"Failed to open registry key: HKEY_LOCAL_MACHINE\\SYSTEM\\" << keyPath << std::endl;
+                }
+            } catch (const std::exception& ex) {
+                std::wcerr << L"Failed to access the registry: " << ex.what() << std::endl;
+            }
+        }
+    }
+    if (providerName.find(L"Intel") != std::wstring::npos) { // Usually "Intel Corporation".
+        // https://www.intel.com/content/www/us/en/support/articles/000005654/graphics.html
+        // Drop off the OS and DirectX version. For example:
+        // 27.20.100.8935 -> 100.8935
+        std::size_t index = driverVersion.find(L'.');
+        if (index != std::wstring::npos) {
+            index = driverVersion.find(L'.', index + 1);
+            if (index != std::wstring::npos) {
+                driverVersion = driverVersion.substr(index + 1);
+            }
+        }
+    }
+    infoOut.provider = providerName;
+    infoOut.version = driverVersion;
+    infoOut.date = driverDate;
+    return true;
+}
+// UE 5 source code ends here.
+
+bool getDriverInfo(DeviceTable& deviceTable, const std::wstring& deviceName, const Registry::RegistryKey_ptr& system, DriverInfo& infoOut) {
+    assert(!deviceName.empty());
+    if (deviceName.empty()) {
+        return false;
+    }
+    const std::optional<DeviceTableRow> row = deviceTable.find(deviceName);
+    return row && getDriverInfo(row.value(), system, infoOut);
+}
+
+} // namespace gputester
@@ -0,0 +1,41 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "device_table.hpp"
+#include "model.hpp"
+#include "registry.hpp"
+#include <string>
+
+namespace gputester {
+
+// Turns the driver version of the device into the one the vendor shows to users. AMD keeps that
+// version in the driver key under "system", which is HKEY_LOCAL_MACHINE\SYSTEM or an offline copy
+// of it (see openRegistryHive()). Without it the AMD version is left as installed.
+[[nodiscard]] bool getDriverInfo(const DeviceTableRow& row, const m4x1m1l14n::Registry::RegistryKey_ptr& system, DriverInfo& infoOut);
+// Finds the adapter in the device table first.
+[[nodiscard]] bool getDriverInfo(DeviceTable& deviceTable, const std::wstring& deviceName, const m4x1m1l14n::Registry::RegistryKey_ptr& system, DriverInfo& infoOut);
+
+} // namespace gputester
@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dxgi_support.hpp"
+#include "driver_info.hpp"
+#include <algorithm>
+#include <exception>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace m4x1m1l14n;
+
+namespace gputester {
+
+// FNV-1a, to notice a different display behind the same output.
+[[nodiscard]] static inline std::uint64_t hashBytes(const std::uint8_t* data, const std::size_t size) {
+    std::uint64_t hash{ 14695981039346656037ull };
+    for (std::size_t index = 0; index != size; ++index) {
+        hash = (hash ^ data[index]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// As the UTF-16 code units Windows has, so a replay elsewhere arrives at the same key.
+[[nodiscard]] static inline std::uint64_t hashUtf16(const std::wstring_view text) {
+    std::vector<std::uint8_t> bytes{};
+    bytes.reserve(text.size() * 2);
+    for (const wchar_t ch : text) {
+        bytes.push_back(static_cast<std::uint8_t>(ch));
+        bytes.push_back(static_cast<std::uint8_t>(static_cast<std::uint32_t>(ch) >> 8));
+    }
+    return hashBytes(bytes.data(), bytes.size());
+}
+
+// "\\?\DISPLAY#DEL4109#5&2f7ce4f&0&UID4352#{e6f07b5f-...}" is an interface of the monitor device
+// "DISPLAY\DEL4109\5&2f7ce4f&0&UID4352", whose EDID the monitor driver keeps in its device parameters.
+[[nodiscard]] static inline std::optional<std::vector<std::uint8_t>> readMonitorEdid(const Registry::RegistryKey_ptr& system, const std::wstring_view devicePath) {
+    static constexpr const std::wstring_view kPrefix{ L"\\\\?\\" };
+    if (!system || !devicePath.starts_with(kPrefix)) {
+        return std::nullopt;
+    }
+    const std::wstring_view instance = devicePath.substr(kPrefix.size());
+    const std::size_t interfaceGuid = instance.rfind(L"#{");
+    if (interfaceGuid == std::wstring_view::npos) {
+        return std::nullopt;
+    }
+    std::wstring keyPath{ instance.substr(0, interfaceGuid) };
+    std::replace(keyPath.begin(), keyPath.end(), L'#', L'\\');
+    keyPath = L"CurrentControlSet\\Enum\\" + keyPath + L"\\Device Parameters";
+    // A monitor without an EDID is common enough (and the device path is a fine key then), so this is not reported.
+    try {
+        const Registry::RegistryKey_ptr key = system->Open(keyPath);
+        if (!key) {
+            return std::nullopt;
+        }
+        std::optional<std::vector<std::uint8_t>> edid = key->TryGetBinary(L"EDID");
+        if (!edid || edid->empty()) {
+            return std::nullopt;
+        }
+        return edid;
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+DxgiSupport::DxgiSupport(DxgiSeams seams) : m_seams(std::move(seams)) {}
+
+void DxgiSupport::invalidate() {
+    {
+        const std::scoped_lock lock{ m_topologyMutex };
+        m_topology.clear();
+        m_topologyValid = false;
+    }
+    {
+        const std::scoped_lock lock{ m_deviceTableMutex };
+        m_deviceTable.clear();
+        m_deviceTableValid = false;
+    }
+}
+
+bool DxgiSupport::getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut) {
+    if (adapter.description.empty()) {
+        return false;
+    }
+    std::optional<DeviceTableRow> row{};
+    {
+        const std::scoped_lock lock{ m_deviceTableMutex };
+        if (!m_deviceTableValid) {
+            // Walk the SetupAPI device list once, all adapters are looked up in the same table.
+            if (!m_deviceTable.build(*m_seams.setupApi)) {
+                return false;
+            }
+            m_deviceTableValid = true;
+        }
+        row = m_deviceTable.find(adapter.description);
+    }
+    // The row is a copy, the registry is read without holding up the other adapters.
+    return row && gputester::getDriverInfo(row.value(), m_seams.system, infoOut);
+}
+
+bool DxgiSupport::getPathInfo(const OutputDesc& output, PathInfo& infoOut) {
+    if (output.deviceName.empty()) {
+        return false;
+    }
+    std::optional<DisplayTopologyEntry> found = findTopologyEntry(output.deviceName);
+    if (!found) {
+        return false;
+    }
+    DisplayTopologyEntry& entry = found.value();
+    infoOut = {};
+    infoOut.sdrWhiteLevel = entry.sdrWhiteLevel;
+    infoOut.currentRefreshRate = entry.refreshRate;
+    infoOut.friendlyName = std::move(entry.friendlyName);
+    return true;
+}
+
+// The mode list only changes with the monitor, so its key is the hash of the monitor's EDID, or of its device
+// path if the EDID can't be read. Both stay the same across processes, unlike the HMONITOR, because the key
+// is saved in the probe cache.
+bool DxgiSupport::getModeInfoKey(const OutputDesc& output, std::uint64_t& keyOut) {
+    if (output.deviceName.empty()) {
+        return false;
+    }
+    const std::optional<DisplayTopologyEntry> entry = findTopologyEntry(output.deviceName);
+    if (!entry || !entry->monitorDevicePath) {
+        return false;
+    }
+    const std::wstring& devicePath = entry->monitorDevicePath.value();
+    if (const std::optional<std::vector<std::uint8_t>> edid = readMonitorEdid(m_seams.system, devicePath)) {
+        keyOut = hashBytes(edid->data(), edid->size());
+    } else {
+        keyOut = hashUtf16(devicePath);
+    }
+    return true;
+}
+
+// One snapshot per enumeration, every output of every adapter is answered from it.
+std::optional<DisplayTopologyEntry> DxgiSupport::findTopologyEntry(const std::wstring& gdiDeviceName) {
+    const std::scoped_lock lock{ m_topologyMutex };
+    if (!m_topologyValid) {
+        if (!m_topology.build(*m_seams.displayConfig)) {
+            return std::nullopt;
+        }
+        m_topologyValid = true;
+    }
+    const DisplayTopologyEntry* found = m_topology.find(gdiDeviceName);
+    if (!found) {
+        return std::nullopt;
+    }
+    return *found;
+}
+
+} // namespace gputester
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include "device_table.hpp"
+#include "display_config.hpp"
+#include "registry.hpp"
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace gputester {
+
+// What the DXGI backend asks the system besides DXGI itself. "system" is HKEY_LOCAL_MACHINE\SYSTEM,
+// it may be null when the registry can't be opened.
+struct DxgiSeams final {
+    display_config_provider_ptr_t displayConfig{};
+    setupapi_provider_ptr_t setupApi{};
+    m4x1m1l14n::Registry::RegistryKey_ptr system{};
+};
+
+#ifdef _WIN32
+// The live QueryDisplayConfig(), SetupAPI and HKEY_LOCAL_MACHINE\SYSTEM.
+[[nodiscard]] DxgiSeams createWin32DxgiSeams();
+[[nodiscard]] backend_ptr_t createDxgiBackend(DxgiSeams seams);
+#endif
+
+// The part of the DXGI backend which only talks to the seams, so it runs on any platform: a
+// replayed trace drives it the same way the live system does (see recordDxgiSeams()).
+// The device table and the display topology are built on first use and kept until invalidate().
+class DxgiSupport final {
+public:
+    explicit DxgiSupport(DxgiSeams seams);
+    DxgiSupport(const DxgiSupport&) = delete;
+    DxgiSupport& operator=(const DxgiSupport&) = delete;
+
+    // Called on every adapter enumeration.
+    void invalidate();
+
+    [[nodiscard]] bool getDriverInfo(const AdapterDesc& adapter, DriverInfo& infoOut);
+    // Without a fallback for a missing refresh rate, that needs GDI.
+    [[nodiscard]] bool getPathInfo(const OutputDesc& output, PathInfo& infoOut);
+    // The key of probe_node_t::ModeInfo.
+    [[nodiscard]] bool getModeInfoKey(const OutputDesc& output, std::uint64_t& keyOut);
+
+private:
+    [[nodiscard]] std::optional<DisplayTopologyEntry> findTopologyEntry(const std::wstring& gdiDeviceName);
+
+    DxgiSeams m_seams{};
+    std::mutex m_topologyMutex{};
+    DisplayTopology m_topology{};
+    bool m_topologyValid{ false };
+    std::mutex m_deviceTableMutex{};
+    DeviceTable m_deviceTable{};
+    bool m_deviceTableValid{ false };
+};
+
+} // namespace gputester
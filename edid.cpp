@@ -0,0 +1,199 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "edid.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace gputester {
+
+static constexpr const std::size_t kEdidBlockSize{ 128 };
+static constexpr const std::size_t kDescriptorSize{ 18 };
+static constexpr const std::uint8_t kEdidHeader[]{ 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+static constexpr const std::uint8_t kDescriptorMonitorName{ 0xFC };
+static constexpr const std::uint8_t kExtensionTagCta{ 0x02 };
+static constexpr const std::uint8_t kCtaTagExtended{ 0x07 };
+static constexpr const std::uint8_t kCtaExtendedTagHdrStaticMetadata{ 0x06 };
+static constexpr const std::uint8_t kEotfSmpteSt2084{ 1 << 2 };
+static constexpr const std::uint8_t kEotfHlg{ 1 << 3 };
+
+[[nodiscard]] static inline bool isChecksumValid(const std::uint8_t* block) {
+    std::uint8_t sum{ 0 };
+    for (std::size_t index = 0; index != kEdidBlockSize; ++index) {
+        sum += block[index];
+    }
+    return sum == 0;
+}
+
+// The ten-bit CIE 1931 coordinates are split into a high byte and two low bits.
+[[nodiscard]] static inline float decodeChromaticity(const std::uint8_t high, const std::uint8_t lowBits) {
+    return static_cast<float>((static_cast<std::uint32_t>(high) << 2) | (lowBits & 0x03)) / 1024.f;
+}
+
+static inline void parseDetailedTiming(const std::uint8_t* descriptor, EdidInfo& infoOut, const bool preferred) {
+    const std::uint32_t pixelClock = (descriptor[0] | (descriptor[1] << 8)) * 10000u;
+    const std::uint32_t horizontalActive = descriptor[2] | ((descriptor[4] & 0xF0) << 4);
+    const std::uint32_t horizontalBlanking = descriptor[3] | ((descriptor[4] & 0x0F) << 8);
+    const std::uint32_t verticalActive = descriptor[5] | ((descriptor[7] & 0xF0) << 4);
+    const std::uint32_t verticalBlanking = descriptor[6] | ((descriptor[7] & 0x0F) << 8);
+    const std::uint32_t horizontalTotal = horizontalActive + horizontalBlanking;
+    const std::uint32_t verticalTotal = verticalActive + verticalBlanking;
+    if (horizontalTotal == 0 || verticalTotal == 0) {
+        return;
+    }
+    const float refreshRate = static_cast<float>(pixelClock) / (static_cast<float>(horizontalTotal) * static_cast<float>(verticalTotal));
+    infoOut.maxRefreshRate = std::max(infoOut.maxRefreshRate, refreshRate);
+    if (preferred && infoOut.preferredWidth == 0) {
+        infoOut.preferredWidth = horizontalActive;
+        infoOut.preferredHeight = verticalActive;
+    }
+}
+
+static inline void parseDisplayDescriptor(const std::uint8_t* descriptor, EdidInfo& infoOut) {
+    if (descriptor[3] != kDescriptorMonitorName) {
+        return;
+    }
+    std::wstring name{};
+    for (std::size_t index = 5; index != kDescriptorSize; ++index) {
+        const std::uint8_t ch = descriptor[index];
+        if (ch == 0x0A || ch == 0x00) {
+            break;
+        }
+        name.push_back(static_cast<wchar_t>(ch));
+    }
+    while (!name.empty() && name.back() == L' ') {
+        name.pop_back();
+    }
+    infoOut.monitorName = std::move(name);
+}
+
+static inline void parseBaseBlock(const std::uint8_t* block, EdidInfo& infoOut) {
+    const std::uint16_t manufacturer = (block[8] << 8) | block[9];
+    infoOut.manufacturerId.clear();
+    for (int shift = 10; shift >= 0; shift -= 5) {
+        infoOut.manufacturerId.push_back(static_cast<wchar_t>(L'A' - 1 + ((manufacturer >> shift) & 0x1F)));
+    }
+    infoOut.productCode = block[10] | (block[11] << 8);
+    const std::uint8_t videoInput = block[20];
+    const bool isDigital = (videoInput & 0x80) != 0;
+    if (isDigital && (block[18] > 1 || block[19] >= 4)) {
+        const std::uint32_t depth = (videoInput >> 4) & 0x07;
+        if (depth >= 1 && depth <= 6) {
+            infoOut.bitsPerColor = 4 + depth * 2;
+        }
+    }
+    infoOut.widthInCentimeters = block[21];
+    infoOut.heightInCentimeters = block[22];
+    const std::uint8_t redGreenLow = block[25];
+    const std::uint8_t blueWhiteLow = block[26];
+    infoOut.redPrimary[0] = decodeChromaticity(block[27], redGreenLow >> 6);
+    infoOut.redPrimary[1] = decodeChromaticity(block[28], redGreenLow >> 4);
+    infoOut.greenPrimary[0] = decodeChromaticity(block[29], redGreenLow >> 2);
+    infoOut.greenPrimary[1] = decodeChromaticity(block[30], redGreenLow);
+    infoOut.bluePrimary[0] = decodeChromaticity(block[31], blueWhiteLow >> 6);
+    infoOut.bluePrimary[1] = decodeChromaticity(block[32], blueWhiteLow >> 4);
+    infoOut.whitePoint[0] = decodeChromaticity(block[33], blueWhiteLow >> 2);
+    infoOut.whitePoint[1] = decodeChromaticity(block[34], blueWhiteLow);
+    // Standard timings: (horizontal / 8 - 31, aspect ratio << 6 | refresh rate - 60), 0x0101 marks an unused slot.
+    for (std::size_t offset = 38; offset != 54; offset += 2) {
+        if (block[offset] == 0x01 && block[offset + 1] == 0x01) {
+            continue;
+        }
+        infoOut.maxRefreshRate = std::max(infoOut.maxRefreshRate, static_cast<float>((block[offset + 1] & 0x3F) + 60));
+    }
+    for (std::size_t offset = 54; offset != 126; offset += kDescriptorSize) {
+        const std::uint8_t* descriptor = block + offset;
+        if (descriptor[0] != 0 || descriptor[1] != 0) {
+            parseDetailedTiming(descriptor, infoOut, offset == 54);
+        } else {
+            parseDisplayDescriptor(descriptor, infoOut);
+        }
+    }
+}
+
+static inline void parseHdrStaticMetadata(const std::uint8_t* payload, const std::size_t length, EdidInfo& infoOut) {
+    // payload[0] is the extended tag, followed by the EOTF and metadata descriptor bytes.
+    if (length < 3) {
+        return;
+    }
+    infoOut.hdrSupported = (payload[1] & (kEotfSmpteSt2084 | kEotfHlg)) != 0;
+    // CTA-861-G 7.5.13: desired content luminance values are coded as 50 * 2^(CV / 32).
+    if (length >= 4 && payload[3] != 0) {
+        infoOut.maxLuminance = 50.f * std::pow(2.f, static_cast<float>(payload[3]) / 32.f);
+    }
+    if (length >= 5 && payload[4] != 0) {
+        infoOut.maxFullFrameLuminance = 50.f * std::pow(2.f, static_cast<float>(payload[4]) / 32.f);
+    }
+    if (length >= 6 && infoOut.maxLuminance) {
+        const float ratio = static_cast<float>(payload[5]) / 255.f;
+        infoOut.minLuminance = infoOut.maxLuminance.value() * ratio * ratio / 100.f;
+    }
+}
+
+static inline void parseCtaBlock(const std::uint8_t* block, EdidInfo& infoOut) {
+    const std::size_t timingsOffset = block[2];
+    if (timingsOffset < 4 || timingsOffset > kEdidBlockSize - 1) {
+        return;
+    }
+    for (std::size_t offset = 4; offset < timingsOffset;) {
+        const std::uint8_t header = block[offset];
+        const std::size_t length = header & 0x1F;
+        if (offset + 1 + length > timingsOffset) {
+            break;
+        }
+        const std::uint8_t* payload = block + offset + 1;
+        if ((header >> 5) == kCtaTagExtended && length >= 1 && payload[0] == kCtaExtendedTagHdrStaticMetadata) {
+            parseHdrStaticMetadata(payload, length, infoOut);
+        }
+        offset += 1 + length;
+    }
+    for (std::size_t offset = timingsOffset; offset + kDescriptorSize <= kEdidBlockSize - 1; offset += kDescriptorSize) {
+        const std::uint8_t* descriptor = block + offset;
+        if (descriptor[0] == 0 && descriptor[1] == 0) {
+            break;
+        }
+        parseDetailedTiming(descriptor, infoOut, false);
+    }
+}
+
+bool parseEdid(const std::uint8_t* data, const std::size_t size, EdidInfo& infoOut) {
+    if (!data || size < kEdidBlockSize || !std::equal(std::begin(kEdidHeader), std::end(kEdidHeader), data)) {
+        return false;
+    }
+    if (!isChecksumValid(data)) {
+        return false;
+    }
+    infoOut = {};
+    parseBaseBlock(data, infoOut);
+    const std::size_t extensionCount = std::min<std::size_t>(data[126], size / kEdidBlockSize - 1);
+    for (std::size_t index = 1; index <= extensionCount; ++index) {
+        const std::uint8_t* block = data + index * kEdidBlockSize;
+        if (block[0] == kExtensionTagCta && isChecksumValid(block)) {
+            parseCtaBlock(block, infoOut);
+        }
+    }
+    return true;
+}
+
+} // namespace gputester
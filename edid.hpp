@@ -0,0 +1,59 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace gputester {
+
+// The subset of the EDID (and its CTA-861 extension blocks) the probes care about.
+struct EdidInfo final {
+    std::wstring manufacturerId{}; // The three letter PNP ID, e.g. "DEL".
+    std::uint16_t productCode{ 0 };
+    std::wstring monitorName{};
+    std::uint32_t bitsPerColor{ 0 }; // 0 if undefined (EDID 1.3 or analog input).
+    std::uint32_t widthInCentimeters{ 0 };
+    std::uint32_t heightInCentimeters{ 0 };
+    float redPrimary[2]{};
+    float greenPrimary[2]{};
+    float bluePrimary[2]{};
+    float whitePoint[2]{};
+    float maxRefreshRate{ 0.f }; // Of all the timings the display advertises.
+    std::uint32_t preferredWidth{ 0 };
+    std::uint32_t preferredHeight{ 0 };
+    // From the CTA-861 HDR static metadata data block, if present.
+    bool hdrSupported{ false };
+    std::optional<float> minLuminance{};
+    std::optional<float> maxLuminance{};
+    std::optional<float> maxFullFrameLuminance{};
+};
+
+// Returns false if the data is not an EDID, a bad checksum only invalidates the affected block.
+[[nodiscard]] bool parseEdid(const std::uint8_t* data, const std::size_t size, EdidInfo& infoOut);
+
+} // namespace gputester
@@ -0,0 +1,651 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "format.hpp"
+#include "binary_report.hpp"
+#include "json.hpp"
+#include "query.hpp"
+#include "text.hpp"
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+namespace gputester {
+
+// Rough upper bounds of the text one adapter or one output produces, used to size the buffer up front.
+static constexpr const std::size_t kAdapterTextSize{ 768 };
+static constexpr const std::size_t kOutputTextSize{ 1024 };
+static constexpr const std::size_t kAdapterJsonSize{ 640 };
+static constexpr const std::size_t kOutputJsonSize{ 1024 };
+
+struct Hex final {
+    std::uint32_t value{ 0 };
+};
+
+// Appends UTF-8 to a caller owned buffer. Numbers look the same as with a default
+// std::wostream (floats like "%g"), but there are no locales, no virtual calls and no flushes.
+class TextWriter final {
+public:
+    explicit TextWriter(std::string& buffer) : m_buffer(buffer) {}
+
+    TextWriter& operator<<(const std::string_view value) {
+        m_buffer.append(value);
+        return *this;
+    }
+
+    TextWriter& operator<<(const char value) {
+        m_buffer.push_back(value);
+        return *this;
+    }
+
+    TextWriter& operator<<(const std::wstring_view value) {
+        appendUtf8(m_buffer, value);
+        return *this;
+    }
+
+    template <typename T>
+        requires (std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> && !std::is_same_v<T, wchar_t>)
+    TextWriter& operator<<(const T value) {
+        char buffer[24]{};
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        m_buffer.append(buffer, result.ptr);
+        return *this;
+    }
+
+    TextWriter& operator<<(const float value) {
+        char buffer[32]{};
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), static_cast<double>(value), std::chars_format::general, 6);
+        m_buffer.append(buffer, result.ptr);
+        return *this;
+    }
+
+    TextWriter& operator<<(const Hex value) {
+        char buffer[12]{};
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value.value, 16);
+        m_buffer.append(buffer, result.ptr);
+        return *this;
+    }
+
+private:
+    std::string& m_buffer;
+};
+
+[[nodiscard]] static inline std::uint32_t getScalePercentage(const std::uint32_t dpi) {
+    return std::uint32_t(std::round(static_cast<float>(dpi) / static_cast<float>(kDefaultScreenDpi) * 100.f));
+}
+
+[[nodiscard]] static inline float getLatencyMilliseconds(const ProbeRecord& record) {
+    return std::chrono::duration<float, std::milli>(record.latency).count();
+}
+
+static inline void writeProbesText(TextWriter& writer, const probe_records_t& probes) {
+    for (std::size_t index = 0; index != probes.size(); ++index) {
+        const ProbeRecord& record = probes[index];
+        if (record.status == probe_status_t::NotRun) {
+            continue;
+        }
+        writer << "Probe " << probeNodeToString(static_cast<probe_node_t>(index)) << ": " << probeStatusToString(record.status);
+        if (record.status != probe_status_t::Reused) {
+            writer << " after " << getLatencyMilliseconds(record) << " ms";
+        }
+        writer << '\n';
+    }
+}
+
+[[nodiscard]] static inline std::size_t estimateSize(const GpuReport& report, const std::size_t adapterSize, const std::size_t outputSize) {
+    std::size_t outputCount{ 0 };
+    for (auto&& adapterInfo : std::as_const(report.adapters)) {
+        outputCount += adapterInfo.outputs.size();
+    }
+    return (report.adapters.size() + 1) * adapterSize + outputCount * outputSize;
+}
+
+void formatText(const GpuReport& report, std::string& bufferOut, const bool colored) {
+    bufferOut.reserve(bufferOut.size() + estimateSize(report, kAdapterTextSize, kOutputTextSize));
+    TextWriter writer{ bufferOut };
+    const auto color = [colored](const std::wstring_view value) -> std::wstring_view {
+        return colored ? value : std::wstring_view{};
+    };
+    for (auto&& adapterInfo : std::as_const(report.adapters)) {
+        const AdapterDesc& adapter = adapterInfo.desc;
+        writer << color(kColorBlue) << "##############################" << color(kColorDefault) << '\n';
+        writer << color(kColorGreen) << "GPU #" << adapter.index + 1 << ':' << color(kColorDefault) << '\n';
+        writer << "Device name: " << adapter.description << '\n';
+        writer << "Vendor ID: 0x" << Hex{ adapter.vendorId };
+        {
+            const vendor_t vendor = vendorIdToVendor(adapter.vendorId);
+            if (vendor != vendor_t::Unknown) {
+                writer << " (" << vendorToString(vendor) << ')';
+            }
+            writer << '\n';
+        }
+        writer << "Device ID: 0x" << Hex{ adapter.deviceId } << '\n';
+        writer << "Dedicated video memory: " << adapter.dedicatedVideoMemory / 1048576 << " MiB\n";
+        writer << "Dedicated system memory: " << adapter.dedicatedSystemMemory / 1048576 << " MiB\n";
+        writer << "Shared system memory: " << adapter.sharedSystemMemory / 1048576 << " MiB\n";
+        writer << "Variable refresh rate supported: " << (report.variableRefreshRateSupported ? "Yes" : "No") << '\n';
+        writer << "Software simulation (rendered by CPU): " << ((adapter.flags & kAdapterFlagSoftware) ? "Yes" : "No") << '\n';
+        if (adapter.integrated) {
+            writer << "Integrated device: " << (adapter.integrated.value() ? "Yes" : "No") << '\n';
+        }
+        if (adapterInfo.driver) {
+            const DriverInfo& driverInfo = adapterInfo.driver.value();
+            writer << "Driver: " << driverInfo.version;
+            if (!driverInfo.date.empty()) {
+                writer << " (" << driverInfo.date << ')';
+            }
+            writer << '\n';
+        }
+        writeProbesText(writer, adapterInfo.probes);
+        for (auto&& outputInfo : std::as_const(adapterInfo.outputs)) {
+            const OutputDesc& output = outputInfo.desc;
+            const DisplayInfo& display = outputInfo.display;
+            const auto width = std::abs(output.right - output.left);
+            const auto height = std::abs(output.bottom - output.top);
+            writer << color(kColorRed) << "-------------------------------" << color(kColorDefault) << '\n';
+            writer << color(kColorYellow) << "Output #" << output.index + 1 << ':' << color(kColorDefault) << '\n';
+            writer << "Device name: " << output.deviceName << '\n';
+            writer << "Desktop geometry: x: " << output.left << ", y: " << output.top << ", width: " << width << ", height: " << height << '\n';
+            writer << "Attached to desktop: " << (output.attachedToDesktop ? "Yes" : "No") << '\n';
+            writer << "Rotation: " << rotationToString(output.rotation) << " degree\n";
+            if (display.mode) {
+                writer << "Maximum refresh rate: " << display.mode->maxRefreshRate << " Hz\n";
+            }
+            if (display.color) {
+                const ColorInfo& colorInfo = display.color.value();
+                writer << "Bits per color: " << colorInfo.bitsPerColor << '\n';
+                writer << "Color space: " << colorSpaceToString(colorInfo.colorSpace) << '\n';
+                writer << "Red primary: " << colorInfo.redPrimary[0] << ", " << colorInfo.redPrimary[1] << '\n';
+                writer << "Green primary: " << colorInfo.greenPrimary[0] << ", " << colorInfo.greenPrimary[1] << '\n';
+                writer << "Blue primary: " << colorInfo.bluePrimary[0] << ", " << colorInfo.bluePrimary[1] << '\n';
+                writer << "White point: " << colorInfo.whitePoint[0] << ", " << colorInfo.whitePoint[1] << '\n';
+                writer << "Minimum luminance: " << colorInfo.minLuminance << " nit\n";
+                writer << "Maximum luminance: " << colorInfo.maxLuminance << " nit\n";
+                writer << "Maximum average full frame luminance: " << colorInfo.maxFullFrameLuminance << " nit\n";
+            }
+            if (display.path) {
+                const PathInfo& pathInfo = display.path.value();
+                if (pathInfo.sdrWhiteLevel) {
+                    writer << "SDR white level: " << pathInfo.sdrWhiteLevel.value() << " nit\n";
+                }
+                if (pathInfo.currentRefreshRate) {
+                    writer << "Current refresh rate: " << pathInfo.currentRefreshRate.value() << " Hz\n";
+                }
+                if (pathInfo.friendlyName) {
+                    writer << "Display name: " << pathInfo.friendlyName.value() << '\n';
+                }
+            }
+            if (display.dpi) {
+                const std::uint32_t dpi = display.dpi.value();
+                writer << "Dots-per-inch: " << dpi << " (" << getScalePercentage(dpi) << "%)\n";
+            }
+            writeProbesText(writer, outputInfo.probes);
+        }
+    }
+    writer << color(kColorBlue) << "##############################" << color(kColorDefault) << '\n';
+}
+
+static inline void writePointJson(JsonWriter& writer, const std::string_view name, const float (&point)[2]) {
+    writer.key(name);
+    writer.beginArray();
+    writer.value(point[0]);
+    writer.value(point[1]);
+    writer.endArray();
+}
+
+// Only written if there is anything to say, i.e. ProbeOptions::recordProbes or a timeout.
+static inline void writeProbesJson(JsonWriter& writer, const probe_records_t& probes) {
+    bool empty{ true };
+    for (std::size_t index = 0; index != probes.size(); ++index) {
+        const ProbeRecord& record = probes[index];
+        if (record.status == probe_status_t::NotRun) {
+            continue;
+        }
+        if (empty) {
+            writer.key("probes");
+            writer.beginArray();
+            empty = false;
+        }
+        writer.beginObject();
+        writer.field("probe", probeNodeToString(static_cast<probe_node_t>(index)));
+        writer.field("status", probeStatusToString(record.status));
+        writer.field("latencyMs", getLatencyMilliseconds(record));
+        writer.endObject();
+    }
+    if (!empty) {
+        writer.endArray();
+    }
+}
+
+static inline void writeOutputJson(JsonWriter& writer, const OutputInfo& outputInfo) {
+    const OutputDesc& output = outputInfo.desc;
+    const DisplayInfo& display = outputInfo.display;
+    writer.beginObject();
+    writer.field("index", output.index);
+    writer.field("deviceName", output.deviceName);
+    writer.key("desktopCoordinates");
+    writer.beginObject();
+    writer.field("left", output.left);
+    writer.field("top", output.top);
+    writer.field("right", output.right);
+    writer.field("bottom", output.bottom);
+    writer.endObject();
+    writer.field("width", std::abs(output.right - output.left));
+    writer.field("height", std::abs(output.bottom - output.top));
+    writer.field("attachedToDesktop", output.attachedToDesktop);
+    writer.field("rotation", static_cast<std::uint32_t>(output.rotation));
+    writer.field("rotationName", rotationToString(output.rotation));
+    if (display.mode) {
+        writer.field("maxRefreshRate", display.mode->maxRefreshRate);
+    }
+    if (display.color) {
+        const ColorInfo& colorInfo = display.color.value();
+        writer.field("bitsPerColor", colorInfo.bitsPerColor);
+        writer.field("colorSpace", static_cast<std::uint32_t>(colorInfo.colorSpace));
+        writer.field("colorSpaceName", colorSpaceToString(colorInfo.colorSpace));
+        writePointJson(writer, "redPrimary", colorInfo.redPrimary);
+        writePointJson(writer, "greenPrimary", colorInfo.greenPrimary);
+        writePointJson(writer, "bluePrimary", colorInfo.bluePrimary);
+        writePointJson(writer, "whitePoint", colorInfo.whitePoint);
+        writer.field("minLuminance", colorInfo.minLuminance);
+        writer.field("maxLuminance", colorInfo.maxLuminance);
+        writer.field("maxFullFrameLuminance", colorInfo.maxFullFrameLuminance);
+    }
+    if (display.path) {
+        const PathInfo& pathInfo = display.path.value();
+        if (pathInfo.sdrWhiteLevel) {
+            writer.field("sdrWhiteLevel", pathInfo.sdrWhiteLevel.value());
+        }
+        if (pathInfo.currentRefreshRate) {
+            writer.field("currentRefreshRate", pathInfo.currentRefreshRate.value());
+        }
+        if (pathInfo.friendlyName) {
+            writer.field("friendlyName", pathInfo.friendlyName.value());
+        }
+    }
+    if (display.dpi) {
+        writer.field("dpi", display.dpi.value());
+        writer.field("scale", getScalePercentage(display.dpi.value()));
+    }
+    writeProbesJson(writer, outputInfo.probes);
+    writer.endObject();
+}
+
+static inline void writeAdapterJson(JsonWriter& writer, const AdapterInfo& adapterInfo) {
+    const AdapterDesc& adapter = adapterInfo.desc;
+    writer.beginObject();
+    writer.field("index", adapter.index);
+    writer.field("description", adapter.description);
+    writer.field("vendorId", adapter.vendorId);
+    {
+        const vendor_t vendor = vendorIdToVendor(adapter.vendorId);
+        if (vendor != vendor_t::Unknown) {
+            writer.field("vendorName", vendorToString(vendor));
+        }
+    }
+    writer.field("deviceId", adapter.deviceId);
+    writer.field("subSysId", adapter.subSysId);
+    writer.field("revision", adapter.revision);
+    writer.field("dedicatedVideoMemory", adapter.dedicatedVideoMemory);
+    writer.field("dedicatedSystemMemory", adapter.dedicatedSystemMemory);
+    writer.field("sharedSystemMemory", adapter.sharedSystemMemory);
+    writer.field("luid", adapter.luid);
+    writer.field("flags", adapter.flags);
+    writer.field("software", (adapter.flags & kAdapterFlagSoftware) != 0);
+    if (adapter.integrated) {
+        writer.field("integrated", adapter.integrated.value());
+    }
+    if (adapterInfo.driver) {
+        const DriverInfo& driverInfo = adapterInfo.driver.value();
+        writer.key("driver");
+        writer.beginObject();
+        writer.field("provider", driverInfo.provider);
+        writer.field("version", driverInfo.version);
+        if (!driverInfo.date.empty()) {
+            writer.field("date", driverInfo.date);
+        }
+        writer.endObject();
+    }
+    writeProbesJson(writer, adapterInfo.probes);
+    writer.key("outputs");
+    writer.beginArray();
+    for (auto&& outputInfo : std::as_const(adapterInfo.outputs)) {
+        writeOutputJson(writer, outputInfo);
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
+static inline void writeReportFieldsJson(JsonWriter& writer, const GpuReport& report) {
+    writer.field("backend", report.backend);
+    writer.field("variableRefreshRateSupported", report.variableRefreshRateSupported);
+}
+
+void formatJson(const GpuReport& report, std::string& bufferOut) {
+    bufferOut.reserve(bufferOut.size() + estimateSize(report, kAdapterJsonSize, kOutputJsonSize));
+    JsonWriter writer{ bufferOut };
+    writer.beginObject();
+    writeReportFieldsJson(writer, report);
+    writer.key("adapters");
+    writer.beginArray();
+    for (auto&& adapterInfo : std::as_const(report.adapters)) {
+        writeAdapterJson(writer, adapterInfo);
+    }
+    writer.endArray();
+    writer.endObject();
+    bufferOut.push_back('\n');
+}
+
+void formatNdjson(const GpuReport& report, std::string& bufferOut) {
+    bufferOut.reserve(bufferOut.size() + estimateSize(report, kAdapterJsonSize, kOutputJsonSize));
+    for (auto&& adapterInfo : std::as_const(report.adapters)) {
+        JsonWriter writer{ bufferOut };
+        writer.beginObject();
+        writeReportFieldsJson(writer, report);
+        writer.key("adapter");
+        writeAdapterJson(writer, adapterInfo);
+        writer.endObject();
+        bufferOut.push_back('\n');
+    }
+}
+
+void formatReport(const GpuReport& report, const output_format_t format, std::string& bufferOut, const bool colored) {
+    switch (format) {
+        case output_format_t::Text:
+            formatText(report, bufferOut, colored);
+            break;
+        case output_format_t::Json:
+            formatJson(report, bufferOut);
+            break;
+        case output_format_t::Ndjson:
+            formatNdjson(report, bufferOut);
+            break;
+        case output_format_t::Binary:
+            encodeBinaryReport(report, bufferOut);
+            break;
+    }
+}
+
+// What a delta points to in the old and the new report, null on the side it doesn't exist on.
+struct DeltaSubjects final {
+    const AdapterInfo* oldAdapter{ nullptr };
+    const AdapterInfo* newAdapter{ nullptr };
+    const OutputInfo* oldOutput{ nullptr };
+    const OutputInfo* newOutput{ nullptr };
+};
+
+[[nodiscard]] static inline DeltaSubjects resolveDelta(const GpuReport& oldReport, const GpuReport& newReport, const ReportDelta& delta) {
+    DeltaSubjects subjects{};
+    if (delta.oldAdapter) {
+        subjects.oldAdapter = &oldReport.adapters[delta.oldAdapter.value()];
+        if (delta.oldOutput) {
+            subjects.oldOutput = &subjects.oldAdapter->outputs[delta.oldOutput.value()];
+        }
+    }
+    if (delta.newAdapter) {
+        subjects.newAdapter = &newReport.adapters[delta.newAdapter.value()];
+        if (delta.newOutput) {
+            subjects.newOutput = &subjects.newAdapter->outputs[delta.newOutput.value()];
+        }
+    }
+    return subjects;
+}
+
+static inline void formatDeltaText(const GpuReport& oldReport, const GpuReport& newReport, const ReportDelta& delta, TextWriter& writer, const bool colored) {
+    const auto color = [colored](const std::wstring_view value) -> std::wstring_view {
+        return colored ? value : std::wstring_view{};
+    };
+    const DeltaSubjects subjects = resolveDelta(oldReport, newReport, delta);
+    const AdapterInfo& adapterInfo = subjects.newAdapter ? *subjects.newAdapter : *subjects.oldAdapter;
+    const OutputInfo* oldOutput = subjects.oldOutput;
+    const OutputInfo* newOutput = subjects.newOutput;
+    const OutputInfo* outputInfo = newOutput ? newOutput : oldOutput;
+    const auto writeRefreshRate = [&writer](const OutputInfo* output) {
+        if (output && output->display.path && output->display.path->currentRefreshRate) {
+            writer << output->display.path->currentRefreshRate.value() << " Hz";
+        } else {
+            writer << "unknown";
+        }
+    };
+    const auto writeHdr = [&writer](const OutputInfo* output) {
+        if (output && output->display.color) {
+            writer << (isHdrColorSpace(output->display.color->colorSpace) ? "on" : "off");
+        } else {
+            writer << "unknown";
+        }
+    };
+    const auto writeDpi = [&writer](const OutputInfo* output) {
+        if (output && output->display.dpi) {
+            writer << output->display.dpi.value() << " (" << getScalePercentage(output->display.dpi.value()) << "%)";
+        } else {
+            writer << "unknown";
+        }
+    };
+    const auto writeDriver = [&writer](const std::optional<DriverInfo>& driver) {
+        if (driver) {
+            writer << driver->version;
+        } else {
+            writer << "unknown";
+        }
+    };
+    switch (delta.type) {
+        case report_delta_t::AdapterAdded:
+            writer << color(kColorGreen) << "GPU #" << adapterInfo.desc.index + 1 << " added: " << color(kColorDefault) << adapterInfo.desc.description;
+            break;
+        case report_delta_t::AdapterRemoved:
+            writer << color(kColorRed) << "GPU #" << adapterInfo.desc.index + 1 << " removed: " << color(kColorDefault) << adapterInfo.desc.description;
+            break;
+        case report_delta_t::DriverChanged:
+            writer << color(kColorYellow) << "GPU #" << adapterInfo.desc.index + 1 << " driver changed: " << color(kColorDefault);
+            writeDriver(subjects.oldAdapter->driver);
+            writer << " -> ";
+            writeDriver(adapterInfo.driver);
+            break;
+        case report_delta_t::OutputAttached:
+            writer << color(kColorGreen) << outputInfo->desc.deviceName << " attached to GPU #" << adapterInfo.desc.index + 1 << color(kColorDefault);
+            if (outputInfo->display.path && outputInfo->display.path->friendlyName) {
+                writer << ": " << outputInfo->display.path->friendlyName.value();
+            }
+            break;
+        case report_delta_t::OutputDetached:
+            writer << color(kColorRed) << outputInfo->desc.deviceName << " detached from GPU #" << adapterInfo.desc.index + 1 << color(kColorDefault);
+            break;
+        case report_delta_t::RefreshRateChanged:
+            writer << color(kColorYellow) << outputInfo->desc.deviceName << " refresh rate changed: " << color(kColorDefault);
+            writeRefreshRate(oldOutput);
+            writer << " -> ";
+            writeRefreshRate(newOutput);
+            break;
+        case report_delta_t::HdrChanged:
+            writer << color(kColorYellow) << outputInfo->desc.deviceName << " HDR changed: " << color(kColorDefault);
+            writeHdr(oldOutput);
+            writer << " -> ";
+            writeHdr(newOutput);
+            if (newOutput && newOutput->display.color) {
+                writer << " (" << colorSpaceToString(newOutput->display.color->colorSpace) << ')';
+            }
+            break;
+        case report_delta_t::DpiChanged:
+            writer << color(kColorYellow) << outputInfo->desc.deviceName << " DPI changed: " << color(kColorDefault);
+            writeDpi(oldOutput);
+            writer << " -> ";
+            writeDpi(newOutput);
+            break;
+    }
+    writer << '\n';
+}
+
+static inline void formatDeltaJson(const GpuReport& oldReport, const GpuReport& newReport, const ReportDelta& delta, std::string& bufferOut) {
+    const DeltaSubjects subjects = resolveDelta(oldReport, newReport, delta);
+    const AdapterInfo& adapterInfo = subjects.newAdapter ? *subjects.newAdapter : *subjects.oldAdapter;
+    const OutputInfo* oldOutput = subjects.oldOutput;
+    const OutputInfo* newOutput = subjects.newOutput;
+    const OutputInfo* outputInfo = newOutput ? newOutput : oldOutput;
+    JsonWriter writer{ bufferOut };
+    writer.beginObject();
+    writer.field("event", reportDeltaToString(delta.type));
+    writer.field("adapterIndex", adapterInfo.desc.index);
+    writer.field("luid", adapterInfo.desc.luid);
+    if (outputInfo) {
+        writer.field("deviceName", outputInfo->desc.deviceName);
+    }
+    // Writes "name": [old, new], with null for an unknown side.
+    const auto writeChange = [&writer, oldOutput, newOutput](const std::string_view name, auto&& getter) {
+        writer.key(name);
+        writer.beginArray();
+        for (const OutputInfo* output : { oldOutput, newOutput }) {
+            const auto value = output ? getter(output->display) : std::nullopt;
+            if (value) {
+                writer.value(value.value());
+            } else {
+                writer.nullValue();
+            }
+        }
+        writer.endArray();
+    };
+    switch (delta.type) {
+        case report_delta_t::AdapterAdded:
+            writer.key("adapter");
+            writeAdapterJson(writer, adapterInfo);
+            break;
+        case report_delta_t::AdapterRemoved:
+            writer.field("description", adapterInfo.desc.description);
+            break;
+        case report_delta_t::DriverChanged: {
+            writer.key("driverVersion");
+            writer.beginArray();
+            for (const auto* driver : { &subjects.oldAdapter->driver, &adapterInfo.driver }) {
+                if (driver->has_value()) {
+                    writer.value((*driver)->version);
+                } else {
+                    writer.nullValue();
+                }
+            }
+            writer.endArray();
+            break;
+        }
+        case report_delta_t::OutputAttached:
+            writer.key("output");
+            writeOutputJson(writer, *outputInfo);
+            break;
+        case report_delta_t::OutputDetached:
+            break;
+        case report_delta_t::RefreshRateChanged:
+            writeChange("currentRefreshRate", [](const DisplayInfo& display) -> std::optional<float> {
+                return display.path ? display.path->currentRefreshRate : std::nullopt;
+            });
+            break;
+        case report_delta_t::HdrChanged:
+            writeChange("hdr", [](const DisplayInfo& display) -> std::optional<bool> {
+                return display.color ? std::optional<bool>{ isHdrColorSpace(display.color->colorSpace) } : std::nullopt;
+            });
+            writeChange("colorSpace", [](const DisplayInfo& display) -> std::optional<std::uint32_t> {
+                return display.color ? std::optional<std::uint32_t>{ static_cast<std::uint32_t>(display.color->colorSpace) } : std::nullopt;
+            });
+            break;
+        case report_delta_t::DpiChanged:
+            writeChange("dpi", [](const DisplayInfo& display) -> std::optional<std::uint32_t> {
+                return display.dpi;
+            });
+            break;
+    }
+    writer.endObject();
+    bufferOut.push_back('\n');
+}
+
+void formatDeltas(const GpuReport& oldReport, const GpuReport& newReport, const std::vector<ReportDelta>& deltas,
+                  const output_format_t format, std::string& bufferOut, const bool colored) {
+    switch (format) {
+        case output_format_t::Text: {
+            TextWriter writer{ bufferOut };
+            for (auto&& delta : std::as_const(deltas)) {
+                formatDeltaText(oldReport, newReport, delta, writer, colored);
+            }
+            break;
+        }
+        case output_format_t::Json:
+        case output_format_t::Ndjson:
+            for (auto&& delta : std::as_const(deltas)) {
+                formatDeltaJson(oldReport, newReport, delta, bufferOut);
+            }
+            break;
+        case output_format_t::Binary:
+            break;
+    }
+}
+
+void formatFields(const GpuReport& report, const std::vector<std::string>& fields, const output_format_t format, std::string& bufferOut) {
+    if (format == output_format_t::Binary) {
+        return;
+    }
+    std::string json{};
+    formatJson(report, json);
+    const bool text = format == output_format_t::Text;
+    std::vector<QuerySegment> segments{};
+    if (!text) {
+        bufferOut.push_back('{');
+    }
+    for (std::size_t index = 0; index != fields.size(); ++index) {
+        const std::string& field = fields[index];
+        if (text) {
+            bufferOut.append(field);
+            bufferOut.append(": ");
+        } else {
+            // Queries consist of key characters, brackets, '*' and '.', nothing needs escaping.
+            bufferOut.append(index == 0 ? "\"" : ",\"");
+            bufferOut.append(field);
+            bufferOut.append("\":");
+        }
+        const std::size_t size = bufferOut.size();
+        if (!parseQuery(field, segments) || !evaluateQuery(json, segments, bufferOut)) {
+            bufferOut.resize(size);
+            bufferOut.append("null");
+        }
+        if (text) {
+            bufferOut.push_back('\n');
+        }
+    }
+    if (!text) {
+        bufferOut.append("}\n");
+    }
+}
+
+bool parseOutputFormat(const std::wstring_view name, output_format_t& formatOut) {
+    if (name == L"text") {
+        formatOut = output_format_t::Text;
+    } else if (name == L"json") {
+        formatOut = output_format_t::Json;
+    } else if (name == L"ndjson") {
+        formatOut = output_format_t::Ndjson;
+    } else if (name == L"binary") {
+        formatOut = output_format_t::Binary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace gputester
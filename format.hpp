@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "model.hpp"
+#include "report_delta.hpp"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gputester {
+
+static constexpr const std::wstring_view kColorDefault{ L"\x1b[0m" };
+static constexpr const std::wstring_view kColorRed{ L"\x1b[1;31m" };
+static constexpr const std::wstring_view kColorGreen{ L"\x1b[1;32m" };
+static constexpr const std::wstring_view kColorYellow{ L"\x1b[1;33m" };
+static constexpr const std::wstring_view kColorBlue{ L"\x1b[1;34m" };
+static constexpr const std::wstring_view kColorMagenta{ L"\x1b[1;35m" };
+static constexpr const std::wstring_view kColorCyan{ L"\x1b[1;36m" };
+
+enum class output_format_t : std::uint8_t {
+    Text,
+    Json,
+    Ndjson,
+    Binary
+};
+
+// Accepts "text", "json", "ndjson" and "binary".
+[[nodiscard]] bool parseOutputFormat(const std::wstring_view name, output_format_t& formatOut);
+
+// The human readable report, the tool's classic console output, appended to "bufferOut" as UTF-8.
+void formatText(const GpuReport& report, std::string& bufferOut, const bool colored = true);
+// The whole report as one JSON document. Besides every field of the text format, the raw
+// values of the enums and flags are included, so nothing is lost in translation.
+void formatJson(const GpuReport& report, std::string& bufferOut);
+// One JSON document per adapter and line, each one also carrying the report level fields.
+void formatNdjson(const GpuReport& report, std::string& bufferOut);
+// "colored" only applies to the text format, see binary_report.hpp for the binary one.
+void formatReport(const GpuReport& report, const output_format_t format, std::string& bufferOut, const bool colored = true);
+// Only the selected fields (queries, see query.hpp): a "field: value" line each for the text format,
+// one JSON object keyed by the fields for the JSON formats. Nothing is appended for the binary format.
+void formatFields(const GpuReport& report, const std::vector<std::string>& fields, const output_format_t format, std::string& bufferOut);
+// One line per delta between "oldReport" and "newReport": a sentence for the text format, a JSON
+// document for the JSON formats. There is no binary encoding of deltas, nothing is appended for it.
+void formatDeltas(const GpuReport& oldReport, const GpuReport& newReport, const std::vector<ReportDelta>& deltas,
+                  const output_format_t format, std::string& bufferOut, const bool colored = true);
+
+} // namespace gputester
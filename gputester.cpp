@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "gputester.h"
+#include "backend.hpp"
+#include "format.hpp"
+#include "probe_graph.hpp"
+#include "report.hpp"
+#include "thread_pool.hpp"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <string>
+#include <utility>
+
+using namespace gputester;
+
+static_assert(static_cast<output_format_t>(GPUTESTER_FORMAT_TEXT) == output_format_t::Text);
+static_assert(static_cast<output_format_t>(GPUTESTER_FORMAT_JSON) == output_format_t::Json);
+static_assert(static_cast<output_format_t>(GPUTESTER_FORMAT_NDJSON) == output_format_t::Ndjson);
+static_assert(static_cast<output_format_t>(GPUTESTER_FORMAT_BINARY) == output_format_t::Binary);
+
+struct gputester_context final {
+    explicit gputester_context(backend_ptr_t backend) : graph(std::move(backend)) {}
+
+    std::mutex mutex{};
+    std::unique_ptr<ThreadPool> pool{};
+    ProbeOptions options{};
+    ProbeGraph graph;
+};
+
+struct gputester_report final {
+    GpuReport report{};
+    // Formatted on first request, indexed by gputester_format.
+    std::array<std::optional<std::string>, 4> buffers{};
+};
+
+// Nothing may unwind into C code, every entry point funnels its exceptions through here.
+template <typename Function>
+[[nodiscard]] static inline gputester_status guard(Function&& function) {
+    try {
+        return function();
+    } catch (const std::bad_alloc&) {
+        return GPUTESTER_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return GPUTESTER_ERROR_INTERNAL;
+    }
+}
+
+// Whether a caller built against an older header passed "field" at all.
+#define GPUTESTER_HAS_OPTION(options, field) \
+    ((options)->struct_size >= offsetof(gputester_options, field) + sizeof((options)->field))
+
+uint32_t gputester_abi_version(void) {
+    return GPUTESTER_ABI_VERSION;
+}
+
+gputester_status gputester_context_create(const gputester_options* options, gputester_context** context_out) {
+    if (!context_out || (options && options->struct_size < sizeof(uint32_t))) {
+        return GPUTESTER_ERROR_INVALID_ARGUMENT;
+    }
+    *context_out = nullptr;
+    return guard([options, context_out]() {
+        const std::uint32_t flags = (options && GPUTESTER_HAS_OPTION(options, flags)) ? options->flags : GPUTESTER_FLAG_PARALLEL;
+        const std::chrono::milliseconds timeout = (options && GPUTESTER_HAS_OPTION(options, timeout_ms)) ? std::chrono::milliseconds{ options->timeout_ms } : kDefaultProbeTimeout;
+        backend_ptr_t backend = createNativeBackend();
+        if (!backend) {
+            return GPUTESTER_ERROR_NO_BACKEND;
+        }
+        auto context = std::make_unique<gputester_context>(std::move(backend));
+        if (flags & GPUTESTER_FLAG_PARALLEL) {
+            context->pool = std::make_unique<ThreadPool>();
+            context->options.pool = context->pool.get();
+        }
+        context->options.timeout = timeout;
+        context->options.recordProbes = (flags & GPUTESTER_FLAG_RECORD_PROBES) != 0;
+        *context_out = context.release();
+        return GPUTESTER_OK;
+    });
+}
+
+void gputester_context_destroy(gputester_context* context) {
+    delete context;
+}
+
+gputester_status gputester_probe(gputester_context* context, gputester_report** report_out) {
+    if (!context || !report_out) {
+        return GPUTESTER_ERROR_INVALID_ARGUMENT;
+    }
+    *report_out = nullptr;
+    return guard([context, report_out]() {
+        auto report = std::make_unique<gputester_report>();
+        {
+            const std::scoped_lock lock{ context->mutex };
+            if (!context->graph.update(report->report, context->options)) {
+                return GPUTESTER_ERROR_ENUMERATION_FAILED;
+            }
+        }
+        *report_out = report.release();
+        return GPUTESTER_OK;
+    });
+}
+
+gputester_status gputester_report_get_buffer(gputester_report* report, const gputester_format format, const uint8_t** data_out, size_t* size_out) {
+    if (!report || !data_out || !size_out || (static_cast<std::size_t>(format) >= report->buffers.size())) {
+        return GPUTESTER_ERROR_INVALID_ARGUMENT;
+    }
+    return guard([report, format, data_out, size_out]() {
+        std::optional<std::string>& buffer = report->buffers[static_cast<std::size_t>(format)];
+        if (!buffer) {
+            std::string formatted{};
+            formatReport(report->report, static_cast<output_format_t>(format), formatted, false);
+            buffer = std::move(formatted);
+        }
+        *data_out = reinterpret_cast<const uint8_t*>(buffer->c_str());
+        *size_out = buffer->size();
+        return GPUTESTER_OK;
+    });
+}
+
+void gputester_report_free(gputester_report* report) {
+    delete report;
+}
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* The C interface of libgputester, for processes which probe in-process instead of
+ * running the command line tool, e.g. through dlopen() or ctypes/cgo. Only plain C
+ * types cross this boundary, nothing here changes in an incompatible way without
+ * bumping GPUTESTER_ABI_VERSION. */
+
+#ifndef GPUTESTER_H
+#define GPUTESTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(GPUTESTER_BUILD_LIBRARY)
+#    define GPUTESTER_API __declspec(dllexport)
+#  else
+#    define GPUTESTER_API __declspec(dllimport)
+#  endif
+#else
+#  define GPUTESTER_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPUTESTER_ABI_VERSION 1
+
+typedef enum gputester_status {
+    GPUTESTER_OK = 0,
+    GPUTESTER_ERROR_INVALID_ARGUMENT = 1,
+    GPUTESTER_ERROR_NO_BACKEND = 2, /* There is no usable backend on this system. */
+    GPUTESTER_ERROR_ENUMERATION_FAILED = 3, /* The graphics adapters can't be enumerated. */
+    GPUTESTER_ERROR_OUT_OF_MEMORY = 4,
+    GPUTESTER_ERROR_INTERNAL = 5
+} gputester_status;
+
+typedef enum gputester_format {
+    GPUTESTER_FORMAT_TEXT = 0, /* The console output of the tool, without colors. */
+    GPUTESTER_FORMAT_JSON = 1,
+    GPUTESTER_FORMAT_NDJSON = 2,
+    GPUTESTER_FORMAT_BINARY = 3 /* See binary_report.hpp. */
+} gputester_format;
+
+/* Probe all adapters and outputs in parallel. */
+#define GPUTESTER_FLAG_PARALLEL 0x1u
+/* Include the status and latency of every probe in the report. */
+#define GPUTESTER_FLAG_RECORD_PROBES 0x2u
+
+typedef struct gputester_options {
+    uint32_t struct_size; /* sizeof(gputester_options), later versions only ever append fields. */
+    uint32_t flags; /* GPUTESTER_FLAG_* */
+    uint32_t timeout_ms; /* The deadline of a single probe, 0 to wait as long as it takes. */
+} gputester_options;
+
+/* Probes keep their state in a context: every probe after the first one only asks the OS
+ * again for what changed. A context may be used from any thread, probes of the same
+ * context run one at a time. */
+typedef struct gputester_context gputester_context;
+/* A probed report, independent of the context it came from. */
+typedef struct gputester_report gputester_report;
+
+/* GPUTESTER_ABI_VERSION of the loaded library, check it before calling anything else. */
+GPUTESTER_API uint32_t gputester_abi_version(void);
+
+/* "options" may be NULL for the defaults: in parallel, 5 second timeout. */
+GPUTESTER_API gputester_status gputester_context_create(const gputester_options* options, gputester_context** context_out);
+GPUTESTER_API void gputester_context_destroy(gputester_context* context);
+
+GPUTESTER_API gputester_status gputester_probe(gputester_context* context, gputester_report** report_out);
+
+/* The report in the given format. The buffer belongs to the report and stays valid until
+ * it is freed; text and JSON are UTF-8 and NUL terminated, "size_out" excludes the NUL.
+ * Unlike a context, a report must not be used by several threads at once. */
+GPUTESTER_API gputester_status gputester_report_get_buffer(gputester_report* report, gputester_format format, const uint8_t** data_out, size_t* size_out);
+GPUTESTER_API void gputester_report_free(gputester_report* report);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* GPUTESTER_H */
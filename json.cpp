@@ -0,0 +1,200 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "json.hpp"
+#include "text.hpp"
+#include <cassert>
+#include <charconv>
+#include <cmath>
+
+namespace gputester {
+
+static constexpr const char kHexDigits[]{ "0123456789abcdef" };
+
+template <typename CharT>
+[[nodiscard]] static inline bool needsEscape(const CharT ch) {
+    return ch == CharT('"') || ch == CharT('\\') || (static_cast<std::uint32_t>(ch) < 0x20);
+}
+
+static inline void appendEscape(std::string& buffer, const std::uint32_t ch) {
+    switch (ch) {
+        case '"':
+            buffer += "\\\"";
+            break;
+        case '\\':
+            buffer += "\\\\";
+            break;
+        case '\b':
+            buffer += "\\b";
+            break;
+        case '\f':
+            buffer += "\\f";
+            break;
+        case '\n':
+            buffer += "\\n";
+            break;
+        case '\r':
+            buffer += "\\r";
+            break;
+        case '\t':
+            buffer += "\\t";
+            break;
+        default: {
+            const char escape[]{ '\\', 'u', '0', '0', kHexDigits[(ch >> 4) & 0xF], kHexDigits[ch & 0xF] };
+            buffer.append(escape, sizeof(escape));
+        } break;
+    }
+}
+
+JsonWriter::JsonWriter(std::string& buffer) : m_buffer(buffer) {}
+
+void JsonWriter::beforeValue() {
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_depth == 0) {
+        return;
+    }
+    const std::uint64_t bit = std::uint64_t{ 1 } << (m_depth - 1);
+    if (m_hasElements & bit) {
+        m_buffer.push_back(',');
+    }
+    m_hasElements |= bit;
+}
+
+void JsonWriter::beginObject() {
+    beforeValue();
+    assert(m_depth < kMaxDepth);
+    m_buffer.push_back('{');
+    ++m_depth;
+    m_hasElements &= ~(std::uint64_t{ 1 } << (m_depth - 1));
+}
+
+void JsonWriter::endObject() {
+    assert(m_depth > 0 && !m_afterKey);
+    --m_depth;
+    m_buffer.push_back('}');
+}
+
+void JsonWriter::beginArray() {
+    beforeValue();
+    assert(m_depth < kMaxDepth);
+    m_buffer.push_back('[');
+    ++m_depth;
+    m_hasElements &= ~(std::uint64_t{ 1 } << (m_depth - 1));
+}
+
+void JsonWriter::endArray() {
+    assert(m_depth > 0 && !m_afterKey);
+    --m_depth;
+    m_buffer.push_back(']');
+}
+
+void JsonWriter::key(const std::string_view name) {
+    assert(m_depth > 0 && !m_afterKey);
+    beforeValue();
+    m_buffer.push_back('"');
+    m_buffer.append(name);
+    m_buffer += "\":";
+    m_afterKey = true;
+}
+
+void JsonWriter::value(const std::wstring_view str) {
+    beforeValue();
+    m_buffer.push_back('"');
+    // Convert the runs between escapes in one go, which keeps the common case a straight copy.
+    std::size_t runBegin{ 0 };
+    for (std::size_t index = 0; index != str.size(); ++index) {
+        if (!needsEscape(str[index])) {
+            continue;
+        }
+        appendUtf8(m_buffer, str.substr(runBegin, index - runBegin));
+        appendEscape(m_buffer, static_cast<std::uint32_t>(str[index]));
+        runBegin = index + 1;
+    }
+    appendUtf8(m_buffer, str.substr(runBegin));
+    m_buffer.push_back('"');
+}
+
+void JsonWriter::value(const std::string_view str) {
+    beforeValue();
+    m_buffer.push_back('"');
+    std::size_t runBegin{ 0 };
+    for (std::size_t index = 0; index != str.size(); ++index) {
+        if (!needsEscape(static_cast<unsigned char>(str[index]))) {
+            continue;
+        }
+        m_buffer.append(str.substr(runBegin, index - runBegin));
+        appendEscape(m_buffer, static_cast<unsigned char>(str[index]));
+        runBegin = index + 1;
+    }
+    m_buffer.append(str.substr(runBegin));
+    m_buffer.push_back('"');
+}
+
+void JsonWriter::value(const char* str) {
+    value(std::string_view{ str });
+}
+
+void JsonWriter::value(const bool boolean) {
+    beforeValue();
+    m_buffer += boolean ? "true" : "false";
+}
+
+void JsonWriter::value(const float number) {
+    if (!std::isfinite(number)) {
+        nullValue();
+        return;
+    }
+    beforeValue();
+    char buffer[32]{};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    m_buffer.append(buffer, result.ptr);
+}
+
+void JsonWriter::value(const std::uint64_t number) {
+    beforeValue();
+    char buffer[24]{};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    m_buffer.append(buffer, result.ptr);
+}
+
+void JsonWriter::value(const std::int64_t number) {
+    beforeValue();
+    char buffer[24]{};
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    m_buffer.append(buffer, result.ptr);
+}
+
+void JsonWriter::nullValue() {
+    beforeValue();
+    m_buffer += "null";
+}
+
+bool JsonWriter::isComplete() const {
+    return m_depth == 0 && !m_afterKey;
+}
+
+} // namespace gputester
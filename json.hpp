@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace gputester {
+
+// A streaming JSON writer appending straight to a caller owned buffer: there is no DOM
+// and nothing is allocated per field. Commas are tracked per nesting level, keys must be
+// plain ASCII, string values are escaped and converted to UTF-8 on the fly.
+class JsonWriter final {
+public:
+    explicit JsonWriter(std::string& buffer);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(const std::string_view name);
+
+    void value(const std::wstring_view str);
+    void value(const std::string_view str); // Must be UTF-8.
+    void value(const char* str);
+    void value(const bool boolean);
+    void value(const float number); // Shortest round trip form, NaN and infinity become null.
+    void value(const std::uint64_t number);
+    void value(const std::int64_t number);
+    void nullValue();
+
+    template <typename T>
+        requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    void value(const T number) {
+        if constexpr (std::is_signed_v<T>) {
+            value(static_cast<std::int64_t>(number));
+        } else {
+            value(static_cast<std::uint64_t>(number));
+        }
+    }
+
+    template <typename T>
+    void field(const std::string_view name, const T& fieldValue) {
+        key(name);
+        value(fieldValue);
+    }
+
+    // The document is complete, the writer can start the next one (e.g. the next NDJSON line).
+    [[nodiscard]] bool isComplete() const;
+
+private:
+    void beforeValue();
+
+    static constexpr const std::uint32_t kMaxDepth{ 64 };
+
+    std::string& m_buffer;
+    std::uint64_t m_hasElements{ 0 }; // One bit per nesting level.
+    std::uint32_t m_depth{ 0 };
+    bool m_afterKey{ false };
+};
+
+} // namespace gputester
@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "mapped_file.hpp"
+#ifdef _WIN32
+#  include "win32.hpp"
+#else
+#  include "text.hpp"
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <cerrno>
+#  include <cstring>
+#endif
+#include <iostream>
+#include <utility>
+
+namespace gputester {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+    , m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+#ifdef _WIN32
+    const HANDLE file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::wcerr << L"\"CreateFileW\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        return false;
+    }
+    LARGE_INTEGER fileSize{};
+    if (!::GetFileSizeEx(file, &fileSize)) {
+        std::wcerr << L"\"GetFileSizeEx\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        ::CloseHandle(file);
+        return false;
+    }
+    if (fileSize.QuadPart == 0) { // Empty files can't be mapped, but they are valid files.
+        ::CloseHandle(file);
+        return true;
+    }
+    const HANDLE mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    ::CloseHandle(file); // The mapping keeps the file open.
+    if (!mapping) {
+        std::wcerr << L"\"CreateFileMappingW\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        return false;
+    }
+    const void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        std::wcerr << L"\"MapViewOfFile\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        ::CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+    return true;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::wcerr << L"Failed to open \"" << path.wstring() << L"\": " << utf8ToWide(std::strerror(errno)) << std::endl;
+        return false;
+    }
+    struct stat status{};
+    if (::fstat(fd, &status) != 0) {
+        std::wcerr << L"\"fstat\" failed: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    if (status.st_size == 0) { // Empty files can't be mapped, but they are valid files.
+        ::close(fd);
+        return true;
+    }
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the file open.
+    if (view == MAP_FAILED) {
+        std::wcerr << L"\"mmap\" failed: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        return false;
+    }
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(status.st_size);
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (m_data) {
+        ::UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        ::CloseHandle(static_cast<HANDLE>(m_mapping));
+        m_mapping = nullptr;
+    }
+#else
+    if (m_data) {
+        ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+    return m_data != nullptr;
+}
+
+const std::uint8_t* MappedFile::data() const {
+    return m_data;
+}
+
+std::size_t MappedFile::size() const {
+    return m_size;
+}
+
+} // namespace gputester
@@ -0,0 +1,203 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "model.hpp"
+#include <unordered_map>
+
+namespace gputester {
+
+// Based on //third_party/angle/src/gpu_info_util/SystemInfo.h
+static const std::unordered_map<std::uint64_t, vendor_t> vendorIdMap = {
+    { 0x0000,  vendor_t::Unknown },
+    { 0x1002,  vendor_t::AMD },
+    { 0x106B,  vendor_t::Apple },
+    { 0x13B5,  vendor_t::ARM },
+    { 0x1AE0,  vendor_t::Google },
+    { 0x1010,  vendor_t::ImgTec },
+    { 0x8086,  vendor_t::Intel },
+    { 0x1414,  vendor_t::Microsoft },
+    { 0x10DE,  vendor_t::Nvidia },
+    { 0x5143,  vendor_t::Qualcomm },
+    { 0x144D,  vendor_t::Samsung },
+    { 0x14E4,  vendor_t::Broadcom },
+    { 0x15AD,  vendor_t::VMWare },
+    { 0x1AF4,  vendor_t::VirtIO },
+    { 0x10001, vendor_t::Vivante },
+    { 0x10002, vendor_t::VeriSilicon },
+    { 0x10003, vendor_t::Kazan },
+    { 0x10004, vendor_t::CodePlay },
+    { 0x10005, vendor_t::Mesa },
+    { 0x10006, vendor_t::PoCL },
+};
+
+static const std::unordered_map<vendor_t, std::wstring_view> vendorNameMap = {
+    { vendor_t::Unknown,     L"Unknown" },
+    { vendor_t::AMD,         L"AMD" },
+    { vendor_t::Apple,       L"Apple" },
+    { vendor_t::ARM,         L"ARM" },
+    { vendor_t::Google,      L"Google" },
+    { vendor_t::ImgTec,      L"Img Tec" },
+    { vendor_t::Intel,       L"Intel" },
+    { vendor_t::Microsoft,   L"Microsoft" },
+    { vendor_t::Nvidia,      L"Nvidia" },
+    { vendor_t::Qualcomm,    L"Qualcomm" },
+    { vendor_t::Samsung,     L"Samsung" },
+    { vendor_t::Broadcom,    L"Broadcom" },
+    { vendor_t::VMWare,      L"VMWare" },
+    { vendor_t::VirtIO,      L"VirtIO" },
+    { vendor_t::Vivante,     L"Vivante" },
+    { vendor_t::VeriSilicon, L"VeriSilicon" },
+    { vendor_t::Kazan,       L"Kazan" },
+    { vendor_t::CodePlay,    L"CodePlay" },
+    { vendor_t::Mesa,        L"Mesa" },
+    { vendor_t::PoCL,        L"PoCL" },
+};
+
+vendor_t vendorIdToVendor(const std::uint64_t vendorId) {
+    const auto it = vendorIdMap.find(vendorId);
+    if (it != vendorIdMap.end()) {
+        return it->second;
+    }
+    return vendor_t::Unknown;
+}
+
+std::wstring_view vendorToString(const vendor_t vendor) {
+    const auto it = vendorNameMap.find(vendor);
+    if (it != vendorNameMap.end()) {
+        return it->second;
+    }
+    return vendorNameMap.at(vendor_t::Unknown);
+}
+
+std::wstring_view rotationToString(const rotation_t rotation) {
+    switch (rotation) {
+        case rotation_t::Unspecified:
+            return L"Unspecified";
+        case rotation_t::Identity:
+            return L"0";
+        case rotation_t::Rotate90:
+            return L"90";
+        case rotation_t::Rotate180:
+            return L"180";
+        case rotation_t::Rotate270:
+            return L"270";
+        default:
+            return L"Unknown";
+    }
+}
+
+std::wstring_view colorSpaceToString(const color_space_t colorSpace) {
+    switch (colorSpace) {
+        case color_space_t::RGB_FULL_G22_NONE_P709:
+            return L"[sRGB] RGB (0-255), gamma: 2.2, siting: image, primaries: BT.709";
+        case color_space_t::RGB_FULL_G10_NONE_P709:
+            return L"[scRGB] RGB (0-255), gamma: 1.0, siting: image, primaries: BT.709";
+        case color_space_t::RGB_STUDIO_G22_NONE_P709:
+            return L"[ITU-R] RGB (16-235), gamma: 2.2, siting: image, primaries: BT.709";
+        case color_space_t::RGB_STUDIO_G22_NONE_P2020:
+            return L"[HDR] RGB (16-235), gamma: 2.2, siting: image, primaries: BT.2020";
+        case color_space_t::YCBCR_FULL_G22_NONE_P709_X601:
+            return L"YCbCr (0-255), gamma: 2.2, siting: image, primaries: BT.709, transfer matrix: BT.601";
+        case color_space_t::YCBCR_STUDIO_G22_LEFT_P601:
+            return L"YCbCr (16-235), gamma: 2.2, siting: video, primaries: BT.601";
+        case color_space_t::YCBCR_FULL_G22_LEFT_P601:
+            return L"YCbCr (0-255), gamma: 2.2, siting: video, primaries: BT.601";
+        case color_space_t::YCBCR_STUDIO_G22_LEFT_P709:
+            return L"YCbCr (16-235), gamma: 2.2, siting: video, primaries: BT.709";
+        case color_space_t::YCBCR_FULL_G22_LEFT_P709:
+            return L"YCbCr (0-255), gamma: 2.2, siting: video, primaries: BT.709";
+        case color_space_t::YCBCR_STUDIO_G22_LEFT_P2020:
+            return L"[HDR] YCbCr (16-235), gamma: 2.2, siting: video, primaries: BT.2020";
+        case color_space_t::YCBCR_FULL_G22_LEFT_P2020:
+            return L"[HDR] YCbCr (0-255), gamma: 2.2, siting: video, primaries: BT.2020";
+        case color_space_t::RGB_FULL_G2084_NONE_P2020:
+            return L"[HDR] RGB (0-255), gamma: 2084, siting: image, primaries: BT.2020";
+        case color_space_t::YCBCR_STUDIO_G2084_LEFT_P2020:
+            return L"[HDR] YCbCr (16-235), gamma: 2084, siting: video, primaries: BT.2020";
+        case color_space_t::RGB_STUDIO_G2084_NONE_P2020:
+            return L"[HDR] RGB (16-235), gamma: 2084, siting: image, primaries: BT.2020";
+        case color_space_t::YCBCR_STUDIO_G22_TOPLEFT_P2020:
+            return L"[HDR] YCbCr (16-235), gamma: 2.2, siting: video, primaries: BT.2020";
+        case color_space_t::YCBCR_STUDIO_G2084_TOPLEFT_P2020:
+            return L"[HDR] YCbCr (16-235), gamma: 2084, siting: video, primaries: BT.2020";
+        case color_space_t::RGB_FULL_G22_NONE_P2020:
+            return L"[HDR] RGB (0-255), gamma: 2.2, siting: image, primaries: BT.2020";
+        case color_space_t::YCBCR_STUDIO_GHLG_TOPLEFT_P2020:
+            return L"[HDR] YCbCr (16-235), gamma: HLG, siting: video, primaries: BT.2020";
+        case color_space_t::YCBCR_FULL_GHLG_TOPLEFT_P2020:
+            return L"[HDR] YCbCr (0-255), gamma: HLG, siting: video, primaries: BT.2020";
+        case color_space_t::RGB_STUDIO_G24_NONE_P709:
+            return L"RGB (16-235), gamma: 2.4, siting: image, primaries: BT.709";
+        case color_space_t::RGB_STUDIO_G24_NONE_P2020:
+            return L"[HDR] RGB (16-235), gamma: 2.4, siting: image, primaries: BT.2020";
+        case color_space_t::YCBCR_STUDIO_G24_LEFT_P709:
+            return L"YCbCr (16-235), gamma: 2.4, siting: video, primaries: BT.709";
+        case color_space_t::YCBCR_STUDIO_G24_LEFT_P2020:
+            return L"[HDR] YCbCr (16-235), gamma: 2.4, siting: video, primaries: BT.2020";
+        case color_space_t::YCBCR_STUDIO_G24_TOPLEFT_P2020:
+            return L"[HDR] YCbCr (16-235), gamma: 2.4, siting: video, primaries: BT.2020";
+        default:
+            return L"Unknown";
+    }
+}
+
+std::wstring_view probeNodeToString(const probe_node_t node) {
+    switch (node) {
+        case probe_node_t::AdapterDesc:
+            return L"adapterDesc";
+        case probe_node_t::DriverInfo:
+            return L"driverInfo";
+        case probe_node_t::OutputList:
+            return L"outputList";
+        case probe_node_t::ModeInfo:
+            return L"modeInfo";
+        case probe_node_t::ColorInfo:
+            return L"colorInfo";
+        case probe_node_t::PathInfo:
+            return L"pathInfo";
+        case probe_node_t::Dpi:
+            return L"dpi";
+        default:
+            return L"unknown";
+    }
+}
+
+std::wstring_view probeStatusToString(const probe_status_t status) {
+    switch (status) {
+        case probe_status_t::NotRun:
+            return L"notRun";
+        case probe_status_t::Succeeded:
+            return L"succeeded";
+        case probe_status_t::Failed:
+            return L"failed";
+        case probe_status_t::TimedOut:
+            return L"timedOut";
+        case probe_status_t::Reused:
+            return L"reused";
+        default:
+            return L"unknown";
+    }
+}
+
+} // namespace gputester
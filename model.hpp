@@ -0,0 +1,230 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gputester {
+
+enum class vendor_t : std::int8_t {
+    Unknown = -1,
+    // PCI-SIG-registered vendors
+    AMD,
+    Apple,
+    ARM,
+    Google,
+    ImgTec,
+    Intel,
+    Microsoft,
+    Nvidia,
+    Qualcomm,
+    Samsung,
+    Broadcom,
+    VMWare,
+    VirtIO,
+    // Khronos-registered vendors
+    Vivante,
+    VeriSilicon,
+    Kazan,
+    CodePlay,
+    Mesa,
+    PoCL,
+};
+
+// Same numeric values as DXGI_MODE_ROTATION, so the raw value can be passed through as is.
+enum class rotation_t : std::uint32_t {
+    Unspecified = 0,
+    Identity = 1,
+    Rotate90 = 2,
+    Rotate180 = 3,
+    Rotate270 = 4,
+};
+
+// Same numeric values as DXGI_COLOR_SPACE_TYPE.
+enum class color_space_t : std::uint32_t {
+    RGB_FULL_G22_NONE_P709 = 0,
+    RGB_FULL_G10_NONE_P709 = 1,
+    RGB_STUDIO_G22_NONE_P709 = 2,
+    RGB_STUDIO_G22_NONE_P2020 = 3,
+    RESERVED = 4,
+    YCBCR_FULL_G22_NONE_P709_X601 = 5,
+    YCBCR_STUDIO_G22_LEFT_P601 = 6,
+    YCBCR_FULL_G22_LEFT_P601 = 7,
+    YCBCR_STUDIO_G22_LEFT_P709 = 8,
+    YCBCR_FULL_G22_LEFT_P709 = 9,
+    YCBCR_STUDIO_G22_LEFT_P2020 = 10,
+    YCBCR_FULL_G22_LEFT_P2020 = 11,
+    RGB_FULL_G2084_NONE_P2020 = 12,
+    YCBCR_STUDIO_G2084_LEFT_P2020 = 13,
+    RGB_STUDIO_G2084_NONE_P2020 = 14,
+    YCBCR_STUDIO_G22_TOPLEFT_P2020 = 15,
+    YCBCR_STUDIO_G2084_TOPLEFT_P2020 = 16,
+    RGB_FULL_G22_NONE_P2020 = 17,
+    YCBCR_STUDIO_GHLG_TOPLEFT_P2020 = 18,
+    YCBCR_FULL_GHLG_TOPLEFT_P2020 = 19,
+    RGB_STUDIO_G24_NONE_P709 = 20,
+    RGB_STUDIO_G24_NONE_P2020 = 21,
+    YCBCR_STUDIO_G24_LEFT_P709 = 22,
+    YCBCR_STUDIO_G24_LEFT_P2020 = 23,
+    YCBCR_STUDIO_G24_TOPLEFT_P2020 = 24,
+    Custom = 0xFFFFFFFF,
+};
+
+// Same value as DXGI_ADAPTER_FLAG_SOFTWARE.
+static constexpr const std::uint32_t kAdapterFlagSoftware{ 2 };
+static constexpr const std::uint32_t kDefaultScreenDpi{ 96 }; // USER_DEFAULT_SCREEN_DPI
+
+// The pieces of information a report is made of, see ProbeGraph.
+enum class probe_node_t : std::uint8_t {
+    AdapterDesc,
+    DriverInfo,
+    OutputList,
+    ModeInfo,
+    ColorInfo, // The HDR description of the display.
+    PathInfo,
+    Dpi,
+};
+static constexpr const std::size_t kProbeNodeCount{ 7 };
+
+enum class probe_status_t : std::uint8_t {
+    NotRun, // Not asked for, or not recorded (see ProbeOptions::recordProbes).
+    Succeeded,
+    Failed, // The backend has no answer.
+    TimedOut, // Missed ProbeOptions::timeout and was abandoned, its part of the report stays empty.
+    Reused // Answered by the probe graph without asking the backend.
+};
+
+struct ProbeRecord final {
+    probe_status_t status{ probe_status_t::NotRun };
+    std::chrono::nanoseconds latency{ 0 };
+};
+
+// Indexed by probe_node_t: an adapter fills the DriverInfo and OutputList slots, an output the
+// ModeInfo, ColorInfo, PathInfo and Dpi ones.
+using probe_records_t = std::array<ProbeRecord, kProbeNodeCount>;
+
+struct AdapterDesc final {
+    std::uint32_t index{ 0 }; // Enumeration order, backends use it to find their native handles.
+    std::wstring description{};
+    std::uint32_t vendorId{ 0 };
+    std::uint32_t deviceId{ 0 };
+    std::uint32_t subSysId{ 0 };
+    std::uint32_t revision{ 0 };
+    std::uint64_t dedicatedVideoMemory{ 0 }; // In bytes.
+    std::uint64_t dedicatedSystemMemory{ 0 }; // In bytes.
+    std::uint64_t sharedSystemMemory{ 0 }; // In bytes.
+    std::uint64_t luid{ 0 }; // HighPart in the upper 32 bits.
+    std::uint32_t flags{ 0 };
+    std::optional<bool> integrated{};
+
+    [[nodiscard]] bool operator==(const AdapterDesc&) const = default;
+};
+
+struct DriverInfo final {
+    std::wstring provider{};
+    std::wstring version{};
+    std::wstring date{};
+
+    [[nodiscard]] bool operator==(const DriverInfo&) const = default;
+};
+
+struct OutputDesc final {
+    std::uint32_t adapterIndex{ 0 };
+    std::uint32_t index{ 0 };
+    std::wstring deviceName{};
+    std::int32_t left{ 0 };
+    std::int32_t top{ 0 };
+    std::int32_t right{ 0 };
+    std::int32_t bottom{ 0 };
+    bool attachedToDesktop{ false };
+    rotation_t rotation{ rotation_t::Unspecified };
+
+    [[nodiscard]] bool operator==(const OutputDesc&) const = default;
+};
+
+struct ModeInfo final {
+    float maxRefreshRate{ 0.f };
+};
+
+struct ColorInfo final {
+    std::uint32_t bitsPerColor{ 0 };
+    color_space_t colorSpace{ color_space_t::RGB_FULL_G22_NONE_P709 };
+    float redPrimary[2]{};
+    float greenPrimary[2]{};
+    float bluePrimary[2]{};
+    float whitePoint[2]{};
+    float minLuminance{ 0.f };
+    float maxLuminance{ 0.f };
+    float maxFullFrameLuminance{ 0.f };
+};
+
+struct PathInfo final {
+    std::optional<float> sdrWhiteLevel{}; // In nits.
+    std::optional<float> currentRefreshRate{};
+    std::optional<std::wstring> friendlyName{};
+};
+
+// The display connected to an output.
+struct DisplayInfo final {
+    std::optional<ModeInfo> mode{};
+    std::optional<ColorInfo> color{};
+    std::optional<PathInfo> path{};
+    std::optional<std::uint32_t> dpi{};
+};
+
+struct OutputInfo final {
+    OutputDesc desc{};
+    DisplayInfo display{};
+    probe_records_t probes{}; // Diagnostics, not part of the binary report.
+};
+
+struct AdapterInfo final {
+    AdapterDesc desc{};
+    std::optional<DriverInfo> driver{};
+    std::vector<OutputInfo> outputs{};
+    probe_records_t probes{}; // Diagnostics, not part of the binary report.
+};
+
+// Everything one run found out, filled by the probes and rendered by the formatters.
+struct GpuReport final {
+    std::wstring backend{};
+    bool variableRefreshRateSupported{ false };
+    std::vector<AdapterInfo> adapters{};
+};
+
+[[nodiscard]] vendor_t vendorIdToVendor(const std::uint64_t vendorId);
+[[nodiscard]] std::wstring_view vendorToString(const vendor_t vendor);
+[[nodiscard]] std::wstring_view rotationToString(const rotation_t rotation);
+[[nodiscard]] std::wstring_view colorSpaceToString(const color_space_t colorSpace);
+[[nodiscard]] std::wstring_view probeNodeToString(const probe_node_t node);
+[[nodiscard]] std::wstring_view probeStatusToString(const probe_status_t status);
+
+} // namespace gputester
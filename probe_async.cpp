@@ -0,0 +1,158 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "probe_async.hpp"
+#include "probe_call.hpp"
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace gputester {
+
+// The coroutine twins of probeOutput() and probeAdapter() in report.cpp: every backend call is awaited, so
+// a probe only occupies a pool thread while it isn't waiting for the OS. The result is always true, Task
+// needs a value.
+static Task<bool> probeOutputAsync(Backend& backend, const ProbeOptions& options, OutputInfo& outputInfo) {
+    const OutputDesc& output = outputInfo.desc;
+    DisplayInfo& display = outputInfo.display;
+    const auto has = [&options](const probe_node_t node) {
+        return (options.nodes & probeNodeBit(node)) != 0;
+    };
+    const auto record = [&outputInfo](const probe_node_t node) -> ProbeRecord& {
+        return outputInfo.probes[static_cast<std::size_t>(node)];
+    };
+    if (has(probe_node_t::ModeInfo)) {
+        const auto probe = [output](Backend& backend, ModeInfo& infoOut) {
+            return backend.getModeInfo(output, infoOut);
+        };
+        std::ignore = co_await callProbeAsync<ModeInfo>(backend, options, probe, display.mode, record(probe_node_t::ModeInfo));
+    }
+    if (has(probe_node_t::ColorInfo)) {
+        const auto probe = [output](Backend& backend, ColorInfo& infoOut) {
+            return backend.getColorInfo(output, infoOut);
+        };
+        std::ignore = co_await callProbeAsync<ColorInfo>(backend, options, probe, display.color, record(probe_node_t::ColorInfo));
+    }
+    if (has(probe_node_t::PathInfo)) {
+        const auto probe = [output](Backend& backend, PathInfo& infoOut) {
+            return backend.getPathInfo(output, infoOut);
+        };
+        std::ignore = co_await callProbeAsync<PathInfo>(backend, options, probe, display.path, record(probe_node_t::PathInfo));
+    }
+    if (has(probe_node_t::Dpi)) {
+        const auto probe = [output](Backend& backend, std::uint32_t& dpiOut) {
+            dpiOut = kDefaultScreenDpi;
+            return backend.getDpi(output, dpiOut);
+        };
+        std::ignore = co_await callProbeAsync<std::uint32_t>(backend, options, probe, display.dpi, record(probe_node_t::Dpi));
+    }
+    co_return true;
+}
+
+static Task<bool> probeAdapterAsync(Backend& backend, const ProbeOptions& options, AdapterInfo& adapterInfo) {
+    const AdapterDesc& adapter = adapterInfo.desc;
+    if (options.nodes & probeNodeBit(probe_node_t::DriverInfo)) {
+        const auto probe = [adapter](Backend& backend, DriverInfo& infoOut) {
+            return backend.getDriverInfo(adapter, infoOut);
+        };
+        std::ignore = co_await callProbeAsync<DriverInfo>(backend, options, probe, adapterInfo.driver, adapterInfo.probes[static_cast<std::size_t>(probe_node_t::DriverInfo)]);
+    }
+    if ((options.nodes & (probeNodeBit(probe_node_t::OutputList) | kOutputProbeNodes)) == 0) {
+        co_return true;
+    }
+    std::optional<std::vector<OutputDesc>> outputs{};
+    const auto enumerate = [adapter](Backend& backend, std::vector<OutputDesc>& outputsOut) {
+        return backend.enumerateOutputs(adapter, outputsOut);
+    };
+    std::ignore = co_await callProbeAsync<std::vector<OutputDesc>>(backend, options, enumerate, outputs, adapterInfo.probes[static_cast<std::size_t>(probe_node_t::OutputList)]);
+    if (!outputs) {
+        co_return true;
+    }
+    adapterInfo.outputs.resize(outputs->size());
+    for (std::size_t index = 0; index != outputs->size(); ++index) {
+        adapterInfo.outputs[index].desc = std::move((*outputs)[index]);
+    }
+    if ((options.nodes & kOutputProbeNodes) == 0) {
+        co_return true;
+    }
+    std::vector<Task<bool>> tasks{};
+    tasks.reserve(adapterInfo.outputs.size());
+    for (auto&& outputInfo : adapterInfo.outputs) {
+        tasks.push_back(probeOutputAsync(backend, options, outputInfo));
+    }
+    std::ignore = co_await whenAll(std::move(tasks));
+    co_return true;
+}
+
+// The options are taken by value: the task first runs when it is awaited, the caller's
+// ProbeOptions may be gone by then, and only parameters passed by value live in the coroutine frame.
+Task<std::optional<GpuReport>> probeAsync(backend_ptr_t backend, const ProbeOptions options) {
+    GpuReport report{};
+    if (!options.pool) {
+        if (!probe(*backend, report, options)) {
+            co_return std::nullopt;
+        }
+        co_return std::move(report);
+    }
+    report.backend = backend->name();
+    // The calls abandoned last time may still be using the handle table enumeration would rebuild.
+    if (backend->abandonedProbeCount() != 0) {
+        co_return std::nullopt;
+    }
+    ProbeRecord record{};
+    std::optional<std::vector<AdapterDesc>> adapters{};
+    const auto enumerate = [](Backend& backend, std::vector<AdapterDesc>& adaptersOut) {
+        return backend.enumerateAdapters(adaptersOut);
+    };
+    if (co_await callProbeAsync<std::vector<AdapterDesc>>(*backend, options, enumerate, adapters, record) != probe_status_t::Succeeded) {
+        co_return std::nullopt;
+    }
+    std::optional<bool> variableRefreshRateSupported{};
+    const auto queryVariableRefreshRate = [](Backend& backend, bool& supportedOut) {
+        return backend.getVariableRefreshRateSupport(supportedOut);
+    };
+    std::ignore = co_await callProbeAsync<bool>(*backend, options, queryVariableRefreshRate, variableRefreshRateSupported, record);
+    report.variableRefreshRateSupported = variableRefreshRateSupported.value_or(false);
+    report.adapters.resize(adapters->size());
+    for (std::size_t index = 0; index != adapters->size(); ++index) {
+        report.adapters[index].desc = std::move((*adapters)[index]);
+    }
+    std::vector<Task<bool>> tasks{};
+    tasks.reserve(report.adapters.size());
+    for (auto&& adapterInfo : report.adapters) {
+        tasks.push_back(probeAdapterAsync(*backend, options, adapterInfo));
+    }
+    std::ignore = co_await whenAll(std::move(tasks));
+    co_return std::move(report);
+}
+
+Task<std::optional<GpuReport>> probeAsync(ProbeGraph& graph, const ProbeOptions options) {
+    GpuReport report{};
+    if (!co_await graph.updateAsync(report, options)) {
+        co_return std::nullopt;
+    }
+    co_return std::move(report);
+}
+
+} // namespace gputester
@@ -0,0 +1,44 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "probe_graph.hpp"
+#include "report.hpp"
+#include "task.hpp"
+#include <optional>
+
+namespace gputester {
+
+// The coroutine flavors of probe() and ProbeGraph::update(), for applications which probe from an
+// event loop. Every blocking OS call runs on a helper thread (see startBlockingCall()) while the probe
+// is suspended, and the probe continues on ProbeOptions::pool in between, where the awaiting coroutine
+// also resumes once the report is complete; any number of probes can be in flight without holding a
+// pool thread. Without a pool the probes run on the awaiting thread.
+// Empty if the adapters can't be enumerated.
+[[nodiscard]] Task<std::optional<GpuReport>> probeAsync(backend_ptr_t backend, const ProbeOptions options = {});
+// "graph" must outlive the task, and only one update of it may be in flight at a time.
+[[nodiscard]] Task<std::optional<GpuReport>> probeAsync(ProbeGraph& graph, const ProbeOptions options = {});
+
+} // namespace gputester
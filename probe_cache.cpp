@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "probe_cache.hpp"
+#include "atomic_file.hpp"
+#include "mapped_file.hpp"
+#include "text.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace gputester {
+
+std::filesystem::path getDefaultProbeCachePath() {
+    std::filesystem::path directory{};
+#ifdef _WIN32
+    if (const wchar_t* localAppData = _wgetenv(L"LOCALAPPDATA"); localAppData && *localAppData) {
+        directory = localAppData;
+    }
+#else
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"); cacheHome && *cacheHome) {
+        directory = cacheHome;
+    } else if (const char* home = std::getenv("HOME"); home && *home) {
+        directory = std::filesystem::path{ home } / ".cache";
+    }
+#endif
+    if (directory.empty()) {
+        return {};
+    }
+    return directory / "gputester" / "probe-cache.bin";
+}
+
+// The mapping is gone again on return, Windows can't replace a file which is still mapped.
+[[nodiscard]] static inline bool hasContent(const std::filesystem::path& path, const std::string_view content) {
+    std::error_code error{};
+    if (std::filesystem::file_size(path, error) != content.size() || error || content.empty()) {
+        return false;
+    }
+    MappedFile file{};
+    return file.open(path) && std::memcmp(file.data(), content.data(), content.size()) == 0;
+}
+
+bool loadProbeCache(const std::filesystem::path& path, ProbeGraph& graph) {
+    std::error_code error{};
+    // No cache yet is the normal cold start, not worth a message.
+    if (!std::filesystem::is_regular_file(path, error)) {
+        return false;
+    }
+    MappedFile file{};
+    if (!file.open(path)) {
+        return false;
+    }
+    if (!graph.loadState(file.data(), file.size())) {
+        std::wcerr << L"Ignoring the outdated or corrupted probe cache \"" << path.wstring() << L"\"." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool saveProbeCache(const std::filesystem::path& path, const ProbeGraph& graph) {
+    std::string state{};
+    graph.saveState(state);
+    // Nothing changed, which is the common case of a warm start.
+    if (hasContent(path, state)) {
+        return true;
+    }
+    std::error_code error{};
+    std::filesystem::create_directories(path.parent_path(), error);
+    if (error) {
+        std::wcerr << L"Failed to create \"" << path.parent_path().wstring() << L"\": " << utf8ToWide(error.message()) << std::endl;
+        return false;
+    }
+    return writeFileAtomically(path, state);
+}
+
+} // namespace gputester
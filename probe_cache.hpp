@@ -0,0 +1,44 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "probe_graph.hpp"
+#include <filesystem>
+
+namespace gputester {
+
+// %LOCALAPPDATA%\gputester\probe-cache.bin on Windows, $XDG_CACHE_HOME/gputester/probe-cache.bin
+// (or ~/.cache/...) elsewhere. Empty if none of these locations is known.
+[[nodiscard]] std::filesystem::path getDefaultProbeCachePath();
+
+// Loads the state a previous run saved into "graph". Returns false if there is no usable cache,
+// the graph then starts empty and the first update() runs every probe.
+[[nodiscard]] bool loadProbeCache(const std::filesystem::path& path, ProbeGraph& graph);
+
+// Saves the state of "graph", unless the file already holds exactly that. The file is replaced
+// atomically, a concurrent run sees either the old or the new state.
+[[nodiscard]] bool saveProbeCache(const std::filesystem::path& path, const ProbeGraph& graph);
+
+} // namespace gputester
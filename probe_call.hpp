@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include "blocking_call.hpp"
+#include "report.hpp"
+#include "task.hpp"
+#include "thread_pool.hpp"
+#include <chrono>
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+namespace gputester {
+
+// What a probe call shares with the helper thread it runs on, it may outlive the caller.
+template <typename T>
+struct ProbeCallState final {
+    std::mutex mutex{};
+    T value{};
+    bool succeeded{ false };
+    bool finished{ false };
+    bool abandoned{ false };
+};
+
+template <typename T, typename Probe>
+[[nodiscard]] inline std::function<void()> makeProbeCall(backend_ptr_t owner, std::shared_ptr<ProbeCallState<T>> call, Probe probe) {
+    return [owner = std::move(owner), call = std::move(call), probe = std::move(probe)]() {
+        T result{};
+        const bool succeeded = probe(*owner, result);
+        const std::scoped_lock lock{ call->mutex };
+        call->value = std::move(result);
+        call->succeeded = succeeded;
+        call->finished = true;
+        if (call->abandoned) {
+            owner->abandonedProbeReturned();
+        }
+    };
+}
+
+// Decided under the lock: a call that returns right after the deadline still counts.
+template <typename T>
+[[nodiscard]] inline probe_status_t collectProbeCall(Backend& owner, ProbeCallState<T>& call, T& valueOut) {
+    const std::scoped_lock lock{ call.mutex };
+    if (!call.finished) {
+        call.abandoned = true;
+        owner.probeAbandoned();
+        return probe_status_t::TimedOut;
+    }
+    valueOut = std::move(call.value);
+    return call.succeeded ? probe_status_t::Succeeded : probe_status_t::Failed;
+}
+
+template <typename T>
+inline void finishProbeCall(const ProbeOptions& options, const std::chrono::steady_clock::time_point start, const probe_status_t status, T& value,
+                            std::optional<T>& valueOut, ProbeRecord& recordOut) {
+    if (status == probe_status_t::Succeeded) {
+        valueOut = std::move(value);
+    } else {
+        valueOut.reset();
+    }
+    if (options.recordProbes || status == probe_status_t::TimedOut) {
+        recordOut.status = status;
+        recordOut.latency = std::chrono::steady_clock::now() - start;
+    }
+}
+
+// Runs a single probe for probe() and ProbeGraph: "probe(backend, valueOut)" returns the backend's
+// answer. Under ProbeOptions::timeout the call is made on a helper thread, and as it may outlive
+// this frame, "probe" must capture by value. Returns the status, "valueOut" only holds a value if
+// it is Succeeded; "recordOut" is filled as ProbeOptions::recordProbes asks. The deadline only
+// applies to a backend owned by a shared_ptr, anything else is called inline.
+template <typename T, typename Probe>
+[[nodiscard]] probe_status_t callProbe(Backend& backend, const ProbeOptions& options, Probe probe, std::optional<T>& valueOut, ProbeRecord& recordOut) {
+    const auto start = std::chrono::steady_clock::now();
+    probe_status_t status{ probe_status_t::Failed };
+    T value{};
+    const backend_ptr_t owner = options.timeout.count() > 0 ? backend.weak_from_this().lock() : backend_ptr_t{};
+    if (owner) {
+        auto call = std::make_shared<ProbeCallState<T>>();
+        std::ignore = runBlockingCall(makeProbeCall<T>(owner, call, std::move(probe)), options.timeout);
+        status = collectProbeCall(*owner, *call, value);
+    } else if (probe(backend, value)) {
+        status = probe_status_t::Succeeded;
+    }
+    finishProbeCall(options, start, status, value, valueOut, recordOut);
+    return status;
+}
+
+// Suspends the awaiting coroutine while "call" runs on a helper thread (see startBlockingCall()) and
+// resumes it on "pool" once the call returned or "timeout" elapsed, whichever came first.
+[[nodiscard]] inline auto blockingCallOn(ThreadPool& pool, std::function<void()> call, const std::chrono::nanoseconds timeout) {
+    struct BlockingCallAwaiter final {
+        ThreadPool& pool;
+        std::function<void()> call;
+        std::chrono::nanoseconds timeout{};
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return false;
+        }
+        // Nothing of the awaiter is touched once the call is started, the coroutine may already run again elsewhere.
+        void await_suspend(const std::coroutine_handle<> handle) {
+            ThreadPool* const target = &pool;
+            startBlockingCall(std::move(call), timeout, [target, handle](const bool) {
+                target->post([handle]() {
+                    handle.resume();
+                });
+            });
+        }
+        void await_resume() const noexcept {}
+    };
+    return BlockingCallAwaiter{ pool, std::move(call), timeout };
+}
+
+// callProbe() for coroutines: with ProbeOptions::pool the call runs on a helper thread, without occupying a pool
+// thread while it blocks, and the awaiting coroutine continues on the pool. Inline like callProbe() otherwise.
+// The references must stay valid until the returned task finished. Name the probe before the co_await:
+// GCC 12 destroys a lambda written inside a co_await expression twice.
+template <typename T, typename Probe>
+[[nodiscard]] Task<probe_status_t> callProbeAsync(Backend& backend, const ProbeOptions& options, Probe probe, std::optional<T>& valueOut, ProbeRecord& recordOut) {
+    const backend_ptr_t owner = options.pool ? backend.weak_from_this().lock() : backend_ptr_t{};
+    if (!owner) {
+        co_return callProbe<T>(backend, options, std::move(probe), valueOut, recordOut);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    auto call = std::make_shared<ProbeCallState<T>>();
+    co_await blockingCallOn(*options.pool, makeProbeCall<T>(owner, call, std::move(probe)), options.timeout);
+    T value{};
+    const probe_status_t status = collectProbeCall(*owner, *call, value);
+    finishProbeCall(options, start, status, value, valueOut, recordOut);
+    co_return status;
+}
+
+} // namespace gputester
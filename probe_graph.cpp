@@ -0,0 +1,541 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "probe_graph.hpp"
+#include "binary_report.hpp"
+#include "probe_call.hpp"
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace gputester {
+
+// Version 1 layout of a saved state, little-endian like the binary report it embeds:
+//
+//   header        kStateHeaderSize bytes
+//   key table     one entry per adapter (driver info), then four per output (mode, color,
+//                 path and DPI) in report order, kStateKeySize bytes each
+//   report        a binary report holding the descriptors and the answers
+static constexpr const std::uint32_t kStateMagic{ 0x43525047 }; // "GPRC"
+static constexpr const std::uint16_t kStateVersion{ 1 };
+static constexpr const std::uint32_t kStateHeaderSize{ 32 };
+static constexpr const std::uint32_t kStateKeySize{ 16 };
+static constexpr const std::uint32_t kStateKeyPresent{ 1 << 0 };
+static constexpr const std::size_t kOutputKeyCount{ 4 };
+
+static inline void storeKey(std::uint8_t* entry, const std::optional<std::uint64_t>& key) {
+    storeLittleEndian(entry, key.value_or(0));
+    storeLittleEndian(entry + 8, key ? kStateKeyPresent : std::uint32_t{ 0 });
+    storeLittleEndian(entry + 12, std::uint32_t{ 0 });
+}
+
+[[nodiscard]] static inline std::optional<std::uint64_t> loadKey(const std::uint8_t* entry) {
+    if ((loadLittleEndian<std::uint32_t>(entry + 8) & kStateKeyPresent) == 0) {
+        return std::nullopt;
+    }
+    return loadLittleEndian<std::uint64_t>(entry);
+}
+
+// Keeps the answer of "node" if it was computed for the same key. Returns false if the probe has to run.
+[[nodiscard]] static inline bool reuseNode(const ProbeOptions& options, auto& node, const std::optional<std::uint64_t>& key) {
+    node.record = {};
+    if (!key || node.key != key) {
+        return false;
+    }
+    node.evaluated = false;
+    if (options.recordProbes) {
+        node.record.status = probe_status_t::Reused;
+    }
+    return true;
+}
+
+static inline void markEvaluated(auto& node, const probe_status_t status, const std::optional<std::uint64_t>& key) {
+    // Without an answer there is nothing to reuse, the next update() tries again.
+    node.key = status == probe_status_t::TimedOut ? std::nullopt : key;
+    node.evaluated = true;
+}
+
+// Runs "probe" (see callProbe()) unless "node" still holds an answer computed for the same key.
+template <typename T, typename Probe>
+static inline void evaluateNode(Backend& backend, const ProbeOptions& options, auto& node, const std::optional<std::uint64_t>& key, Probe probe) {
+    if (reuseNode(options, node, key)) {
+        return;
+    }
+    markEvaluated(node, callProbe<T>(backend, options, std::move(probe), node.value, node.record), key);
+}
+
+template <typename T, typename Probe>
+static Task<bool> evaluateNodeAsync(Backend& backend, const ProbeOptions& options, auto& node, const std::optional<std::uint64_t> key, Probe probe) {
+    if (!reuseNode(options, node, key)) {
+        markEvaluated(node, co_await callProbeAsync<T>(backend, options, std::move(probe), node.value, node.record), key);
+    }
+    co_return true;
+}
+
+// The key of a node is asked for under the same deadline as the node itself (see callProbe()),
+// a key which failed or timed out is unknown and the node is evaluated again.
+template <typename Getter>
+[[nodiscard]] static inline std::optional<std::uint64_t> getKey(Backend& backend, const ProbeOptions& options, Getter getter) {
+    std::optional<std::uint64_t> key{};
+    ProbeRecord record{};
+    std::ignore = callProbe<std::uint64_t>(backend, options, std::move(getter), key, record);
+    return key;
+}
+
+template <typename Getter>
+static Task<std::optional<std::uint64_t>> getKeyAsync(Backend& backend, const ProbeOptions& options, Getter getter) {
+    std::optional<std::uint64_t> key{};
+    ProbeRecord record{};
+    std::ignore = co_await callProbeAsync<std::uint64_t>(backend, options, std::move(getter), key, record);
+    co_return key;
+}
+
+template <typename T>
+static inline void countNode(ProbeGraphStatistics& statistics, const probe_node_t type, const T& node) {
+    auto& counter = node.evaluated ? statistics.evaluated : statistics.reused;
+    ++counter[static_cast<std::size_t>(type)];
+}
+
+ProbeGraph::ProbeGraph(backend_ptr_t backend) : m_backend(std::move(backend)) {}
+
+ProbeGraph::~ProbeGraph() = default;
+
+bool ProbeGraph::update(GpuReport& reportOut, const ProbeOptions& options) {
+    reportOut = {};
+    reportOut.backend = m_backend->name();
+    // The calls abandoned last time may still be using the handle table enumeration would rebuild.
+    if (m_backend->abandonedProbeCount() != 0) {
+        return false;
+    }
+    ProbeRecord record{};
+    // Every other probe needs the handle table enumeration builds, see Backend::enumerateAdapters().
+    std::optional<std::vector<AdapterDesc>> enumerated{};
+    if (callProbe<std::vector<AdapterDesc>>(*m_backend, options, [](Backend& backend, std::vector<AdapterDesc>& adaptersOut) {
+        return backend.enumerateAdapters(adaptersOut);
+    }, enumerated, record) != probe_status_t::Succeeded) {
+        clear();
+        return false;
+    }
+    std::optional<bool> variableRefreshRateSupported{};
+    std::ignore = callProbe<bool>(*m_backend, options, [](Backend& backend, bool& supportedOut) {
+        return backend.getVariableRefreshRateSupport(supportedOut);
+    }, variableRefreshRateSupported, record);
+    reportOut.variableRefreshRateSupported = variableRefreshRateSupported.value_or(false);
+    adoptAdapters(enumerated.value());
+    m_mask = options.nodes;
+    forEachIndex(options.pool, m_adapters.size(), [this, &options](const std::size_t index) {
+        updateAdapter(options, m_adapters[index]);
+    });
+    collectReport(options.nodes, reportOut);
+    collectStatistics();
+    return true;
+}
+
+Task<bool> ProbeGraph::updateAsync(GpuReport& reportOut, const ProbeOptions& options) {
+    if (!options.pool) {
+        co_return update(reportOut, options);
+    }
+    reportOut = {};
+    reportOut.backend = m_backend->name();
+    if (m_backend->abandonedProbeCount() != 0) {
+        co_return false;
+    }
+    ProbeRecord record{};
+    std::optional<std::vector<AdapterDesc>> enumerated{};
+    const auto enumerate = [](Backend& backend, std::vector<AdapterDesc>& adaptersOut) {
+        return backend.enumerateAdapters(adaptersOut);
+    };
+    if (co_await callProbeAsync<std::vector<AdapterDesc>>(*m_backend, options, enumerate, enumerated, record) != probe_status_t::Succeeded) {
+        clear();
+        co_return false;
+    }
+    std::optional<bool> variableRefreshRateSupported{};
+    const auto queryVariableRefreshRate = [](Backend& backend, bool& supportedOut) {
+        return backend.getVariableRefreshRateSupport(supportedOut);
+    };
+    std::ignore = co_await callProbeAsync<bool>(*m_backend, options, queryVariableRefreshRate, variableRefreshRateSupported, record);
+    reportOut.variableRefreshRateSupported = variableRefreshRateSupported.value_or(false);
+    adoptAdapters(enumerated.value());
+    m_mask = options.nodes;
+    std::vector<Task<bool>> tasks{};
+    tasks.reserve(m_adapters.size());
+    for (auto&& nodes : m_adapters) {
+        tasks.push_back(updateAdapterAsync(options, nodes));
+    }
+    std::ignore = co_await whenAll(std::move(tasks));
+    collectReport(options.nodes, reportOut);
+    collectStatistics();
+    co_return true;
+}
+
+void ProbeGraph::adoptAdapters(std::vector<AdapterDesc>& adapters) {
+    std::vector<AdapterNodes> previous = std::move(m_adapters);
+    m_adapters.clear();
+    m_adapters.resize(adapters.size());
+    for (std::size_t index = 0; index != adapters.size(); ++index) {
+        AdapterNodes& nodes = m_adapters[index];
+        const auto it = std::find_if(previous.begin(), previous.end(), [&adapters, index](const AdapterNodes& candidate) {
+            return candidate.desc == adapters[index];
+        });
+        if (it != previous.end()) {
+            nodes = std::move(*it);
+            // Nodes are inherited once, a duplicate descriptor starts from scratch.
+            previous.erase(it);
+        }
+        nodes.desc = std::move(adapters[index]);
+    }
+}
+
+void ProbeGraph::adoptOutputs(AdapterNodes& nodes, std::vector<OutputDesc>& outputs) {
+    std::vector<OutputNodes> previous = std::move(nodes.outputs);
+    nodes.outputs.clear();
+    nodes.outputs.resize(outputs.size());
+    for (std::size_t index = 0; index != outputs.size(); ++index) {
+        OutputNodes& outputNodes = nodes.outputs[index];
+        const auto it = std::find_if(previous.begin(), previous.end(), [&outputs, index](const OutputNodes& candidate) {
+            return candidate.desc == outputs[index];
+        });
+        if (it != previous.end()) {
+            outputNodes = std::move(*it);
+            previous.erase(it);
+        }
+        outputNodes.desc = std::move(outputs[index]);
+    }
+}
+
+void ProbeGraph::clear() {
+    m_adapters.clear();
+    m_statistics = {};
+}
+
+const ProbeGraphStatistics& ProbeGraph::statistics() const {
+    return m_statistics;
+}
+
+void ProbeGraph::saveState(std::string& bufferOut) const {
+    GpuReport report{};
+    report.backend = m_backend->name();
+    collectReport(kAllProbeNodes, report);
+    std::size_t outputCount{ 0 };
+    for (auto&& adapter : std::as_const(m_adapters)) {
+        outputCount += adapter.outputs.size();
+    }
+    const std::size_t keyCount = m_adapters.size() + outputCount * kOutputKeyCount;
+    const std::size_t reportOffset = kStateHeaderSize + keyCount * kStateKeySize;
+    bufferOut.assign(reportOffset, '\0');
+    auto* data = reinterpret_cast<std::uint8_t*>(bufferOut.data());
+    std::uint8_t* entry = data + kStateHeaderSize;
+    for (auto&& adapter : std::as_const(m_adapters)) {
+        storeKey(entry, adapter.driver.key);
+        entry += kStateKeySize;
+    }
+    for (auto&& adapter : std::as_const(m_adapters)) {
+        for (auto&& output : std::as_const(adapter.outputs)) {
+            for (auto&& key : { output.mode.key, output.color.key, output.path.key, output.dpi.key }) {
+                storeKey(entry, key);
+                entry += kStateKeySize;
+            }
+        }
+    }
+    encodeBinaryReport(report, bufferOut);
+    // The encoder may have grown the buffer.
+    data = reinterpret_cast<std::uint8_t*>(bufferOut.data());
+    storeLittleEndian(data + 0, kStateMagic);
+    storeLittleEndian(data + 4, kStateVersion);
+    storeLittleEndian(data + 6, static_cast<std::uint16_t>(kStateHeaderSize));
+    storeLittleEndian(data + 8, static_cast<std::uint32_t>(m_adapters.size()));
+    storeLittleEndian(data + 12, static_cast<std::uint32_t>(outputCount));
+    storeLittleEndian(data + 16, static_cast<std::uint64_t>(reportOffset));
+    storeLittleEndian(data + 24, static_cast<std::uint64_t>(bufferOut.size() - reportOffset));
+}
+
+bool ProbeGraph::loadState(const std::uint8_t* data, const std::size_t size) {
+    if (!data || size < kStateHeaderSize || loadLittleEndian<std::uint32_t>(data) != kStateMagic
+        || loadLittleEndian<std::uint16_t>(data + 4) != kStateVersion) {
+        return false;
+    }
+    const auto adapterCount = loadLittleEndian<std::uint32_t>(data + 8);
+    const auto outputCount = loadLittleEndian<std::uint32_t>(data + 12);
+    const auto reportOffset = loadLittleEndian<std::uint64_t>(data + 16);
+    const auto reportSize = loadLittleEndian<std::uint64_t>(data + 24);
+    const std::uint64_t keyCount = adapterCount + std::uint64_t{ outputCount } * kOutputKeyCount;
+    if (reportOffset < kStateHeaderSize + keyCount * kStateKeySize || reportOffset > size || reportSize > size - reportOffset) {
+        return false;
+    }
+    const std::optional<BinaryReportView> view = BinaryReportView::open(data + reportOffset, static_cast<std::size_t>(reportSize));
+    if (!view || view->adapterCount() != adapterCount || view->outputCount() != outputCount) {
+        return false;
+    }
+    GpuReport report{};
+    view->decode(report);
+    if (report.backend != m_backend->name()) {
+        return false;
+    }
+    std::vector<AdapterNodes> adapters(report.adapters.size());
+    const std::uint8_t* adapterEntry = data + kStateHeaderSize;
+    const std::uint8_t* outputEntry = adapterEntry + std::size_t{ adapterCount } * kStateKeySize;
+    for (std::size_t adapterIndex = 0; adapterIndex != adapters.size(); ++adapterIndex) {
+        AdapterInfo& adapterInfo = report.adapters[adapterIndex];
+        AdapterNodes& nodes = adapters[adapterIndex];
+        nodes.desc = std::move(adapterInfo.desc);
+        nodes.driver.value = std::move(adapterInfo.driver);
+        nodes.driver.key = loadKey(adapterEntry);
+        adapterEntry += kStateKeySize;
+        nodes.outputs.resize(adapterInfo.outputs.size());
+        for (std::size_t outputIndex = 0; outputIndex != nodes.outputs.size(); ++outputIndex) {
+            OutputInfo& outputInfo = adapterInfo.outputs[outputIndex];
+            OutputNodes& outputNodes = nodes.outputs[outputIndex];
+            outputNodes.desc = std::move(outputInfo.desc);
+            outputNodes.mode.value = outputInfo.display.mode;
+            outputNodes.mode.key = loadKey(outputEntry);
+            outputNodes.color.value = outputInfo.display.color;
+            outputNodes.color.key = loadKey(outputEntry + kStateKeySize);
+            outputNodes.path.value = std::move(outputInfo.display.path);
+            outputNodes.path.key = loadKey(outputEntry + kStateKeySize * 2);
+            outputNodes.dpi.value = outputInfo.display.dpi;
+            outputNodes.dpi.key = loadKey(outputEntry + kStateKeySize * 3);
+            outputEntry += kStateKeySize * kOutputKeyCount;
+        }
+    }
+    m_adapters = std::move(adapters);
+    m_statistics = {};
+    return true;
+}
+
+void ProbeGraph::updateAdapter(const ProbeOptions& options, AdapterNodes& nodes) {
+    Backend& backend = *m_backend;
+    const AdapterDesc& adapter = nodes.desc;
+    if (options.nodes & probeNodeBit(probe_node_t::DriverInfo)) {
+        const std::optional<std::uint64_t> driverKey = getKey(backend, options, [adapter](Backend& backend, std::uint64_t& keyOut) {
+            return backend.getDriverInfoKey(adapter, keyOut);
+        });
+        evaluateNode<DriverInfo>(backend, options, nodes.driver, driverKey, [adapter](Backend& backend, DriverInfo& infoOut) {
+            return backend.getDriverInfo(adapter, infoOut);
+        });
+    }
+    if ((options.nodes & (probeNodeBit(probe_node_t::OutputList) | kOutputProbeNodes)) == 0) {
+        return;
+    }
+    nodes.outputsRecord = {};
+    std::optional<std::vector<OutputDesc>> enumerated{};
+    nodes.outputsEnumerated = callProbe<std::vector<OutputDesc>>(backend, options, [adapter](Backend& backend, std::vector<OutputDesc>& outputsOut) {
+        return backend.enumerateOutputs(adapter, outputsOut);
+    }, enumerated, nodes.outputsRecord) == probe_status_t::Succeeded;
+    if (!nodes.outputsEnumerated) {
+        nodes.outputs.clear();
+        return;
+    }
+    adoptOutputs(nodes, enumerated.value());
+    if ((options.nodes & kOutputProbeNodes) == 0) {
+        return;
+    }
+    forEachIndex(options.pool, nodes.outputs.size(), [this, &options, &nodes](const std::size_t index) {
+        updateOutput(options, nodes.outputs[index]);
+    });
+}
+
+Task<bool> ProbeGraph::updateAdapterAsync(const ProbeOptions& options, AdapterNodes& nodes) {
+    Backend& backend = *m_backend;
+    const AdapterDesc& adapter = nodes.desc;
+    if (options.nodes & probeNodeBit(probe_node_t::DriverInfo)) {
+        const auto getDriverKey = [adapter](Backend& backend, std::uint64_t& keyOut) {
+            return backend.getDriverInfoKey(adapter, keyOut);
+        };
+        const std::optional<std::uint64_t> driverKey = co_await getKeyAsync(backend, options, getDriverKey);
+        const auto probe = [adapter](Backend& backend, DriverInfo& infoOut) {
+            return backend.getDriverInfo(adapter, infoOut);
+        };
+        std::ignore = co_await evaluateNodeAsync<DriverInfo>(backend, options, nodes.driver, driverKey, probe);
+    }
+    if ((options.nodes & (probeNodeBit(probe_node_t::OutputList) | kOutputProbeNodes)) == 0) {
+        co_return true;
+    }
+    nodes.outputsRecord = {};
+    std::optional<std::vector<OutputDesc>> enumerated{};
+    const auto enumerate = [adapter](Backend& backend, std::vector<OutputDesc>& outputsOut) {
+        return backend.enumerateOutputs(adapter, outputsOut);
+    };
+    nodes.outputsEnumerated = co_await callProbeAsync<std::vector<OutputDesc>>(backend, options, enumerate, enumerated, nodes.outputsRecord) == probe_status_t::Succeeded;
+    if (!nodes.outputsEnumerated) {
+        nodes.outputs.clear();
+        co_return true;
+    }
+    adoptOutputs(nodes, enumerated.value());
+    if ((options.nodes & kOutputProbeNodes) == 0) {
+        co_return true;
+    }
+    std::vector<Task<bool>> tasks{};
+    tasks.reserve(nodes.outputs.size());
+    for (auto&& outputNodes : nodes.outputs) {
+        tasks.push_back(updateOutputAsync(options, outputNodes));
+    }
+    std::ignore = co_await whenAll(std::move(tasks));
+    co_return true;
+}
+
+void ProbeGraph::updateOutput(const ProbeOptions& options, OutputNodes& nodes) {
+    Backend& backend = *m_backend;
+    const OutputDesc& output = nodes.desc;
+    const auto outputKey = [&backend, &options, &output](const probe_node_t node) {
+        return getKey(backend, options, [output, node](Backend& backend, std::uint64_t& keyOut) {
+            return backend.getOutputProbeKey(node, output, keyOut);
+        });
+    };
+    if (options.nodes & probeNodeBit(probe_node_t::ModeInfo)) {
+        evaluateNode<ModeInfo>(backend, options, nodes.mode, outputKey(probe_node_t::ModeInfo), [output](Backend& backend, ModeInfo& infoOut) {
+            return backend.getModeInfo(output, infoOut);
+        });
+    }
+    if (options.nodes & probeNodeBit(probe_node_t::ColorInfo)) {
+        evaluateNode<ColorInfo>(backend, options, nodes.color, outputKey(probe_node_t::ColorInfo), [output](Backend& backend, ColorInfo& infoOut) {
+            return backend.getColorInfo(output, infoOut);
+        });
+    }
+    if (options.nodes & probeNodeBit(probe_node_t::PathInfo)) {
+        evaluateNode<PathInfo>(backend, options, nodes.path, outputKey(probe_node_t::PathInfo), [output](Backend& backend, PathInfo& infoOut) {
+            return backend.getPathInfo(output, infoOut);
+        });
+    }
+    if (options.nodes & probeNodeBit(probe_node_t::Dpi)) {
+        evaluateNode<std::uint32_t>(backend, options, nodes.dpi, outputKey(probe_node_t::Dpi), [output](Backend& backend, std::uint32_t& dpiOut) {
+            dpiOut = kDefaultScreenDpi;
+            return backend.getDpi(output, dpiOut);
+        });
+    }
+}
+
+Task<bool> ProbeGraph::updateOutputAsync(const ProbeOptions& options, OutputNodes& nodes) {
+    Backend& backend = *m_backend;
+    const OutputDesc& output = nodes.desc;
+    const auto outputKey = [&backend, &options, &output](const probe_node_t node) {
+        const auto getOutputKey = [output, node](Backend& backend, std::uint64_t& keyOut) {
+            return backend.getOutputProbeKey(node, output, keyOut);
+        };
+        return getKeyAsync(backend, options, getOutputKey);
+    };
+    if (options.nodes & probeNodeBit(probe_node_t::ModeInfo)) {
+        const auto probe = [output](Backend& backend, ModeInfo& infoOut) {
+            return backend.getModeInfo(output, infoOut);
+        };
+        const std::optional<std::uint64_t> key = co_await outputKey(probe_node_t::ModeInfo);
+        std::ignore = co_await evaluateNodeAsync<ModeInfo>(backend, options, nodes.mode, key, probe);
+    }
+    if (options.nodes & probeNodeBit(probe_node_t::ColorInfo)) {
+        const auto probe = [output](Backend& backend, ColorInfo& infoOut) {
+            return backend.getColorInfo(output, infoOut);
+        };
+        const std::optional<std::uint64_t> key = co_await outputKey(probe_node_t::ColorInfo);
+        std::ignore = co_await evaluateNodeAsync<ColorInfo>(backend, options, nodes.color, key, probe);
+    }
+    if (options.nodes & probeNodeBit(probe_node_t::PathInfo)) {
+        const auto probe = [output](Backend& backend, PathInfo& infoOut) {
+            return backend.getPathInfo(output, infoOut);
+        };
+        const std::optional<std::uint64_t> key = co_await outputKey(probe_node_t::PathInfo);
+        std::ignore = co_await evaluateNodeAsync<PathInfo>(backend, options, nodes.path, key, probe);
+    }
+    if (options.nodes & probeNodeBit(probe_node_t::Dpi)) {
+        const auto probe = [output](Backend& backend, std::uint32_t& dpiOut) {
+            dpiOut = kDefaultScreenDpi;
+            return backend.getDpi(output, dpiOut);
+        };
+        const std::optional<std::uint64_t> key = co_await outputKey(probe_node_t::Dpi);
+        std::ignore = co_await evaluateNodeAsync<std::uint32_t>(backend, options, nodes.dpi, key, probe);
+    }
+    co_return true;
+}
+
+// Only what a probe() with the same mask would return, not the answers kept for other updates.
+void ProbeGraph::collectReport(const probe_node_mask_t mask, GpuReport& reportOut) const {
+    const auto has = [mask](const probe_node_t node) {
+        return (mask & probeNodeBit(node)) != 0;
+    };
+    reportOut.adapters.resize(m_adapters.size());
+    for (std::size_t adapterIndex = 0; adapterIndex != m_adapters.size(); ++adapterIndex) {
+        const AdapterNodes& nodes = m_adapters[adapterIndex];
+        AdapterInfo& adapterInfo = reportOut.adapters[adapterIndex];
+        adapterInfo.desc = nodes.desc;
+        if (has(probe_node_t::DriverInfo)) {
+            adapterInfo.driver = nodes.driver.value;
+            adapterInfo.probes[static_cast<std::size_t>(probe_node_t::DriverInfo)] = nodes.driver.record;
+        }
+        if ((mask & (probeNodeBit(probe_node_t::OutputList) | kOutputProbeNodes)) == 0) {
+            continue;
+        }
+        adapterInfo.probes[static_cast<std::size_t>(probe_node_t::OutputList)] = nodes.outputsRecord;
+        adapterInfo.outputs.resize(nodes.outputs.size());
+        for (std::size_t outputIndex = 0; outputIndex != nodes.outputs.size(); ++outputIndex) {
+            const OutputNodes& outputNodes = nodes.outputs[outputIndex];
+            OutputInfo& outputInfo = adapterInfo.outputs[outputIndex];
+            outputInfo.desc = outputNodes.desc;
+            const auto record = [&outputInfo](const probe_node_t node) -> ProbeRecord& {
+                return outputInfo.probes[static_cast<std::size_t>(node)];
+            };
+            if (has(probe_node_t::ModeInfo)) {
+                outputInfo.display.mode = outputNodes.mode.value;
+                record(probe_node_t::ModeInfo) = outputNodes.mode.record;
+            }
+            if (has(probe_node_t::ColorInfo)) {
+                outputInfo.display.color = outputNodes.color.value;
+                record(probe_node_t::ColorInfo) = outputNodes.color.record;
+            }
+            if (has(probe_node_t::PathInfo)) {
+                outputInfo.display.path = outputNodes.path.value;
+                record(probe_node_t::PathInfo) = outputNodes.path.record;
+            }
+            if (has(probe_node_t::Dpi)) {
+                outputInfo.display.dpi = outputNodes.dpi.value;
+                record(probe_node_t::Dpi) = outputNodes.dpi.record;
+            }
+        }
+    }
+}
+
+void ProbeGraph::collectStatistics() {
+    m_statistics = {};
+    m_statistics.evaluated[static_cast<std::size_t>(probe_node_t::AdapterDesc)] = m_adapters.size();
+    const auto count = [this](const probe_node_t type, const auto& node) {
+        if (m_mask & probeNodeBit(type)) {
+            countNode(m_statistics, type, node);
+        }
+    };
+    const bool outputsListed = (m_mask & (probeNodeBit(probe_node_t::OutputList) | kOutputProbeNodes)) != 0;
+    for (auto&& adapter : std::as_const(m_adapters)) {
+        count(probe_node_t::DriverInfo, adapter.driver);
+        if (!outputsListed) {
+            continue;
+        }
+        if (adapter.outputsEnumerated) {
+            ++m_statistics.evaluated[static_cast<std::size_t>(probe_node_t::OutputList)];
+        }
+        for (auto&& output : std::as_const(adapter.outputs)) {
+            count(probe_node_t::ModeInfo, output.mode);
+            count(probe_node_t::ColorInfo, output.color);
+            count(probe_node_t::PathInfo, output.path);
+            count(probe_node_t::Dpi, output.dpi);
+        }
+    }
+}
+
+} // namespace gputester
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include "report.hpp"
+#include "task.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace gputester {
+
+struct ProbeGraphStatistics final {
+    // Indexed by probe_node_t. A node counts once per adapter or output it belongs to.
+    std::array<std::size_t, kProbeNodeCount> evaluated{};
+    std::array<std::size_t, kProbeNodeCount> reused{};
+};
+
+// Remembers every answer together with the inputs it was computed from, so repeated runs only
+// ask the backend again for what changed. The adapter list and the output lists are re-read every
+// time, they are the cheap checks everything else hangs off:
+//
+//   adapter list -> adapter desc -> driver info
+//                                -> output list -> output desc -> mode list, HDR desc, path info, DPI
+//
+// A node is reused if its descriptor compares equal to last time and the backend reports the same
+// key for it (see Backend::getDriverInfoKey()), otherwise its probe runs again.
+class ProbeGraph final {
+public:
+    explicit ProbeGraph(backend_ptr_t backend);
+    ~ProbeGraph();
+    ProbeGraph(const ProbeGraph&) = delete;
+    ProbeGraph& operator=(const ProbeGraph&) = delete;
+
+    // Same contract as probe(), the report is identical to what a full probe would return.
+    [[nodiscard]] bool update(GpuReport& reportOut, const ProbeOptions& options = {});
+    // The coroutine flavor of update(), see probeAsync(). The references must stay valid until the task finished.
+    [[nodiscard]] Task<bool> updateAsync(GpuReport& reportOut, const ProbeOptions& options);
+    // Forgets all answers, the next update() runs every probe.
+    void clear();
+    // Of the last update().
+    [[nodiscard]] const ProbeGraphStatistics& statistics() const;
+
+    // Serializes the remembered answers together with their keys, so that the next process can
+    // start where this one stopped. The answers are stored as a binary report, see binary_report.hpp.
+    void saveState(std::string& bufferOut) const;
+    // Replaces the remembered answers. Returns false, and keeps the current ones, if "data" is not a
+    // valid state of the same backend. Nothing is trusted blindly: update() still checks every key.
+    [[nodiscard]] bool loadState(const std::uint8_t* data, const std::size_t size);
+
+private:
+    template <typename T>
+    struct Node final {
+        std::optional<T> value{};
+        std::optional<std::uint64_t> key{}; // What the backend reported when "value" was computed.
+        bool evaluated{ false }; // Whether the last update() ran the probe.
+        ProbeRecord record{}; // Of the last update().
+    };
+
+    struct OutputNodes final {
+        OutputDesc desc{};
+        Node<ModeInfo> mode{};
+        Node<ColorInfo> color{};
+        Node<PathInfo> path{};
+        Node<std::uint32_t> dpi{};
+    };
+
+    struct AdapterNodes final {
+        AdapterDesc desc{};
+        Node<DriverInfo> driver{};
+        bool outputsEnumerated{ false };
+        ProbeRecord outputsRecord{};
+        std::vector<OutputNodes> outputs{};
+    };
+
+    // Take over the nodes of the adapters and outputs which are still there, by descriptor.
+    void adoptAdapters(std::vector<AdapterDesc>& adapters);
+    static void adoptOutputs(AdapterNodes& nodes, std::vector<OutputDesc>& outputs);
+    void updateAdapter(const ProbeOptions& options, AdapterNodes& nodes);
+    void updateOutput(const ProbeOptions& options, OutputNodes& nodes);
+    // Always true, Task needs a value.
+    [[nodiscard]] Task<bool> updateAdapterAsync(const ProbeOptions& options, AdapterNodes& nodes);
+    [[nodiscard]] Task<bool> updateOutputAsync(const ProbeOptions& options, OutputNodes& nodes);
+    void collectReport(const probe_node_mask_t mask, GpuReport& reportOut) const;
+    void collectStatistics();
+
+    backend_ptr_t m_backend{};
+    std::vector<AdapterNodes> m_adapters{};
+    // Of the last update(). The nodes it didn't ask for keep their answers and keys for later ones.
+    probe_node_mask_t m_mask{ kAllProbeNodes };
+    ProbeGraphStatistics m_statistics{};
+};
+
+} // namespace gputester
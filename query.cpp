@@ -0,0 +1,292 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "query.hpp"
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+
+namespace gputester {
+
+static constexpr const std::string_view kNull{ "null" };
+
+[[nodiscard]] static inline bool isKeyCharacter(const char ch) {
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+}
+
+[[nodiscard]] static inline bool isJsonWhitespace(const char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+}
+
+bool parseQuery(const std::string_view query, std::vector<QuerySegment>& segmentsOut) {
+    segmentsOut.clear();
+    std::size_t position{ 0 };
+    while (position < query.size()) {
+        QuerySegment segment{};
+        if (query[position] == '[') {
+            const std::size_t end = query.find(']', position);
+            if (end == std::string_view::npos) {
+                return false;
+            }
+            const std::string_view inner = query.substr(position + 1, end - position - 1);
+            if (inner == "*") {
+                segment.type = query_segment_t::Wildcard;
+            } else {
+                segment.type = query_segment_t::Index;
+                const auto result = std::from_chars(inner.data(), inner.data() + inner.size(), segment.index);
+                if (inner.empty() || result.ec != std::errc{} || result.ptr != inner.data() + inner.size()) {
+                    return false;
+                }
+            }
+            position = end + 1;
+        } else {
+            if (!segmentsOut.empty()) {
+                if (query[position] != '.') {
+                    return false;
+                }
+                ++position;
+            }
+            const std::size_t begin = position;
+            while (position < query.size() && isKeyCharacter(query[position])) {
+                ++position;
+            }
+            if (position == begin) {
+                return false;
+            }
+            segment.key = query.substr(begin, position - begin);
+        }
+        segmentsOut.push_back(std::move(segment));
+    }
+    return true;
+}
+
+[[nodiscard]] static inline std::size_t skipWhitespace(const std::string_view json, std::size_t position) {
+    while (position < json.size() && isJsonWhitespace(json[position])) {
+        ++position;
+    }
+    return position;
+}
+
+// "position" is at the opening quote. Returns the position after the closing one, or npos.
+[[nodiscard]] static inline std::size_t skipString(const std::string_view json, std::size_t position) {
+    for (++position; position < json.size(); ++position) {
+        if (json[position] == '\\') {
+            ++position; // Whatever is escaped.
+        } else if (json[position] == '"') {
+            return position + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+
+// "position" is at the first character of a value. Returns the position after it, or npos.
+[[nodiscard]] static inline std::size_t skipValue(const std::string_view json, std::size_t position) {
+    if (position >= json.size()) {
+        return std::string_view::npos;
+    }
+    const char first = json[position];
+    if (first == '"') {
+        return skipString(json, position);
+    }
+    if (first == '{' || first == '[') {
+        std::size_t depth{ 0 };
+        while (position < json.size()) {
+            const char ch = json[position];
+            if (ch == '"') {
+                position = skipString(json, position);
+                if (position == std::string_view::npos) {
+                    return position;
+                }
+                continue;
+            }
+            if (ch == '{' || ch == '[') {
+                ++depth;
+            } else if ((ch == '}' || ch == ']') && --depth == 0) {
+                return position + 1;
+            }
+            ++position;
+        }
+        return std::string_view::npos;
+    }
+    const std::size_t begin = position;
+    while (position < json.size() && json[position] != ',' && json[position] != '}' && json[position] != ']' && !isJsonWhitespace(json[position])) {
+        ++position;
+    }
+    return position == begin ? std::string_view::npos : position;
+}
+
+[[nodiscard]] static inline bool evaluateAt(const std::string_view json, std::size_t position, const std::vector<QuerySegment>& segments,
+                                            const std::size_t segmentIndex, std::string& resultOut) {
+    position = skipWhitespace(json, position);
+    if (segmentIndex == segments.size()) {
+        const std::size_t end = skipValue(json, position);
+        if (end == std::string_view::npos) {
+            return false;
+        }
+        resultOut.append(json.substr(position, end - position));
+        return true;
+    }
+    if (position >= json.size()) {
+        return false;
+    }
+    const QuerySegment& segment = segments[segmentIndex];
+    if (segment.type == query_segment_t::Key) {
+        if (json[position] != '{') {
+            resultOut.append(kNull);
+            return true;
+        }
+        for (++position;;) {
+            position = skipWhitespace(json, position);
+            if (position >= json.size()) {
+                return false;
+            }
+            if (json[position] == '}') {
+                resultOut.append(kNull);
+                return true;
+            }
+            if (json[position] == ',') {
+                ++position;
+                continue;
+            }
+            const std::size_t keyEnd = json[position] == '"' ? skipString(json, position) : std::string_view::npos;
+            if (keyEnd == std::string_view::npos) {
+                return false;
+            }
+            // The writer only emits plain ASCII keys, they never contain escapes.
+            const std::string_view key = json.substr(position + 1, keyEnd - position - 2);
+            position = skipWhitespace(json, keyEnd);
+            if (position >= json.size() || json[position] != ':') {
+                return false;
+            }
+            ++position;
+            if (key == segment.key) {
+                return evaluateAt(json, position, segments, segmentIndex + 1, resultOut);
+            }
+            position = skipValue(json, skipWhitespace(json, position));
+            if (position == std::string_view::npos) {
+                return false;
+            }
+        }
+    }
+    if (json[position] != '[') {
+        resultOut.append(kNull);
+        return true;
+    }
+    const bool wildcard = segment.type == query_segment_t::Wildcard;
+    if (wildcard) {
+        resultOut.push_back('[');
+    }
+    std::size_t elementIndex{ 0 };
+    for (++position;;) {
+        position = skipWhitespace(json, position);
+        if (position >= json.size()) {
+            return false;
+        }
+        if (json[position] == ']') {
+            if (wildcard) {
+                resultOut.push_back(']');
+            } else {
+                resultOut.append(kNull);
+            }
+            return true;
+        }
+        if (json[position] == ',') {
+            ++position;
+            continue;
+        }
+        if (wildcard) {
+            if (elementIndex != 0) {
+                resultOut.push_back(',');
+            }
+            if (!evaluateAt(json, position, segments, segmentIndex + 1, resultOut)) {
+                return false;
+            }
+        } else if (elementIndex == segment.index) {
+            return evaluateAt(json, position, segments, segmentIndex + 1, resultOut);
+        }
+        position = skipValue(json, position);
+        if (position == std::string_view::npos) {
+            return false;
+        }
+        ++elementIndex;
+    }
+}
+
+bool evaluateQuery(const std::string_view json, const std::vector<QuerySegment>& segments, std::string& resultOut) {
+    return evaluateAt(json, 0, segments, 0, resultOut);
+}
+
+// Mirrors the field names of writeOutputJson() in format.cpp.
+[[nodiscard]] static inline probe_node_mask_t getOutputFieldProbeNodes(const std::string_view name) {
+    static constexpr const std::string_view kColorFields[]{ "bitsPerColor", "colorSpace", "colorSpaceName", "redPrimary", "greenPrimary",
+                                                            "bluePrimary", "whitePoint", "minLuminance", "maxLuminance", "maxFullFrameLuminance" };
+    if (name == "maxRefreshRate") {
+        return probeNodeBit(probe_node_t::ModeInfo);
+    }
+    if (std::find(std::begin(kColorFields), std::end(kColorFields), name) != std::end(kColorFields)) {
+        return probeNodeBit(probe_node_t::ColorInfo);
+    }
+    if (name == "sdrWhiteLevel" || name == "currentRefreshRate" || name == "friendlyName") {
+        return probeNodeBit(probe_node_t::PathInfo);
+    }
+    if (name == "dpi" || name == "scale") {
+        return probeNodeBit(probe_node_t::Dpi);
+    }
+    return 0; // Part of the output descriptor.
+}
+
+probe_node_mask_t getQueryProbeNodes(const std::vector<QuerySegment>& segments) {
+    if (segments.empty()) {
+        return kAllProbeNodes;
+    }
+    // The report level fields come with the adapter list.
+    if (segments[0].type != query_segment_t::Key || segments[0].key != "adapters") {
+        return probeNodeBit(probe_node_t::AdapterDesc);
+    }
+    // Skips the indices and wildcards into an array, returns segments.size() if the query ends there.
+    const auto nextKey = [&segments](std::size_t index) {
+        while (index < segments.size() && segments[index].type != query_segment_t::Key) {
+            ++index;
+        }
+        return index;
+    };
+    const std::size_t adapterField = nextKey(1);
+    if (adapterField == segments.size()) {
+        return kAllProbeNodes;
+    }
+    if (segments[adapterField].key == "driver") {
+        return probeNodeBit(probe_node_t::AdapterDesc) | probeNodeBit(probe_node_t::DriverInfo);
+    }
+    if (segments[adapterField].key != "outputs") {
+        return probeNodeBit(probe_node_t::AdapterDesc);
+    }
+    const probe_node_mask_t listNodes = probeNodeBit(probe_node_t::AdapterDesc) | probeNodeBit(probe_node_t::OutputList);
+    const std::size_t outputField = nextKey(adapterField + 1);
+    if (outputField == segments.size()) {
+        return listNodes | kOutputProbeNodes;
+    }
+    return listNodes | getOutputFieldProbeNodes(segments[outputField].key);
+}
+
+} // namespace gputester
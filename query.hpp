@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Field selective queries into the JSON report (the --format=json document), using the same
+// field names: "adapters[*].driver.version", "adapters[0].outputs[*].deviceName", "backend".
+// "[*]" maps the rest of the query over every element of an array, so the result of
+// "adapters[*].outputs[*].dpi" is an array of arrays. A field or element that doesn't exist
+// evaluates to null. The empty query selects the whole report.
+namespace gputester {
+
+enum class query_segment_t : std::uint8_t {
+    Key,
+    Index,
+    Wildcard
+};
+
+struct QuerySegment final {
+    query_segment_t type{ query_segment_t::Key };
+    std::string key{};
+    std::size_t index{ 0 };
+};
+
+[[nodiscard]] bool parseQuery(const std::string_view query, std::vector<QuerySegment>& segmentsOut);
+
+// Appends the selected value of "json" to "resultOut" as compact JSON. Works on the text of the
+// document, no DOM is built: unselected values are only skipped over. Returns false if the
+// document is malformed on the way to the selected values.
+[[nodiscard]] bool evaluateQuery(const std::string_view json, const std::vector<QuerySegment>& segments, std::string& resultOut);
+
+// The probes whose answers the query can select, e.g. only DriverInfo for "adapters[*].driver.version".
+// Everything else in the report can be left out without changing the result of the query.
+[[nodiscard]] probe_node_mask_t getQueryProbeNodes(const std::vector<QuerySegment>& segments);
+
+} // namespace gputester
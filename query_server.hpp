@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "model.hpp"
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace gputester {
+
+#ifdef __linux__
+// $XDG_RUNTIME_DIR/gputester.sock, or /tmp/gputester-<uid>.sock without a runtime directory.
+[[nodiscard]] std::filesystem::path getDefaultQuerySocketPath();
+
+// Answers queries (see query.hpp) about the latest report over a Unix domain socket, so that
+// frequent callers don't pay for a process spawn, let alone a probe. The protocol is one query
+// per line in, one line of compact JSON per query out, in order; clients may pipeline as many
+// queries as they like without waiting for the answers. An invalid query is answered with
+// {"error":"..."}. One thread serves every connection from an epoll loop.
+class QueryServer final {
+public:
+    QueryServer() = default;
+    ~QueryServer();
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Binds "socketPath" (replacing a stale socket) and starts serving on a background thread.
+    [[nodiscard]] bool start(const std::filesystem::path& socketPath);
+    void stop();
+
+    // Queries arriving from now on see "report". Safe to call while serving.
+    void setReport(const GpuReport& report);
+
+private:
+    void run();
+    [[nodiscard]] std::shared_ptr<const std::string> currentReport() const;
+
+    mutable std::mutex m_mutex{};
+    std::shared_ptr<const std::string> m_report{}; // As JSON, queries are evaluated on the text.
+    std::filesystem::path m_socketPath{};
+    std::thread m_thread{};
+    int m_epoll{ -1 };
+    int m_listenSocket{ -1 };
+    int m_stopEvent{ -1 }; // An eventfd.
+};
+#endif
+
+} // namespace gputester
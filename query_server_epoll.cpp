@@ -0,0 +1,309 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "query_server.hpp"
+#include "format.hpp"
+#include "query.hpp"
+#include "text.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace gputester {
+
+static constexpr const int kListenBacklog{ 64 };
+static constexpr const int kMaxEvents{ 64 };
+static constexpr const std::size_t kReadChunkSize{ 16384 };
+// A line longer than this is no query, the connection is dropped.
+static constexpr const std::size_t kMaxQueryLength{ 4096 };
+
+static constexpr const std::string_view kInvalidQueryAnswer{ R"({"error":"invalid query"})" };
+static constexpr const std::string_view kMalformedReportAnswer{ R"({"error":"malformed report"})" };
+
+struct Connection final {
+    std::string input{};
+    std::string output{};
+    std::size_t outputOffset{ 0 };
+    bool writing{ false }; // Waiting for EPOLLOUT, no more queries are read until the answers are out.
+    bool peerClosed{ false };
+};
+
+std::filesystem::path getDefaultQuerySocketPath() {
+    if (const char* runtimeDirectory = std::getenv("XDG_RUNTIME_DIR"); runtimeDirectory && *runtimeDirectory) {
+        return std::filesystem::path{ runtimeDirectory } / "gputester.sock";
+    }
+    return std::filesystem::path{ "/tmp" } / ("gputester-" + std::to_string(::getuid()) + ".sock");
+}
+
+[[nodiscard]] static inline bool isSomeoneListening(const sockaddr_un& address) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    const bool connected = ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+    ::close(fd);
+    return connected;
+}
+
+static inline void answerQuery(const std::string_view query, const std::string_view report, std::vector<QuerySegment>& segments, std::string& output) {
+    if (!parseQuery(query, segments)) {
+        output.append(kInvalidQueryAnswer);
+    } else if (const std::size_t size = output.size(); !evaluateQuery(report, segments, output)) {
+        output.resize(size);
+        output.append(kMalformedReportAnswer);
+    }
+    output.push_back('\n');
+}
+
+// Answers every complete line. Returns false if the client sent something that can't be a query.
+[[nodiscard]] static inline bool answerQueries(Connection& connection, const std::string_view report, std::vector<QuerySegment>& segments) {
+    std::size_t begin{ 0 };
+    while (true) {
+        const std::size_t end = connection.input.find('\n', begin);
+        if (end == std::string::npos) {
+            break;
+        }
+        std::string_view query{ connection.input.data() + begin, end - begin };
+        if (query.ends_with('\r')) {
+            query.remove_suffix(1);
+        }
+        answerQuery(query, report, segments, connection.output);
+        begin = end + 1;
+    }
+    connection.input.erase(0, begin);
+    // "printf 'backend' | nc -U ..." sends no final newline.
+    if (connection.peerClosed && !connection.input.empty()) {
+        answerQuery(connection.input, report, segments, connection.output);
+        connection.input.clear();
+    }
+    return connection.input.size() <= kMaxQueryLength;
+}
+
+// Returns false if the connection broke.
+[[nodiscard]] static inline bool readQueries(const int fd, Connection& connection, char* chunk) {
+    // One read per wakeup: epoll is level triggered, so a busy client can't starve the others.
+    ssize_t size{ 0 };
+    do {
+        size = ::recv(fd, chunk, kReadChunkSize, 0);
+    } while (size < 0 && errno == EINTR);
+    if (size < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if (size == 0) {
+        connection.peerClosed = true;
+    } else {
+        connection.input.append(chunk, static_cast<std::size_t>(size));
+    }
+    return true;
+}
+
+// Sends as much of the pending answers as the socket takes. Returns false if the connection broke.
+[[nodiscard]] static inline bool flushAnswers(const int fd, Connection& connection) {
+    while (connection.outputOffset < connection.output.size()) {
+        const ssize_t size = ::send(fd, connection.output.data() + connection.outputOffset, connection.output.size() - connection.outputOffset, MSG_NOSIGNAL);
+        if (size < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        connection.outputOffset += static_cast<std::size_t>(size);
+    }
+    connection.output.clear();
+    connection.outputOffset = 0;
+    return true;
+}
+
+QueryServer::~QueryServer() {
+    stop();
+}
+
+bool QueryServer::start(const std::filesystem::path& socketPath) {
+    stop();
+    const std::string path = socketPath.string();
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::wcerr << L"The socket path is too long: " << socketPath.wstring() << std::endl;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    if (isSomeoneListening(address)) {
+        std::wcerr << L"Another server is already listening on " << socketPath.wstring() << std::endl;
+        return false;
+    }
+    // Whatever is left at the path belongs to a server which didn't exit cleanly.
+    ::unlink(path.c_str());
+    m_listenSocket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenSocket < 0) {
+        std::wcerr << L"Failed to create the query socket: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        return false;
+    }
+    if (::bind(m_listenSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(m_listenSocket, kListenBacklog) != 0) {
+        std::wcerr << L"Failed to listen on " << socketPath.wstring() << L": " << utf8ToWide(std::strerror(errno)) << std::endl;
+        ::close(m_listenSocket);
+        m_listenSocket = -1;
+        return false;
+    }
+    m_socketPath = socketPath;
+    m_stopEvent = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    epoll_event listenEvent{};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.fd = m_listenSocket;
+    epoll_event stopEvent{};
+    stopEvent.events = EPOLLIN;
+    stopEvent.data.fd = m_stopEvent;
+    if (m_stopEvent < 0 || m_epoll < 0 || ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listenSocket, &listenEvent) != 0
+        || ::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_stopEvent, &stopEvent) != 0) {
+        std::wcerr << L"Failed to set up the query event loop: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        stop();
+        return false;
+    }
+    m_thread = std::thread{ &QueryServer::run, this };
+    return true;
+}
+
+void QueryServer::stop() {
+    if (m_thread.joinable()) {
+        const std::uint64_t value{ 1 };
+        std::ignore = ::write(m_stopEvent, &value, sizeof(value));
+        m_thread.join();
+    }
+    for (int* fd : { &m_epoll, &m_stopEvent, &m_listenSocket }) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+    if (!m_socketPath.empty()) {
+        ::unlink(m_socketPath.c_str());
+        m_socketPath.clear();
+    }
+}
+
+void QueryServer::setReport(const GpuReport& report) {
+    auto json = std::make_shared<std::string>();
+    formatJson(report, *json);
+    json->pop_back(); // The newline, every answer is exactly one line.
+    const std::scoped_lock lock{ m_mutex };
+    m_report = std::move(json);
+}
+
+std::shared_ptr<const std::string> QueryServer::currentReport() const {
+    const std::scoped_lock lock{ m_mutex };
+    return m_report;
+}
+
+void QueryServer::run() {
+    std::unordered_map<int, Connection> connections{};
+    std::vector<QuerySegment> segments{};
+    epoll_event events[kMaxEvents]{};
+    char chunk[kReadChunkSize]{};
+    const auto closeConnection = [this, &connections](const int fd) {
+        ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+    };
+    bool running{ true };
+    while (running) {
+        const int count = ::epoll_wait(m_epoll, events, kMaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::wcerr << L"\"epoll_wait\" failed: " << utf8ToWide(std::strerror(errno)) << std::endl;
+            break;
+        }
+        for (int index = 0; index != count; ++index) {
+            const int fd = events[index].data.fd;
+            if (fd == m_stopEvent) {
+                running = false;
+                break;
+            }
+            if (fd == m_listenSocket) {
+                while (true) {
+                    const int client = ::accept4(m_listenSocket, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (client < 0) {
+                        break; // EAGAIN once the backlog is empty, anything else only concerns that client.
+                    }
+                    epoll_event event{};
+                    event.events = EPOLLIN;
+                    event.data.fd = client;
+                    if (::epoll_ctl(m_epoll, EPOLL_CTL_ADD, client, &event) != 0) {
+                        ::close(client);
+                        continue;
+                    }
+                    connections.emplace(client, Connection{});
+                }
+                continue;
+            }
+            const auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
+            }
+            Connection& connection = it->second;
+            bool healthy{ true };
+            if (!connection.writing) {
+                healthy = readQueries(fd, connection, chunk);
+                if (healthy) {
+                    const std::shared_ptr<const std::string> report = currentReport();
+                    healthy = answerQueries(connection, report ? std::string_view{ *report } : std::string_view{ "null" }, segments);
+                }
+            }
+            if (healthy) {
+                healthy = flushAnswers(fd, connection);
+            }
+            const bool writing = !connection.output.empty();
+            if (!healthy || (connection.peerClosed && !writing)) {
+                closeConnection(fd);
+                continue;
+            }
+            if (writing != connection.writing) {
+                epoll_event event{};
+                event.events = writing ? EPOLLOUT : EPOLLIN;
+                event.data.fd = fd;
+                std::ignore = ::epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event);
+                connection.writing = writing;
+            }
+        }
+    }
+    for (auto&& [fd, connection] : connections) {
+        ::close(fd);
+    }
+}
+
+} // namespace gputester
@@ -4,10 +4,10 @@ namespace m4x1m1l14n
 {
 	namespace Registry
 	{
-		RegistryKey_ptr ClassesRoot(new RegistryKey(HKEY_CLASSES_ROOT));
-		RegistryKey_ptr CurrentUser(new RegistryKey(HKEY_CURRENT_USER));
-		RegistryKey_ptr LocalMachine(new RegistryKey(HKEY_LOCAL_MACHINE));
-		RegistryKey_ptr Users(new RegistryKey(HKEY_USERS));
-		RegistryKey_ptr CurrentConfig(new RegistryKey(HKEY_CURRENT_CONFIG));
+		RegistryKey_ptr ClassesRoot(new NativeRegistryKey(HKEY_CLASSES_ROOT));
+		RegistryKey_ptr CurrentUser(new NativeRegistryKey(HKEY_CURRENT_USER));
+		RegistryKey_ptr LocalMachine(new NativeRegistryKey(HKEY_LOCAL_MACHINE));
+		RegistryKey_ptr Users(new NativeRegistryKey(HKEY_USERS));
+		RegistryKey_ptr CurrentConfig(new NativeRegistryKey(HKEY_CURRENT_CONFIG));
 	}
 }
@@ -1,13 +1,22 @@
 #pragma once
 
+#ifdef _WIN32
 #include <windows.h>
+#endif
 
 #include <string>
 #include <memory>
 #include <exception>
 
 #include <assert.h>
+#ifdef _WIN32
 #include <tchar.h>
+#endif
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <functional>
+#include <optional>
 #include <vector>
 #include <stdexcept>
 #include <system_error>
@@ -26,6 +35,7 @@ namespace m4x1m1l14n
 			BINARY
 		};*/
 
+#ifdef _WIN32
 		enum class DesiredAccess : REGSAM
 		{
 			Delete = DELETE,
@@ -64,6 +74,34 @@ namespace m4x1m1l14n
 		};
 
 		DEFINE_ENUM_FLAG_OPERATORS(NotifyFilter);
+#else
+		// Same values as the Windows SDK, so code written against the native registry keeps its meaning
+		enum class DesiredAccess : std::uint32_t
+		{
+			Delete = 0x00010000,
+			ReadControl = 0x00020000,
+			WriteDAC = 0x00040000,
+			WriteOwner = 0x00080000,
+			AllAccess = 0x000F003F,
+			CreateSubKey = 0x0004,
+			EnumerateSubKeys = 0x0008,
+			Execute = 0x00020019,
+			Notify = 0x0010,
+			QueryValue = 0x0001,
+			Read = 0x00020019,
+			SetValue = 0x0002,
+			Wow6432 = 0x0200,
+			Wow6464 = 0x0100,
+			Write = 0x00020006
+		};
+
+		enum class CreateKeyOptions : std::uint32_t
+		{
+			BackupRestore = 0x00000004,
+			NonVolatile = 0x00000000,
+			Volatile = 0x00000001
+		};
+#endif
 
 #if 0
 		class RegistryValue
@@ -145,16 +183,318 @@ namespace m4x1m1l14n
 
 		typedef std::shared_ptr<RegistryKey> RegistryKey_ptr;
 
+		/// <summary>
+		///		Registry key interface. The native registry implements all of it, other
+		///		implementations (e.g. offline hive files) throw from what they can't support.
+		/// </summary>
 		class RegistryKey
 		{
+		public:
+			RegistryKey() = default;
+			virtual ~RegistryKey() = default;
+
+			// Disable copy ctor & copy assignment operator
+			RegistryKey(const RegistryKey& other) = delete;
+			RegistryKey& operator=(RegistryKey& other) = delete;
+
+			/// <summary>
+			///		Member method to open registry key on specified path, with specified access rights
+			/// </summary>
+			/// <param name="path">Relative path to subkey of this registry key</param>
+			/// <param name="access>
+			///		Desired access rights to open specified key.
+			///		Default only read!
+			///	</param>
+			virtual RegistryKey_ptr Open(const std::wstring& path, DesiredAccess access = DesiredAccess::Read) = 0;
+
+			/// <summary>
+			///		Creates registry key on specified path
+			/// </summary>
+			/// <param name="path">Relative path to subkey to create</param>
+			RegistryKey_ptr CreateVolatile(const std::wstring& path, DesiredAccess access = DesiredAccess::Read)
+			{
+				return Create(path, access, CreateKeyOptions::Volatile);
+			}
+
+			/// <summary>
+			///		Creates registry key on specified path
+			/// </summary>
+			/// <param name="path">Relative path to subkey to create</param>
+			/// <param name="access">Relative path to subkey to create</param>
+			/// <param name="options">Relative path to subkey to create</param>
+			virtual RegistryKey_ptr Create(const std::wstring& /*path*/, DesiredAccess /*access*/ = DesiredAccess::Read, CreateKeyOptions /*options*/ = CreateKeyOptions::NonVolatile)
+			{
+				ThrowNotSupported("Create()");
+			}
+
+			virtual void Delete()
+			{
+				ThrowNotSupported("Delete()");
+			}
+
+			virtual void Delete(const std::wstring& /*name*/)
+			{
+				ThrowNotSupported("Delete()");
+			}
+
+			/// <summary>
+			///		Checks whether specified subkey exists or not
+			/// </summary>
+			/// <param name="path">Subkey relative path to be checked for existence</param>
+			virtual bool HasKey(const std::wstring& path) = 0;
+
+			// For backward compatibility only
+			bool Exists(const std::wstring& path)
+			{
+				return HasKey(path);
+			}
+
+			virtual bool HasValue(const std::wstring& name) = 0;
+
+			virtual bool GetBoolean(const std::wstring& name) = 0;
+
+			// Default registry value
+			bool GetBoolean()
+			{
+				return GetBoolean(L"");
+			}
+
+			virtual void SetBoolean(const std::wstring& /*name*/, bool /*value*/)
+			{
+				ThrowNotSupported("SetBoolean()");
+			}
+
+			void SetBoolean(bool value)
+			{
+				SetBoolean(L"", value);
+			}
+
+			virtual long GetInt32(const std::wstring& name) = 0;
+
+			long GetInt32()
+			{
+				return GetInt32(L"");
+			}
+
+			unsigned long GetUInt32(const std::wstring& name)
+			{
+				return static_cast<unsigned long>(static_cast<std::uint32_t>(GetInt32(name)));
+			}
+
+			unsigned long GetUInt32()
+			{
+				return GetUInt32(L"");
+			}
+
+			virtual void SetInt32(const std::wstring& /*name*/, long /*value*/)
+			{
+				ThrowNotSupported("SetInt32()");
+			}
+
+			void SetInt32(long value)
+			{
+				return SetInt32(L"", value);
+			}
+
+			void SetUInt32(const std::wstring& name, unsigned long value)
+			{
+				return SetInt32(name, static_cast<long>(value));
+			}
+
+			void SetUInt32(unsigned long value)
+			{
+				return SetUInt32(L"", value);
+			}
+
+			virtual long long GetInt64(const std::wstring& name) = 0;
+
+			long long GetInt64()
+			{
+				return GetInt64(L"");
+			}
+
+			unsigned long long GetUInt64(const std::wstring& name)
+			{
+				return static_cast<unsigned long long>(GetInt64(name));
+			}
+
+			unsigned long long GetUInt64()
+			{
+				return static_cast<unsigned long long>(GetUInt64(L""));
+			}
+
+			virtual void SetInt64(const std::wstring& /*name*/, long long /*value*/)
+			{
+				ThrowNotSupported("SetInt64()");
+			}
+
+			void SetInt64(long long value)
+			{
+				return SetInt64(L"", value);
+			}
+
+			void SetUInt64(const std::wstring& name, unsigned long long value)
+			{
+				SetInt64(name, static_cast<long long>(value));
+			}
+
+			void SetUInt64(unsigned long long value)
+			{
+				SetUInt64(L"", value);
+			}
+
+			virtual std::wstring GetString(const std::wstring& name) = 0;
+
+			std::wstring GetString()
+			{
+				return GetString(L"");
+			}
+
+			/// <summary>
+			///		Reads a string value, with a single lookup where the implementation allows it
+			/// </summary>
+			/// <param name="name">Name of registry value (Empty string for default key value)</param>
+			/// <returns>Nothing if there is no such value, a value of another type throws like GetString() does</returns>
+			virtual std::optional<std::wstring> TryGetString(const std::wstring& name)
+			{
+				if (!name.empty() && !HasValue(name))
+				{
+					return std::nullopt;
+				}
+
+				return GetString(name);
+			}
+
+			/// <summary>
+			///		Reads a REG_DWORD value, with a single lookup where the implementation allows it
+			/// </summary>
+			/// <param name="name">Name of registry value (Empty string for default key value)</param>
+			/// <returns>Nothing if there is no such value</returns>
+			virtual std::optional<std::uint32_t> TryGetDWORD(const std::wstring& name)
+			{
+				if (!name.empty() && !HasValue(name))
+				{
+					return std::nullopt;
+				}
+
+				return static_cast<std::uint32_t>(GetUInt32(name));
+			}
+
+			/// <summary>
+			///		Reads a REG_BINARY value
+			/// </summary>
+			/// <param name="name">Name of registry value (Empty string for default key value)</param>
+			/// <returns>Nothing if there is no such value</returns>
+			virtual std::optional<std::vector<std::uint8_t>> TryGetBinary(const std::wstring& /*name*/)
+			{
+				ThrowNotSupported("TryGetBinary()");
+			}
+
+			/// <summary>
+			///		Reads several string values, in a single call where the implementation allows it
+			/// </summary>
+			/// <param name="names">Names of the registry values</param>
+			/// <returns>What TryGetString() returns for each of the names, in the same order. Implementations which can tell the
+			/// value types apart return nothing for a value which is not a string, instead of failing the others with it</returns>
+			virtual std::vector<std::optional<std::wstring>> GetValues(const std::vector<std::wstring>& names)
+			{
+				std::vector<std::optional<std::wstring>> values;
+				values.reserve(names.size());
+
+				for (const auto& name : names)
+				{
+					values.push_back(TryGetString(name));
+				}
+
+				return values;
+			}
+
+			virtual void SetString(const std::wstring& /*name*/, const std::wstring& /*value*/)
+			{
+				ThrowNotSupported("SetString()");
+			}
+
+			void SetString(const std::wstring& value)
+			{
+				SetString(L"", value);
+			}
+
+			/// <summary>
+			///	Create registry value with specified name of type REG_EXPAND_SZ within this registry key
+			/// </summary>
+			/// <param name="name">Name of registry value (Empty string for default key value)</param>
+			/// <param name="value">Value to be set</param>
+			virtual void SetExpandString(const std::wstring& /*name*/, const std::wstring& /*value*/)
+			{
+				ThrowNotSupported("SetExpandString()");
+			}
+
+			/// <summary>
+			///	Create default registry value of type REG_EXPAND_SZ within this registry key
+			/// </summary>
+			/// <param name="value">Value to be set</param>
+			void SetExpandString(const std::wstring& value)
+			{
+				SetExpandString(L"", value);
+			}
+
+			/// <summary>
+			///	Create registry value with specified name of type REG_BINARY within this registry key
+			/// </summary>
+			/// <param name="name">Name of registry value (Empty string for default key value)</param>
+			/// <param name="value">Value to be set</param>
+			virtual void SetBinary(const std::wstring& /*name*/, const std::vector<std::uint8_t>& /*value*/)
+			{
+				ThrowNotSupported("SetBinary()");
+			}
+
+			/// <summary>
+			///	Calls the callback with the name of every direct subkey, until it returns false
+			/// </summary>
+			virtual void EnumerateSubKeys(const std::function<bool(const std::wstring&)>& callback) = 0;
+
+#ifdef _WIN32
+			virtual void Flush()
+			{
+				ThrowNotSupported("Flush()");
+			}
+
+			virtual void Save(const std::wstring& /*file*/)
+			{
+				ThrowNotSupported("Save()");
+			}
+
+			virtual void Notify(bool /*watchSubtree*/ = false, NotifyFilter /*notifyFilter*/ = NotifyFilter::ChangeName | NotifyFilter::ChangeAttributes)
+			{
+				ThrowNotSupported("Notify()");
+			}
+
+			virtual void NotifyAsync(HANDLE /*hEvent*/, bool /*watchSubtree*/ = false, NotifyFilter /*notifyFilter*/ = NotifyFilter::ChangeName | NotifyFilter::ChangeAttributes | NotifyFilter::ChangeLastSet)
+			{
+				ThrowNotSupported("NotifyAsync()");
+			}
+#endif
+
+		protected:
+			[[noreturn]] static void ThrowNotSupported(const char* function)
+			{
+				auto ec = std::make_error_code(std::errc::operation_not_supported);
+
+				throw std::system_error(ec, std::string(function) + " failed");
+			}
+		};
+
+#ifdef _WIN32
+		class NativeRegistryKey final : public RegistryKey
+		{
 		private:
 			/// <summary>
 			/// Deleted default constructor
 			/// </summary>
-			RegistryKey() = delete;
+			NativeRegistryKey() = delete;
 
 		public:
-			RegistryKey(HKEY hKey)
+			NativeRegistryKey(HKEY hKey)
 				: m_hKey(hKey)
 			{
 				if (m_hKey == nullptr)
@@ -164,14 +504,14 @@ namespace m4x1m1l14n
 			}
 
 			// Disable copy ctor & copy assignment operator
-			RegistryKey(const RegistryKey& other) = delete;
-			RegistryKey& operator=(RegistryKey& other) = delete;
+			NativeRegistryKey(const NativeRegistryKey& other) = delete;
+			NativeRegistryKey& operator=(NativeRegistryKey& other) = delete;
 
 			// TODO Implement move logic
-			// RegistryKey(RegistryKey&& other);
-			// RegistryKey& operator=(RegistryKey&& other);
+			// NativeRegistryKey(NativeRegistryKey&& other);
+			// NativeRegistryKey& operator=(NativeRegistryKey&& other);
 
-			~RegistryKey()
+			~NativeRegistryKey() override
 			{
 				if ((m_hKey != nullptr) && !(
 					(m_hKey >= HKEY_CLASSES_ROOT) &&
@@ -200,7 +540,7 @@ namespace m4x1m1l14n
 			///		Default only read!
 			///	</param>
 			/// <exception></exception>
-			RegistryKey_ptr Open(const std::wstring& path, DesiredAccess access = DesiredAccess::Read)
+			RegistryKey_ptr Open(const std::wstring& path, DesiredAccess access = DesiredAccess::Read) override
 			{
 				if (path.empty())
 				{
@@ -221,16 +561,7 @@ namespace m4x1m1l14n
 
 				assert(hKey != nullptr);
 
-				return std::make_shared<RegistryKey>(hKey);
-			}
-
-			/// <summary>
-			///		Creates registry key on specified path
-			/// </summary>
-			/// <param name="path">Relative path to subkey to create</param>
-			RegistryKey_ptr CreateVolatile(const std::wstring& path, DesiredAccess access = DesiredAccess::Read)
-			{
-				return Create(path, access, CreateKeyOptions::Volatile);
+				return std::make_shared<NativeRegistryKey>(hKey);
 			}
 
 			/// <summary>
@@ -239,7 +570,7 @@ namespace m4x1m1l14n
 			/// <param name="path">Relative path to subkey to create</param>
 			/// <param name="access">Relative path to subkey to create</param>
 			/// <param name="options">Relative path to subkey to create</param>
-			RegistryKey_ptr Create(const std::wstring& path, DesiredAccess access = DesiredAccess::Read, CreateKeyOptions options = CreateKeyOptions::NonVolatile)
+			RegistryKey_ptr Create(const std::wstring& path, DesiredAccess access = DesiredAccess::Read, CreateKeyOptions options = CreateKeyOptions::NonVolatile) override
 			{
 				if (path.empty())
 				{
@@ -275,10 +606,10 @@ namespace m4x1m1l14n
 
 				assert(hKey != nullptr);
 
-				return std::make_shared<RegistryKey>(hKey);
+				return std::make_shared<NativeRegistryKey>(hKey);
 			}
 
-			void Delete()
+			void Delete() override
 			{
 				LPTSTR lpSubKey = nullptr;
 
@@ -291,7 +622,7 @@ namespace m4x1m1l14n
 				}
 			}
 
-			void Delete(const std::wstring& name)
+			void Delete(const std::wstring& name) override
 			{
 				LSTATUS lStatus = RegDeleteValue(m_hKey, name.c_str());
 				// In case registry entry with specified name is not registry Value
@@ -310,7 +641,7 @@ namespace m4x1m1l14n
 				}
 			}
 
-			void Flush()
+			void Flush() override
 			{
 				LSTATUS lStatus = RegFlushKey(m_hKey);
 				if (lStatus != ERROR_SUCCESS)
@@ -321,7 +652,7 @@ namespace m4x1m1l14n
 				}
 			}
 
-			void Save(const std::wstring& file)
+			void Save(const std::wstring& file) override
 			{
 				LPSECURITY_ATTRIBUTES lpSecurityAttributes = nullptr;
 
@@ -340,7 +671,7 @@ namespace m4x1m1l14n
 			///		Checks whether specified subkey exists or not
 			/// </summary>
 			/// <param name="path">Subkey relative path to be checked for existence</param>
-			bool HasKey(const std::wstring& path)
+			bool HasKey(const std::wstring& path) override
 			{
 				if (path.empty())
 				{
@@ -372,13 +703,7 @@ namespace m4x1m1l14n
 				return hasKey;
 			}
 
-			// For backward compatibility only
-			bool Exists(const std::wstring& path)
-			{
-				return HasKey(path);
-			}
-
-			bool HasValue(const std::wstring& name)
+			bool HasValue(const std::wstring& name) override
 			{
 				if (name.empty())
 				{
@@ -402,7 +727,7 @@ namespace m4x1m1l14n
 				return hasValue;
 			}
 
-			bool GetBoolean(const std::wstring& name)
+			bool GetBoolean(const std::wstring& name) override
 			{
 				DWORD dwType = 0;
 				DWORD dwData = 0;
@@ -426,13 +751,7 @@ namespace m4x1m1l14n
 				return (dwData == 0) ? false : true;
 			}
 
-			// Default registry value
-			bool GetBoolean()
-			{
-				return GetBoolean(L"");
-			}
-
-			void SetBoolean(const std::wstring& name, bool value)
+			void SetBoolean(const std::wstring& name, bool value) override
 			{
 				DWORD dwValue = value ? 1 : 0;
 				DWORD cbData = sizeof(dwValue);
@@ -446,12 +765,7 @@ namespace m4x1m1l14n
 				}
 			}
 
-			void SetBoolean(bool value)
-			{
-				SetBoolean(L"", value);
-			}
-
-			long GetInt32(const std::wstring& name)
+			long GetInt32(const std::wstring& name) override
 			{
 				long lData = 0;
 				DWORD cbData = sizeof(lData);
@@ -467,22 +781,7 @@ namespace m4x1m1l14n
 				return lData;
 			}
 
-			long GetInt32()
-			{
-				return GetInt32(L"");
-			}
-
-			unsigned long GetUInt32(const std::wstring& name)
-			{
-				return static_cast<unsigned long>(GetInt32(name));
-			}
-
-			unsigned long GetUInt32()
-			{
-				return GetUInt32(L"");
-			}
-
-			void SetInt32(const std::wstring& name, long value)
+			void SetInt32(const std::wstring& name, long value) override
 			{
 				DWORD cbData = sizeof(value);
 
@@ -495,22 +794,7 @@ namespace m4x1m1l14n
 				}
 			}
 
-			void SetInt32(long value)
-			{
-				return SetInt32(L"", value);
-			}
-
-			void SetUInt32(const std::wstring& name, unsigned long value)
-			{
-				return SetInt32(name, static_cast<long>(value));
-			}
-
-			void SetUInt32(unsigned long value)
-			{
-				return SetUInt32(L"", value);
-			}
-
-			long long GetInt64(const std::wstring& name) 
+			long long GetInt64(const std::wstring& name) override
 			{
 				long long llData = 0;
 				DWORD cbData = sizeof(llData);
@@ -526,22 +810,7 @@ namespace m4x1m1l14n
 				return llData;
 			}
 
-			long long GetInt64()
-			{
-				return GetInt64(L"");
-			}
-
-			unsigned long long GetUInt64(const std::wstring& name)
-			{
-				return static_cast<unsigned long long>(GetInt64(name));
-			}
-
-			unsigned long long GetUInt64()
-			{
-				return static_cast<unsigned long long>(GetUInt64(L""));
-			}
-
-			void SetInt64(const std::wstring& name, long long value)
+			void SetInt64(const std::wstring& name, long long value) override
 			{
 				DWORD cbData = sizeof(value);
 
@@ -554,29 +823,53 @@ namespace m4x1m1l14n
 				}
 			}
 
-			void SetInt64(long long value)
+			std::wstring GetString(const std::wstring& name) override
 			{
-				return SetInt64(L"", value);
-			}
+				auto value = TryGetString(name);
+				if (!value)
+				{
+					auto ec = std::error_code(ERROR_FILE_NOT_FOUND, std::system_category());
 
-			void SetUInt64(const std::wstring& name, unsigned long long value)
-			{
-				SetInt64(name, static_cast<long long>(value));
-			}
+					throw std::system_error(ec, "RegGetValue() failed");
+				}
 
-			void SetUInt64(unsigned long long value)
-			{
-				SetUInt64(L"", value);
+				return std::move(*value);
 			}
 
-			std::wstring GetString(const std::wstring& name) 
+			/// <summary>
+			///		Reads straight into a buffer on the stack, which most values fit into. Only longer ones
+			///		take another call, with a buffer of the size the first one reported.
+			/// </summary>
+			std::optional<std::wstring> TryGetString(const std::wstring& name) override
 			{
-				DWORD cbData = 0;
-				DWORD dwType = 0;
-
 				DWORD dwFlags = RRF_RT_REG_EXPAND_SZ | RRF_NOEXPAND | RRF_RT_REG_SZ;
-				
-				LSTATUS lStatus = RegGetValue(m_hKey, nullptr, name.c_str(), dwFlags, &dwType, nullptr, &cbData);
+
+				TCHAR buffer[kSmallValueLength];
+				DWORD cbData = sizeof(buffer);
+
+				LSTATUS lStatus = RegGetValue(m_hKey, nullptr, name.c_str(), dwFlags, nullptr, buffer, &cbData);
+				if (lStatus == ERROR_SUCCESS)
+				{
+					// RegGetValue() terminates strings even if they were stored without
+					return std::wstring(buffer);
+				}
+
+				std::wstring value;
+
+				// Repeated in case the value grew in between
+				while (lStatus == ERROR_MORE_DATA)
+				{
+					value.resize(cbData / sizeof(TCHAR) + 1);
+					cbData = static_cast<DWORD>(value.size() * sizeof(TCHAR));
+
+					lStatus = RegGetValue(m_hKey, nullptr, name.c_str(), dwFlags, nullptr, value.data(), &cbData);
+				}
+
+				if (lStatus == ERROR_FILE_NOT_FOUND)
+				{
+					return std::nullopt;
+				}
+
 				if (lStatus != ERROR_SUCCESS)
 				{
 					auto ec = std::error_code(lStatus, std::system_category());
@@ -584,54 +877,153 @@ namespace m4x1m1l14n
 					throw std::system_error(ec, "RegGetValue() failed");
 				}
 
-				if (dwType != REG_SZ && dwType != REG_EXPAND_SZ) // ???
+				value.resize(wcslen(value.c_str()));
+
+				return value;
+			}
+
+			std::optional<std::uint32_t> TryGetDWORD(const std::wstring& name) override
+			{
+				DWORD dwData = 0;
+				DWORD cbData = sizeof(dwData);
+
+				LSTATUS lStatus = RegGetValue(m_hKey, nullptr, name.c_str(), RRF_RT_REG_DWORD, nullptr, &dwData, &cbData);
+				if (lStatus == ERROR_FILE_NOT_FOUND)
 				{
-					throw std::runtime_error("Wrong registry value type " + std::to_string(dwType) + " for string value.");
+					return std::nullopt;
 				}
 
-				std::wstring value;
-
-				if (cbData)
+				if (lStatus != ERROR_SUCCESS)
 				{
-					assert((cbData % sizeof(TCHAR)) != 1);
+					auto ec = std::error_code(lStatus, std::system_category());
 
-					auto data = new TCHAR[cbData / sizeof(TCHAR)];
-					assert(data != nullptr);
+					throw std::system_error(ec, "RegGetValue() failed");
+				}
 
-					lStatus = RegGetValue(m_hKey, nullptr, name.c_str(), dwFlags, &dwType, reinterpret_cast<LPBYTE>(data), &cbData);
+				return static_cast<std::uint32_t>(dwData);
+			}
+
+			/// <summary>
+			///		Sized by a first call, repeated in case the value grew in between.
+			/// </summary>
+			std::optional<std::vector<std::uint8_t>> TryGetBinary(const std::wstring& name) override
+			{
+				std::vector<std::uint8_t> value;
+				DWORD cbData = 0;
 
-					std::exception_ptr pex;
+				LSTATUS lStatus = RegGetValue(m_hKey, nullptr, name.c_str(), RRF_RT_REG_BINARY, nullptr, nullptr, &cbData);
+				while (lStatus == ERROR_SUCCESS || lStatus == ERROR_MORE_DATA)
+				{
+					value.resize(cbData);
 
+					lStatus = RegGetValue(m_hKey, nullptr, name.c_str(), RRF_RT_REG_BINARY, nullptr, value.data(), &cbData);
 					if (lStatus == ERROR_SUCCESS)
 					{
-						//assert(data[cbData / sizeof(TCHAR) - 1] == _T('\0'));
+						value.resize(cbData);
 
-						value = std::wstring(data);
+						return value;
 					}
-					else
+				}
+
+				if (lStatus == ERROR_FILE_NOT_FOUND)
+				{
+					return std::nullopt;
+				}
+
+				auto ec = std::error_code(lStatus, std::system_category());
+
+				throw std::system_error(ec, "RegGetValue() failed");
+			}
+
+			/// <summary>
+			///		One RegQueryMultipleValues() call for all of the values. It fails as a whole if any of
+			///		them is missing, only then (or if the function isn't available) they are read one by one.
+			///		A value which is not a string gives nothing.
+			/// </summary>
+			std::vector<std::optional<std::wstring>> GetValues(const std::vector<std::wstring>& names) override
+			{
+				if (names.empty())
+				{
+					return {};
+				}
+
+				std::vector<VALENT> entries(names.size());
+				for (size_t i = 0; i < names.size(); ++i)
+				{
+					entries[i].ve_valuename = const_cast<LPTSTR>(names[i].c_str());
+				}
+
+				TCHAR buffer[kSmallValueLength * 4];
+				std::vector<TCHAR> heapBuffer;
+
+				LPTSTR data = buffer;
+				DWORD cbTotal = sizeof(buffer);
+
+				LSTATUS lStatus = RegQueryMultipleValues(m_hKey, entries.data(), static_cast<DWORD>(entries.size()), data, &cbTotal);
+
+				while (lStatus == ERROR_MORE_DATA)
+				{
+					heapBuffer.resize(cbTotal / sizeof(TCHAR) + 1);
+
+					data = heapBuffer.data();
+					cbTotal = static_cast<DWORD>(heapBuffer.size() * sizeof(TCHAR));
+
+					lStatus = RegQueryMultipleValues(m_hKey, entries.data(), static_cast<DWORD>(entries.size()), data, &cbTotal);
+				}
+
+				std::vector<std::optional<std::wstring>> values;
+				values.reserve(entries.size());
+
+				if (lStatus == ERROR_FILE_NOT_FOUND || lStatus == ERROR_CALL_NOT_IMPLEMENTED)
+				{
+					for (const auto& name : names)
 					{
-						auto ec = std::error_code(lStatus, std::system_category());
+						try
+						{
+							values.push_back(TryGetString(name));
+						}
+						catch (const std::system_error& ex)
+						{
+							if (ex.code() != std::error_code(ERROR_UNSUPPORTED_TYPE, std::system_category()))
+							{
+								throw;
+							}
 
-						pex = std::make_exception_ptr(std::system_error(ec, "RegGetValue() failed"));
+							values.push_back(std::nullopt);
+						}
 					}
 
-					delete[] data;
+					return values;
+				}
 
-					if (pex)
+				if (lStatus != ERROR_SUCCESS)
+				{
+					auto ec = std::error_code(lStatus, std::system_category());
+
+					throw std::system_error(ec, "RegQueryMultipleValues() failed");
+				}
+
+				for (const auto& entry : entries)
+				{
+					if (entry.ve_type != REG_SZ && entry.ve_type != REG_EXPAND_SZ)
 					{
-						std::rethrow_exception(pex);
+						values.push_back(std::nullopt);
+
+						continue;
 					}
-				}
 
-				return value;
-			}
+					// Unlike RegGetValue(), the data is returned as stored, the terminating null included or not
+					std::wstring value(entry.ve_valuelen / sizeof(TCHAR), L'\0');
+					std::memcpy(value.data(), reinterpret_cast<const void*>(entry.ve_valueptr), value.size() * sizeof(TCHAR));
+					value.resize(wcslen(value.c_str()));
 
-			std::wstring GetString()
-			{
-				return GetString(L"");
+					values.push_back(std::move(value));
+				}
+
+				return values;
 			}
 
-			void SetString(const std::wstring& name, const std::wstring& value) 
+			void SetString(const std::wstring& name, const std::wstring& value) override
 			{
 				auto cbData = static_cast<DWORD>(value.length());
 
@@ -644,17 +1036,12 @@ namespace m4x1m1l14n
 				}
 			}
 
-			void SetString(const std::wstring& value)
-			{
-				SetString(L"", value);
-			}
-
 			/// <summary>
 			///	Create registry value with specified name of type REG_EXPAND_SZ within this registry key
 			/// </summary>
 			/// <param name="name">Name of registry value (Empty string for default key value)</param>
 			/// <param name="value">Value to be set</param>
-			void SetExpandString(const std::wstring& name, const std::wstring& value)
+			void SetExpandString(const std::wstring& name, const std::wstring& value) override
 			{
 				auto cbData = static_cast<DWORD>(value.length());
 
@@ -667,17 +1054,18 @@ namespace m4x1m1l14n
 				}
 			}
 
-			/// <summary>
-			///	Create default registry value of type REG_EXPAND_SZ within this registry key
-			/// </summary>
-			/// <param name="value">Value to be set</param>
-			void SetExpandString(const std::wstring& value)
+			void SetBinary(const std::wstring& name, const std::vector<std::uint8_t>& value) override
 			{
-				SetExpandString(L"", value);
+				LSTATUS lStatus = RegSetValueEx(m_hKey, name.c_str(), 0, REG_BINARY, value.data(), static_cast<DWORD>(value.size()));
+				if (lStatus != ERROR_SUCCESS)
+				{
+					auto ec = std::error_code(lStatus, std::system_category());
+
+					throw std::system_error(ec, "RegSetValueEx() failed");
+				}
 			}
 
-			template <typename __Function>
-			void EnumerateSubKeys(const __Function& callback)
+			void EnumerateSubKeys(const std::function<bool(const std::wstring&)>& callback) override
 			{
 				DWORD dwSubKeys = 0;
 				DWORD dwLongestSubKeyLen = 0;
@@ -779,7 +1167,7 @@ namespace m4x1m1l14n
 			///	A value that indicates the changes that should be reported.
 			/// Default is ChangeName and ChangeAttributes.
 			/// </param>
-			void Notify(bool watchSubtree = false, NotifyFilter notifyFilter = NotifyFilter::ChangeName | NotifyFilter::ChangeAttributes)
+			void Notify(bool watchSubtree = false, NotifyFilter notifyFilter = NotifyFilter::ChangeName | NotifyFilter::ChangeAttributes) override
 			{
 				HANDLE hEvent = nullptr;
 				BOOL fAsynchronous = FALSE;
@@ -816,7 +1204,7 @@ namespace m4x1m1l14n
 			///	A value that indicates the changes that should be reported.
 			/// Default is ChangeName and ChangeAttributes.
 			/// </param>
-			void NotifyAsync(HANDLE hEvent, bool watchSubtree = false, NotifyFilter notifyFilter = NotifyFilter::ChangeName | NotifyFilter::ChangeAttributes | NotifyFilter::ChangeLastSet)
+			void NotifyAsync(HANDLE hEvent, bool watchSubtree = false, NotifyFilter notifyFilter = NotifyFilter::ChangeName | NotifyFilter::ChangeAttributes | NotifyFilter::ChangeLastSet) override
 			{
 				if (hEvent == nullptr)
 				{
@@ -992,6 +1380,9 @@ namespace m4x1m1l14n
 #endif
 
 		private:
+			// Characters of a string value that are read without any heap allocation
+			static constexpr DWORD kSmallValueLength = 128;
+
 			HKEY m_hKey;
 		};
 
@@ -1000,5 +1391,6 @@ namespace m4x1m1l14n
 		extern RegistryKey_ptr LocalMachine;
 		extern RegistryKey_ptr Users;
 		extern RegistryKey_ptr CurrentConfig;
+#endif
 	}
 }
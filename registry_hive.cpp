@@ -0,0 +1,903 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "registry_hive.hpp"
+#include "atomic_file.hpp"
+#include "mapped_file.hpp"
+#include "text.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace m4x1m1l14n;
+
+namespace gputester {
+
+// The layout is documented in https://github.com/msuhanov/regf/blob/master/Windows%20registry%20file%20format%20specification.md
+static constexpr const std::uint32_t kHiveMagic{ 0x66676572 }; // "regf"
+static constexpr const std::uint32_t kBinMagic{ 0x6E696268 }; // "hbin"
+static constexpr const std::size_t kBaseBlockSize{ 4096 };
+static constexpr const std::size_t kBinHeaderSize{ 32 };
+static constexpr const std::uint32_t kNoCell{ 0xFFFFFFFF };
+
+static constexpr const std::uint16_t kKeyNodeSignature{ 0x6B6E }; // "nk"
+static constexpr const std::uint16_t kKeyValueSignature{ 0x6B76 }; // "vk"
+static constexpr const std::uint16_t kIndexLeafSignature{ 0x696C }; // "li"
+static constexpr const std::uint16_t kFastLeafSignature{ 0x666C }; // "lf"
+static constexpr const std::uint16_t kHashLeafSignature{ 0x686C }; // "lh"
+static constexpr const std::uint16_t kIndexRootSignature{ 0x6972 }; // "ri"
+static constexpr const std::uint16_t kBigDataSignature{ 0x6264 }; // "db"
+
+static constexpr const std::size_t kKeyNodeNameOffset{ 0x4C };
+static constexpr const std::size_t kKeyValueNameOffset{ 0x14 };
+static constexpr const std::uint16_t kKeyCompressedName{ 0x0020 };
+static constexpr const std::uint16_t kValueCompressedName{ 0x0001 };
+static constexpr const std::uint32_t kValueDataInline{ 0x80000000 };
+// Values larger than this are split into "db" segments, from hive version 1.4 on.
+static constexpr const std::uint32_t kBigDataSegmentSize{ 16344 };
+
+static constexpr const std::uint32_t kValueTypeString{ 1 }; // REG_SZ
+static constexpr const std::uint32_t kValueTypeExpandString{ 2 }; // REG_EXPAND_SZ
+static constexpr const std::uint32_t kValueTypeBinary{ 3 }; // REG_BINARY
+static constexpr const std::uint32_t kValueTypeDword{ 4 }; // REG_DWORD
+static constexpr const std::uint32_t kValueTypeQword{ 11 }; // REG_QWORD
+
+static constexpr const std::u16string_view kCurrentControlSet{ u"CurrentControlSet" };
+
+// The path index file: the magic "GPHI" and the version, both u32, then what identifies the
+// hive it was built for (its size, the two sequence numbers, the last write time and the base block
+// checksum), the key count and the FNV-1a hash of the rest. The path hashes of all keys follow in
+// ascending order, then their cells.
+static constexpr const std::uint32_t kHiveIndexMagic{ 0x49485047 }; // "GPHI"
+static constexpr const std::uint32_t kHiveIndexVersion{ 1 };
+static constexpr const std::size_t kHiveIndexHeaderSize{ 48 };
+// Windows limits the registry to 512 levels of keys.
+static constexpr const std::size_t kMaxKeyDepth{ 512 };
+
+// Access rights a read-only key can't grant: KEY_SET_VALUE, KEY_CREATE_SUB_KEY, DELETE, WRITE_DAC and WRITE_OWNER.
+static constexpr const std::uint32_t kWriteAccessMask{ 0x000D0006 };
+
+[[nodiscard]] static inline std::uint16_t readU16(const std::span<const std::uint8_t> bytes, const std::size_t offset) {
+    return static_cast<std::uint16_t>(bytes[offset] | (bytes[offset + 1] << 8));
+}
+
+[[nodiscard]] static inline std::uint32_t readU32(const std::span<const std::uint8_t> bytes, const std::size_t offset) {
+    return static_cast<std::uint32_t>(bytes[offset]) | (static_cast<std::uint32_t>(bytes[offset + 1]) << 8)
+        | (static_cast<std::uint32_t>(bytes[offset + 2]) << 16) | (static_cast<std::uint32_t>(bytes[offset + 3]) << 24);
+}
+
+[[nodiscard]] static inline std::uint64_t readU64(const std::span<const std::uint8_t> bytes, const std::size_t offset) {
+    return static_cast<std::uint64_t>(readU32(bytes, offset)) | (static_cast<std::uint64_t>(readU32(bytes, offset + 4)) << 32);
+}
+
+static inline void appendU32(std::string& out, const std::uint32_t value) {
+    for (std::size_t index = 0; index != 4; ++index) {
+        out.push_back(static_cast<char>((value >> (index * 8)) & 0xFF));
+    }
+}
+
+static inline void appendU64(std::string& out, const std::uint64_t value) {
+    appendU32(out, static_cast<std::uint32_t>(value));
+    appendU32(out, static_cast<std::uint32_t>(value >> 32));
+}
+
+[[nodiscard]] static inline std::u16string toUtf16(const std::wstring_view str) {
+    std::u16string result{};
+    result.reserve(str.size());
+    for (const wchar_t ch : str) {
+        const auto codePoint = static_cast<std::uint32_t>(ch);
+        if (codePoint > 0xFFFF && codePoint <= 0x10FFFF) {
+            result.push_back(static_cast<char16_t>(0xD800 + ((codePoint - 0x10000) >> 10)));
+            result.push_back(static_cast<char16_t>(0xDC00 + ((codePoint - 0x10000) & 0x3FF)));
+        } else {
+            result.push_back(static_cast<char16_t>(codePoint));
+        }
+    }
+    return result;
+}
+
+// Stops at the first null character, like the string value readers of the native registry.
+[[nodiscard]] static inline std::wstring decodeUtf16(const std::span<const std::uint8_t> bytes) {
+    std::wstring result{};
+    result.reserve(bytes.size() / 2);
+    for (std::size_t offset = 0; offset + 1 < bytes.size(); offset += 2) {
+        const char16_t unit = readU16(bytes, offset);
+        if (unit == 0) {
+            break;
+        }
+        if constexpr (sizeof(wchar_t) > sizeof(char16_t)) {
+            if (unit >= 0xD800 && unit <= 0xDBFF && offset + 3 < bytes.size()) {
+                const char16_t low = readU16(bytes, offset + 2);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    result.push_back(static_cast<wchar_t>(0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00)));
+                    offset += 2;
+                    continue;
+                }
+            }
+        }
+        result.push_back(static_cast<wchar_t>(unit));
+    }
+    return result;
+}
+
+// A key or value name as stored in the hive: Latin-1 if compressed, UTF-16LE otherwise.
+struct HiveName final {
+    std::span<const std::uint8_t> bytes{};
+    bool compressed{ false };
+
+    [[nodiscard]] std::size_t length() const {
+        return compressed ? bytes.size() : bytes.size() / 2;
+    }
+
+    [[nodiscard]] char16_t at(const std::size_t index) const {
+        return compressed ? static_cast<char16_t>(bytes[index]) : readU16(bytes, index * 2);
+    }
+
+    // Registry names compare case-insensitively, see foldCase().
+    [[nodiscard]] bool equals(const std::u16string_view other) const {
+        return compressed ? equalsIgnoringCaseLatin1(bytes, other) : equalsIgnoringCaseUtf16(bytes, other);
+    }
+
+    [[nodiscard]] std::wstring toWide() const {
+        if (!compressed) {
+            return decodeUtf16(bytes);
+        }
+        return std::wstring(bytes.begin(), bytes.end());
+    }
+};
+
+// The hash "lh" lists store for every subkey. Returns nothing for names with characters outside
+// what foldCase() knows, Windows may have upper cased those differently.
+[[nodiscard]] static inline std::optional<std::uint32_t> hashName(const std::u16string_view name) {
+    std::uint32_t hash{ 0 };
+    for (const char16_t ch : name) {
+        if (ch > 0xFF) {
+            return std::nullopt;
+        }
+        hash = hash * 37 + foldCase(ch);
+    }
+    return hash;
+}
+
+// "lf" lists store the first four characters of every subkey name, null padded. Only ASCII
+// characters can rule a subkey out, the hint of anything else is lossy.
+[[nodiscard]] static inline bool hintMatches(const std::uint32_t hint, const std::u16string_view name) {
+    for (std::size_t index = 0; index != 4; ++index) {
+        const auto ch = static_cast<char16_t>((hint >> (index * 8)) & 0xFF);
+        if (index >= name.size()) {
+            return ch == 0;
+        }
+        if (ch >= 0x80 || name[index] >= 0x80) {
+            return true;
+        }
+        if (foldCase(ch) != foldCase(name[index])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+[[nodiscard]] static inline std::uint64_t hashBytes(const std::span<const std::uint8_t> bytes) {
+    std::uint64_t hash{ 14695981039346656037ull };
+    for (const std::uint8_t byte : bytes) {
+        hash = (hash ^ byte) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// FNV-1a over the case folded path below the root key, with a separator before every name, so the
+// hash of a subkey continues from the hash of its parent.
+static constexpr const std::uint64_t kPathHashBasis{ 14695981039346656037ull };
+
+[[nodiscard]] static inline std::uint64_t appendPathHash(std::uint64_t hash, const char16_t ch) {
+    return (hash ^ foldCase(ch)) * 1099511628211ull;
+}
+
+[[nodiscard]] static inline std::uint64_t appendPathHash(std::uint64_t hash, const std::u16string_view name) {
+    hash = appendPathHash(hash, u'\\');
+    for (const char16_t ch : name) {
+        hash = appendPathHash(hash, ch);
+    }
+    return hash;
+}
+
+[[nodiscard]] static inline std::uint64_t appendPathHash(std::uint64_t hash, const HiveName& name) {
+    hash = appendPathHash(hash, u'\\');
+    for (std::size_t index = 0; index != name.length(); ++index) {
+        hash = appendPathHash(hash, name.at(index));
+    }
+    return hash;
+}
+
+struct KeyNode final {
+    std::uint32_t parent{ kNoCell };
+    std::uint32_t subKeyCount{ 0 };
+    std::uint32_t subKeyList{ kNoCell };
+    std::uint32_t valueCount{ 0 };
+    std::uint32_t valueList{ kNoCell };
+    HiveName name{};
+};
+
+struct KeyValue final {
+    std::span<const std::uint8_t> cell{};
+    std::uint32_t dataSize{ 0 };
+    std::uint32_t dataOffset{ kNoCell };
+    std::uint32_t type{ 0 };
+    HiveName name{};
+};
+
+class Hive final {
+public:
+    explicit Hive(MappedFile file) : m_file(std::move(file)), m_image(m_file.data(), m_file.size()) {}
+    explicit Hive(std::string buffer) : m_buffer(std::move(buffer)), m_image(reinterpret_cast<const std::uint8_t*>(m_buffer.data()), m_buffer.size()) {}
+    Hive(const Hive&) = delete;
+    Hive& operator=(const Hive&) = delete;
+
+    // Checks the base block and the root key. A hive whose bins were cut short is accepted, the
+    // cells beyond the end just can't be found.
+    [[nodiscard]] bool parse() {
+        if (m_image.size() < kBaseBlockSize + kBinHeaderSize || readU32(m_image, 0) != kHiveMagic || readU32(m_image, 0x14) != 1
+            || readU32(m_image, kBaseBlockSize) != kBinMagic) {
+            return false;
+        }
+        m_minorVersion = readU32(m_image, 0x18);
+        m_rootCell = readU32(m_image, 0x24);
+        const std::size_t available = m_image.size() - kBaseBlockSize;
+        const std::size_t binsSize = readU32(m_image, 0x28);
+        m_bins = m_image.subspan(kBaseBlockSize, (binsSize == 0 || binsSize > available) ? available : binsSize);
+        const std::optional<KeyNode> root = keyNode(m_rootCell);
+        if (!root) {
+            return false;
+        }
+        if (findSubKey(root.value(), kCurrentControlSet) == kNoCell) {
+            m_currentControlSet = findCurrentControlSet(root.value());
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::uint32_t rootCell() const {
+        return m_rootCell;
+    }
+
+    // The name of the control set "CurrentControlSet" stands for below the root key, or nothing.
+    [[nodiscard]] std::u16string_view currentControlSet() const {
+        return m_currentControlSet;
+    }
+
+    [[nodiscard]] bool hasIndex() const {
+        return m_indexed;
+    }
+
+    // Indexes every key reachable from the root key. Keys which can't be reached, e.g. through a
+    // broken subkey list, can't be found through the index either.
+    void buildIndex() {
+        struct Pending final {
+            std::uint32_t cell{ kNoCell };
+            std::uint64_t hash{ 0 };
+            std::size_t depth{ 0 };
+        };
+        std::vector<std::pair<std::uint64_t, std::uint32_t>> entries{};
+        // No key node is smaller than this, so a hive with cycles in its lists can't go on forever.
+        const std::size_t maxKeyCount = m_bins.size() / (4 + kKeyNodeNameOffset);
+        std::vector<Pending> pending{ { m_rootCell, kPathHashBasis, 0 } };
+        while (!pending.empty() && entries.size() < maxKeyCount) {
+            const Pending current = pending.back();
+            pending.pop_back();
+            const std::optional<KeyNode> node = keyNode(current.cell);
+            if (!node || current.depth == kMaxKeyDepth) {
+                continue;
+            }
+            std::ignore = walkSubKeys(node->subKeyList, [this, &current, &entries, &pending](const std::uint32_t offset, const std::uint16_t, const std::uint32_t) {
+                const std::optional<KeyNode> subKey = keyNode(offset);
+                if (subKey) {
+                    const std::uint64_t hash = appendPathHash(current.hash, subKey->name);
+                    entries.emplace_back(hash, offset);
+                    pending.push_back({ offset, hash, current.depth + 1 });
+                }
+                return true;
+            });
+        }
+        std::sort(entries.begin(), entries.end());
+        m_indexHashes.clear();
+        m_indexCells.clear();
+        m_indexHashes.reserve(entries.size());
+        m_indexCells.reserve(entries.size());
+        for (auto&& [hash, cell] : std::as_const(entries)) {
+            m_indexHashes.push_back(hash);
+            m_indexCells.push_back(cell);
+        }
+        m_indexed = true;
+    }
+
+    void saveIndex(std::string& bufferOut) const {
+        bufferOut.clear();
+        bufferOut.reserve(kHiveIndexHeaderSize + m_indexHashes.size() * 12);
+        appendU32(bufferOut, kHiveIndexMagic);
+        appendU32(bufferOut, kHiveIndexVersion);
+        appendU64(bufferOut, m_image.size());
+        appendU32(bufferOut, readU32(m_image, 0x04));
+        appendU32(bufferOut, readU32(m_image, 0x08));
+        appendU64(bufferOut, readU64(m_image, 0x0C));
+        appendU32(bufferOut, readU32(m_image, 0x1FC));
+        appendU32(bufferOut, static_cast<std::uint32_t>(m_indexHashes.size()));
+        appendU64(bufferOut, 0);
+        for (const std::uint64_t hash : m_indexHashes) {
+            appendU64(bufferOut, hash);
+        }
+        for (const std::uint32_t cell : m_indexCells) {
+            appendU32(bufferOut, cell);
+        }
+        const std::uint64_t checksum = hashBytes({ reinterpret_cast<const std::uint8_t*>(bufferOut.data()) + kHiveIndexHeaderSize, bufferOut.size() - kHiveIndexHeaderSize });
+        for (std::size_t index = 0; index != 8; ++index) {
+            bufferOut[40 + index] = static_cast<char>((checksum >> (index * 8)) & 0xFF);
+        }
+    }
+
+    // Fails if the index was built for another hive, or another state of this one.
+    [[nodiscard]] bool loadIndex(const std::span<const std::uint8_t> index) {
+        if (index.size() < kHiveIndexHeaderSize || readU32(index, 0) != kHiveIndexMagic || readU32(index, 4) != kHiveIndexVersion
+            || readU64(index, 8) != m_image.size() || readU32(index, 16) != readU32(m_image, 0x04) || readU32(index, 20) != readU32(m_image, 0x08)
+            || readU64(index, 24) != readU64(m_image, 0x0C) || readU32(index, 32) != readU32(m_image, 0x1FC)) {
+            return false;
+        }
+        const std::size_t count = readU32(index, 36);
+        if (index.size() != kHiveIndexHeaderSize + count * 12 || readU64(index, 40) != hashBytes(index.subspan(kHiveIndexHeaderSize))) {
+            return false;
+        }
+        std::vector<std::uint64_t> hashes(count);
+        std::vector<std::uint32_t> cells(count);
+        for (std::size_t entry = 0; entry != count; ++entry) {
+            hashes[entry] = readU64(index, kHiveIndexHeaderSize + entry * 8);
+            cells[entry] = readU32(index, kHiveIndexHeaderSize + count * 8 + entry * 4);
+            if ((entry != 0 && hashes[entry] < hashes[entry - 1]) || cells[entry] >= m_bins.size()) {
+                return false;
+            }
+        }
+        m_indexHashes = std::move(hashes);
+        m_indexCells = std::move(cells);
+        m_indexed = true;
+        return true;
+    }
+
+    // The key "components" lead to from "start", "hash" is the hash of the whole path. Every entry with
+    // that hash is checked against the names on the way back up, so collisions can't mislead.
+    [[nodiscard]] std::uint32_t findIndexed(const std::uint32_t start, const std::uint64_t hash, const std::vector<std::u16string>& components) const {
+        const auto [first, last] = std::equal_range(m_indexHashes.begin(), m_indexHashes.end(), hash);
+        for (auto it = first; it != last; ++it) {
+            const std::uint32_t candidate = m_indexCells[static_cast<std::size_t>(it - m_indexHashes.begin())];
+            std::uint32_t cell{ candidate };
+            bool matches{ true };
+            for (auto component = components.rbegin(); component != components.rend() && matches; ++component) {
+                const std::optional<KeyNode> node = keyNode(cell);
+                matches = node && node->name.equals(*component);
+                cell = node ? node->parent : kNoCell;
+            }
+            if (matches && cell == start) {
+                return candidate;
+            }
+        }
+        return kNoCell;
+    }
+
+    // The data of the cell at "offset", relative to the first bin. Free cells are read too, a hive
+    // copied from a live system may still reference them.
+    [[nodiscard]] std::span<const std::uint8_t> cell(const std::uint32_t offset) const {
+        if (offset == kNoCell || m_bins.size() < 4 || offset > m_bins.size() - 4) {
+            return {};
+        }
+        const auto rawSize = static_cast<std::int32_t>(readU32(m_bins, offset));
+        const std::uint32_t size = rawSize < 0 ? 0u - static_cast<std::uint32_t>(rawSize) : static_cast<std::uint32_t>(rawSize);
+        if (size < 4 || size > m_bins.size() - offset) {
+            return {};
+        }
+        return m_bins.subspan(offset + 4, size - 4);
+    }
+
+    [[nodiscard]] std::optional<KeyNode> keyNode(const std::uint32_t offset) const {
+        const std::span<const std::uint8_t> data = cell(offset);
+        if (data.size() < kKeyNodeNameOffset || readU16(data, 0) != kKeyNodeSignature) {
+            return std::nullopt;
+        }
+        const std::uint16_t nameLength = readU16(data, 0x48);
+        if (nameLength > data.size() - kKeyNodeNameOffset) {
+            return std::nullopt;
+        }
+        KeyNode node{};
+        node.parent = readU32(data, 0x10);
+        node.subKeyCount = readU32(data, 0x14);
+        node.subKeyList = readU32(data, 0x1C);
+        node.valueCount = readU32(data, 0x24);
+        node.valueList = readU32(data, 0x28);
+        node.name = { data.subspan(kKeyNodeNameOffset, nameLength), (readU16(data, 0x02) & kKeyCompressedName) != 0 };
+        return node;
+    }
+
+    [[nodiscard]] std::optional<KeyValue> keyValue(const std::uint32_t offset) const {
+        const std::span<const std::uint8_t> data = cell(offset);
+        if (data.size() < kKeyValueNameOffset || readU16(data, 0) != kKeyValueSignature) {
+            return std::nullopt;
+        }
+        const std::uint16_t nameLength = readU16(data, 0x02);
+        if (nameLength > data.size() - kKeyValueNameOffset) {
+            return std::nullopt;
+        }
+        KeyValue value{};
+        value.cell = data;
+        value.dataSize = readU32(data, 0x04);
+        value.dataOffset = readU32(data, 0x08);
+        value.type = readU32(data, 0x0C);
+        value.name = { data.subspan(kKeyValueNameOffset, nameLength), (readU16(data, 0x10) & kValueCompressedName) != 0 };
+        return value;
+    }
+
+    // Points into the hive, except for values split into segments, which are joined in "scratch".
+    [[nodiscard]] std::optional<std::span<const std::uint8_t>> valueData(const KeyValue& value, std::vector<std::uint8_t>& scratch) const {
+        const std::uint32_t size = value.dataSize & ~kValueDataInline;
+        if ((value.dataSize & kValueDataInline) != 0) {
+            if (size > 4) {
+                return std::nullopt;
+            }
+            return value.cell.subspan(0x08, size);
+        }
+        if (size == 0) {
+            return std::span<const std::uint8_t>{};
+        }
+        const std::span<const std::uint8_t> data = cell(value.dataOffset);
+        if (m_minorVersion >= 4 && size > kBigDataSegmentSize && data.size() >= 8 && readU16(data, 0) == kBigDataSignature) {
+            const std::span<const std::uint8_t> segments = cell(readU32(data, 0x04));
+            const std::size_t segmentCount = std::min<std::size_t>(readU16(data, 0x02), segments.size() / 4);
+            scratch.clear();
+            for (std::size_t index = 0; index != segmentCount && scratch.size() < size; ++index) {
+                const std::span<const std::uint8_t> segment = cell(readU32(segments, index * 4));
+                const std::size_t take = std::min<std::size_t>({ segment.size(), kBigDataSegmentSize, size - scratch.size() });
+                scratch.insert(scratch.end(), segment.begin(), segment.begin() + take);
+            }
+            if (scratch.size() != size) {
+                return std::nullopt;
+            }
+            return std::span<const std::uint8_t>{ scratch };
+        }
+        if (data.size() < size) {
+            return std::nullopt;
+        }
+        return data.first(size);
+    }
+
+    // Calls "visitor" with the offset of every key node in a subkey list and the list's signature
+    // and hint for it, until it returns false. Broken lists are skipped.
+    template <typename Visitor>
+    bool walkSubKeys(const std::uint32_t list, Visitor&& visitor, const bool nested = false) const {
+        const std::span<const std::uint8_t> data = cell(list);
+        if (data.size() < 4) {
+            return true;
+        }
+        const std::uint16_t signature = readU16(data, 0);
+        const std::size_t count = readU16(data, 0x02);
+        if (signature == kIndexRootSignature) {
+            if (nested) { // Index roots only ever point to leaves.
+                return true;
+            }
+            for (std::size_t index = 0; index != count && 4 + index * 4 + 4 <= data.size(); ++index) {
+                if (!walkSubKeys(readU32(data, 4 + index * 4), visitor, true)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if (signature == kIndexLeafSignature) {
+            for (std::size_t index = 0; index != count && 4 + index * 4 + 4 <= data.size(); ++index) {
+                if (!visitor(readU32(data, 4 + index * 4), signature, std::uint32_t{ 0 })) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if (signature == kFastLeafSignature || signature == kHashLeafSignature) {
+            for (std::size_t index = 0; index != count && 4 + index * 8 + 8 <= data.size(); ++index) {
+                if (!visitor(readU32(data, 4 + index * 8), signature, readU32(data, 4 + index * 8 + 4))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::uint32_t findSubKey(const KeyNode& parent, const std::u16string_view name) const {
+        if (parent.subKeyCount == 0) {
+            return kNoCell;
+        }
+        const std::optional<std::uint32_t> hash = hashName(name);
+        std::uint32_t found{ kNoCell };
+        std::ignore = walkSubKeys(parent.subKeyList, [this, &name, &hash, &found](const std::uint32_t offset, const std::uint16_t signature, const std::uint32_t hint) {
+            if (signature == kHashLeafSignature && hash && hint != hash.value()) {
+                return true;
+            }
+            if (signature == kFastLeafSignature && !hintMatches(hint, name)) {
+                return true;
+            }
+            const std::optional<KeyNode> node = keyNode(offset);
+            if (node && node->name.equals(name)) {
+                found = offset;
+                return false;
+            }
+            return true;
+        });
+        return found;
+    }
+
+    [[nodiscard]] std::optional<KeyValue> findValue(const KeyNode& key, const std::u16string_view name) const {
+        const std::span<const std::uint8_t> list = cell(key.valueList);
+        const std::size_t count = std::min<std::size_t>(key.valueCount, list.size() / 4);
+        for (std::size_t index = 0; index != count; ++index) {
+            std::optional<KeyValue> value = keyValue(readU32(list, index * 4));
+            if (value && value->name.equals(name)) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    // The control set "Select\\Current" names, which "CurrentControlSet" links to on a running system.
+    [[nodiscard]] std::u16string findCurrentControlSet(const KeyNode& root) const {
+        const std::optional<KeyNode> select = keyNode(findSubKey(root, u"Select"));
+        if (!select) {
+            return {};
+        }
+        const std::optional<KeyValue> current = findValue(select.value(), u"Current");
+        if (!current || current->type != kValueTypeDword) {
+            return {};
+        }
+        std::vector<std::uint8_t> scratch{};
+        const std::optional<std::span<const std::uint8_t>> data = valueData(current.value(), scratch);
+        if (!data || data->size() != 4) {
+            return {};
+        }
+        std::u16string name{ u"ControlSet000" };
+        const std::uint32_t number = std::min<std::uint32_t>(readU32(data.value(), 0), 999);
+        name[10] = static_cast<char16_t>(u'0' + number / 100);
+        name[11] = static_cast<char16_t>(u'0' + number / 10 % 10);
+        name[12] = static_cast<char16_t>(u'0' + number % 10);
+        return name;
+    }
+
+    MappedFile m_file{};
+    std::string m_buffer{};
+    std::span<const std::uint8_t> m_image{};
+    std::span<const std::uint8_t> m_bins{};
+    std::uint32_t m_rootCell{ kNoCell };
+    std::uint32_t m_minorVersion{ 0 };
+    std::u16string m_currentControlSet{};
+    bool m_indexed{ false };
+    std::vector<std::uint64_t> m_indexHashes{};
+    std::vector<std::uint32_t> m_indexCells{};
+};
+using hive_ptr_t = std::shared_ptr<const Hive>;
+
+class HiveRegistryKey final : public Registry::RegistryKey {
+public:
+    // "pathHash" only matters for indexed hives.
+    explicit HiveRegistryKey(hive_ptr_t hive, const std::uint32_t cell, const std::uint64_t pathHash)
+        : m_hive(std::move(hive)), m_cell(cell), m_pathHash(pathHash) {}
+    ~HiveRegistryKey() override = default;
+
+    Registry::RegistryKey_ptr Open(const std::wstring& path, Registry::DesiredAccess access = Registry::DesiredAccess::Read) override {
+        if (path.empty()) {
+            throw std::invalid_argument("Specified path to registry key cannot be empty");
+        }
+        if ((static_cast<std::uint32_t>(access) & kWriteAccessMask) != 0) {
+            throw std::system_error(std::make_error_code(std::errc::read_only_file_system), "Open() failed");
+        }
+        const auto [cell, pathHash] = resolve(path);
+        if (cell == kNoCell) {
+            throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "Open() failed");
+        }
+        return std::make_shared<HiveRegistryKey>(m_hive, cell, pathHash);
+    }
+
+    bool HasKey(const std::wstring& path) override {
+        if (path.empty()) {
+            throw std::invalid_argument("Specified path to registry key cannot be empty");
+        }
+        return resolve(path).first != kNoCell;
+    }
+
+    bool HasValue(const std::wstring& name) override {
+        if (name.empty()) {
+            throw std::invalid_argument("Value name cannot be empty");
+        }
+        return m_hive->findValue(node(), toUtf16(name)).has_value();
+    }
+
+    bool GetBoolean(const std::wstring& name) override {
+        std::vector<std::uint8_t> scratch{};
+        const auto [type, data] = value(name, scratch, "GetBoolean()");
+        if (type != kValueTypeDword && type != kValueTypeQword) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(type) + " for boolean value.");
+        }
+        return std::any_of(data.begin(), data.end(), [](const std::uint8_t byte) { return byte != 0; });
+    }
+
+    long GetInt32(const std::wstring& name) override {
+        return static_cast<long>(static_cast<std::int32_t>(static_cast<std::uint32_t>(getInteger(name, sizeof(std::int32_t), "GetInt32()"))));
+    }
+
+    long long GetInt64(const std::wstring& name) override {
+        return static_cast<long long>(getInteger(name, sizeof(std::int64_t), "GetInt64()"));
+    }
+
+    std::wstring GetString(const std::wstring& name) override {
+        std::vector<std::uint8_t> scratch{};
+        const auto [type, data] = value(name, scratch, "GetString()");
+        return toString(type, data);
+    }
+
+    std::optional<std::wstring> TryGetString(const std::wstring& name) override {
+        std::vector<std::uint8_t> scratch{};
+        const auto found = tryValue(name, scratch);
+        if (!found) {
+            return std::nullopt;
+        }
+        return toString(found->first, found->second);
+    }
+
+    // A value which is not a string gives nothing.
+    std::vector<std::optional<std::wstring>> GetValues(const std::vector<std::wstring>& names) override {
+        std::vector<std::optional<std::wstring>> values{};
+        values.reserve(names.size());
+        std::vector<std::uint8_t> scratch{};
+        for (auto&& name : names) {
+            const auto found = tryValue(name, scratch);
+            if (!found || (found->first != kValueTypeString && found->first != kValueTypeExpandString)) {
+                values.push_back(std::nullopt);
+                continue;
+            }
+            values.push_back(toString(found->first, found->second));
+        }
+        return values;
+    }
+
+    std::optional<std::uint32_t> TryGetDWORD(const std::wstring& name) override {
+        std::vector<std::uint8_t> scratch{};
+        const auto found = tryValue(name, scratch);
+        if (!found) {
+            return std::nullopt;
+        }
+        const auto [type, data] = found.value();
+        if (type != kValueTypeDword) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(type) + " for DWORD value.");
+        }
+        if (data.size() > sizeof(std::uint32_t)) {
+            throw std::system_error(std::make_error_code(std::errc::value_too_large), "TryGetDWORD() failed");
+        }
+        std::uint32_t result{ 0 };
+        for (std::size_t index = 0; index != data.size(); ++index) {
+            result |= static_cast<std::uint32_t>(data[index]) << (index * 8);
+        }
+        return result;
+    }
+
+    std::optional<std::vector<std::uint8_t>> TryGetBinary(const std::wstring& name) override {
+        std::vector<std::uint8_t> scratch{};
+        const auto found = tryValue(name, scratch);
+        if (!found) {
+            return std::nullopt;
+        }
+        const auto [type, data] = found.value();
+        if (type != kValueTypeBinary) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(type) + " for binary value.");
+        }
+        return std::vector<std::uint8_t>(data.begin(), data.end());
+    }
+
+    void EnumerateSubKeys(const std::function<bool(const std::wstring&)>& callback) override {
+        std::ignore = m_hive->walkSubKeys(node().subKeyList, [this, &callback](const std::uint32_t offset, const std::uint16_t, const std::uint32_t) {
+            const std::optional<KeyNode> subKey = m_hive->keyNode(offset);
+            return !subKey || callback(subKey->name.toWide());
+        });
+    }
+
+private:
+    [[nodiscard]] KeyNode node() const {
+        const std::optional<KeyNode> result = m_hive->keyNode(m_cell);
+        if (!result) { // Every key was a valid node when it was opened, and the hive doesn't change.
+            throw std::runtime_error("The registry hive is corrupted.");
+        }
+        return result.value();
+    }
+
+    // The cell of the key and the hash of its path.
+    [[nodiscard]] std::pair<std::uint32_t, std::uint64_t> resolve(const std::wstring_view path) const {
+        std::vector<std::u16string> components{};
+        std::size_t begin{ 0 };
+        while (begin <= path.size()) {
+            std::size_t end = path.find(L'\\', begin);
+            if (end == std::wstring_view::npos) {
+                end = path.size();
+            }
+            if (end != begin) {
+                components.push_back(toUtf16(path.substr(begin, end - begin)));
+            }
+            begin = end + 1;
+        }
+        if (!components.empty() && m_cell == m_hive->rootCell() && !m_hive->currentControlSet().empty()
+            && equalsIgnoringCase(components.front(), kCurrentControlSet)) {
+            components.front() = m_hive->currentControlSet();
+        }
+        if (components.empty()) {
+            return { m_cell, m_pathHash };
+        }
+        if (m_hive->hasIndex()) {
+            std::uint64_t hash{ m_pathHash };
+            for (auto&& component : std::as_const(components)) {
+                hash = appendPathHash(hash, component);
+            }
+            return { m_hive->findIndexed(m_cell, hash, components), hash };
+        }
+        std::uint32_t cell{ m_cell };
+        for (auto&& component : std::as_const(components)) {
+            const std::optional<KeyNode> parent = m_hive->keyNode(cell);
+            if (!parent) {
+                return { kNoCell, 0 };
+            }
+            cell = m_hive->findSubKey(parent.value(), component);
+            if (cell == kNoCell) {
+                return { kNoCell, 0 };
+            }
+        }
+        return { cell, 0 };
+    }
+
+    // The type and data of the value, nothing if there is no such value.
+    [[nodiscard]] std::optional<std::pair<std::uint32_t, std::span<const std::uint8_t>>> tryValue(const std::wstring& name, std::vector<std::uint8_t>& scratch) const {
+        const std::optional<KeyValue> found = m_hive->findValue(node(), toUtf16(name));
+        if (!found) {
+            return std::nullopt;
+        }
+        const std::optional<std::span<const std::uint8_t>> data = m_hive->valueData(found.value(), scratch);
+        if (!data) {
+            throw std::runtime_error("The registry hive is corrupted.");
+        }
+        return std::pair{ found->type, data.value() };
+    }
+
+    [[nodiscard]] std::pair<std::uint32_t, std::span<const std::uint8_t>> value(const std::wstring& name, std::vector<std::uint8_t>& scratch, const char* function) const {
+        const auto found = tryValue(name, scratch);
+        if (!found) {
+            throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), std::string(function) + " failed");
+        }
+        return found.value();
+    }
+
+    [[nodiscard]] static std::wstring toString(const std::uint32_t type, const std::span<const std::uint8_t> data) {
+        if (type != kValueTypeString && type != kValueTypeExpandString) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(type) + " for string value.");
+        }
+        return decodeUtf16(data);
+    }
+
+    // Like the native registry, any value type is accepted as long as the data fits.
+    [[nodiscard]] std::uint64_t getInteger(const std::wstring& name, const std::size_t size, const char* function) const {
+        std::vector<std::uint8_t> scratch{};
+        const auto [type, data] = value(name, scratch, function);
+        if (data.size() > size) {
+            throw std::system_error(std::make_error_code(std::errc::value_too_large), std::string(function) + " failed");
+        }
+        std::uint64_t result{ 0 };
+        for (std::size_t index = 0; index != data.size(); ++index) {
+            result |= static_cast<std::uint64_t>(data[index]) << (index * 8);
+        }
+        return result;
+    }
+
+    hive_ptr_t m_hive{};
+    std::uint32_t m_cell{ kNoCell };
+    std::uint64_t m_pathHash{ kPathHashBasis };
+};
+
+[[nodiscard]] static inline Registry::RegistryKey_ptr createRootKey(hive_ptr_t hive) {
+    const std::uint32_t rootCell = hive->rootCell();
+    return std::make_shared<HiveRegistryKey>(std::move(hive), rootCell, kPathHashBasis);
+}
+
+// Missing or outdated indexes are rebuilt, that's not worth failing the hive for.
+[[nodiscard]] static inline bool loadHiveIndex(Hive& hive, const std::filesystem::path& path) {
+    std::error_code error{};
+    if (path.empty() || !std::filesystem::is_regular_file(path, error)) {
+        return false;
+    }
+    MappedFile file{};
+    if (!file.open(path)) {
+        return false;
+    }
+    if (!hive.loadIndex({ file.data(), file.size() })) {
+        std::wcerr << L"Rebuilding the outdated or corrupted registry hive index \"" << path.wstring() << L"\"." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+[[nodiscard]] static inline bool saveHiveIndex(const Hive& hive, const std::filesystem::path& path) {
+    std::string index{};
+    hive.saveIndex(index);
+    // Concurrent openers may rebuild the same index, none of them sees half of one.
+    return writeFileAtomically(path, index);
+}
+
+[[nodiscard]] static inline std::shared_ptr<Hive> openHive(const std::filesystem::path& path) {
+    MappedFile file{};
+    if (!file.open(path)) {
+        return nullptr;
+    }
+    auto hive = std::make_shared<Hive>(std::move(file));
+    if (!hive->parse()) {
+        std::wcerr << L"\"" << path.wstring() << L"\" is not a registry hive." << std::endl;
+        return nullptr;
+    }
+    return hive;
+}
+
+Registry::RegistryKey_ptr openRegistryHive(const std::filesystem::path& path) {
+    std::shared_ptr<Hive> hive = openHive(path);
+    if (!hive) {
+        return nullptr;
+    }
+    return createRootKey(std::move(hive));
+}
+
+Registry::RegistryKey_ptr openRegistryHive(const std::filesystem::path& path, const std::filesystem::path& indexPath) {
+    std::shared_ptr<Hive> hive = openHive(path);
+    if (!hive) {
+        return nullptr;
+    }
+    if (!loadHiveIndex(*hive, indexPath)) {
+        hive->buildIndex();
+        if (!indexPath.empty()) {
+            std::ignore = saveHiveIndex(*hive, indexPath);
+        }
+    }
+    return createRootKey(std::move(hive));
+}
+
+Registry::RegistryKey_ptr parseRegistryHive(std::string data) {
+    auto hive = std::make_shared<Hive>(std::move(data));
+    if (!hive->parse()) {
+        std::wcerr << L"Not a registry hive." << std::endl;
+        return nullptr;
+    }
+    return createRootKey(std::move(hive));
+}
+
+} // namespace gputester
@@ -0,0 +1,53 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "registry.hpp"
+#include <filesystem>
+#include <string>
+
+namespace gputester {
+
+// Read-only access to an offline registry hive, in the REGF format "reg save" writes and
+// %SystemRoot%\System32\config holds. The returned key is the root key of the hive, e.g.
+// HKEY_LOCAL_MACHINE\SYSTEM for a SYSTEM hive. Keys and values are read in place from the
+// file, which stays mapped as long as any key of the hive is alive.
+//
+// "CurrentControlSet" only exists on a running system. Opened below the root key of an offline
+// hive, it resolves to the control set "Select\Current" names, the way the kernel links it.
+//
+// Every write throws, and so does anything the native registry can't do without a live system
+// (e.g. Notify()). Returns nullptr if the file is not a hive, the reason is reported.
+[[nodiscard]] m4x1m1l14n::Registry::RegistryKey_ptr openRegistryHive(const std::filesystem::path& path);
+// The same with an index of every key path in the hive: Open() and HasKey() resolve a path with one
+// hash lookup instead of walking the subkey lists of every key on the way, which pays off when the
+// same hives are queried over and over. The index is read from "indexPath" if it was built for this
+// very state of the hive, otherwise it is built with one walk over the whole hive and saved there.
+// An empty "indexPath" builds it in memory only.
+[[nodiscard]] m4x1m1l14n::Registry::RegistryKey_ptr openRegistryHive(const std::filesystem::path& path, const std::filesystem::path& indexPath);
+// The same for a hive image already in memory.
+[[nodiscard]] m4x1m1l14n::Registry::RegistryKey_ptr parseRegistryHive(std::string data);
+
+} // namespace gputester
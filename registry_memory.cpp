@@ -0,0 +1,460 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "registry_memory.hpp"
+#include "text.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace m4x1m1l14n;
+
+namespace gputester {
+
+static constexpr const std::uint32_t kValueTypeString{ 1 }; // REG_SZ
+static constexpr const std::uint32_t kValueTypeExpandString{ 2 }; // REG_EXPAND_SZ
+static constexpr const std::uint32_t kValueTypeBinary{ 3 }; // REG_BINARY
+static constexpr const std::uint32_t kValueTypeDword{ 4 }; // REG_DWORD
+static constexpr const std::uint32_t kValueTypeQword{ 11 }; // REG_QWORD
+
+static constexpr const std::size_t kArenaBlockSize{ 16 * 1024 };
+
+// Both keep the folded name next to the one they were created with, the vectors holding them are
+// sorted by it. Neither is ever destroyed, their memory all comes from the arena.
+struct MemoryValue final {
+    explicit MemoryValue(std::pmr::memory_resource* arena) : name(arena), foldedName(arena), string(arena), bytes(arena) {}
+
+    std::pmr::wstring name;
+    std::pmr::wstring foldedName;
+    std::uint32_t type{ 0 };
+    std::uint64_t number{ 0 };
+    std::pmr::wstring string;
+    std::pmr::vector<std::uint8_t> bytes;
+};
+
+struct MemoryKey final {
+    explicit MemoryKey(std::pmr::memory_resource* arena) : name(arena), foldedName(arena), subKeys(arena), values(arena) {}
+
+    std::pmr::wstring name;
+    std::pmr::wstring foldedName;
+    std::pmr::vector<MemoryKey*> subKeys;
+    std::pmr::vector<MemoryValue*> values;
+    bool deleted{ false };
+};
+
+struct MemoryRegistry final {
+    std::pmr::monotonic_buffer_resource arena{ kArenaBlockSize };
+    // Shared by the readers, the arena is only allocated from with it held exclusively.
+    std::shared_mutex mutex{};
+    MemoryKey* root{ nullptr };
+    // Deleted values, reused for the next ones created. Nothing can reach them any more, unlike
+    // deleted keys which open handles still point to.
+    std::vector<MemoryValue*> freeValues{};
+};
+using memory_registry_ptr_t = std::shared_ptr<MemoryRegistry>;
+
+// Orders a folded name against one that isn't, without making a folded copy of the latter.
+[[nodiscard]] static inline int compareFolded(const std::wstring_view folded, const std::wstring_view name) {
+    const std::size_t length = std::min(folded.size(), name.size());
+    for (std::size_t index = 0; index != length; ++index) {
+        const auto left = static_cast<std::uint32_t>(folded[index]);
+        const auto right = static_cast<std::uint32_t>(foldCase(name[index]));
+        if (left != right) {
+            return left < right ? -1 : 1;
+        }
+    }
+    if (folded.size() == name.size()) {
+        return 0;
+    }
+    return folded.size() < name.size() ? -1 : 1;
+}
+
+template <typename Entry>
+[[nodiscard]] static inline auto lowerBound(const std::pmr::vector<Entry*>& entries, const std::wstring_view name) {
+    return std::lower_bound(entries.begin(), entries.end(), name, [](const Entry* entry, const std::wstring_view key) {
+        return compareFolded(entry->foldedName, key) < 0;
+    });
+}
+
+template <typename Entry>
+[[nodiscard]] static inline Entry* findEntry(const std::pmr::vector<Entry*>& entries, const std::wstring_view name) {
+    const auto it = lowerBound(entries, name);
+    return (it != entries.end() && compareFolded((*it)->foldedName, name) == 0) ? *it : nullptr;
+}
+
+template <typename Entry>
+static inline void setName(Entry& entry, const std::wstring_view name) {
+    entry.name = name;
+    entry.foldedName.resize(name.size());
+    std::transform(name.begin(), name.end(), entry.foldedName.begin(), [](const wchar_t ch) { return foldCase(ch); });
+}
+
+// Handles of the key or of any key below it fail from now on, like native ones do. Their values
+// go to "freeValues".
+static inline void markDeleted(MemoryKey& key, std::vector<MemoryValue*>& freeValues) {
+    key.deleted = true;
+    freeValues.insert(freeValues.end(), key.values.begin(), key.values.end());
+    key.values.clear();
+    for (MemoryKey* subKey : key.subKeys) {
+        markDeleted(*subKey, freeValues);
+    }
+}
+
+// Calls "visitor" with every component of a backslash separated path, empty ones are skipped.
+// Stops early and returns false once "visitor" does.
+template <typename Visitor>
+[[nodiscard]] static inline bool forEachComponent(const std::wstring_view path, Visitor&& visitor) {
+    std::size_t begin{ 0 };
+    while (begin <= path.size()) {
+        std::size_t end = path.find(L'\\', begin);
+        if (end == std::wstring_view::npos) {
+            end = path.size();
+        }
+        if (end != begin && !visitor(path.substr(begin, end - begin))) {
+            return false;
+        }
+        begin = end + 1;
+    }
+    return true;
+}
+
+class MemoryRegistryKey final : public Registry::RegistryKey {
+public:
+    explicit MemoryRegistryKey(memory_registry_ptr_t registry, MemoryKey* key) : m_registry(std::move(registry)), m_key(key) {}
+    ~MemoryRegistryKey() override = default;
+
+    Registry::RegistryKey_ptr Open(const std::wstring& path, Registry::DesiredAccess /*access*/ = Registry::DesiredAccess::Read) override {
+        if (path.empty()) {
+            throw std::invalid_argument("Specified path to registry key cannot be empty");
+        }
+        MemoryKey* key{ nullptr };
+        {
+            const std::shared_lock lock{ m_registry->mutex };
+            key = resolve(path, "Open()");
+        }
+        if (!key) {
+            throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), "Open() failed");
+        }
+        return std::make_shared<MemoryRegistryKey>(m_registry, key);
+    }
+
+    Registry::RegistryKey_ptr Create(const std::wstring& path, Registry::DesiredAccess /*access*/ = Registry::DesiredAccess::Read, Registry::CreateKeyOptions /*options*/ = Registry::CreateKeyOptions::NonVolatile) override {
+        if (path.empty()) {
+            throw std::invalid_argument("Specified path to registry key cannot be empty");
+        }
+        MemoryKey* key{ nullptr };
+        {
+            const std::scoped_lock lock{ m_registry->mutex };
+            key = live("Create()");
+            std::ignore = forEachComponent(path, [this, &key](const std::wstring_view component) {
+                const auto it = lowerBound(key->subKeys, component);
+                if (it != key->subKeys.end() && compareFolded((*it)->foldedName, component) == 0) {
+                    key = *it;
+                    return true;
+                }
+                std::pmr::polymorphic_allocator<> allocator{ &m_registry->arena };
+                MemoryKey* subKey = allocator.new_object<MemoryKey>(&m_registry->arena);
+                setName(*subKey, component);
+                key = *key->subKeys.insert(it, subKey);
+                return true;
+            });
+        }
+        return std::make_shared<MemoryRegistryKey>(m_registry, key);
+    }
+
+    // Like RegDeleteTree() without a subkey: every value and subkey goes, the key itself stays.
+    void Delete() override {
+        const std::scoped_lock lock{ m_registry->mutex };
+        std::ignore = live("Delete()");
+        for (MemoryKey* subKey : m_key->subKeys) {
+            markDeleted(*subKey, m_registry->freeValues);
+        }
+        m_key->subKeys.clear();
+        m_registry->freeValues.insert(m_registry->freeValues.end(), m_key->values.begin(), m_key->values.end());
+        m_key->values.clear();
+    }
+
+    // The value of that name, or if there is none the subkey with everything below it. Deleting
+    // something that doesn't exist is not an error.
+    void Delete(const std::wstring& name) override {
+        const std::scoped_lock lock{ m_registry->mutex };
+        std::ignore = live("Delete()");
+        if (const auto it = lowerBound(m_key->values, name); it != m_key->values.end() && compareFolded((*it)->foldedName, name) == 0) {
+            m_registry->freeValues.push_back(*it);
+            m_key->values.erase(it);
+            return;
+        }
+        if (const auto it = lowerBound(m_key->subKeys, name); it != m_key->subKeys.end() && compareFolded((*it)->foldedName, name) == 0) {
+            markDeleted(**it, m_registry->freeValues);
+            m_key->subKeys.erase(it);
+        }
+    }
+
+    bool HasKey(const std::wstring& path) override {
+        if (path.empty()) {
+            throw std::invalid_argument("Specified path to registry key cannot be empty");
+        }
+        const std::shared_lock lock{ m_registry->mutex };
+        return resolve(path, "HasKey()") != nullptr;
+    }
+
+    bool HasValue(const std::wstring& name) override {
+        if (name.empty()) {
+            throw std::invalid_argument("Value name cannot be empty");
+        }
+        const std::shared_lock lock{ m_registry->mutex };
+        return findEntry(live("HasValue()")->values, name) != nullptr;
+    }
+
+    bool GetBoolean(const std::wstring& name) override {
+        const std::shared_lock lock{ m_registry->mutex };
+        const MemoryValue& found = value(name, "GetBoolean()");
+        if (found.type != kValueTypeDword && found.type != kValueTypeQword) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(found.type) + " for boolean value.");
+        }
+        return found.number != 0;
+    }
+
+    void SetBoolean(const std::wstring& name, bool value) override {
+        setNumber(name, kValueTypeDword, value ? 1 : 0, "SetBoolean()");
+    }
+
+    // Like the native registry, a QWORD doesn't fit.
+    long GetInt32(const std::wstring& name) override {
+        const std::shared_lock lock{ m_registry->mutex };
+        const MemoryValue& found = value(name, "GetInt32()");
+        if (found.type == kValueTypeQword) {
+            throw std::system_error(std::make_error_code(std::errc::value_too_large), "GetInt32() failed");
+        }
+        if (found.type != kValueTypeDword) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(found.type) + " for integer value.");
+        }
+        return static_cast<long>(static_cast<std::int32_t>(static_cast<std::uint32_t>(found.number)));
+    }
+
+    void SetInt32(const std::wstring& name, long value) override {
+        setNumber(name, kValueTypeDword, static_cast<std::uint32_t>(value), "SetInt32()");
+    }
+
+    long long GetInt64(const std::wstring& name) override {
+        const std::shared_lock lock{ m_registry->mutex };
+        const MemoryValue& found = value(name, "GetInt64()");
+        if (found.type != kValueTypeDword && found.type != kValueTypeQword) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(found.type) + " for integer value.");
+        }
+        return static_cast<long long>(found.number);
+    }
+
+    void SetInt64(const std::wstring& name, long long value) override {
+        setNumber(name, kValueTypeQword, static_cast<std::uint64_t>(value), "SetInt64()");
+    }
+
+    std::wstring GetString(const std::wstring& name) override {
+        const std::shared_lock lock{ m_registry->mutex };
+        return toString(value(name, "GetString()"));
+    }
+
+    std::optional<std::wstring> TryGetString(const std::wstring& name) override {
+        const std::shared_lock lock{ m_registry->mutex };
+        const MemoryValue* found = findEntry(live("TryGetString()")->values, name);
+        if (!found) {
+            return std::nullopt;
+        }
+        return toString(*found);
+    }
+
+    std::optional<std::uint32_t> TryGetDWORD(const std::wstring& name) override {
+        const std::shared_lock lock{ m_registry->mutex };
+        const MemoryValue* found = findEntry(live("TryGetDWORD()")->values, name);
+        if (!found) {
+            return std::nullopt;
+        }
+        if (found->type != kValueTypeDword) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(found->type) + " for DWORD value.");
+        }
+        return static_cast<std::uint32_t>(found->number);
+    }
+
+    std::optional<std::vector<std::uint8_t>> TryGetBinary(const std::wstring& name) override {
+        const std::shared_lock lock{ m_registry->mutex };
+        const MemoryValue* found = findEntry(live("TryGetBinary()")->values, name);
+        if (!found) {
+            return std::nullopt;
+        }
+        if (found->type != kValueTypeBinary) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(found->type) + " for binary value.");
+        }
+        return std::vector<std::uint8_t>(found->bytes.begin(), found->bytes.end());
+    }
+
+    // All of them under one lock, a value which is not a string gives nothing.
+    std::vector<std::optional<std::wstring>> GetValues(const std::vector<std::wstring>& names) override {
+        std::vector<std::optional<std::wstring>> values{};
+        values.reserve(names.size());
+        const std::shared_lock lock{ m_registry->mutex };
+        const MemoryKey* key = live("GetValues()");
+        for (auto&& name : names) {
+            const MemoryValue* found = findEntry(key->values, name);
+            if (!found || (found->type != kValueTypeString && found->type != kValueTypeExpandString)) {
+                values.push_back(std::nullopt);
+                continue;
+            }
+            values.push_back(std::wstring(found->string));
+        }
+        return values;
+    }
+
+    void SetString(const std::wstring& name, const std::wstring& value) override {
+        setString(name, kValueTypeString, value, "SetString()");
+    }
+
+    void SetExpandString(const std::wstring& name, const std::wstring& value) override {
+        setString(name, kValueTypeExpandString, value, "SetExpandString()");
+    }
+
+    void SetBinary(const std::wstring& name, const std::vector<std::uint8_t>& value) override {
+        const std::scoped_lock lock{ m_registry->mutex };
+        MemoryValue& target = valueForWrite(name, "SetBinary()");
+        target.type = kValueTypeBinary;
+        target.number = 0;
+        target.string.clear();
+        target.bytes.assign(value.begin(), value.end());
+    }
+
+    // The names are copied first, so the callback is free to use the registry.
+    void EnumerateSubKeys(const std::function<bool(const std::wstring&)>& callback) override {
+        std::vector<std::wstring> names{};
+        {
+            const std::shared_lock lock{ m_registry->mutex };
+            const MemoryKey* key = live("EnumerateSubKeys()");
+            names.reserve(key->subKeys.size());
+            for (const MemoryKey* subKey : key->subKeys) {
+                names.emplace_back(subKey->name);
+            }
+        }
+        for (auto&& name : std::as_const(names)) {
+            if (!callback(name)) {
+                break;
+            }
+        }
+    }
+
+private:
+    [[nodiscard]] static std::wstring toString(const MemoryValue& value) {
+        if (value.type != kValueTypeString && value.type != kValueTypeExpandString) {
+            throw std::runtime_error("Wrong registry value type " + std::to_string(value.type) + " for string value.");
+        }
+        return std::wstring(value.string);
+    }
+
+    [[noreturn]] static void throwDeleted(const char* function) {
+        throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), std::string(function) + " failed");
+    }
+
+    // Only call with the mutex held.
+    [[nodiscard]] MemoryKey* live(const char* function) const {
+        if (m_key->deleted) {
+            throwDeleted(function);
+        }
+        return m_key;
+    }
+
+    [[nodiscard]] MemoryKey* resolve(const std::wstring_view path, const char* function) const {
+        MemoryKey* key = live(function);
+        const bool found = forEachComponent(path, [&key](const std::wstring_view component) {
+            key = findEntry(key->subKeys, component);
+            return key != nullptr;
+        });
+        return found ? key : nullptr;
+    }
+
+    [[nodiscard]] const MemoryValue& value(const std::wstring_view name, const char* function) const {
+        const MemoryValue* found = findEntry(live(function)->values, name);
+        if (!found) {
+            throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), std::string(function) + " failed");
+        }
+        return *found;
+    }
+
+    // Only call with the mutex held exclusively. An existing value is overwritten, whatever its type, and
+    // keeps its buffers: only data which doesn't fit them takes more of the arena.
+    [[nodiscard]] MemoryValue& valueForWrite(const std::wstring_view name, const char* function) {
+        MemoryKey* key = live(function);
+        const auto it = lowerBound(key->values, name);
+        if (it != key->values.end() && compareFolded((*it)->foldedName, name) == 0) {
+            return **it;
+        }
+        MemoryValue* created{ nullptr };
+        if (!m_registry->freeValues.empty()) {
+            created = m_registry->freeValues.back();
+            m_registry->freeValues.pop_back();
+        } else {
+            std::pmr::polymorphic_allocator<> allocator{ &m_registry->arena };
+            created = allocator.new_object<MemoryValue>(&m_registry->arena);
+        }
+        setName(*created, name);
+        return **key->values.insert(it, created);
+    }
+
+    void setNumber(const std::wstring_view name, const std::uint32_t type, const std::uint64_t number, const char* function) {
+        const std::scoped_lock lock{ m_registry->mutex };
+        MemoryValue& target = valueForWrite(name, function);
+        target.type = type;
+        target.number = number;
+        target.string.clear();
+        target.bytes.clear();
+    }
+
+    void setString(const std::wstring_view name, const std::uint32_t type, const std::wstring_view string, const char* function) {
+        const std::scoped_lock lock{ m_registry->mutex };
+        MemoryValue& target = valueForWrite(name, function);
+        target.type = type;
+        target.number = 0;
+        target.string = string;
+        target.bytes.clear();
+    }
+
+    memory_registry_ptr_t m_registry{};
+    MemoryKey* m_key{ nullptr };
+};
+
+Registry::RegistryKey_ptr createMemoryRegistry() {
+    auto registry = std::make_shared<MemoryRegistry>();
+    std::pmr::polymorphic_allocator<> allocator{ &registry->arena };
+    registry->root = allocator.new_object<MemoryKey>(&registry->arena);
+    MemoryKey* root = registry->root;
+    return std::make_shared<MemoryRegistryKey>(std::move(registry), root);
+}
+
+} // namespace gputester
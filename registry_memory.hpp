@@ -0,0 +1,47 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "registry.hpp"
+
+namespace gputester {
+
+// A registry that only exists in memory. Everything of the RegistryKey interface works except what
+// needs a live system (Flush(), Save() and the notifications), so it can stand in for
+// HKEY_LOCAL_MACHINE where there is none, and hold what registry heavy probes read over and over.
+//
+// Keys and values are allocated from a monotonic arena owned by the registry, which is released
+// with its last key; deleting a key only unlinks it. The arena never takes memory back: a value
+// overwritten with data that doesn't fit its buffer, and a subkey or value list outgrowing its
+// capacity, leave the old buffer behind until then. Deleted values are reused by the next values
+// created, buffers included. So the registry suits being filled once and read many times, a
+// long-lived registry written over and over keeps growing. The subkeys and values of a key are
+// flat vectors sorted by their case folded names (see foldCase()), so every path component is a
+// binary search. Any key may be used from any thread.
+//
+// The access rights and options passed to Open() and Create() are ignored, every key is writable.
+[[nodiscard]] m4x1m1l14n::Registry::RegistryKey_ptr createMemoryRegistry();
+
+} // namespace gputester
@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "report.hpp"
+#include "probe_call.hpp"
+#include "thread_pool.hpp"
+#include <tuple>
+#include <utility>
+
+namespace gputester {
+
+static inline void probeOutput(Backend& backend, const ProbeOptions& options, OutputInfo& outputInfo) {
+    const OutputDesc& output = outputInfo.desc;
+    DisplayInfo& display = outputInfo.display;
+    const auto has = [&options](const probe_node_t node) {
+        return (options.nodes & probeNodeBit(node)) != 0;
+    };
+    const auto record = [&outputInfo](const probe_node_t node) -> ProbeRecord& {
+        return outputInfo.probes[static_cast<std::size_t>(node)];
+    };
+    if (has(probe_node_t::ModeInfo)) {
+        std::ignore = callProbe<ModeInfo>(backend, options, [output](Backend& backend, ModeInfo& infoOut) {
+            return backend.getModeInfo(output, infoOut);
+        }, display.mode, record(probe_node_t::ModeInfo));
+    }
+    if (has(probe_node_t::ColorInfo)) {
+        std::ignore = callProbe<ColorInfo>(backend, options, [output](Backend& backend, ColorInfo& infoOut) {
+            return backend.getColorInfo(output, infoOut);
+        }, display.color, record(probe_node_t::ColorInfo));
+    }
+    if (has(probe_node_t::PathInfo)) {
+        std::ignore = callProbe<PathInfo>(backend, options, [output](Backend& backend, PathInfo& infoOut) {
+            return backend.getPathInfo(output, infoOut);
+        }, display.path, record(probe_node_t::PathInfo));
+    }
+    if (has(probe_node_t::Dpi)) {
+        std::ignore = callProbe<std::uint32_t>(backend, options, [output](Backend& backend, std::uint32_t& dpiOut) {
+            dpiOut = kDefaultScreenDpi;
+            return backend.getDpi(output, dpiOut);
+        }, display.dpi, record(probe_node_t::Dpi));
+    }
+}
+
+static inline void probeAdapter(Backend& backend, const ProbeOptions& options, AdapterInfo& adapterInfo) {
+    const AdapterDesc& adapter = adapterInfo.desc;
+    if (options.nodes & probeNodeBit(probe_node_t::DriverInfo)) {
+        std::ignore = callProbe<DriverInfo>(backend, options, [adapter](Backend& backend, DriverInfo& infoOut) {
+            return backend.getDriverInfo(adapter, infoOut);
+        }, adapterInfo.driver, adapterInfo.probes[static_cast<std::size_t>(probe_node_t::DriverInfo)]);
+    }
+    if ((options.nodes & (probeNodeBit(probe_node_t::OutputList) | kOutputProbeNodes)) == 0) {
+        return;
+    }
+    std::optional<std::vector<OutputDesc>> outputs{};
+    std::ignore = callProbe<std::vector<OutputDesc>>(backend, options, [adapter](Backend& backend, std::vector<OutputDesc>& outputsOut) {
+        return backend.enumerateOutputs(adapter, outputsOut);
+    }, outputs, adapterInfo.probes[static_cast<std::size_t>(probe_node_t::OutputList)]);
+    if (!outputs) {
+        return;
+    }
+    adapterInfo.outputs.resize(outputs->size());
+    for (std::size_t index = 0; index != outputs->size(); ++index) {
+        adapterInfo.outputs[index].desc = std::move((*outputs)[index]);
+    }
+    if ((options.nodes & kOutputProbeNodes) == 0) {
+        return;
+    }
+    forEachIndex(options.pool, adapterInfo.outputs.size(), [&backend, &options, &adapterInfo](const std::size_t index) {
+        probeOutput(backend, options, adapterInfo.outputs[index]);
+    });
+}
+
+bool probe(Backend& backend, GpuReport& reportOut, const ProbeOptions& options) {
+    reportOut = {};
+    reportOut.backend = backend.name();
+    // The calls abandoned last time may still be using the handle table enumeration would rebuild.
+    if (backend.abandonedProbeCount() != 0) {
+        return false;
+    }
+    ProbeRecord record{};
+    // Every other probe needs the handle table enumeration builds, see Backend::enumerateAdapters().
+    std::optional<std::vector<AdapterDesc>> adapters{};
+    if (callProbe<std::vector<AdapterDesc>>(backend, options, [](Backend& backend, std::vector<AdapterDesc>& adaptersOut) {
+        return backend.enumerateAdapters(adaptersOut);
+    }, adapters, record) != probe_status_t::Succeeded) {
+        return false;
+    }
+    std::optional<bool> variableRefreshRateSupported{};
+    std::ignore = callProbe<bool>(backend, options, [](Backend& backend, bool& supportedOut) {
+        return backend.getVariableRefreshRateSupport(supportedOut);
+    }, variableRefreshRateSupported, record);
+    reportOut.variableRefreshRateSupported = variableRefreshRateSupported.value_or(false);
+    reportOut.adapters.resize(adapters->size());
+    for (std::size_t index = 0; index != adapters->size(); ++index) {
+        reportOut.adapters[index].desc = std::move((*adapters)[index]);
+    }
+    forEachIndex(options.pool, reportOut.adapters.size(), [&backend, &options, &reportOut](const std::size_t index) {
+        probeAdapter(backend, options, reportOut.adapters[index]);
+    });
+    return true;
+}
+
+} // namespace gputester
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "backend.hpp"
+#include <chrono>
+
+namespace gputester {
+
+class ThreadPool;
+
+// A driver call that takes longer than this is hung, what the tool and libgputester use unless told otherwise.
+static constexpr const std::chrono::milliseconds kDefaultProbeTimeout{ 5000 };
+
+struct ProbeOptions final {
+    // Probes independent adapters and outputs in parallel when set, the report is the same either way.
+    ThreadPool* pool{ nullptr };
+    // The probes to run, the parts of the report the others would fill stay empty. The adapter
+    // list is always enumerated, and any output probe implies the output list.
+    probe_node_mask_t nodes{ kAllProbeNodes };
+    // How long to wait for a single probe, zero to wait as long as it takes. A probe that misses its
+    // deadline is abandoned and recorded as TimedOut, the rest of the report doesn't wait for it.
+    // Only backends owned by a backend_ptr_t can be left behind like that, others are never abandoned.
+    std::chrono::nanoseconds timeout{ 0 };
+    // Fills AdapterInfo::probes and OutputInfo::probes with the status and latency of every probe.
+    // Timeouts are recorded either way.
+    bool recordProbes{ false };
+};
+
+// Runs the probes of "backend" selected by the options and collects the answers. Returns false only if the
+// adapters can't be enumerated, a failed probe just leaves its part of the report empty. That includes
+// the case of a probe abandoned by an earlier run which is still stuck in the backend.
+[[nodiscard]] bool probe(Backend& backend, GpuReport& reportOut, const ProbeOptions& options = {});
+
+} // namespace gputester
@@ -0,0 +1,168 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "report_delta.hpp"
+#include <utility>
+
+namespace gputester {
+
+[[nodiscard]] static inline bool isSameAdapter(const AdapterDesc& lhs, const AdapterDesc& rhs) {
+    if (lhs.luid != rhs.luid || lhs.vendorId != rhs.vendorId || lhs.deviceId != rhs.deviceId) {
+        return false;
+    }
+    // Backends without LUIDs only have the enumeration order left.
+    return lhs.luid != 0 || lhs.index == rhs.index;
+}
+
+template <typename T, typename Predicate>
+[[nodiscard]] static inline std::optional<std::size_t> findIndex(const std::vector<T>& items, Predicate&& predicate) {
+    for (std::size_t index = 0; index != items.size(); ++index) {
+        if (predicate(items[index])) {
+            return index;
+        }
+    }
+    return std::nullopt;
+}
+
+[[nodiscard]] static inline std::optional<float> getRefreshRate(const DisplayInfo& display) {
+    if (!display.path) {
+        return std::nullopt;
+    }
+    return display.path->currentRefreshRate;
+}
+
+[[nodiscard]] static inline std::optional<bool> getHdr(const DisplayInfo& display) {
+    if (!display.color) {
+        return std::nullopt;
+    }
+    return isHdrColorSpace(display.color->colorSpace);
+}
+
+static inline void diffOutputs(const AdapterInfo& oldAdapter, const std::size_t oldAdapterIndex, const AdapterInfo& newAdapter,
+                               const std::size_t newAdapterIndex, std::vector<ReportDelta>& deltasOut) {
+    const auto push = [&](const report_delta_t type, const std::optional<std::size_t> oldOutput, const std::optional<std::size_t> newOutput) {
+        deltasOut.push_back({ type, oldAdapterIndex, newAdapterIndex, oldOutput, newOutput });
+    };
+    for (std::size_t oldIndex = 0; oldIndex != oldAdapter.outputs.size(); ++oldIndex) {
+        const OutputInfo& oldOutput = oldAdapter.outputs[oldIndex];
+        const std::optional<std::size_t> newIndex = findIndex(newAdapter.outputs, [&oldOutput](const OutputInfo& candidate) {
+            return candidate.desc.deviceName == oldOutput.desc.deviceName;
+        });
+        if (!newIndex) {
+            if (oldOutput.desc.attachedToDesktop) {
+                push(report_delta_t::OutputDetached, oldIndex, std::nullopt);
+            }
+            continue;
+        }
+        const OutputInfo& newOutput = newAdapter.outputs[newIndex.value()];
+        if (oldOutput.desc.attachedToDesktop != newOutput.desc.attachedToDesktop) {
+            push(newOutput.desc.attachedToDesktop ? report_delta_t::OutputAttached : report_delta_t::OutputDetached, oldIndex, newIndex);
+            continue;
+        }
+        if (getRefreshRate(oldOutput.display) != getRefreshRate(newOutput.display)) {
+            push(report_delta_t::RefreshRateChanged, oldIndex, newIndex);
+        }
+        if (getHdr(oldOutput.display) != getHdr(newOutput.display)) {
+            push(report_delta_t::HdrChanged, oldIndex, newIndex);
+        }
+        if (oldOutput.display.dpi != newOutput.display.dpi) {
+            push(report_delta_t::DpiChanged, oldIndex, newIndex);
+        }
+    }
+    for (std::size_t newIndex = 0; newIndex != newAdapter.outputs.size(); ++newIndex) {
+        const OutputInfo& newOutput = newAdapter.outputs[newIndex];
+        const bool known = findIndex(oldAdapter.outputs, [&newOutput](const OutputInfo& candidate) {
+            return candidate.desc.deviceName == newOutput.desc.deviceName;
+        }).has_value();
+        if (!known && newOutput.desc.attachedToDesktop) {
+            push(report_delta_t::OutputAttached, std::nullopt, newIndex);
+        }
+    }
+}
+
+void diffReports(const GpuReport& oldReport, const GpuReport& newReport, std::vector<ReportDelta>& deltasOut) {
+    deltasOut.clear();
+    for (std::size_t oldIndex = 0; oldIndex != oldReport.adapters.size(); ++oldIndex) {
+        const AdapterInfo& oldAdapter = oldReport.adapters[oldIndex];
+        const std::optional<std::size_t> newIndex = findIndex(newReport.adapters, [&oldAdapter](const AdapterInfo& candidate) {
+            return isSameAdapter(candidate.desc, oldAdapter.desc);
+        });
+        if (!newIndex) {
+            deltasOut.push_back({ report_delta_t::AdapterRemoved, oldIndex, std::nullopt, std::nullopt, std::nullopt });
+            continue;
+        }
+        const AdapterInfo& newAdapter = newReport.adapters[newIndex.value()];
+        if (oldAdapter.driver != newAdapter.driver) {
+            deltasOut.push_back({ report_delta_t::DriverChanged, oldIndex, newIndex, std::nullopt, std::nullopt });
+        }
+        diffOutputs(oldAdapter, oldIndex, newAdapter, newIndex.value(), deltasOut);
+    }
+    for (std::size_t newIndex = 0; newIndex != newReport.adapters.size(); ++newIndex) {
+        const AdapterInfo& newAdapter = newReport.adapters[newIndex];
+        const bool known = findIndex(oldReport.adapters, [&newAdapter](const AdapterInfo& candidate) {
+            return isSameAdapter(candidate.desc, newAdapter.desc);
+        }).has_value();
+        if (!known) {
+            deltasOut.push_back({ report_delta_t::AdapterAdded, std::nullopt, newIndex, std::nullopt, std::nullopt });
+        }
+    }
+}
+
+std::wstring_view reportDeltaToString(const report_delta_t type) {
+    switch (type) {
+        case report_delta_t::AdapterAdded:
+            return L"adapterAdded";
+        case report_delta_t::AdapterRemoved:
+            return L"adapterRemoved";
+        case report_delta_t::DriverChanged:
+            return L"driverChanged";
+        case report_delta_t::OutputAttached:
+            return L"outputAttached";
+        case report_delta_t::OutputDetached:
+            return L"outputDetached";
+        case report_delta_t::RefreshRateChanged:
+            return L"refreshRateChanged";
+        case report_delta_t::HdrChanged:
+            return L"hdrChanged";
+        case report_delta_t::DpiChanged:
+            return L"dpiChanged";
+    }
+    return L"Unknown";
+}
+
+bool isHdrColorSpace(const color_space_t colorSpace) {
+    switch (colorSpace) {
+        case color_space_t::RGB_FULL_G2084_NONE_P2020:
+        case color_space_t::YCBCR_STUDIO_G2084_LEFT_P2020:
+        case color_space_t::RGB_STUDIO_G2084_NONE_P2020:
+        case color_space_t::YCBCR_STUDIO_G2084_TOPLEFT_P2020:
+        case color_space_t::YCBCR_STUDIO_GHLG_TOPLEFT_P2020:
+        case color_space_t::YCBCR_FULL_GHLG_TOPLEFT_P2020:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace gputester
@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "model.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace gputester {
+
+enum class report_delta_t : std::uint8_t {
+    AdapterAdded,
+    AdapterRemoved,
+    DriverChanged,
+    OutputAttached,
+    OutputDetached,
+    RefreshRateChanged,
+    HdrChanged, // HDR turned on or off, a switch between two SDR or two HDR color spaces is no change.
+    DpiChanged,
+};
+
+// One difference between two reports. It points into both of them: the positions of the
+// adapter and the output in the old and in the new report. The side an addition or a
+// removal has no counterpart on is empty, and so are the outputs of the adapter deltas.
+struct ReportDelta final {
+    report_delta_t type{ report_delta_t::AdapterAdded };
+    std::optional<std::size_t> oldAdapter{};
+    std::optional<std::size_t> newAdapter{};
+    std::optional<std::size_t> oldOutput{};
+    std::optional<std::size_t> newOutput{};
+};
+
+// Adapters are matched by their LUID and PCI IDs, outputs by their device name. An output
+// which leaves the desktop counts as detached even if it is still enumerated.
+void diffReports(const GpuReport& oldReport, const GpuReport& newReport, std::vector<ReportDelta>& deltasOut);
+
+[[nodiscard]] std::wstring_view reportDeltaToString(const report_delta_t type);
+
+// PQ and HLG, the color spaces Windows switches an output to when HDR is turned on.
+[[nodiscard]] bool isHdrColorSpace(const color_space_t colorSpace);
+
+} // namespace gputester
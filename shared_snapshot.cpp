@@ -0,0 +1,311 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "shared_snapshot.hpp"
+#include "text.hpp"
+#ifdef _WIN32
+#  include "win32.hpp"
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  include <csignal>
+#  include <cerrno>
+#endif
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace gputester {
+
+// A lock based fallback would live in this process only and protect nothing in the others.
+static_assert(std::atomic_ref<std::uint64_t>::is_always_lock_free);
+
+static constexpr const std::size_t kSequenceOffset{ 16 };
+static constexpr const std::size_t kSizeOffset{ 24 };
+static constexpr const std::size_t kPublishTimeOffset{ 32 };
+static constexpr const std::size_t kProcessIdOffset{ 40 };
+// A publisher which died halfway through a write leaves the sequence odd forever.
+static constexpr const std::size_t kMaxReadAttempts{ 1000 };
+
+[[nodiscard]] static inline std::size_t alignTo8(const std::size_t value) {
+    return (value + 7) & ~std::size_t{ 7 };
+}
+
+// Every access to the shared words is atomic: the snapshot area is read while it may be
+// written, and only the sequence check afterwards tells whether the copy is usable.
+[[nodiscard]] static inline std::atomic_ref<std::uint64_t> sharedWord(const std::uint8_t* data, const std::size_t offset) {
+    return std::atomic_ref<std::uint64_t>{ *reinterpret_cast<std::uint64_t*>(const_cast<std::uint8_t*>(data + offset)) };
+}
+
+#ifndef _WIN32
+static inline void getSharedMemoryName(const std::string_view name, std::string& nameOut) {
+    nameOut.assign(1, '/');
+    nameOut += name;
+}
+#else
+[[nodiscard]] static inline std::wstring getSharedMemoryName(const std::string_view name) {
+    return L"Local\\" + utf8ToWide(name);
+}
+#endif
+
+SharedSnapshotPublisher::~SharedSnapshotPublisher() {
+    close();
+}
+
+bool SharedSnapshotPublisher::open(const std::string_view name, const std::size_t capacity) {
+    close();
+    const std::size_t size = kSharedSnapshotHeaderSize + alignTo8(capacity);
+#ifdef _WIN32
+    const std::wstring mappingName = getSharedMemoryName(name);
+    const HANDLE mapping = ::CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(std::uint64_t{ size } >> 32),
+                                                static_cast<DWORD>(size & 0xFFFFFFFF), mappingName.c_str());
+    if (!mapping) {
+        std::wcerr << L"\"CreateFileMappingW\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        return false;
+    }
+    void* view = ::MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (!view) {
+        std::wcerr << L"\"MapViewOfFile\" failed: " << getLastWin32ErrorMessage() << std::endl;
+        ::CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+#else
+    getSharedMemoryName(name, m_name);
+    // A fresh object rather than resizing one that readers may still have mapped.
+    ::shm_unlink(m_name.c_str());
+    const int fd = ::shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0) {
+        std::wcerr << L"\"shm_open\" failed: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        m_name.clear();
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::wcerr << L"\"ftruncate\" failed: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        ::close(fd);
+        ::shm_unlink(m_name.c_str());
+        m_name.clear();
+        return false;
+    }
+    void* view = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // The mapping keeps the object alive.
+    if (view == MAP_FAILED) {
+        std::wcerr << L"\"mmap\" failed: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        ::shm_unlink(m_name.c_str());
+        m_name.clear();
+        return false;
+    }
+#endif
+    m_data = static_cast<std::uint8_t*>(view);
+    m_size = size;
+    // Readers only trust a segment with a complete header, the sequence goes last.
+    sharedWord(m_data, kSequenceOffset).store(0, std::memory_order_relaxed);
+    const std::uint32_t magic = kSharedSnapshotMagic;
+    const std::uint16_t version = kSharedSnapshotVersion;
+    const auto headerSize = static_cast<std::uint16_t>(kSharedSnapshotHeaderSize);
+    const auto snapshotCapacity = static_cast<std::uint64_t>(size - kSharedSnapshotHeaderSize);
+#ifdef _WIN32
+    const auto processId = static_cast<std::uint32_t>(::GetCurrentProcessId());
+#else
+    const auto processId = static_cast<std::uint32_t>(::getpid());
+#endif
+    std::memcpy(m_data + 4, &version, sizeof(version));
+    std::memcpy(m_data + 6, &headerSize, sizeof(headerSize));
+    std::memcpy(m_data + 8, &snapshotCapacity, sizeof(snapshotCapacity));
+    std::memcpy(m_data + kProcessIdOffset, &processId, sizeof(processId));
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(m_data, &magic, sizeof(magic));
+    return true;
+}
+
+void SharedSnapshotPublisher::close() {
+    if (!m_data) {
+        return;
+    }
+#ifdef _WIN32
+    ::UnmapViewOfFile(m_data);
+    ::CloseHandle(static_cast<HANDLE>(m_mapping));
+    m_mapping = nullptr;
+#else
+    ::munmap(m_data, m_size);
+    ::shm_unlink(m_name.c_str());
+    m_name.clear();
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool SharedSnapshotPublisher::publish(const std::string_view snapshot) {
+    if (!m_data) {
+        return false;
+    }
+    if (snapshot.size() > m_size - kSharedSnapshotHeaderSize) {
+        std::wcerr << L"The snapshot of " << snapshot.size() << L" bytes doesn't fit into the shared memory segment of "
+                   << m_size - kSharedSnapshotHeaderSize << L" bytes." << std::endl;
+        return false;
+    }
+    const auto publishTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const std::atomic_ref<std::uint64_t> sequence = sharedWord(m_data, kSequenceOffset);
+    const std::uint64_t begin = sequence.load(std::memory_order_relaxed) + 1;
+    sequence.store(begin, std::memory_order_relaxed);
+    // Nothing of the new snapshot may become visible before the odd sequence does.
+    std::atomic_thread_fence(std::memory_order_release);
+    sharedWord(m_data, kSizeOffset).store(snapshot.size(), std::memory_order_relaxed);
+    sharedWord(m_data, kPublishTimeOffset).store(static_cast<std::uint64_t>(publishTime), std::memory_order_relaxed);
+    for (std::size_t offset = 0; offset < snapshot.size(); offset += 8) {
+        std::uint64_t word{ 0 };
+        std::memcpy(&word, snapshot.data() + offset, std::min<std::size_t>(8, snapshot.size() - offset));
+        sharedWord(m_data, kSharedSnapshotHeaderSize + offset).store(word, std::memory_order_relaxed);
+    }
+    sequence.store(begin + 1, std::memory_order_release);
+    return true;
+}
+
+SharedSnapshotReader::~SharedSnapshotReader() {
+    close();
+}
+
+bool SharedSnapshotReader::open(const std::string_view name) {
+    close();
+#ifdef _WIN32
+    const std::wstring mappingName = getSharedMemoryName(name);
+    const HANDLE mapping = ::OpenFileMappingW(FILE_MAP_READ, FALSE, mappingName.c_str());
+    if (!mapping) {
+        return false;
+    }
+    const void* view = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info{};
+    if (!view || ::VirtualQuery(view, &info, sizeof(info)) == 0) {
+        std::wcerr << L"Failed to map the shared snapshot: " << getLastWin32ErrorMessage() << std::endl;
+        if (view) {
+            ::UnmapViewOfFile(view);
+        }
+        ::CloseHandle(mapping);
+        return false;
+    }
+    m_mapping = mapping;
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = info.RegionSize;
+#else
+    std::string objectName{};
+    getSharedMemoryName(name, objectName);
+    const int fd = ::shm_open(objectName.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat status{};
+    if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < kSharedSnapshotHeaderSize) {
+        ::close(fd);
+        return false;
+    }
+    void* view = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        std::wcerr << L"Failed to map the shared snapshot: " << utf8ToWide(std::strerror(errno)) << std::endl;
+        return false;
+    }
+    m_data = static_cast<const std::uint8_t*>(view);
+    m_size = static_cast<std::size_t>(status.st_size);
+#endif
+    std::uint32_t magic{ 0 };
+    std::memcpy(&magic, m_data, sizeof(magic));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    std::uint16_t version{ 0 };
+    std::uint64_t capacity{ 0 };
+    std::uint32_t processId{ 0 };
+    std::memcpy(&version, m_data + 4, sizeof(version));
+    std::memcpy(&capacity, m_data + 8, sizeof(capacity));
+    std::memcpy(&processId, m_data + kProcessIdOffset, sizeof(processId));
+    if (magic != kSharedSnapshotMagic || version != kSharedSnapshotVersion || capacity > m_size - kSharedSnapshotHeaderSize) {
+        close();
+        return false;
+    }
+#ifndef _WIN32
+    // Windows destroys the mapping with its last handle, a POSIX segment stays until it's unlinked.
+    if (::kill(static_cast<pid_t>(processId), 0) != 0 && errno == ESRCH) {
+        close();
+        return false;
+    }
+#endif
+    // The mapping may be rounded up to whole pages, only the capacity is ever written.
+    m_size = kSharedSnapshotHeaderSize + static_cast<std::size_t>(capacity);
+    return true;
+}
+
+void SharedSnapshotReader::close() {
+    if (!m_data) {
+        return;
+    }
+#ifdef _WIN32
+    ::UnmapViewOfFile(m_data);
+    ::CloseHandle(static_cast<HANDLE>(m_mapping));
+    m_mapping = nullptr;
+#else
+    ::munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool SharedSnapshotReader::read(std::string& bufferOut, std::uint64_t* publishTimeOut) const {
+    if (!m_data) {
+        return false;
+    }
+    const std::size_t capacity = m_size - kSharedSnapshotHeaderSize;
+    const std::atomic_ref<std::uint64_t> sequence = sharedWord(m_data, kSequenceOffset);
+    for (std::size_t attempt = 0; attempt != kMaxReadAttempts; ++attempt) {
+        const std::uint64_t begin = sequence.load(std::memory_order_acquire);
+        if (begin == 0) {
+            return false; // Nothing published yet.
+        }
+        const auto size = static_cast<std::size_t>(sharedWord(m_data, kSizeOffset).load(std::memory_order_relaxed));
+        const std::uint64_t publishTime = sharedWord(m_data, kPublishTimeOffset).load(std::memory_order_relaxed);
+        if ((begin & 1) || size > capacity) {
+            std::this_thread::yield();
+            continue;
+        }
+        bufferOut.resize(alignTo8(size));
+        for (std::size_t offset = 0; offset < size; offset += 8) {
+            const std::uint64_t word = sharedWord(m_data, kSharedSnapshotHeaderSize + offset).load(std::memory_order_relaxed);
+            std::memcpy(bufferOut.data() + offset, &word, sizeof(word));
+        }
+        // The copy has to be complete before the sequence is checked again.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != begin) {
+            continue;
+        }
+        bufferOut.resize(size);
+        if (publishTimeOut) {
+            *publishTimeOut = publishTime;
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace gputester
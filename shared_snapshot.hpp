@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// The latest binary report of a long running gputester, published in a shared memory segment
+// which any number of local processes can read without probing and without taking a lock.
+// Version 1 layout, in native byte order since the segment never leaves the machine:
+//
+//   0   u32  magic "GPSM"
+//   4   u16  version
+//   6   u16  header size, the snapshot starts right after the header
+//   8   u64  capacity of the snapshot area in bytes
+//   16  u64  sequence, odd while the publisher is writing (a seqlock)
+//   24  u64  size of the current snapshot in bytes
+//   32  u64  publish time in nanoseconds since the UNIX epoch
+//   40  u32  process id of the publisher; a killed publisher leaves its POSIX segment behind
+//
+// Readers copy the snapshot and check the sequence before and after the copy; if it was odd
+// or moved on, they raced with the publisher and simply copy again.
+namespace gputester {
+
+static constexpr const std::uint32_t kSharedSnapshotMagic{ 0x4D535047 }; // "GPSM"
+static constexpr const std::uint16_t kSharedSnapshotVersion{ 1 };
+static constexpr const std::uint32_t kSharedSnapshotHeaderSize{ 64 };
+static constexpr const std::size_t kDefaultSharedSnapshotCapacity{ 1 << 20 };
+// "/gputester-snapshot" in /dev/shm, "Local\gputester-snapshot" on Windows.
+static constexpr const std::string_view kDefaultSharedSnapshotName{ "gputester-snapshot" };
+
+class SharedSnapshotPublisher final {
+public:
+    SharedSnapshotPublisher() = default;
+    ~SharedSnapshotPublisher();
+    SharedSnapshotPublisher(const SharedSnapshotPublisher&) = delete;
+    SharedSnapshotPublisher& operator=(const SharedSnapshotPublisher&) = delete;
+
+    // Creates (or takes over) the segment. It goes away with the publisher, readers then fall back to probing.
+    [[nodiscard]] bool open(const std::string_view name = kDefaultSharedSnapshotName, const std::size_t capacity = kDefaultSharedSnapshotCapacity);
+    void close();
+
+    // Replaces the published snapshot. Readers get either the old or the new one, never a mix.
+    [[nodiscard]] bool publish(const std::string_view snapshot);
+
+private:
+    std::uint8_t* m_data{ nullptr };
+    std::size_t m_size{ 0 };
+#ifdef _WIN32
+    void* m_mapping{ nullptr }; // HANDLE
+#else
+    std::string m_name{}; // Unlinked again in close().
+#endif
+};
+
+class SharedSnapshotReader final {
+public:
+    SharedSnapshotReader() = default;
+    ~SharedSnapshotReader();
+    SharedSnapshotReader(const SharedSnapshotReader&) = delete;
+    SharedSnapshotReader& operator=(const SharedSnapshotReader&) = delete;
+
+    // Returns false without a message if nobody publishes under "name".
+    [[nodiscard]] bool open(const std::string_view name = kDefaultSharedSnapshotName);
+    void close();
+
+    // Copies the latest snapshot to "bufferOut". Returns false if nothing was published yet.
+    [[nodiscard]] bool read(std::string& bufferOut, std::uint64_t* publishTimeOut = nullptr) const;
+
+private:
+    const std::uint8_t* m_data{ nullptr };
+    std::size_t m_size{ 0 };
+#ifdef _WIN32
+    void* m_mapping{ nullptr }; // HANDLE
+#endif
+};
+
+} // namespace gputester
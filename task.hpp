@@ -0,0 +1,258 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "thread_pool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace gputester {
+
+// A lazily started coroutine which produces a T: nothing runs until it is awaited, and the
+// awaiting coroutine resumes on whichever thread the task finishes on. Must be awaited at most once.
+template <typename T>
+class [[nodiscard]] Task final {
+public:
+    struct promise_type final {
+        std::optional<T> value{};
+        std::exception_ptr exception{};
+        std::coroutine_handle<> continuation{};
+
+        [[nodiscard]] Task get_return_object() {
+            return Task{ std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+        [[nodiscard]] std::suspend_always initial_suspend() const noexcept {
+            return {};
+        }
+        [[nodiscard]] auto final_suspend() const noexcept {
+            struct FinalAwaiter final {
+                [[nodiscard]] bool await_ready() const noexcept {
+                    return false;
+                }
+                // Symmetric transfer, a chain of tasks finishing at once doesn't grow the stack.
+                [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept {
+                    const std::coroutine_handle<> continuation = handle.promise().continuation;
+                    return continuation ? continuation : std::noop_coroutine();
+                }
+                void await_resume() const noexcept {}
+            };
+            return FinalAwaiter{};
+        }
+        template <typename U>
+        void return_value(U&& result) {
+            value.emplace(std::forward<U>(result));
+        }
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+    };
+
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        destroy();
+    }
+
+    [[nodiscard]] bool await_ready() const noexcept {
+        return false;
+    }
+    [[nodiscard]] std::coroutine_handle<> await_suspend(const std::coroutine_handle<> continuation) noexcept {
+        m_handle.promise().continuation = continuation;
+        return m_handle;
+    }
+    T await_resume() {
+        promise_type& promise = m_handle.promise();
+        if (promise.exception) {
+            std::rethrow_exception(promise.exception);
+        }
+        return std::move(promise.value.value());
+    }
+
+private:
+    explicit Task(const std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    void destroy() {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = {};
+        }
+    }
+
+    std::coroutine_handle<promise_type> m_handle{};
+};
+
+// Resumes the awaiting coroutine on one of the pool's threads: "co_await resumeOn(pool);".
+[[nodiscard]] inline auto resumeOn(ThreadPool& pool) {
+    struct PoolAwaiter final {
+        ThreadPool& pool;
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return false;
+        }
+        void await_suspend(const std::coroutine_handle<> handle) const {
+            pool.post([handle]() {
+                handle.resume();
+            });
+        }
+        void await_resume() const noexcept {}
+    };
+    return PoolAwaiter{ pool };
+}
+
+// A coroutine nobody awaits: it starts right away and frees itself when it returns.
+struct DetachedTask final {
+    struct promise_type final {
+        [[nodiscard]] DetachedTask get_return_object() const noexcept {
+            return {};
+        }
+        [[nodiscard]] std::suspend_never initial_suspend() const noexcept {
+            return {};
+        }
+        [[nodiscard]] std::suspend_never final_suspend() const noexcept {
+            return {};
+        }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept {
+            std::terminate();
+        }
+    };
+};
+
+struct WhenAllState final {
+    std::atomic<std::size_t> remaining{ 0 };
+    std::coroutine_handle<> continuation{};
+    std::mutex exceptionMutex{};
+    std::exception_ptr exception{};
+};
+
+template <typename T>
+inline DetachedTask runWhenAllTask(Task<T>& task, std::optional<T>& resultOut, WhenAllState& state) {
+    try {
+        resultOut.emplace(co_await std::move(task));
+    } catch (...) {
+        const std::scoped_lock lock{ state.exceptionMutex };
+        if (!state.exception) {
+            state.exception = std::current_exception();
+        }
+    }
+    if (--state.remaining == 0) {
+        state.continuation.resume();
+    }
+}
+
+// Starts all of "tasks" at once and resumes the awaiting coroutine on the thread of the last one to finish.
+// The results keep the order of the tasks. The first exception thrown by any of them is rethrown here.
+template <typename T>
+[[nodiscard]] inline Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks) {
+    struct WhenAllAwaiter final {
+        std::vector<Task<T>>& tasks;
+        std::vector<std::optional<T>>& results;
+        WhenAllState& state;
+
+        [[nodiscard]] bool await_ready() const noexcept {
+            return tasks.empty();
+        }
+        // One count more than there are tasks, so none of them can resume the caller before all of them started.
+        [[nodiscard]] bool await_suspend(const std::coroutine_handle<> continuation) const {
+            state.continuation = continuation;
+            state.remaining = tasks.size() + 1;
+            for (std::size_t index = 0; index != tasks.size(); ++index) {
+                runWhenAllTask(tasks[index], results[index], state);
+            }
+            return --state.remaining != 0;
+        }
+        void await_resume() const noexcept {}
+    };
+    WhenAllState state{};
+    std::vector<std::optional<T>> results(tasks.size());
+    co_await WhenAllAwaiter{ tasks, results, state };
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+    std::vector<T> values{};
+    values.reserve(results.size());
+    for (auto&& result : results) {
+        values.push_back(std::move(result.value()));
+    }
+    co_return values;
+}
+
+template <typename T>
+struct SyncWaitState final {
+    std::mutex mutex{};
+    std::condition_variable condition{};
+    bool done{ false };
+    std::optional<T> value{};
+    std::exception_ptr exception{};
+};
+
+template <typename T>
+inline DetachedTask runSyncWait(Task<T>& task, SyncWaitState<T>& state) {
+    std::optional<T> value{};
+    std::exception_ptr exception{};
+    try {
+        value.emplace(co_await std::move(task));
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    // Notified under the lock, "state" is gone as soon as the waiter sees "done".
+    const std::scoped_lock lock{ state.mutex };
+    state.value = std::move(value);
+    state.exception = std::move(exception);
+    state.done = true;
+    state.condition.notify_one();
+}
+
+// Blocks the calling thread until "task" finished, for callers which aren't coroutines themselves.
+template <typename T>
+[[nodiscard]] inline T syncWait(Task<T> task) {
+    SyncWaitState<T> state{};
+    runSyncWait(task, state);
+    std::unique_lock lock{ state.mutex };
+    state.condition.wait(lock, [&state]() {
+        return state.done;
+    });
+    if (state.exception) {
+        std::rethrow_exception(state.exception);
+    }
+    return std::move(state.value.value());
+}
+
+} // namespace gputester
@@ -0,0 +1,484 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "text.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#if defined(__x86_64__) || defined(_M_X64)
+#  define GPUTESTER_SIMD_X86
+#  include <emmintrin.h>
+#  ifdef __AVX2__
+#    include <immintrin.h>
+#  endif
+#endif
+
+namespace gputester {
+
+static constexpr const char32_t kReplacementCharacter{ 0xFFFD };
+
+#if defined(__AVX2__) && defined(GPUTESTER_SIMD_X86)
+static constexpr const simd_level_t kSupportedSimdLevel{ simd_level_t::AVX2 };
+#elif defined(GPUTESTER_SIMD_X86)
+static constexpr const simd_level_t kSupportedSimdLevel{ simd_level_t::SSE2 };
+#else
+static constexpr const simd_level_t kSupportedSimdLevel{ simd_level_t::Scalar };
+#endif
+
+static std::atomic<simd_level_t> g_simdLevel{ kSupportedSimdLevel };
+
+// How the different inputs are read. "kUnitSize" is the size of the vector lanes they are compared
+// in, Latin-1 is widened to UTF-16 on load. The vector code only exists for x86, which is little
+// endian, so there the UTF-16LE bytes are plain loads too.
+struct Utf16Units final {
+    static constexpr const std::size_t kUnitSize{ 2 };
+    const std::uint8_t* data{ nullptr };
+
+    [[nodiscard]] char16_t operator[](const std::size_t index) const {
+        return static_cast<char16_t>(data[index * 2] | (data[index * 2 + 1] << 8));
+    }
+
+    template <typename Lanes>
+    [[nodiscard]] auto load(const std::size_t index) const {
+        return Lanes::load(data + index * 2);
+    }
+};
+
+struct Latin1Units final {
+    static constexpr const std::size_t kUnitSize{ 2 };
+    const std::uint8_t* data{ nullptr };
+
+    [[nodiscard]] char16_t operator[](const std::size_t index) const {
+        return static_cast<char16_t>(data[index]);
+    }
+
+    template <typename Lanes>
+    [[nodiscard]] auto load(const std::size_t index) const {
+        return Lanes::loadLatin1(data + index);
+    }
+};
+
+template <typename Char>
+struct NativeUnits final {
+    static constexpr const std::size_t kUnitSize{ sizeof(Char) };
+    const Char* data{ nullptr };
+
+    [[nodiscard]] Char operator[](const std::size_t index) const {
+        return data[index];
+    }
+
+    template <typename Lanes>
+    [[nodiscard]] auto load(const std::size_t index) const {
+        return Lanes::load(data + index);
+    }
+};
+
+template <typename Lhs, typename Rhs>
+[[nodiscard]] static inline bool equalsScalar(const Lhs lhs, const Rhs rhs, std::size_t index, const std::size_t length) {
+    for (; index != length; ++index) {
+        if (static_cast<std::uint32_t>(foldCase(lhs[index])) != static_cast<std::uint32_t>(foldCase(rhs[index]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef GPUTESTER_SIMD_X86
+// The vector form of foldCase(): the lanes are compared as signed integers, which is fine since
+// nothing above 0x7FFF needs folding. "matchMask" has "kMaskBitsPerUnit" bits set for each lane
+// where "units1" is one of "either1" or "or1" and "units2" one of "either2" or "or2".
+template <std::size_t UnitSize>
+struct Sse2Lanes;
+
+template <>
+struct Sse2Lanes<2> final {
+    using vector_t = __m128i;
+    static constexpr const std::size_t kUnits{ 8 };
+    static constexpr const std::size_t kMaskBitsPerUnit{ 2 };
+    static constexpr const std::uint32_t kAllEqual{ 0xFFFF };
+
+    [[nodiscard]] static vector_t load(const void* data) {
+        return _mm_loadu_si128(static_cast<const __m128i*>(data));
+    }
+
+    [[nodiscard]] static vector_t loadLatin1(const std::uint8_t* data) {
+        return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)), _mm_setzero_si128());
+    }
+
+    [[nodiscard]] static vector_t broadcast(const std::uint32_t unit) {
+        return _mm_set1_epi16(static_cast<short>(unit));
+    }
+
+    [[nodiscard]] static vector_t fold(const vector_t units) {
+        const __m128i ascii = _mm_and_si128(_mm_cmpgt_epi16(units, broadcast(0x60)), _mm_cmplt_epi16(units, broadcast(0x7B)));
+        const __m128i latin1 = _mm_andnot_si128(_mm_cmpeq_epi16(units, broadcast(0xF7)), _mm_and_si128(_mm_cmpgt_epi16(units, broadcast(0xDF)), _mm_cmplt_epi16(units, broadcast(0xFF))));
+        return _mm_sub_epi16(units, _mm_and_si128(_mm_or_si128(ascii, latin1), broadcast(0x20)));
+    }
+
+    [[nodiscard]] static std::uint32_t equalMask(const vector_t lhs, const vector_t rhs) {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(lhs, rhs)));
+    }
+
+    [[nodiscard]] static std::uint32_t matchMask(const vector_t units1, const vector_t either1, const vector_t or1, const vector_t units2, const vector_t either2, const vector_t or2) {
+        const vector_t match1 = _mm_or_si128(_mm_cmpeq_epi16(units1, either1), _mm_cmpeq_epi16(units1, or1));
+        const vector_t match2 = _mm_or_si128(_mm_cmpeq_epi16(units2, either2), _mm_cmpeq_epi16(units2, or2));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(match1, match2)));
+    }
+};
+
+template <>
+struct Sse2Lanes<4> final {
+    using vector_t = __m128i;
+    static constexpr const std::size_t kUnits{ 4 };
+    static constexpr const std::size_t kMaskBitsPerUnit{ 4 };
+    static constexpr const std::uint32_t kAllEqual{ 0xFFFF };
+
+    [[nodiscard]] static vector_t load(const void* data) {
+        return _mm_loadu_si128(static_cast<const __m128i*>(data));
+    }
+
+    [[nodiscard]] static vector_t broadcast(const std::uint32_t unit) {
+        return _mm_set1_epi32(static_cast<int>(unit));
+    }
+
+    [[nodiscard]] static vector_t fold(const vector_t units) {
+        const __m128i ascii = _mm_and_si128(_mm_cmpgt_epi32(units, broadcast(0x60)), _mm_cmplt_epi32(units, broadcast(0x7B)));
+        const __m128i latin1 = _mm_andnot_si128(_mm_cmpeq_epi32(units, broadcast(0xF7)), _mm_and_si128(_mm_cmpgt_epi32(units, broadcast(0xDF)), _mm_cmplt_epi32(units, broadcast(0xFF))));
+        return _mm_sub_epi32(units, _mm_and_si128(_mm_or_si128(ascii, latin1), broadcast(0x20)));
+    }
+
+    [[nodiscard]] static std::uint32_t equalMask(const vector_t lhs, const vector_t rhs) {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi32(lhs, rhs)));
+    }
+
+    [[nodiscard]] static std::uint32_t matchMask(const vector_t units1, const vector_t either1, const vector_t or1, const vector_t units2, const vector_t either2, const vector_t or2) {
+        const vector_t match1 = _mm_or_si128(_mm_cmpeq_epi32(units1, either1), _mm_cmpeq_epi32(units1, or1));
+        const vector_t match2 = _mm_or_si128(_mm_cmpeq_epi32(units2, either2), _mm_cmpeq_epi32(units2, or2));
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(match1, match2)));
+    }
+};
+
+#  ifdef __AVX2__
+template <std::size_t UnitSize>
+struct Avx2Lanes;
+
+template <>
+struct Avx2Lanes<2> final {
+    using vector_t = __m256i;
+    static constexpr const std::size_t kUnits{ 16 };
+    static constexpr const std::size_t kMaskBitsPerUnit{ 2 };
+    static constexpr const std::uint32_t kAllEqual{ 0xFFFFFFFF };
+
+    [[nodiscard]] static vector_t load(const void* data) {
+        return _mm256_loadu_si256(static_cast<const __m256i*>(data));
+    }
+
+    [[nodiscard]] static vector_t loadLatin1(const std::uint8_t* data) {
+        return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+    }
+
+    [[nodiscard]] static vector_t broadcast(const std::uint32_t unit) {
+        return _mm256_set1_epi16(static_cast<short>(unit));
+    }
+
+    [[nodiscard]] static vector_t fold(const vector_t units) {
+        const __m256i ascii = _mm256_and_si256(_mm256_cmpgt_epi16(units, broadcast(0x60)), _mm256_cmpgt_epi16(broadcast(0x7B), units));
+        const __m256i latin1 = _mm256_andnot_si256(_mm256_cmpeq_epi16(units, broadcast(0xF7)), _mm256_and_si256(_mm256_cmpgt_epi16(units, broadcast(0xDF)), _mm256_cmpgt_epi16(broadcast(0xFF), units)));
+        return _mm256_sub_epi16(units, _mm256_and_si256(_mm256_or_si256(ascii, latin1), broadcast(0x20)));
+    }
+
+    [[nodiscard]] static std::uint32_t equalMask(const vector_t lhs, const vector_t rhs) {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(lhs, rhs)));
+    }
+
+    [[nodiscard]] static std::uint32_t matchMask(const vector_t units1, const vector_t either1, const vector_t or1, const vector_t units2, const vector_t either2, const vector_t or2) {
+        const vector_t match1 = _mm256_or_si256(_mm256_cmpeq_epi16(units1, either1), _mm256_cmpeq_epi16(units1, or1));
+        const vector_t match2 = _mm256_or_si256(_mm256_cmpeq_epi16(units2, either2), _mm256_cmpeq_epi16(units2, or2));
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(match1, match2)));
+    }
+};
+
+template <>
+struct Avx2Lanes<4> final {
+    using vector_t = __m256i;
+    static constexpr const std::size_t kUnits{ 8 };
+    static constexpr const std::size_t kMaskBitsPerUnit{ 4 };
+    static constexpr const std::uint32_t kAllEqual{ 0xFFFFFFFF };
+
+    [[nodiscard]] static vector_t load(const void* data) {
+        return _mm256_loadu_si256(static_cast<const __m256i*>(data));
+    }
+
+    [[nodiscard]] static vector_t broadcast(const std::uint32_t unit) {
+        return _mm256_set1_epi32(static_cast<int>(unit));
+    }
+
+    [[nodiscard]] static vector_t fold(const vector_t units) {
+        const __m256i ascii = _mm256_and_si256(_mm256_cmpgt_epi32(units, broadcast(0x60)), _mm256_cmpgt_epi32(broadcast(0x7B), units));
+        const __m256i latin1 = _mm256_andnot_si256(_mm256_cmpeq_epi32(units, broadcast(0xF7)), _mm256_and_si256(_mm256_cmpgt_epi32(units, broadcast(0xDF)), _mm256_cmpgt_epi32(broadcast(0xFF), units)));
+        return _mm256_sub_epi32(units, _mm256_and_si256(_mm256_or_si256(ascii, latin1), broadcast(0x20)));
+    }
+
+    [[nodiscard]] static std::uint32_t equalMask(const vector_t lhs, const vector_t rhs) {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(lhs, rhs)));
+    }
+
+    [[nodiscard]] static std::uint32_t matchMask(const vector_t units1, const vector_t either1, const vector_t or1, const vector_t units2, const vector_t either2, const vector_t or2) {
+        const vector_t match1 = _mm256_or_si256(_mm256_cmpeq_epi32(units1, either1), _mm256_cmpeq_epi32(units1, or1));
+        const vector_t match2 = _mm256_or_si256(_mm256_cmpeq_epi32(units2, either2), _mm256_cmpeq_epi32(units2, or2));
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(match1, match2)));
+    }
+};
+#  endif
+
+template <typename Lanes, typename Lhs, typename Rhs>
+[[nodiscard]] static inline bool equalsVector(const Lhs lhs, const Rhs rhs, const std::size_t length) {
+    std::size_t index{ 0 };
+    for (; index + Lanes::kUnits <= length; index += Lanes::kUnits) {
+        if (Lanes::equalMask(Lanes::fold(lhs.template load<Lanes>(index)), Lanes::fold(rhs.template load<Lanes>(index))) != Lanes::kAllEqual) {
+            return false;
+        }
+    }
+    return equalsScalar(lhs, rhs, index, length);
+}
+
+// Looks for the first and the last character of the needle together, which rules out almost every
+// position before any of the characters in between are compared. The positions left over after the
+// whole vectors are covered by one more vector ending at the last position, so short haystacks
+// don't end up in a scalar loop.
+template <typename Lanes, typename Char>
+[[nodiscard]] static inline std::size_t findVector(const std::basic_string_view<Char> haystack, const std::basic_string_view<Char> needle) {
+    static constexpr const std::uint32_t kUnitMask{ (1u << Lanes::kMaskBitsPerUnit) - 1 };
+    const NativeUnits<Char> units{ haystack.data() };
+    // Both cases of the two characters, so the haystack doesn't need to be folded to find them.
+    const auto broadcastCases = [](const Char ch) {
+        const auto folded = static_cast<std::uint32_t>(foldCase(ch));
+        const std::uint32_t other = static_cast<std::uint32_t>(foldCase(static_cast<Char>(folded + 0x20))) == folded ? folded + 0x20 : folded;
+        return std::pair{ Lanes::broadcast(folded), Lanes::broadcast(other) };
+    };
+    const auto [firstUpper, firstLower] = broadcastCases(needle.front());
+    const auto [lastUpper, lastLower] = broadcastCases(needle.back());
+    const std::size_t lastOffset = needle.size() - 1;
+    const std::size_t positionCount = haystack.size() - lastOffset;
+    if (positionCount < Lanes::kUnits) {
+        for (std::size_t index = 0; index != positionCount; ++index) {
+            if (equalsScalar(NativeUnits<Char>{ haystack.data() + index }, NativeUnits<Char>{ needle.data() }, 0, needle.size())) {
+                return index;
+            }
+        }
+        return std::basic_string_view<Char>::npos;
+    }
+    for (std::size_t index = 0; index < positionCount; index += Lanes::kUnits) {
+        std::uint32_t mask{ ~std::uint32_t{ 0 } };
+        if (index + Lanes::kUnits > positionCount) {
+            const std::size_t overlap = index + Lanes::kUnits - positionCount;
+            index -= overlap;
+            mask <<= overlap * Lanes::kMaskBitsPerUnit;
+        }
+        mask &= Lanes::matchMask(units.template load<Lanes>(index), firstUpper, firstLower, units.template load<Lanes>(index + lastOffset), lastUpper, lastLower);
+        while (mask != 0) {
+            const auto bit = static_cast<std::uint32_t>(std::countr_zero(mask));
+            const std::size_t position = index + bit / Lanes::kMaskBitsPerUnit;
+            if (equalsVector<Lanes>(NativeUnits<Char>{ haystack.data() + position }, NativeUnits<Char>{ needle.data() }, lastOffset)) {
+                return position;
+            }
+            mask &= ~(kUnitMask << bit);
+        }
+    }
+    return std::basic_string_view<Char>::npos;
+}
+#endif
+
+template <typename Lhs, typename Rhs>
+[[nodiscard]] static inline bool equalsUnits(const Lhs lhs, const Rhs rhs, const std::size_t length) {
+#ifdef GPUTESTER_SIMD_X86
+    switch (g_simdLevel.load(std::memory_order_relaxed)) {
+#  ifdef __AVX2__
+        case simd_level_t::AVX2:
+            return equalsVector<Avx2Lanes<Rhs::kUnitSize>>(lhs, rhs, length);
+#  endif
+        case simd_level_t::SSE2:
+            return equalsVector<Sse2Lanes<Rhs::kUnitSize>>(lhs, rhs, length);
+        default:
+            break;
+    }
+#endif
+    return equalsScalar(lhs, rhs, 0, length);
+}
+
+static inline void appendCodePoint(std::wstring& str, const char32_t codePoint) {
+    if constexpr (sizeof(wchar_t) == 2) {
+        if (codePoint >= 0x10000) {
+            const char32_t value = codePoint - 0x10000;
+            str.push_back(static_cast<wchar_t>(0xD800 + (value >> 10)));
+            str.push_back(static_cast<wchar_t>(0xDC00 + (value & 0x3FF)));
+            return;
+        }
+    }
+    str.push_back(static_cast<wchar_t>(codePoint));
+}
+
+std::wstring utf8ToWide(const std::string_view str) {
+    std::wstring result{};
+    result.reserve(str.size());
+    for (std::size_t index = 0; index < str.size();) {
+        const auto lead = static_cast<std::uint8_t>(str[index]);
+        if (lead < 0x80) {
+            result.push_back(static_cast<wchar_t>(lead));
+            ++index;
+            continue;
+        }
+        std::size_t length{ 0 };
+        char32_t codePoint{ 0 };
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            codePoint = lead & 0x1F;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            codePoint = lead & 0x0F;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            codePoint = lead & 0x07;
+        } else {
+            appendCodePoint(result, kReplacementCharacter);
+            ++index;
+            continue;
+        }
+        if (index + length > str.size()) {
+            appendCodePoint(result, kReplacementCharacter);
+            break;
+        }
+        bool valid{ true };
+        for (std::size_t offset = 1; offset != length; ++offset) {
+            const auto trail = static_cast<std::uint8_t>(str[index + offset]);
+            if ((trail & 0xC0) != 0x80) {
+                valid = false;
+                break;
+            }
+            codePoint = (codePoint << 6) | (trail & 0x3F);
+        }
+        if (!valid || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            appendCodePoint(result, kReplacementCharacter);
+            ++index;
+            continue;
+        }
+        appendCodePoint(result, codePoint);
+        index += length;
+    }
+    return result;
+}
+
+void appendUtf8(std::string& out, const std::wstring_view str) {
+    for (std::size_t index = 0; index != str.size(); ++index) {
+        auto codePoint = static_cast<char32_t>(str[index]);
+        if (codePoint < 0x80) { // Fast path, almost everything we print is ASCII.
+            out.push_back(static_cast<char>(codePoint));
+            continue;
+        }
+        if constexpr (sizeof(wchar_t) == 2) {
+            if (codePoint >= 0xD800 && codePoint <= 0xDBFF && index + 1 != str.size()) {
+                const auto trail = static_cast<char32_t>(str[index + 1]);
+                if (trail >= 0xDC00 && trail <= 0xDFFF) {
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (trail - 0xDC00);
+                    ++index;
+                }
+            }
+        }
+        if ((codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF) {
+            codePoint = kReplacementCharacter;
+        }
+        if (codePoint < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+}
+
+bool equalsIgnoringCase(const std::u16string_view lhs, const std::u16string_view rhs) {
+    return lhs.size() == rhs.size() && equalsUnits(NativeUnits<char16_t>{ lhs.data() }, NativeUnits<char16_t>{ rhs.data() }, lhs.size());
+}
+
+bool equalsIgnoringCase(const std::wstring_view lhs, const std::wstring_view rhs) {
+    return lhs.size() == rhs.size() && equalsUnits(NativeUnits<wchar_t>{ lhs.data() }, NativeUnits<wchar_t>{ rhs.data() }, lhs.size());
+}
+
+bool equalsIgnoringCaseUtf16(const std::span<const std::uint8_t> utf16, const std::u16string_view rhs) {
+    return utf16.size() == rhs.size() * 2 && equalsUnits(Utf16Units{ utf16.data() }, NativeUnits<char16_t>{ rhs.data() }, rhs.size());
+}
+
+bool equalsIgnoringCaseLatin1(const std::span<const std::uint8_t> latin1, const std::u16string_view rhs) {
+    return latin1.size() == rhs.size() && equalsUnits(Latin1Units{ latin1.data() }, NativeUnits<char16_t>{ rhs.data() }, rhs.size());
+}
+
+std::size_t findIgnoringCase(const std::wstring_view haystack, const std::wstring_view needle) {
+    if (needle.empty()) {
+        return 0;
+    }
+    if (needle.size() > haystack.size()) {
+        return std::wstring_view::npos;
+    }
+#ifdef GPUTESTER_SIMD_X86
+    switch (g_simdLevel.load(std::memory_order_relaxed)) {
+#  ifdef __AVX2__
+        case simd_level_t::AVX2:
+            return findVector<Avx2Lanes<sizeof(wchar_t)>>(haystack, needle);
+#  endif
+        case simd_level_t::SSE2:
+            return findVector<Sse2Lanes<sizeof(wchar_t)>>(haystack, needle);
+        default:
+            break;
+    }
+#endif
+    for (std::size_t index = 0; index + needle.size() <= haystack.size(); ++index) {
+        if (equalsScalar(NativeUnits<wchar_t>{ haystack.data() + index }, NativeUnits<wchar_t>{ needle.data() }, 0, needle.size())) {
+            return index;
+        }
+    }
+    return std::wstring_view::npos;
+}
+
+simd_level_t supportedSimdLevel() {
+    return kSupportedSimdLevel;
+}
+
+simd_level_t simdLevel() {
+    return g_simdLevel.load(std::memory_order_relaxed);
+}
+
+void setSimdLevel(const simd_level_t level) {
+    g_simdLevel.store(std::min(level, kSupportedSimdLevel), std::memory_order_relaxed);
+}
+
+} // namespace gputester
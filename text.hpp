@@ -0,0 +1,76 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace gputester {
+
+// The instruction sets the case-insensitive compare and search below choose from.
+enum class simd_level_t : std::uint8_t {
+    Scalar,
+    SSE2, // Every x86-64 CPU has it.
+    AVX2 // Only with GPUTESTER_ENABLE_AVX2, which makes the whole build require it.
+};
+
+// Invalid sequences are replaced with U+FFFD instead of failing the conversion.
+[[nodiscard]] std::wstring utf8ToWide(const std::string_view str);
+// Appends to "out" so a caller can keep reusing one buffer, unpaired surrogates become U+FFFD.
+void appendUtf8(std::string& out, const std::wstring_view str);
+
+// Upper cases ASCII and Latin-1 letters (except U+00FF, whose upper case is outside Latin-1), every
+// other character only matches itself. The registry compares names by the full RtlUpcaseUnicodeChar()
+// table instead, so this is the registry's folding only for names within Latin-1: two names which
+// differ by the case of e.g. a Greek or Cyrillic letter are the same to Windows but not to us.
+template <typename Char>
+[[nodiscard]] constexpr Char foldCase(const Char ch) {
+    const auto value = static_cast<std::uint32_t>(ch);
+    if ((value >= 0x61 && value <= 0x7A) || (value >= 0xE0 && value <= 0xFE && value != 0xF7)) {
+        return static_cast<Char>(value - 0x20);
+    }
+    return ch;
+}
+
+// Compare and search ignoring case the way foldCase() does, a vector of characters at a time.
+[[nodiscard]] bool equalsIgnoringCase(const std::u16string_view lhs, const std::u16string_view rhs);
+[[nodiscard]] bool equalsIgnoringCase(const std::wstring_view lhs, const std::wstring_view rhs);
+// For names stored in files, "utf16" is UTF-16LE and "latin1" has one byte per character. Neither
+// has to be aligned.
+[[nodiscard]] bool equalsIgnoringCaseUtf16(const std::span<const std::uint8_t> utf16, const std::u16string_view rhs);
+[[nodiscard]] bool equalsIgnoringCaseLatin1(const std::span<const std::uint8_t> latin1, const std::u16string_view rhs);
+// The position of the first occurrence of "needle" in "haystack", or npos. An empty needle is found at 0.
+[[nodiscard]] std::size_t findIgnoringCase(const std::wstring_view haystack, const std::wstring_view needle);
+
+// The best level this build can use, the functions above start out with it.
+[[nodiscard]] simd_level_t supportedSimdLevel();
+[[nodiscard]] simd_level_t simdLevel();
+// Lets the benchmarks compare the levels, clamped to supportedSimdLevel().
+void setSimdLevel(const simd_level_t level);
+
+} // namespace gputester
@@ -0,0 +1,196 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+namespace gputester {
+
+static constexpr const std::size_t kMinThreadCount{ 4 };
+static constexpr const std::size_t kMaxThreadCount{ 16 };
+
+// The pool and queue the current thread works for, so its pushes stay local.
+static thread_local const ThreadPool* t_currentPool{ nullptr };
+static thread_local std::size_t t_currentQueue{ 0 };
+
+ThreadPool::ThreadPool(const std::size_t threadCount) {
+    const std::size_t count = std::max<std::size_t>(threadCount, 1);
+    m_queues.reserve(count);
+    for (std::size_t index = 0; index != count; ++index) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    m_threads.reserve(count);
+    for (std::size_t index = 0; index != count; ++index) {
+        m_threads.emplace_back(&ThreadPool::workerMain, this, index);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::scoped_lock lock{ m_wakeMutex };
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    for (auto&& thread : m_threads) {
+        thread.join();
+    }
+}
+
+std::size_t ThreadPool::defaultThreadCount() {
+    return std::clamp<std::size_t>(std::thread::hardware_concurrency(), kMinThreadCount, kMaxThreadCount);
+}
+
+std::size_t ThreadPool::threadCount() const {
+    return m_threads.size();
+}
+
+void ThreadPool::push(task_t task, const bool posted) {
+    const std::size_t queueIndex = (t_currentPool == this) ? t_currentQueue : (m_nextQueue++ % m_queues.size());
+    {
+        // Counted before it is queued, so the count never drops below the real number of
+        // queued tasks. Taking the lock orders it with the predicate checks of the waiters.
+        const std::scoped_lock lock{ m_wakeMutex };
+        ++m_queuedTaskCount;
+        if (!posted) {
+            ++m_queuedLoopTaskCount;
+        }
+    }
+    {
+        Queue& queue = *m_queues[queueIndex];
+        const std::scoped_lock lock{ queue.mutex };
+        queue.tasks.push_back(Entry{ std::move(task), posted });
+    }
+    // A parallelFor() waiter woken for a posted task would go back to sleep, so wake everyone.
+    if (posted) {
+        m_wakeCondition.notify_all();
+    } else {
+        m_wakeCondition.notify_one();
+    }
+}
+
+bool ThreadPool::tryRunOne(const bool includePosted) {
+    const bool isWorker = t_currentPool == this;
+    const std::size_t first = isWorker ? t_currentQueue : (m_nextQueue.load() % m_queues.size());
+    const auto runnable = [includePosted](const Entry& entry) {
+        return includePosted || !entry.posted;
+    };
+    Entry entry{};
+    for (std::size_t offset = 0; offset != m_queues.size() && !entry.task; ++offset) {
+        const std::size_t queueIndex = (first + offset) % m_queues.size();
+        Queue& queue = *m_queues[queueIndex];
+        const std::scoped_lock lock{ queue.mutex };
+        if (isWorker && queueIndex == t_currentQueue) {
+            // Own queue: newest first, its data is still hot.
+            const auto it = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), runnable);
+            if (it != queue.tasks.rend()) {
+                entry = std::move(*it);
+                queue.tasks.erase(std::next(it).base());
+            }
+        } else {
+            // Stealing: oldest first, usually the biggest chunk of work.
+            const auto it = std::find_if(queue.tasks.begin(), queue.tasks.end(), runnable);
+            if (it != queue.tasks.end()) {
+                entry = std::move(*it);
+                queue.tasks.erase(it);
+            }
+        }
+    }
+    if (!entry.task) {
+        return false;
+    }
+    --m_queuedTaskCount;
+    if (!entry.posted) {
+        --m_queuedLoopTaskCount;
+    }
+    entry.task();
+    return true;
+}
+
+void ThreadPool::workerMain(const std::size_t index) {
+    t_currentPool = this;
+    t_currentQueue = index;
+    while (true) {
+        if (tryRunOne(true)) {
+            continue;
+        }
+        std::unique_lock lock{ m_wakeMutex };
+        m_wakeCondition.wait(lock, [this]() {
+            return m_stopping || m_queuedTaskCount.load() > 0;
+        });
+        if (m_stopping) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    push(std::move(task), true);
+}
+
+void ThreadPool::parallelFor(const std::size_t count, const std::function<void(std::size_t)>& function) {
+    if (count == 0) {
+        return;
+    }
+    struct Group final {
+        std::atomic<std::size_t> remaining{ 0 };
+        std::mutex exceptionMutex{};
+        std::exception_ptr exception{};
+    } group{};
+    group.remaining = count;
+    for (std::size_t index = 0; index != count; ++index) {
+        push([this, &group, &function, index]() {
+            try {
+                function(index);
+            } catch (...) {
+                const std::scoped_lock lock{ group.exceptionMutex };
+                if (!group.exception) {
+                    group.exception = std::current_exception();
+                }
+            }
+            if (--group.remaining == 0) {
+                {
+                    const std::scoped_lock lock{ m_wakeMutex };
+                }
+                m_wakeCondition.notify_all();
+            }
+        }, false);
+    }
+    while (group.remaining.load() > 0) {
+        if (tryRunOne(false)) {
+            continue;
+        }
+        std::unique_lock lock{ m_wakeMutex };
+        m_wakeCondition.wait(lock, [this, &group]() {
+            return group.remaining.load() == 0 || m_queuedLoopTaskCount.load() > 0;
+        });
+    }
+    if (group.exception) {
+        std::rethrow_exception(group.exception);
+    }
+}
+
+} // namespace gputester
@@ -0,0 +1,102 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace gputester {
+
+// A small work stealing pool: every worker owns a queue, runs its own newest task first and
+// steals the oldest task of another queue when it runs dry. Threads which wait for their
+// loop keep running queued loop tasks meanwhile, so parallel loops can be nested freely.
+class ThreadPool final {
+public:
+    explicit ThreadPool(const std::size_t threadCount = defaultThreadCount());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Most probes wait for the OS rather than compute, so even small machines get a few threads.
+    [[nodiscard]] static std::size_t defaultThreadCount();
+    [[nodiscard]] std::size_t threadCount() const;
+
+    // Calls function(0) ... function(count - 1) on the pool and returns when all of them
+    // have returned. The first exception thrown by any of them is rethrown here.
+    void parallelFor(const std::size_t count, const std::function<void(std::size_t)>& function);
+
+    // Queues "task" and returns right away. It must not throw, and tasks still queued when the
+    // pool is destroyed never run. Only the workers run posted tasks, never a parallelFor()
+    // waiter: a resumed coroutine could otherwise keep the waiter's loop from returning.
+    void post(std::function<void()> task);
+
+private:
+    using task_t = std::function<void()>;
+
+    struct Entry final {
+        task_t task{};
+        bool posted{ false };
+    };
+
+    struct Queue final {
+        std::mutex mutex{};
+        std::deque<Entry> tasks{};
+    };
+
+    void push(task_t task, const bool posted);
+    [[nodiscard]] bool tryRunOne(const bool includePosted);
+    void workerMain(const std::size_t index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues{};
+    std::vector<std::thread> m_threads{};
+    std::mutex m_wakeMutex{};
+    std::condition_variable m_wakeCondition{};
+    std::atomic<std::size_t> m_queuedTaskCount{ 0 };
+    std::atomic<std::size_t> m_queuedLoopTaskCount{ 0 };
+    std::atomic<std::size_t> m_nextQueue{ 0 };
+    bool m_stopping{ false };
+};
+
+// Runs inline without a pool. Either way every result should go to its own preallocated slot,
+// which keeps the results in index order no matter which task finishes first.
+template <typename Function>
+inline void forEachIndex(ThreadPool* pool, const std::size_t count, Function&& function) {
+    if (pool && count > 1) {
+        pool->parallelFor(count, function);
+        return;
+    }
+    for (std::size_t index = 0; index != count; ++index) {
+        function(index);
+    }
+}
+
+} // namespace gputester
@@ -0,0 +1,104 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "win32.hpp"
+
+using namespace gputester;
+
+// The system libraries are loaded dynamically at runtime (see the DLL definitions in
+// win32.hpp), these shims make the registry wrapper work without an import library.
+extern "C" LSTATUS WINAPI
+RegQueryValueExW(HKEY hKey, LPCWSTR lpValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData) {
+    return ADVAPI32_API(RegQueryValueExW) ? ADVAPI32_API(RegQueryValueExW)(hKey, lpValueName, lpReserved, lpType, lpData, lpcbData) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegSetValueExW(HKEY hKey, LPCWSTR lpValueName, DWORD dwReserved, DWORD dwType, const BYTE* lpData, DWORD cbData) {
+    return ADVAPI32_API(RegSetValueExW) ? ADVAPI32_API(RegSetValueExW)(hKey, lpValueName, dwReserved, dwType, lpData, cbData) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegDeleteValueW(HKEY hKey, LPCWSTR lpValueName) {
+    return ADVAPI32_API(RegDeleteValueW) ? ADVAPI32_API(RegDeleteValueW)(hKey, lpValueName) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegEnumValueW(HKEY hKey, DWORD dwIndex, LPWSTR lpValueName, LPDWORD lpcchValueName, LPDWORD lpReserved, LPDWORD lpType, LPBYTE lpData, LPDWORD lpcbData) {
+    return ADVAPI32_API(RegEnumValueW) ? ADVAPI32_API(RegEnumValueW)(hKey, dwIndex, lpValueName, lpcchValueName, lpReserved, lpType, lpData, lpcbData) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegOpenKeyExW(HKEY hKey, LPCWSTR lpSubKey, DWORD dwOptions, REGSAM samDesired, PHKEY phkResult) {
+    return ADVAPI32_API(RegOpenKeyExW) ? ADVAPI32_API(RegOpenKeyExW)(hKey, lpSubKey, dwOptions, samDesired, phkResult) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegCreateKeyExW(HKEY hKey, LPCWSTR lpSubKey, DWORD dwReserved, LPWSTR lpClass, DWORD dwOptions, REGSAM samDesired, const LPSECURITY_ATTRIBUTES lpSecurityAttributes, PHKEY phkResult, LPDWORD lpdwDisposition) {
+    return ADVAPI32_API(RegCreateKeyExW) ? ADVAPI32_API(RegCreateKeyExW)(hKey, lpSubKey, dwReserved, lpClass, dwOptions, samDesired, lpSecurityAttributes, phkResult, lpdwDisposition) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegCloseKey(HKEY hKey) {
+    return ADVAPI32_API(RegCloseKey) ? ADVAPI32_API(RegCloseKey)(hKey) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegGetValueW(HKEY hKey, LPCWSTR lpSubKey, LPCWSTR lpValue, DWORD dwFlags, LPDWORD lpdwType, PVOID pvData, LPDWORD lpcbData) {
+    return ADVAPI32_API(RegGetValueW) ? ADVAPI32_API(RegGetValueW)(hKey, lpSubKey, lpValue, dwFlags, lpdwType, pvData, lpcbData) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegQueryMultipleValuesW(HKEY hKey, PVALENTW val_list, DWORD num_vals, LPWSTR lpValueBuf, LPDWORD ldwTotsize) {
+    return ADVAPI32_API(RegQueryMultipleValuesW) ? ADVAPI32_API(RegQueryMultipleValuesW)(hKey, val_list, num_vals, lpValueBuf, ldwTotsize) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegDeleteTreeW(HKEY hKey, LPCWSTR lpSubKey) {
+    return ADVAPI32_API(RegDeleteTreeW) ? ADVAPI32_API(RegDeleteTreeW)(hKey, lpSubKey) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegFlushKey(HKEY hKey) {
+    return ADVAPI32_API(RegFlushKey) ? ADVAPI32_API(RegFlushKey)(hKey) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegSaveKeyW(HKEY hKey, LPCWSTR lpFile, const LPSECURITY_ATTRIBUTES lpSecurityAttributes) {
+    return ADVAPI32_API(RegSaveKeyW) ? ADVAPI32_API(RegSaveKeyW)(hKey, lpFile, lpSecurityAttributes) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegQueryInfoKeyW(HKEY hKey, LPWSTR lpClass, LPDWORD lpcchClass, LPDWORD lpReserved, LPDWORD lpcSubKeys, LPDWORD lpcbMaxSubKeyLen, LPDWORD lpcbMaxClassLen, LPDWORD lpcValues, LPDWORD lpcbMaxValueNameLen, LPDWORD lpcbMaxValueLen, LPDWORD lpcbSecurityDescriptor, PFILETIME lpftLastWriteTime) {
+    return ADVAPI32_API(RegQueryInfoKeyW) ? ADVAPI32_API(RegQueryInfoKeyW)(hKey, lpClass, lpcchClass, lpReserved, lpcSubKeys, lpcbMaxSubKeyLen, lpcbMaxClassLen, lpcValues, lpcbMaxValueNameLen, lpcbMaxValueLen, lpcbSecurityDescriptor, lpftLastWriteTime) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegEnumKeyExW(HKEY hKey, DWORD dwIndex, LPWSTR lpName, LPDWORD lpcchName, LPDWORD lpReserved, LPWSTR lpClass, LPDWORD lpcchClass, PFILETIME lpftLastWriteTime) {
+    return ADVAPI32_API(RegEnumKeyExW) ? ADVAPI32_API(RegEnumKeyExW)(hKey, dwIndex, lpName, lpcchName, lpReserved, lpClass, lpcchClass, lpftLastWriteTime) : ERROR_CALL_NOT_IMPLEMENTED;
+}
+
+extern "C" LSTATUS WINAPI
+RegNotifyChangeKeyValue(HKEY hKey, BOOL bWatchSubtree, DWORD dwNotifyFilter, HANDLE hEvent, BOOL fAsynchronous) {
+    return ADVAPI32_API(RegNotifyChangeKeyValue) ? ADVAPI32_API(RegNotifyChangeKeyValue)(hKey, bWatchSubtree, dwNotifyFilter, hEvent, fAsynchronous) : ERROR_CALL_NOT_IMPLEMENTED;
+}
@@ -0,0 +1,313 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2024 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <windows.h>
+#include <versionhelpers.h>
+#include <shellscalingapi.h>
+#include <dxgi1_6.h>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Code copied from Unreal Engine 5.4.4:
+// Engine/Source/Runtime/Core/Private/Windows/WindowsPlatformMisc.cpp
+#define USE_SP_ALTPLATFORM_INFO_V1 0
+#define USE_SP_ALTPLATFORM_INFO_V3 1
+#define USE_SP_DRVINFO_DATA_V1 0
+#define USE_SP_BACKUP_QUEUE_PARAMS_V1 0
+#define USE_SP_INF_SIGNER_INFO_V1 0
+#include <setupapi.h>
+#include <initguid.h>
+#include <devguid.h>
+#include <devpkey.h>
+#undef USE_SP_ALTPLATFORM_INFO_V1
+#undef USE_SP_ALTPLATFORM_INFO_V3
+#undef USE_SP_DRVINFO_DATA_V1
+#undef USE_SP_BACKUP_QUEUE_PARAMS_V1
+#undef USE_SP_INF_SIGNER_INFO_V1
+// UE 5 source code ends here.
+
+namespace gputester {
+
+struct library_deleter_t final {
+    void operator()(const HMODULE dll) const {
+        if (dll) {
+            ::FreeLibrary(dll);
+        }
+    }
+};
+using scoped_library_t = std::unique_ptr<std::remove_pointer_t<HMODULE>, library_deleter_t>;
+
+#define LOAD_DLL(DLL, VAR) VAR = scoped_library_t{ ::LoadLibraryExW(L## #DLL, nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32) };
+#define DECL_API(SYM, VAR) \
+    using PFN_##SYM = decltype(&::SYM); \
+    PFN_##SYM p##SYM{ nullptr };
+#define LOAD_API(DLL, SYM) \
+    p##SYM = reinterpret_cast<PFN_##SYM>(::GetProcAddress(DLL, #SYM)); \
+    if (!p##SYM) { \
+        std::wcerr << L"Failed to resolve \""## #SYM ##"\": " << getLastWin32ErrorMessage() << std::endl; \
+    }
+
+[[nodiscard]] inline std::wstring getWin32ErrorMessage(const DWORD dwError) {
+    LPWSTR buf{ nullptr };
+    ::FormatMessageW(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+                     nullptr, dwError, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
+                     reinterpret_cast<LPWSTR>(&buf), 0, nullptr);
+    std::wstring str{ buf };
+    ::LocalFree(buf);
+    return str;
+}
+
+[[nodiscard]] inline std::wstring getLastWin32ErrorMessage() {
+    return getWin32ErrorMessage(::GetLastError());
+}
+
+[[nodiscard]] inline std::wstring getComErrorMessage(const HRESULT hr) {
+    return getWin32ErrorMessage(HRESULT_CODE(hr));
+}
+
+struct DLLBase {
+    DLLBase() = default;
+    ~DLLBase() = default;
+    DLLBase(const DLLBase&) = delete;
+    DLLBase& operator=(const DLLBase&) = delete;
+
+    [[nodiscard]] inline bool isAvailable() const {
+        return m_dll != nullptr;
+    }
+
+    [[nodiscard]] inline explicit operator bool() const {
+        return isAvailable();
+    }
+
+    [[nodiscard]] inline HMODULE get() const {
+        return m_dll ? m_dll.get() : nullptr;
+    }
+
+    [[nodiscard]] inline HMODULE operator*() const {
+        return get();
+    }
+
+    [[nodiscard]] inline HMODULE operator->() const {
+        return get();
+    }
+
+protected:
+    scoped_library_t m_dll{ nullptr };
+};
+#define DLLBASE_DECL_INSTANCE(Class) \
+    [[nodiscard]] static inline const Class& instance() { \
+        static const Class inst; \
+        return inst; \
+    }
+
+struct User32DLL final : public DLLBase {
+    DLLBASE_DECL_INSTANCE(User32DLL)
+
+    // Windows 2000
+    DECL_API(GetMonitorInfoW)
+    DECL_API(EnumDisplaySettingsW)
+    // Windows Vista
+    DECL_API(GetDisplayConfigBufferSizes)
+    DECL_API(DisplayConfigGetDeviceInfo)
+    // Windows 7
+    DECL_API(QueryDisplayConfig)
+    // Windows 10, version 1703
+    DECL_API(SetProcessDpiAwarenessContext)
+
+private:
+    User32DLL() : DLLBase() {
+        LOAD_DLL(user32, m_dll)
+        if (m_dll) {
+            LOAD_API(m_dll.get(), GetMonitorInfoW)
+            LOAD_API(m_dll.get(), EnumDisplaySettingsW)
+            if (::IsWindowsVistaOrGreater()) {
+                LOAD_API(m_dll.get(), GetDisplayConfigBufferSizes)
+                LOAD_API(m_dll.get(), DisplayConfigGetDeviceInfo)
+                if (::IsWindows7OrGreater()) {
+                    LOAD_API(m_dll.get(), QueryDisplayConfig)
+                    if (::IsWindows10OrGreater()) {
+                        LOAD_API(m_dll.get(), SetProcessDpiAwarenessContext)
+                    }
+                }
+            }
+        } else {
+            std::wcerr << L"Failed to load \"user32.dll\": " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+
+    ~User32DLL() = default;
+};
+#define USER32_AVAILABLE (User32DLL::instance().isAvailable())
+#define USER32_API(Name) (User32DLL::instance().p##Name)
+
+struct AdvAPI32DLL final : public DLLBase {
+    DLLBASE_DECL_INSTANCE(AdvAPI32DLL)
+
+    DECL_API(RegQueryValueExW)
+    DECL_API(RegSetValueExW)
+    DECL_API(RegDeleteValueW)
+    DECL_API(RegEnumValueW)
+    DECL_API(RegOpenKeyExW)
+    DECL_API(RegCreateKeyExW)
+    DECL_API(RegCloseKey)
+    DECL_API(RegGetValueW)
+    DECL_API(RegQueryMultipleValuesW)
+    DECL_API(RegDeleteTreeW)
+    DECL_API(RegFlushKey)
+    DECL_API(RegSaveKeyW)
+    DECL_API(RegQueryInfoKeyW)
+    DECL_API(RegEnumKeyExW)
+    DECL_API(RegNotifyChangeKeyValue)
+
+private:
+    AdvAPI32DLL() : DLLBase() {
+        LOAD_DLL(advapi32, m_dll)
+        if (m_dll) {
+            LOAD_API(m_dll.get(), RegQueryValueExW)
+            LOAD_API(m_dll.get(), RegSetValueExW)
+            LOAD_API(m_dll.get(), RegDeleteValueW)
+            LOAD_API(m_dll.get(), RegEnumValueW)
+            LOAD_API(m_dll.get(), RegOpenKeyExW)
+            LOAD_API(m_dll.get(), RegCreateKeyExW)
+            LOAD_API(m_dll.get(), RegCloseKey)
+            LOAD_API(m_dll.get(), RegGetValueW)
+            LOAD_API(m_dll.get(), RegQueryMultipleValuesW)
+            LOAD_API(m_dll.get(), RegDeleteTreeW)
+            LOAD_API(m_dll.get(), RegFlushKey)
+            LOAD_API(m_dll.get(), RegSaveKeyW)
+            LOAD_API(m_dll.get(), RegQueryInfoKeyW)
+            LOAD_API(m_dll.get(), RegEnumKeyExW)
+            LOAD_API(m_dll.get(), RegNotifyChangeKeyValue)
+        } else {
+            std::wcerr << L"Failed to load \"advapi32.dll\": " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+
+    ~AdvAPI32DLL() = default;
+};
+#define ADVAPI32_AVAILABLE (AdvAPI32DLL::instance().isAvailable())
+#define ADVAPI32_API(Name) (AdvAPI32DLL::instance().p##Name)
+
+struct GDI32DLL final : public DLLBase {
+    DLLBASE_DECL_INSTANCE(GDI32DLL)
+
+    DECL_API(CreateDCW)
+    DECL_API(DeleteDC)
+    DECL_API(GetDeviceCaps)
+
+private:
+    GDI32DLL() : DLLBase() {
+        LOAD_DLL(gdi32, m_dll)
+        if (m_dll) {
+            LOAD_API(m_dll.get(), CreateDCW)
+            LOAD_API(m_dll.get(), DeleteDC)
+            LOAD_API(m_dll.get(), GetDeviceCaps)
+        } else {
+            std::wcerr << L"Failed to load \"gdi32.dll\": " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+
+    ~GDI32DLL() = default;
+};
+#define GDI32_AVAILABLE (GDI32DLL::instance().isAvailable())
+#define GDI32_API(Name) (GDI32DLL::instance().p##Name)
+
+struct DXGIDLL final : public DLLBase {
+    DLLBASE_DECL_INSTANCE(DXGIDLL)
+
+    DECL_API(CreateDXGIFactory1)
+
+private:
+    DXGIDLL() : DLLBase() {
+        LOAD_DLL(dxgi, m_dll)
+        if (m_dll) {
+            if (::IsWindows7OrGreater()) {
+                LOAD_API(m_dll.get(), CreateDXGIFactory1)
+            }
+        } else {
+            std::wcerr << L"Failed to load \"dxgi.dll\": " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+
+    ~DXGIDLL() = default;
+};
+#define DXGI_AVAILABLE (DXGIDLL::instance().isAvailable())
+#define DXGI_API(Name) (DXGIDLL::instance().p##Name)
+
+struct SHCoreDLL final : public DLLBase {
+    DLLBASE_DECL_INSTANCE(SHCoreDLL)
+
+    DECL_API(GetDpiForMonitor)
+
+private:
+    SHCoreDLL() : DLLBase() {
+        LOAD_DLL(shcore, m_dll)
+        if (m_dll) {
+            if (::IsWindows8Point1OrGreater()) {
+                LOAD_API(m_dll.get(), GetDpiForMonitor)
+            }
+        } else {
+            std::wcerr << L"Failed to load \"shcore.dll\": " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+
+    ~SHCoreDLL() = default;
+};
+#define SHCORE_AVAILABLE (SHCoreDLL::instance().isAvailable())
+#define SHCORE_API(Name) (SHCoreDLL::instance().p##Name)
+
+struct SetupAPIDLL final : public DLLBase {
+    DLLBASE_DECL_INSTANCE(SetupAPIDLL)
+
+    // Windows 2000
+    DECL_API(SetupDiDestroyDeviceInfoList)
+    DECL_API(SetupDiEnumDeviceInfo)
+    // Windows Vista
+    DECL_API(SetupDiGetClassDevsW)
+    DECL_API(SetupDiGetDevicePropertyW)
+
+private:
+    SetupAPIDLL() : DLLBase() {
+        LOAD_DLL(setupapi, m_dll)
+        if (m_dll) {
+            LOAD_API(m_dll.get(), SetupDiDestroyDeviceInfoList)
+            LOAD_API(m_dll.get(), SetupDiEnumDeviceInfo)
+            if (::IsWindowsVistaOrGreater()) {
+                LOAD_API(m_dll.get(), SetupDiGetClassDevsW)
+                LOAD_API(m_dll.get(), SetupDiGetDevicePropertyW)
+            }
+        } else {
+            std::wcerr << L"Failed to load \"setupapi.dll\": " << getLastWin32ErrorMessage() << std::endl;
+        }
+    }
+
+    ~SetupAPIDLL() = default;
+};
+#define SETUPAPI_AVAILABLE (SetupAPIDLL::instance().isAvailable())
+#define SETUPAPI_API(Name) (SetupAPIDLL::instance().p##Name)
+
+} // namespace gputester